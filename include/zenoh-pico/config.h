@@ -17,22 +17,24 @@
 
 /*------------------ Configuration properties ------------------*/
 /**
- * The library mode.
+ * The library mode. In `"peer"` mode the session joins a multicast group and exchanges
+ * the data directly with the other peers of the group.
  * String key : `"mode"`.
- * Accepted values : `"client"`.
+ * Accepted values : `"client"`, `"peer"`.
  * Default value : `"client"`.
  */
 #define ZN_CONFIG_MODE_KEY 0x40
 #define ZN_CONFIG_MODE_DEFAULT "client"
 
 /**
- * The locator of a peer to connect to.
+ * The locator of a peer to connect to. In `"peer"` mode, the multicast group to join.
  * String key : `"peer"`.
- * Accepted values : `<locator>` (ex: `"tcp/10.10.10.10:7447"`).
- * Default value : None.
+ * Accepted values : `<locator>` (ex: `"tcp/10.10.10.10:7447"`, `"udp/224.0.0.225:7447"`).
+ * Default value : None, `"udp/224.0.0.225:7447"` in `"peer"` mode.
  * Multiple values are not accepted in zenoh-pico.
  */
 #define ZN_CONFIG_PEER_KEY 0x41
+#define ZN_CONFIG_MULTICAST_PEER_DEFAULT "udp/224.0.0.225:7447"
 
 /**
  * The user name to use for authentication.
@@ -60,7 +62,7 @@
 #define ZN_CONFIG_MULTICAST_SCOUTING_DEFAULT "true"
 
 /**
- * The network interface to use for multicast scouting.
+ * The network interface to use for multicast scouting and for the multicast group in `"peer"` mode.
  * String key : `"multicast_interface"`.
  * Accepted values : `"auto"`, `<ip address>`, `<interface name>`.
  * Default value : `"auto"`.
@@ -95,6 +97,99 @@
 #define ZN_CONFIG_ADD_TIMESTAMP_KEY 0x4A
 #define ZN_CONFIG_ADD_TIMESTAMP_DEFAULT "false"
 
+/**
+ * Indicates if multiple zenoh messages should be batched in a single frame.
+ * With `"adaptive"`, a batch is sent as soon as the link is idle and messages are only
+ * coalesced while previous writes are still in flight, up to the batching timeout.
+ * String key : `"batching"`.
+ * Accepted values : `"true"`, `"false"`, `"adaptive"`.
+ * Default value : `"false"`.
+ */
+#define ZN_CONFIG_BATCHING_KEY 0x60
+#define ZN_CONFIG_BATCHING_DEFAULT "false"
+
+/**
+ * The maximum time a batched message is retained before being sent.
+ * A value of `0` disables the deadline: in adaptive mode, a batch retained because the
+ * link was busy is then only sent by the next write or the next tick of the lease task.
+ * String key : `"batching_timeout"`.
+ * Accepted values : `<unsigned int in milliseconds>`.
+ * Default value : `"1"`.
+ */
+#define ZN_CONFIG_BATCHING_TIMEOUT_KEY 0x61
+#define ZN_CONFIG_BATCHING_TIMEOUT_DEFAULT "1"
+
+/**
+ * Indicates if QoS should be negotiated with the router. When enabled, each priority
+ * has its own sequence numbers on the wire and fragments of low priority messages
+ * can be preempted by higher priority messages.
+ * String key : `"qos"`.
+ * Accepted values : `"true"`, `"false"`.
+ * Default value : `"true"`.
+ */
+#define ZN_CONFIG_QOS_KEY 0x62
+#define ZN_CONFIG_QOS_DEFAULT "true"
+
+/**
+ * Indicates if the Nagle's algorithm should be disabled on TCP links (TCP_NODELAY).
+ * String key : `"tcp_nodelay"`.
+ * Accepted values : `"true"`, `"false"`.
+ * Default value : `"true"`.
+ */
+#define ZN_CONFIG_TCP_NODELAY_KEY 0x63
+#define ZN_CONFIG_TCP_NODELAY_DEFAULT "true"
+
+/**
+ * Indicates if the TCP delayed acknowledgments should be disabled on Linux (TCP_QUICKACK).
+ * String key : `"tcp_quickack"`.
+ * Accepted values : `"true"`, `"false"`.
+ * Default value : `"false"`.
+ */
+#define ZN_CONFIG_TCP_QUICKACK_KEY 0x64
+#define ZN_CONFIG_TCP_QUICKACK_DEFAULT "false"
+
+/**
+ * The size of the socket send buffer of the links (SO_SNDBUF).
+ * String key : `"so_sndbuf"`.
+ * Accepted values : `<int in bytes from 1 to INT_MAX>`.
+ * Default value : None, the system default is used.
+ */
+#define ZN_CONFIG_SO_SNDBUF_KEY 0x65
+
+/**
+ * The size of the socket receive buffer of the links (SO_RCVBUF).
+ * String key : `"so_rcvbuf"`.
+ * Accepted values : `<int in bytes from 1 to INT_MAX>`.
+ * Default value : None, the system default is used.
+ */
+#define ZN_CONFIG_SO_RCVBUF_KEY 0x66
+
+/**
+ * The type of service of the IP packets sent on the links (IP_TOS or IPV6_TCLASS).
+ * The DSCP value occupies the 6 most significant bits.
+ * String key : `"ip_tos"`.
+ * Accepted values : `<unsigned int from 0 to 255>`.
+ * Default value : None, the system default is used.
+ */
+#define ZN_CONFIG_IP_TOS_KEY 0x67
+
+/**
+ * The priority of the packets sent on the links on Linux (SO_PRIORITY).
+ * String key : `"so_priority"`.
+ * Accepted values : `<int from 0 to INT_MAX>`.
+ * Default value : None, the system default is used.
+ */
+#define ZN_CONFIG_SO_PRIORITY_KEY 0x68
+
+/**
+ * The path MTU of the datagram links, i.e. the largest payload of the datagrams they send.
+ * The frames and the fragments are sized after it to avoid the IP fragmentation.
+ * String key : `"mtu"`.
+ * Accepted values : `<int in bytes from ZN_LINK_MTU_MIN to INT_MAX>`.
+ * Default value : None, the MTU of the route towards the peer is used if known.
+ */
+#define ZN_CONFIG_MTU_KEY 0x69
+
 /*------------------ Configuration properties ------------------*/
 #define ZN_ATTACHMENT_BUF_LEN 16384
 #define ZN_PID_LENGTH 8
@@ -105,6 +200,15 @@
  */
 #define ZN_TRANSPORT_LEASE 10000
 #define ZN_KEEP_ALIVE_INTERVAL 1000
+/**
+ * The interval in milliseconds between two JOIN messages sent on a multicast group
+ */
+#define ZN_JOIN_INTERVAL 2500
+/**
+ * The interval in milliseconds between two SYNC messages asking the peer to acknowledge
+ * the reliable frames sent on a datagram link
+ */
+#define ZN_RELIABLE_SYNC_INTERVAL 100
 
 /**
  * The default sequence number resolution takes 4 bytes on the wire.
@@ -115,14 +219,83 @@
 #define ZN_SN_RESOLUTION ZN_SN_RESOLUTION_DEFAULT
 
 #define ZN_CONGESTION_CONTROL_DEFAULT zn_congestion_control_t_DROP
+#define ZN_PRIORITY_DEFAULT zn_priority_t_DATA
 
 #define ZN_TRANSPORT_TCP_IP 1
 //#define ZN_TRANSPORT_BLE 1
 
 #define ZN_FRAG_BUF_TX_CHUNK 128
+
+/**
+ * The maximum size of a fragmented message being reassembled on a channel, the
+ * larger messages are dropped.
+ */
 #define ZN_FRAG_BUF_RX_LIMIT 10000000
 
+/**
+ * The maximum number of buffer slices submitted at once to a scatter-gather link write.
+ */
+#define ZN_LINK_IOV_MAX 16
+
+/**
+ * The number of entries of the transmission queue used by the tx task and the
+ * size in bytes of each entry. Larger messages are encoded on a dedicated buffer.
+ */
+#define ZN_TX_QUEUE_LEN 256
+#define ZN_TX_QUEUE_ENTRY_SIZE 256
+
 #define ZN_BATCH_SIZE 65535
+
+/**
+ * The smallest path MTU of a datagram link, in bytes. The session establishment messages
+ * and the frame header of a fragment followed by some of its bytes must fit in a datagram.
+ */
+#define ZN_LINK_MTU_MIN 512
+
+/**
+ * The number of reliable frames kept by each conduit of a datagram link, both for the
+ * retransmission of the frames sent and for the reordering of the frames received.
+ * It can not exceed the number of bits of the ACK_NACK mask, i.e. of a z_zint_t.
+ */
+#define ZN_RELIABLE_WINDOW 32
+
+/**
+ * The maximum number of ready sockets handled by a reactor thread at each wake up.
+ */
+#define ZN_REACTOR_EVENTS 64
+
+/**
+ * The size in bytes of each of the two rings of a shared memory link. Must be a power of two.
+ */
+#define ZN_SHM_RING_SIZE 1048576
+
+/**
+ * The number and the size in bytes of the buffers provided to the kernel for the reception
+ * on the io_uring links. The number must be a power of two.
+ */
+#define ZN_IO_URING_BUF_NUM 8
+#define ZN_IO_URING_BUF_SIZE 65536
+
+/**
+ * The number of datagrams received or sent at once by a single recvmmsg or sendmmsg on the
+ * UDP links, the size in bytes of each receive buffer and the size in bytes of the buffer
+ * holding the datagrams queued for sending, the largest UDP payload over IPv4.
+ */
+#define ZN_UDP_MMSG_LEN 16
+#define ZN_UDP_MMSG_BUF_SIZE 65535
+#define ZN_UDP_MMSG_TX_SIZE 65507
+
+/**
+ * The number of buckets of the batch size distribution. The bucket ``i`` counts the
+ * batches carrying from ``2^i`` to ``2^(i+1) - 1`` messages, the last one all the larger batches.
+ */
+#define ZN_BATCH_STATS_BUCKETS 8
+
+/**
+ * The initial size in bytes of the arena the messages are decoded in by the read path.
+ * The arena grows to the largest size needed by a single message.
+ */
+#define ZN_READ_ARENA_SIZE 4096
 #ifdef ZN_TRANSPORT_TCP_IP
 /**
  * NOTE: 16 bits (2 bytes) may be prepended to the serialized message indicating the total length
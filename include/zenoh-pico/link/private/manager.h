@@ -18,10 +18,19 @@
 #include "zenoh-pico/link/private/result.h"
 #include "zenoh-pico/link/types.h"
 
-_zn_link_p_result_t _zn_open_link(const char *locator, const clock_t tout);
+_zn_link_opts_t _zn_link_opts_default(void);
+_zn_link_p_result_t _zn_open_link(const char *locator, const clock_t tout, const _zn_link_opts_t *opts);
 void _zn_close_link(_zn_link_t *link);
+#if defined(ZENOH_LINUX) || defined(ZENOH_MACOS)
+// Join the multicast group of a UDP locator on the given interface, "auto" lets the system choose
+_zn_link_p_result_t _zn_open_link_multicast(const char *locator, const char *iface, const clock_t tout, const _zn_link_opts_t *opts);
+#endif
 
 _zn_link_t *_zn_new_link_tcp(const char *s_addr, const char *port);
 _zn_link_t *_zn_new_link_udp(const char *s_addr, const char *port);
+_zn_link_t *_zn_new_link_udp_multicast(const char *s_addr, const char *port, const char *iface);
+_zn_link_t *_zn_new_link_shm(const char *name, int is_listener);
+_zn_link_t *_zn_new_link_unix(const char *path);
+_zn_link_t *_zn_new_link_inproc(const char *name);
 
 #endif /* _ZENOH_PICO_TRANSPORT_PRIVATE_LINK_MANAGER_H */
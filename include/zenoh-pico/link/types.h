@@ -19,26 +19,59 @@
 
 #include "zenoh-pico/system/types.h"
 #include "zenoh-pico/system/result.h"
+#include "zenoh-pico/utils/types.h"
 
 #define TCP_SCHEMA "tcp"
 #define UDP_SCHEMA "udp"
+#define SHM_SCHEMA "shm"
+#define UNIXSOCK_STREAM_SCHEMA "unixsock-stream"
+#define INPROC_SCHEMA "inproc"
+
+/**
+ * The socket options applied when opening a link. A negative value keeps the system default.
+ */
+typedef struct
+{
+    int tcp_nodelay;
+    int tcp_quickack;
+    int sndbuf;
+    int rcvbuf;
+    int tos;
+    int priority;
+    int mtu; // The path MTU of the datagram links, the largest payload of their datagrams
+} _zn_link_opts_t;
 
 typedef _zn_socket_result_t (*_zn_f_link_open)(void *arg, clock_t tout);
 typedef int (*_zn_f_link_close)(void *arg);
 typedef void (*_zn_f_link_release)(void *arg);
 typedef size_t (*_zn_f_link_write)(void *arg, const uint8_t *ptr, size_t len);
 typedef size_t (*_zn_f_link_write_all)(void *arg, const uint8_t *ptr, size_t len);
+typedef size_t (*_zn_f_link_writev)(void *arg, const z_bytes_t *bufs, size_t cnt);
+typedef size_t (*_zn_f_link_pending)(void *arg);
+typedef int (*_zn_f_link_flush)(void *arg);
+typedef size_t (*_zn_f_link_buffered)(void *arg);
 typedef size_t (*_zn_f_link_read)(void *arg, uint8_t *ptr, size_t len);
 typedef size_t (*_zn_f_link_read_exact)(void *arg, uint8_t *ptr, size_t len);
+typedef size_t (*_zn_f_link_read_from)(void *arg, uint8_t *ptr, size_t len, z_bytes_t *addr);
 
 typedef struct {
     _zn_socket_t sock;
 
     uint8_t is_reliable;
     uint8_t is_streamed;
+    uint8_t is_pollable; // The readiness of the socket can be waited for before reading
+    uint8_t is_corked; // The writes are queued by the link until the next flush
+    uint8_t is_multicast; // The frames are sent to a group and received from several peers
 
     void* endpoint;
     uint16_t mtu;
+    _zn_link_opts_t opts;
+#if defined(ZENOH_LINUX) && defined(ZENOH_IO_URING)
+    void *uring; // The io_uring queues of the socket, NULL if the plain socket calls are used
+#endif
+#if defined(ZENOH_LINUX)
+    void *mmsg; // The batched datagrams of a UDP socket, NULL if one datagram is handled per call
+#endif
 
     // Function pointers
     _zn_f_link_open open_f;
@@ -46,8 +79,13 @@ typedef struct {
     _zn_f_link_release release_f;
     _zn_f_link_write write_f;
     _zn_f_link_write_all write_all_f;
+    _zn_f_link_writev writev_f; // Optional, NULL if the link has no scatter-gather write
+    _zn_f_link_pending pending_f; // Optional, NULL if the link can not report the bytes not yet sent
+    _zn_f_link_flush flush_f; // Optional, NULL if the link can not queue the writes
     _zn_f_link_read read_f;
     _zn_f_link_read_exact read_exact_f;
+    _zn_f_link_buffered buffered_f; // Optional, NULL if the link holds no received bytes out of the socket
+    _zn_f_link_read_from read_from_f; // Optional, NULL if the link does not report the sender of the datagrams
 } _zn_link_t;
 
 #endif /* _ZENOH_PICO_TRANSPORT_PRIVATE_LINK_H */
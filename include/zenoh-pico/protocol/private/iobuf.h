@@ -39,9 +39,22 @@ z_bytes_t _z_iosli_to_bytes(const _z_iosli_t *ios);
 void _z_iosli_clear(_z_iosli_t *ios);
 void _z_iosli_free(_z_iosli_t *ios);
 
+/*------------------ Arena ------------------*/
+_z_arena_t _z_arena_make(size_t capacity);
+
+void *_z_arena_alloc(_z_arena_t *a, size_t size);
+
+size_t _z_arena_mark(const _z_arena_t *a);
+void _z_arena_rewind(_z_arena_t *a, size_t mark);
+
+void _z_arena_reset(_z_arena_t *a);
+void _z_arena_free(_z_arena_t *a);
+
 /*------------------ ZBuf ------------------*/
 _z_zbuf_t _z_zbuf_make(size_t capacity);
+_z_zbuf_t _z_zbuf_make_ring(size_t capacity);
 _z_zbuf_t _z_zbuf_view(_z_zbuf_t *zbf, size_t length);
+_z_zbuf_t _z_zbuf_wrap(uint8_t *buf, size_t length);
 
 size_t _z_zbuf_capacity(const _z_zbuf_t *zbf);
 size_t _z_zbuf_len(const _z_zbuf_t *zbf);
@@ -60,6 +73,11 @@ void _z_zbuf_set_wpos(_z_zbuf_t *zbf, size_t w_pos);
 uint8_t *_z_zbuf_get_rptr(const _z_zbuf_t *zbf);
 uint8_t *_z_zbuf_get_wptr(const _z_zbuf_t *zbf);
 
+void *_z_zbuf_alloc(_z_zbuf_t *zbf, size_t size);
+void _z_zbuf_dealloc(_z_zbuf_t *zbf, void *ptr);
+
+int _z_zbuf_append(_z_zbuf_t *zbf, const uint8_t *bs, size_t len, size_t limit);
+
 void _z_zbuf_clear(_z_zbuf_t *zbf);
 void _z_zbuf_compact(_z_zbuf_t *zbf);
 void _z_zbuf_free(_z_zbuf_t *zbf);
@@ -82,6 +100,7 @@ void _z_wbuf_set_wpos(_z_wbuf_t *wbf, size_t w_pos);
 
 void _z_wbuf_add_iosli(_z_wbuf_t *wbf, _z_iosli_t *ios);
 void _z_wbuf_add_iosli_from(_z_wbuf_t *wbf, const uint8_t *buf, size_t capacity);
+void _z_wbuf_add_iosli_wrap(_z_wbuf_t *wbf, uint8_t *buf, size_t len);
 _z_iosli_t *_z_wbuf_get_iosli(const _z_wbuf_t *wbf, size_t idx);
 size_t _z_wbuf_len_iosli(const _z_wbuf_t *wbf);
 
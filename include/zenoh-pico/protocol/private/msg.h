@@ -72,7 +72,7 @@
 #define _ZN_FLAG_T_P 0x20  // 1 << 5 | PingOrPong    if P==1 then the message is Ping, otherwise is Pong
 #define _ZN_FLAG_T_R 0x20  // 1 << 5 | Reliable      if R==1 then it concerns the reliable channel, best-effort otherwise
 #define _ZN_FLAG_T_S 0x40  // 1 << 6 | SN Resolution if S==1 then the SN Resolution is present
-#define _ZN_FLAG_T_T1 0x40 // 1 << 5 | TimeRes       if T==1 then the time resolution is in seconds
+#define _ZN_FLAG_T_T1 0x20 // 1 << 5 | TimeRes       if T==1 then the time resolution is in seconds
 #define _ZN_FLAG_T_T2 0x40 // 1 << 6 | TimeRes       if T==1 then the time resolution is in seconds
 #define _ZN_FLAG_T_W 0x40  // 1 << 6 | WhatAmI       if W==1 then WhatAmI is indicated
 #define _ZN_FLAG_T_Z 0x20  // 1 << 5 | MixedSlices   if Z==1 then the payload contains a mix of raw and shm_info payload
@@ -108,6 +108,9 @@
 #define _ZN_HAS_FLAG(h, f) ((h & f) != 0)
 #define _ZN_SET_FLAG(h, f) (h |= f)
 
+#define _ZN_PRIORITY(h) (_ZN_FLAGS(h) >> 5)
+#define _ZN_DECO_PRIORITY(p) (_ZN_MID_PRIORITY | ((p) << 5))
+
 /*=============================*/
 /*       Declaration IDs       */
 /*=============================*/
@@ -229,10 +232,11 @@ typedef struct
 //
 //  7 6 5 4 3 2 1 0
 // +-+-+-+-+-+-+-+-+
-// | ID  |  Prio   |
+// | Prio|   ID    |
 // +-+-+-+---------+
 //
-// WARNING: zenoh-pico does not support priorities and QoS.
+// The priority is carried in the flag bits. Messages without a priority decorator
+// have the default priority (zn_priority_t_DATA).
 
 /*=============================*/
 /*     Transport Messages      */
@@ -587,6 +591,8 @@ typedef struct
         _zn_payload_t fragment;
         z_vec_t messages;
     } payload;
+    // The zenoh messages are left encoded in the fragment payload, see _zn_transport_message_decode_lazy
+    int is_lazy;
 } _zn_frame_t;
 
 /*------------------ Transport Message ------------------*/
@@ -607,6 +613,7 @@ typedef struct
         _zn_ping_pong_t ping_pong;
         _zn_frame_t frame;
     } body;
+    zn_priority_t priority;
     uint8_t header;
 } _zn_transport_message_t;
 
@@ -917,6 +924,7 @@ typedef struct
         _zn_query_t query;
         _zn_pull_t pull;
     } body;
+    zn_priority_t priority;
     uint8_t header;
 } _zn_zenoh_message_t;
 
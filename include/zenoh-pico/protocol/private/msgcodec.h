@@ -104,12 +104,17 @@ _ZN_DECLARE_FREE(hello);
 _ZN_DECLARE_ENCODE_NOH(transport_message);
 _ZN_DECLARE_P_DECODE_NOH(transport_message);
 _ZN_DECLARE_FREE_NOH(transport_message);
+_zn_transport_message_p_result_t _zn_transport_message_decode_lazy(_z_zbuf_t *zbf);
 
 /*------------------ Zenoh Message ------------------*/
 _ZN_DECLARE_ENCODE_NOH(zenoh_message);
 _ZN_DECLARE_P_DECODE_NOH(zenoh_message);
 _ZN_DECLARE_FREE_NOH(zenoh_message);
 
+// Encode a data message up to its payload, the payload is encoded separately
+int _zn_zenoh_message_encode_prefix(_z_wbuf_t *wbf, const _zn_zenoh_message_t *msg);
+int _zn_zenoh_message_encode_preencoded(_z_wbuf_t *wbf, const z_bytes_t *prefix, const uint8_t *payload, size_t len);
+
 /*------------------ Free Helpers ------------------*/
 void _zn_reskey_free(zn_reskey_t *rk);
 
@@ -42,9 +42,32 @@ typedef struct
     uint8_t *buf;
 } _z_iosli_t;
 
+/**
+ * A bump allocator whose allocations are all released at once when it is reset.
+ *
+ *  Members:
+ *   uint8_t *buf: The memory the allocations are carved from.
+ *   size_t capacity: The size of the memory.
+ *   size_t len: The size of the memory already allocated.
+ *   z_list_t *overflow: The blocks allocated since the last reset once the memory was exhausted.
+ *   size_t overflow_len: The size of those blocks, added to the memory at the next reset.
+ */
+typedef struct
+{
+    uint8_t *buf;
+    size_t capacity;
+    size_t len;
+    z_list_t *overflow;
+    size_t overflow_len;
+} _z_arena_t;
+
 typedef struct
 {
     _z_iosli_t ios;
+    // The arena the messages decoded from the buffer are allocated in, if any
+    _z_arena_t *arena;
+    // The capacity of the ring, if the memory is mapped twice back to back, see _z_zbuf_make_ring
+    size_t ring;
 } _z_zbuf_t;
 
 typedef struct
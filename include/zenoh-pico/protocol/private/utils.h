@@ -25,6 +25,8 @@ _zn_transport_message_t _zn_transport_message_init(uint8_t header);
 _zn_zenoh_message_t _zn_zenoh_message_init(uint8_t header);
 _zn_reply_context_t *_zn_reply_context_init(void);
 _zn_attachment_t *_zn_attachment_init(void);
+_zn_transport_message_t _zn_init_ack_make(z_zint_t sn_resolution, int is_qos, z_bytes_t cookie);
+_zn_transport_message_t _zn_open_ack_make(z_zint_t lease, z_zint_t initial_sn);
 
 /*------------------ Clone/Copy/Free helpers ------------------*/
 zn_reskey_t _zn_reskey_clone(const zn_reskey_t *resky);
@@ -216,6 +216,30 @@ typedef enum
     zn_congestion_control_t_DROP,
 } zn_congestion_control_t;
 
+/**
+ * The priority of zenoh messages.
+ *
+ *     - **zn_priority_t_CONTROL**
+ *     - **zn_priority_t_REAL_TIME**
+ *     - **zn_priority_t_INTERACTIVE_HIGH**
+ *     - **zn_priority_t_INTERACTIVE_LOW**
+ *     - **zn_priority_t_DATA_HIGH**
+ *     - **zn_priority_t_DATA**
+ *     - **zn_priority_t_DATA_LOW**
+ *     - **zn_priority_t_BACKGROUND**
+ */
+typedef enum
+{
+    zn_priority_t_CONTROL = 0,
+    zn_priority_t_REAL_TIME = 1,
+    zn_priority_t_INTERACTIVE_HIGH = 2,
+    zn_priority_t_INTERACTIVE_LOW = 3,
+    zn_priority_t_DATA_HIGH = 4,
+    zn_priority_t_DATA = 5,
+    zn_priority_t_DATA_LOW = 6,
+    zn_priority_t_BACKGROUND = 7,
+} zn_priority_t;
+
 /**
  * The subscription period.
  *
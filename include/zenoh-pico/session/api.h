@@ -40,6 +40,15 @@ zn_properties_t *zn_config_empty(void);
  */
 zn_properties_t *zn_config_client(const char *locator);
 
+/**
+ * Create a default set of properties for peer mode zenoh-net session configuration.
+ * The session joins a multicast group and exchanges the data directly with the other peers of the group.
+ *
+ * Parameters:
+ *   locator: An optional multicast locator, ``udp/224.0.0.225:7447`` if null.
+ */
+zn_properties_t *zn_config_peer(const char *locator);
+
 /**
  * Create a default set of properties for zenoh-net session configuration.
  */
@@ -84,7 +93,8 @@ void zn_hello_array_free(zn_hello_array_t hellos);
  *     config: A set of properties.
  *
  * Returns:
- *     The created zenoh-net session or null if the creation did not succeed.
+ *     The created zenoh-net session or null if the creation did not succeed, including
+ *     when a link option of the config is out of its accepted values.
  */
 zn_session_t *zn_open(zn_properties_t *config);
 
@@ -97,7 +107,8 @@ zn_session_t *zn_open(zn_properties_t *config);
 void zn_close(zn_session_t *session);
 
 /**
- * Get informations about an zenoh-net session.
+ * Get informations about an zenoh-net session. In peer mode, the PIDs of the peers
+ * currently known are comma separated under the ``ZN_INFO_PEER_PID_KEY`` key.
  *
  * Parameters:
  *     session: A zenoh-net session.
@@ -161,6 +172,38 @@ zn_publisher_t *zn_declare_publisher(zn_session_t *session, zn_reskey_t reskey);
  */
 void zn_undeclare_publisher(zn_publisher_t *publ);
 
+/**
+ * Set the priority of the data written with a :c:type:`zn_publisher_t`.
+ * When QoS is in place, the data is sent on the conduit of the given priority
+ * and may preempt the fragmented messages of lower priority.
+ *
+ * Parameters:
+ *     pub: The :c:type:`zn_publisher_t` to configure.
+ *     priority: The :c:type:`zn_priority_t` of the published data.
+ * Returns:
+ *     ``0`` in case of success, ``-1`` if the priority is not a valid :c:type:`zn_priority_t`.
+ */
+int zn_publisher_set_priority(zn_publisher_t *pub, zn_priority_t priority);
+
+/**
+ * Set the reliability of the data written with a :c:type:`zn_publisher_t`.
+ * Best effort data uses its own sequence numbers and is never retransmitted.
+ *
+ * Parameters:
+ *     pub: The :c:type:`zn_publisher_t` to configure.
+ *     reliability: The :c:type:`zn_reliability_t` of the published data.
+ */
+void zn_publisher_set_reliability(zn_publisher_t *pub, zn_reliability_t reliability);
+
+/**
+ * Set the congestion control of the data written with a :c:type:`zn_publisher_t`.
+ *
+ * Parameters:
+ *     pub: The :c:type:`zn_publisher_t` to configure.
+ *     cong_ctrl: The :c:type:`zn_congestion_control_t` of the published data.
+ */
+void zn_publisher_set_congestion_control(zn_publisher_t *pub, zn_congestion_control_t cong_ctrl);
+
 /**
  * Declare a :c:type:`zn_subscriber_t` for the given resource key.
  *
@@ -287,6 +330,92 @@ int zn_write(zn_session_t *zn, zn_reskey_t reskey, const uint8_t *payload, size_
  */
 int zn_write_ext(zn_session_t *zn, zn_reskey_t reskey, const uint8_t *payload, size_t len, uint8_t encoding, uint8_t kind, zn_congestion_control_t cong_ctrl);
 
+/**
+ * Write data with the given priority, reliability and congestion control.
+ *
+ * Parameters:
+ *     session: The zenoh-net session.
+ *     resource: The resource key to write.
+ *     payload: The value to write.
+ *     len: The length of the value to write.
+ *     priority: The priority of this write.
+ *     reliability: The reliability of this write.
+ *     cong_ctrl: The congestion control of this write.
+ * Returns:
+ *     ``0`` in case of success, ``-1`` in case of failure or if the priority is not valid.
+ */
+int zn_write_qos(zn_session_t *zn, zn_reskey_t reskey, const uint8_t *payload, size_t len, zn_priority_t priority, zn_reliability_t reliability, zn_congestion_control_t cong_ctrl);
+
+/**
+ * Write data bypassing the transmission batching.
+ * The data and any batched message pending on the session are sent right away.
+ *
+ * Parameters:
+ *     session: The zenoh-net session.
+ *     resource: The resource key to write.
+ *     payload: The value to write.
+ *     len: The length of the value to write.
+ * Returns:
+ *     ``0`` in case of success, ``-1`` in case of failure.
+ */
+int zn_write_express(zn_session_t *zn, zn_reskey_t reskey, const uint8_t *payload, size_t len);
+
+/**
+ * Write data with a :c:type:`zn_publisher_t`.
+ * The data message is encoded when declaring the publisher, only the payload is
+ * serialized on each write.
+ *
+ * Parameters:
+ *     pub: The :c:type:`zn_publisher_t` to write with.
+ *     payload: The value to write.
+ *     len: The length of the value to write.
+ * Returns:
+ *     ``0`` in case of success, ``-1`` in case of failure.
+ */
+int zn_publish(zn_publisher_t *pub, const uint8_t *payload, size_t len);
+
+/**
+ * Begin a batch of writes.
+ * The following writes are packed in as few frames as possible and kept on the session
+ * until :c:func:`zn_batch_flush` is called. Writes larger than a frame are fragmented.
+ *
+ * Parameters:
+ *     session: The zenoh-net session.
+ * Returns:
+ *     ``0`` in case of success, ``-1`` in case of failure.
+ */
+int zn_batch_begin(zn_session_t *zn);
+
+/**
+ * Send the writes batched since the last call to :c:func:`zn_batch_begin`.
+ *
+ * Parameters:
+ *     session: The zenoh-net session.
+ * Returns:
+ *     ``0`` in case of success, ``-1`` in case of failure.
+ */
+int zn_batch_flush(zn_session_t *zn);
+
+/**
+ * Get the distribution of the size of the batches sent on the session, either by
+ * the transmission batching or as single message frames. The fragments of the messages
+ * too large for a frame are not counted.
+ *
+ * Parameters:
+ *     session: The zenoh-net session.
+ * Returns:
+ *     The :c:type:`zn_batch_stats_t` collected since the session was opened or the stats were reset.
+ */
+zn_batch_stats_t zn_batch_stats(zn_session_t *zn);
+
+/**
+ * Reset the batch size distribution of the session.
+ *
+ * Parameters:
+ *     session: The zenoh-net session.
+ */
+void zn_batch_stats_reset(zn_session_t *zn);
+
 /**
  * Pull data for a pull mode :c:type:`zn_subscriber_t`. The pulled data will be provided
  * by calling the **callback** function provided to the :c:func:`zn_declare_subscriber` function.
@@ -409,6 +538,43 @@ void zn_send_reply(zn_query_t *query, const char *key, const uint8_t *payload, s
  */
 int znp_read(zn_session_t *z);
 
+/**
+ * Get the file descriptor of the session link, to wait for it to be readable from an
+ * user event loop, e.g., epoll or libuv, instead of running a read task. The readiness
+ * must be level-triggered.
+ *
+ * Parameters:
+ *     session: The zenoh-net session.
+ * Returns:
+ *     The file descriptor or ``-1`` if the link has none, e.g., on shared memory links.
+ */
+int znp_get_fd(zn_session_t *z);
+
+/**
+ * Process the messages available on the session link, once its file descriptor is
+ * readable. All the complete batches are handled without blocking, an incomplete one
+ * is kept until the next call.
+ *
+ * Parameters:
+ *     session: The zenoh-net session.
+ * Returns:
+ *     ``0`` in case of success, ``-1`` if the link is closed or has failed.
+ */
+int znp_process_readable(zn_session_t *z);
+
+/**
+ * Process the lease, the keep alive and the batching timers of a session, instead of
+ * running a lease task. It must be called again at the latest after the returned interval.
+ * If the lease has expired, the session is closed and must not be used anymore.
+ *
+ * Parameters:
+ *     session: The zenoh-net session.
+ *     now: The current time in milliseconds, from any monotonic clock, e.g., the one of the event loop.
+ * Returns:
+ *     The interval in milliseconds until the next timer or ``-1`` if the session has expired.
+ */
+int znp_process_timers(zn_session_t *z, unsigned long now);
+
 /**
  * Send a KeepAlive message.
  *
@@ -466,4 +632,122 @@ int znp_start_lease_task(zn_session_t *z);
  */
 int znp_stop_lease_task(zn_session_t *z);
 
+/**
+ * Start a separate task to transmit the zenoh messages. Once started, the messages are
+ * encoded by the calling thread in a bounded transmission queue and the task batches and
+ * sends them on the network. Writes with ``zn_congestion_control_t_DROP`` are dropped only
+ * when the queue is full. Note that the task can be implemented in form of thread, process,
+ * etc. and its implementation is platform-dependent.
+ *
+ * Parameters:
+ *     session: The zenoh-net session.
+ * Returns:
+ *     ``0`` in case of success, ``-1`` in case of failure.
+ */
+int znp_start_tx_task(zn_session_t *z);
+
+/**
+ * Stop the transmission task and wait for it to terminate once the messages in the queue
+ * have been sent. This may result in stopping a thread or a process depending on the target
+ * platform. The task is also stopped by :c:func:`zn_close`.
+ *
+ * Parameters:
+ *     session: The zenoh-net session.
+ * Returns:
+ *     ``0`` in case of success, ``-1`` in case of failure.
+ */
+int znp_stop_tx_task(zn_session_t *z);
+
+/**
+ * Start a pool of tasks to deliver the samples to the subscribers. Once started, the samples
+ * received are copied and queued, and the subscriber callbacks are called from the tasks
+ * instead of the reception, so that a slow subscriber does not delay the others nor the
+ * session lease. The samples of a subscriber are delivered in order, by a single task at a
+ * time. Each subscriber is preferably served by the same task, and the idle tasks take the
+ * subscribers waiting on the busy ones. A subscriber undeclared from a callback, its own or
+ * another one, is not called anymore, the samples still waiting for it are dropped.
+ *
+ * Parameters:
+ *     session: The zenoh-net session.
+ *     threads: The number of tasks.
+ * Returns:
+ *     ``0`` in case of success, ``-1`` in case of failure.
+ */
+int znp_start_dispatch_tasks(zn_session_t *z, unsigned int threads);
+
+/**
+ * Stop the dispatch tasks once the samples waiting for them have been delivered, and wait
+ * for them to terminate. The samples received meanwhile are delivered first, in order, then
+ * the callbacks are called again from the reception.
+ *
+ * Parameters:
+ *     session: The zenoh-net session.
+ * Returns:
+ *     ``0`` in case of success, ``-1`` if the tasks were not started.
+ */
+int znp_stop_dispatch_tasks(zn_session_t *z);
+
+/**
+ * Create a reactor. A reactor drives the reception, the lease and the keep alive of several
+ * sessions from a pool of threads, instead of a read task and a lease task per session.
+ * It waits for the readiness of the sessions sockets and is only available on Linux.
+ *
+ * Returns:
+ *     A :c:type:`znp_reactor_t` or ``NULL`` if the reactor is not supported on the platform.
+ */
+znp_reactor_t *znp_reactor_new(void);
+
+/**
+ * Attach a session to a reactor. The session must not have a read task nor a lease task,
+ * and its link must be a TCP, UDP or Unix domain socket link. A session whose lease expires
+ * is closed by the reactor, as the lease task would do.
+ *
+ * Parameters:
+ *     reactor: The reactor.
+ *     session: The zenoh-net session.
+ * Returns:
+ *     ``0`` in case of success, ``-1`` in case of failure.
+ */
+int znp_reactor_attach(znp_reactor_t *r, zn_session_t *z);
+
+/**
+ * Detach a session from a reactor. The session is left open.
+ *
+ * Parameters:
+ *     reactor: The reactor.
+ *     session: The zenoh-net session.
+ * Returns:
+ *     ``0`` in case of success, ``-1`` if the session was not attached.
+ */
+int znp_reactor_detach(znp_reactor_t *r, zn_session_t *z);
+
+/**
+ * Start the threads of a reactor. A ready session is processed by a single thread at a time.
+ *
+ * Parameters:
+ *     reactor: The reactor.
+ *     threads: The number of threads.
+ * Returns:
+ *     ``0`` in case of success, ``-1`` in case of failure.
+ */
+int znp_reactor_start(znp_reactor_t *r, unsigned int threads);
+
+/**
+ * Stop the threads of a reactor and wait for them to terminate.
+ *
+ * Parameters:
+ *     reactor: The reactor.
+ * Returns:
+ *     ``0`` in case of success, ``-1`` if the reactor was not started.
+ */
+int znp_reactor_stop(znp_reactor_t *r);
+
+/**
+ * Stop and free a reactor. The sessions still attached are left open.
+ *
+ * Parameters:
+ *     reactor: The reactor.
+ */
+void znp_reactor_free(znp_reactor_t *r);
+
 #endif /* _ZENOH_PICO_SESSION_API_H */
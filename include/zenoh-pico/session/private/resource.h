@@ -34,4 +34,8 @@ z_str_t __unsafe_zn_get_resource_name_from_key(zn_session_t *zn, int is_local, c
 _zn_resource_t *__unsafe_zn_get_resource_by_id(zn_session_t *zn, int is_local, z_zint_t id);
 _zn_resource_t *__unsafe_zn_get_resource_matching_key(zn_session_t *zn, int is_local, const zn_reskey_t *reskey);
 
+// The resources of a list not owned by the session, e.g. the ones declared by a multicast peer
+_zn_resource_t *__zn_get_resource_by_id_from_list(z_list_t *decls, z_zint_t id);
+z_str_t __zn_get_resource_name_from_list(z_list_t *decls, const zn_reskey_t *reskey);
+
 #endif /* _ZENOH_PICO_SESSION_RESOURCE_H */
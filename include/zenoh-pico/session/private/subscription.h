@@ -30,6 +30,10 @@ void _zn_unregister_subscription(zn_session_t *zn, int is_local, _zn_subscriber_
 void _zn_flush_subscriptions(zn_session_t *zn);
 void _zn_trigger_subscriptions(zn_session_t *zn, const zn_reskey_t reskey, const z_bytes_t payload);
 
+/*------------------ Dispatch ------------------*/
+void __unsafe_zn_dispatch_sample(zn_session_t *zn, _zn_subscriber_t *sub, const zn_sample_t *s);
+int _zn_dispatch_forget(zn_session_t *zn, _zn_subscriber_t *sub);
+
 void __unsafe_zn_add_rem_res_to_loc_sub_map(zn_session_t *zn, z_zint_t id, zn_reskey_t *reskey);
 
 /*------------------ Pull ------------------*/
@@ -31,15 +31,65 @@ typedef struct
     zn_reskey_t key;
 } _zn_resource_t;
 
-typedef struct
+/**
+ * A sample waiting to be delivered by the dispatch tasks. The key and the payload are
+ * copied right after the job, in the same allocation.
+ */
+typedef struct _zn_dispatch_job_t
+{
+    struct _zn_dispatch_job_t *next;
+    zn_sample_t sample;
+} _zn_dispatch_job_t;
+
+typedef struct _zn_subscriber_t
 {
     z_zint_t id;
     zn_reskey_t key;
     zn_subinfo_t info;
     zn_data_handler_t callback;
     void *arg;
+
+    // The samples waiting for the dispatch tasks, in the order they have been received
+    _zn_dispatch_job_t *jobs_head;
+    _zn_dispatch_job_t *jobs_tail;
+    // Whether the subscriber is ready on, or run by, a dispatch task, a single one at a time
+    int is_scheduled;
+    // Whether the subscriber has been undeclared from a callback, the dispatch task frees it
+    int is_undeclared;
+    struct _zn_subscriber_t *next_ready;
 } _zn_subscriber_t;
 
+/**
+ * A dispatch task and the subscribers ready on it, that the idle tasks may steal.
+ */
+typedef struct
+{
+    z_mutex_t mutex;
+    _zn_subscriber_t *ready_head;
+    _zn_subscriber_t *ready_tail;
+    z_task_t task;
+    void *dispatcher;
+} _zn_dispatch_worker_t;
+
+/**
+ * The pool of tasks delivering the samples to the subscribers, see znp_start_dispatch_tasks.
+ * The mutex protects the samples waiting on the subscribers and puts the idle tasks to sleep.
+ */
+typedef struct
+{
+    z_mutex_t mutex;
+    z_condvar_t ready;
+    z_condvar_t idle;
+    volatile unsigned int ready_num;
+    volatile int running;
+    // The undeclarations waiting for the samples being delivered, the pool outlives them
+    unsigned int forgetting;
+
+    _zn_dispatch_worker_t *workers;
+    unsigned int workers_num;
+    unsigned int tasks_num;
+} _zn_dispatcher_t;
+
 typedef struct
 {
     z_zint_t id;
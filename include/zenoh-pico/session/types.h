@@ -28,6 +28,110 @@
  */
 typedef void (*zn_on_disconnect_t)(void *zn);
 
+/**
+ * The distribution of the size of the batches sent on a session.
+ *
+ * Members:
+ *   z_zint_t batches: The number of batches sent.
+ *   z_zint_t messages: The number of zenoh messages carried by the batches.
+ *   z_zint_t bytes: The number of bytes sent in the batches.
+ *   z_zint_t hist[ZN_BATCH_STATS_BUCKETS]: The number of batches per number of messages, in power of two buckets.
+ */
+typedef struct
+{
+    z_zint_t batches;
+    z_zint_t messages;
+    z_zint_t bytes;
+    z_zint_t hist[ZN_BATCH_STATS_BUCKETS];
+} zn_batch_stats_t;
+
+/**
+ * A reliable frame kept by a conduit on a datagram link, either to be retransmitted or
+ * until the frames preceding it are received. The buffer is reused by the following frames.
+ */
+typedef struct
+{
+    z_zint_t sn;
+    uint8_t *buf;
+    size_t len;
+    size_t capacity;
+} _zn_frame_slot_t;
+
+/**
+ * The reassembly of the fragmented messages of a channel. The fragments are appended to a single
+ * contiguous buffer, kept from one message to the next, where the message is decoded in place.
+ */
+typedef struct
+{
+    _z_zbuf_t zbf;
+    // The message exceeded ZN_FRAG_BUF_RX_LIMIT, its fragments are dropped up to the last one
+    int is_dropping;
+} _zn_defrag_t;
+
+/**
+ * A conduit of the session. When QoS is negotiated each priority has its own conduit,
+ * otherwise all the messages are sent and received on the first one.
+ */
+typedef struct
+{
+    // SN numbers
+    z_zint_t sn_tx_reliable;
+    z_zint_t sn_tx_best_effort;
+    z_zint_t sn_rx_reliable;
+    z_zint_t sn_rx_best_effort;
+
+    // Defragmentation buffers
+    _zn_defrag_t dbuf_reliable;
+    _zn_defrag_t dbuf_best_effort;
+
+    // Transmission batching, the buffer is allocated on first use
+    _z_wbuf_t *wbuf;
+    int batch_is_open;
+    unsigned int batch_msgs;
+    zn_reliability_t batch_reliability;
+    z_zint_t batch_sn;
+    z_clock_t batch_start;
+
+    // Reliability on the datagram links, the windows are allocated on first use.
+    // The reliable frames sent and not yet acknowledged, from the oldest one
+    _zn_frame_slot_t *tx_window;
+    unsigned int tx_first;
+    unsigned int tx_count;
+    // The reliable frames received ahead of the next expected one
+    _zn_frame_slot_t *rx_window;
+    unsigned int rx_count;
+    unsigned int rx_unacked;
+} _zn_conduit_t;
+
+/**
+ * A peer of the multicast group a session in peer mode has joined. The peer is known from
+ * its JOIN messages and receives its own SNs, conduits and resource declarations.
+ */
+typedef struct
+{
+    // The address the datagrams of the peer are sent from
+    z_bytes_t addr;
+    z_bytes_t pid;
+
+    z_zint_t sn_resolution;
+    z_zint_t sn_resolution_half;
+    z_zint_t lease;
+
+    // Priority conduits
+    int is_qos;
+    _zn_conduit_t conduits[_ZN_PRIORITIES_NUM];
+    // The SNs of the best effort frames are only known from the first frame received
+    int is_best_effort_synced[_ZN_PRIORITIES_NUM];
+
+    // The resources declared by the peer
+    z_list_t *resources;
+
+    // The lease of the peer, in milliseconds
+    volatile int received;
+    int lease_started;
+    unsigned long lease_deadline;
+} _zn_transport_peer_t;
+
 /**
  * A zenoh-net session.
  */
@@ -41,9 +145,8 @@ typedef struct
 
     _z_wbuf_t wbuf;
     _z_zbuf_t zbuf;
-
-    _z_wbuf_t dbuf_reliable;
-    _z_wbuf_t dbuf_best_effort;
+    // The arena the batches are decoded in, reset after each message
+    _z_arena_t arena;
 
     // Connection state
     z_bytes_t local_pid;
@@ -55,11 +158,32 @@ typedef struct
     z_zint_t sn_resolution;
     z_zint_t sn_resolution_half;
 
-    // SN numbers
-    z_zint_t sn_tx_reliable;
-    z_zint_t sn_tx_best_effort;
-    z_zint_t sn_rx_reliable;
-    z_zint_t sn_rx_best_effort;
+    // Priority conduits
+    int is_qos;
+    _zn_conduit_t conduits[_ZN_PRIORITIES_NUM];
+
+    // Transmission batching
+    int batching;
+    int batch_is_adaptive;
+    unsigned int batch_timeout;
+    int batch_is_held;
+    zn_batch_stats_t batch_stats;
+
+    // Preemption of fragmented messages
+    volatile int tx_waiting[_ZN_PRIORITIES_NUM];
+    volatile int tx_frag_cid;
+    unsigned int tx_cid_busy;
+    z_condvar_t tx_cid_free;
+    z_condvar_t tx_preempted;
+
+    // Transmission queue
+    z_lf_queue_t *tx_queue;
+    z_lf_queue_t *tx_pool;
+    z_mutex_t mutex_tx_queue;
+    z_condvar_t tx_queue_not_empty;
+    z_condvar_t tx_queue_not_full;
+    volatile int tx_queue_waiters;
+    volatile int tx_task_idle;
 
     // Counters
     z_zint_t resource_id;
@@ -80,6 +204,12 @@ typedef struct
 
     z_list_t *pending_queries;
 
+    // The peers of the multicast group, if the session is in peer mode
+    z_list_t *peers;
+    z_mutex_t mutex_peers;
+    // The address the datagrams of the session are looped back from
+    z_bytes_t self_addr;
+
     // Runtime
     zn_on_disconnect_t on_disconnect;
 
@@ -90,8 +220,38 @@ typedef struct
     volatile int received;
     volatile int transmitted;
     z_task_t *lease_task;
+
+    // The deadlines of the lease, keep alive, batching, join and sync timers, in milliseconds
+    int timers_started;
+    unsigned long lease_deadline;
+    unsigned long keep_alive_deadline;
+    unsigned long batch_deadline;
+    unsigned long join_deadline;
+    unsigned long sync_deadline;
+
+    volatile int tx_task_running;
+    z_task_t *tx_task;
+
+    // The tasks the samples are delivered to the subscribers from, if started
+    void *dispatcher;
 } zn_session_t;
 
+/**
+ * A reactor driving the reception and the timers of several sessions from a pool of threads.
+ */
+typedef struct
+{
+    void *poller;
+    z_mutex_t mutex;
+    z_list_t *entries;
+    z_clock_t start;
+    volatile unsigned long next_timer;
+
+    volatile int running;
+    z_task_t *tasks;
+    unsigned int tasks_num;
+} znp_reactor_t;
+
 /**
  * Return type when declaring a publisher.
  */
@@ -100,6 +260,15 @@ typedef struct
     zn_session_t *zn;
     z_zint_t id;
     zn_reskey_t key;
+
+    // The resource id declared for the key, if any
+    z_zint_t rid;
+    // The data message encoded up to the payload
+    z_bytes_t header;
+    // The priority, reliability and congestion control of the published data
+    zn_priority_t priority;
+    zn_reliability_t reliability;
+    zn_congestion_control_t cong_ctrl;
 } zn_publisher_t;
 
 /**
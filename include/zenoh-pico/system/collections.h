@@ -25,4 +25,13 @@ z_mvar_t *z_mvar_of(void *e);
 void *z_mvar_get(z_mvar_t *mv);
 void z_mvar_put(z_mvar_t *mv, void *e);
 
+/*-------- Lock-free bounded queue --------*/
+z_lf_queue_t *z_lf_queue_make(size_t capacity);
+size_t z_lf_queue_capacity(const z_lf_queue_t *q);
+
+int z_lf_queue_push(z_lf_queue_t *q, void *e);
+void *z_lf_queue_pull(z_lf_queue_t *q);
+
+void z_lf_queue_free(z_lf_queue_t *q);
+
 #endif /* _ZENOH_PICO_SYSTEM_PRIVATE_COLLECTIONS_H */
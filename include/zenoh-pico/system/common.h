@@ -23,6 +23,7 @@
 
 /*------------------ Thread ------------------*/
 int z_task_init(z_task_t *task, z_task_attr_t *attr, void *(*fun)(void *), void *arg);
+int z_task_join(z_task_t *task);
 
 /*------------------ Mutex ------------------*/
 int z_mutex_init(z_mutex_t *m);
@@ -37,6 +38,7 @@ int z_condvar_init(z_condvar_t *cv);
 int z_condvar_free(z_condvar_t *cv);
 
 int z_condvar_signal(z_condvar_t *cv);
+int z_condvar_broadcast(z_condvar_t *cv);
 int z_condvar_wait(z_condvar_t *cv, z_mutex_t *m);
 
 /*------------------ Sleep ------------------*/
@@ -56,29 +58,119 @@ time_t z_time_elapsed_us(z_time_t *time);
 time_t z_time_elapsed_ms(z_time_t *time);
 time_t z_time_elapsed_s(z_time_t *time);
 
+#if defined(ZENOH_LINUX) || defined(ZENOH_MACOS)
+/*------------------ Ring ------------------*/
+uint8_t *_zn_ring_map(size_t *capacity);
+void _zn_ring_unmap(uint8_t *buf, size_t capacity);
+#endif
+
+#if defined(ZENOH_LINUX)
+/*------------------ Poller ------------------*/
+void *_zn_poller_open(void);
+void _zn_poller_close(void *poller);
+int _zn_poller_add(void *poller, _zn_socket_t sock, void *data);
+int _zn_poller_rearm(void *poller, _zn_socket_t sock, void *data);
+int _zn_poller_del(void *poller, _zn_socket_t sock);
+int _zn_poller_wait(void *poller, void **ready, int max, int timeout);
+int _zn_poller_wakeup(void *poller);
+int _zn_poller_reset(void *poller);
+#endif
+
 /*------------------ Network ------------------*/
 int _zn_send_wbuf(_zn_link_t *link, const _z_wbuf_t *wbf);
 int _zn_recv_zbuf(_zn_link_t *link, _z_zbuf_t *zbf);
 int _zn_recv_exact_zbuf(_zn_link_t *link, _z_zbuf_t *zbf, size_t len);
+int _zn_recv_from_zbuf(_zn_link_t *link, _z_zbuf_t *zbf, z_bytes_t *addr);
+void _zn_cork_link(_zn_link_t *link);
+int _zn_flush_link(_zn_link_t *link);
+int _zn_uncork_link(_zn_link_t *link);
 
 char *_zn_select_scout_iface(void);
+int _zn_set_socket_opts(_zn_socket_t sock, int family, const _zn_link_opts_t *opts);
+#if defined(ZENOH_LINUX) || defined(ZENOH_MACOS)
+int _zn_socket_readable(_zn_socket_t sock);
+#endif
 
 // TCP
 void* _zn_create_endpoint_tcp(const char *s_addr, const char *port);
 void _zn_release_endpoint_tcp(void *arg);
-_zn_socket_result_t _zn_open_tcp(void *arg);
+_zn_socket_result_t _zn_open_tcp(void *arg, const _zn_link_opts_t *opts);
 int _zn_close_tcp(_zn_socket_t sock);
 int _zn_read_exact_tcp(_zn_socket_t sock, uint8_t *ptr, size_t len);
 int _zn_read_tcp(_zn_socket_t sock, uint8_t *ptr, size_t len);
 int _zn_send_tcp(_zn_socket_t sock, const uint8_t *ptr, size_t len);
+int _zn_sendv_tcp(_zn_socket_t sock, const z_bytes_t *bufs, size_t cnt);
+size_t _zn_pending_tcp(_zn_socket_t sock);
+void _zn_rearm_quickack_tcp(_zn_socket_t sock);
 
 // UDP
 void* _zn_create_endpoint_udp(const char *s_addr, const char *port);
 void _zn_release_endpoint_udp(void *arg);
-_zn_socket_result_t _zn_open_udp(void *arg, const clock_t tout);
+_zn_socket_result_t _zn_open_udp(void *arg, const clock_t tout, const _zn_link_opts_t *opts);
 int _zn_close_udp(_zn_socket_t sock);
 int _zn_read_exact_udp(_zn_socket_t sock, uint8_t *ptr, size_t len);
 int _zn_read_udp(_zn_socket_t sock, uint8_t *ptr, size_t len);
 int _zn_send_udp(_zn_socket_t sock, const uint8_t *ptr, size_t len, void *arg);
+int _zn_sendv_udp(_zn_socket_t sock, const z_bytes_t *bufs, size_t cnt, void *arg);
+size_t _zn_pending_udp(_zn_socket_t sock);
+size_t _zn_get_mtu_udp(void *arg);
+
+#if defined(ZENOH_LINUX) || defined(ZENOH_MACOS)
+// UDP MULTICAST
+void* _zn_create_endpoint_udp_multicast(const char *s_addr, const char *port, const char *iface);
+void _zn_release_endpoint_udp_multicast(void *arg);
+_zn_socket_result_t _zn_open_udp_multicast(void *arg, const _zn_link_opts_t *opts);
+int _zn_close_udp_multicast(_zn_socket_t sock, void *arg);
+int _zn_read_exact_udp_multicast(_zn_socket_t sock, uint8_t *ptr, size_t len, void *arg);
+int _zn_read_udp_multicast(_zn_socket_t sock, uint8_t *ptr, size_t len, void *arg, z_bytes_t *addr);
+int _zn_send_udp_multicast(void *arg, const uint8_t *ptr, size_t len);
+int _zn_sendv_udp_multicast(void *arg, const z_bytes_t *bufs, size_t cnt);
+size_t _zn_pending_udp_multicast(void *arg);
+size_t _zn_get_mtu_udp_multicast(void *arg);
+#endif
+
+// UNIX
+void* _zn_create_endpoint_unix(const char *path);
+void _zn_release_endpoint_unix(void *arg);
+_zn_socket_result_t _zn_open_unix(void *arg, const _zn_link_opts_t *opts);
+int _zn_close_unix(_zn_socket_t sock);
+int _zn_read_exact_unix(_zn_socket_t sock, uint8_t *ptr, size_t len);
+int _zn_read_unix(_zn_socket_t sock, uint8_t *ptr, size_t len);
+int _zn_send_unix(_zn_socket_t sock, const uint8_t *ptr, size_t len);
+int _zn_sendv_unix(_zn_socket_t sock, const z_bytes_t *bufs, size_t cnt);
+size_t _zn_pending_unix(_zn_socket_t sock);
+
+// SHM
+void* _zn_create_endpoint_shm(const char *name, int is_listener);
+void _zn_release_endpoint_shm(void *arg);
+_zn_socket_result_t _zn_open_shm(void *arg, const clock_t tout);
+int _zn_close_shm(void *arg);
+int _zn_read_exact_shm(void *arg, uint8_t *ptr, size_t len);
+int _zn_read_shm(void *arg, uint8_t *ptr, size_t len);
+int _zn_send_shm(void *arg, const uint8_t *ptr, size_t len);
+int _zn_sendv_shm(void *arg, const z_bytes_t *bufs, size_t cnt);
+size_t _zn_pending_shm(void *arg);
+
+#if defined(ZENOH_LINUX)
+// UDP MMSG
+void *_zn_mmsg_open(_zn_socket_t sock, const void *raddr);
+void _zn_mmsg_free(void *arg);
+int _zn_mmsg_read_exact(void *arg, uint8_t *ptr, size_t len);
+int _zn_mmsg_read(void *arg, uint8_t *ptr, size_t len);
+size_t _zn_mmsg_buffered(void *arg);
+int _zn_mmsg_sendv(void *arg, const z_bytes_t *bufs, size_t cnt);
+int _zn_mmsg_flush(void *arg);
+#endif
+
+#if defined(ZENOH_LINUX) && defined(ZENOH_IO_URING)
+// IO_URING
+void *_zn_uring_open(_zn_socket_t sock, int is_streamed, const void *raddr);
+void _zn_uring_cancel(void *arg);
+void _zn_uring_free(void *arg);
+int _zn_uring_read_exact(void *arg, uint8_t *ptr, size_t len);
+int _zn_uring_read(void *arg, uint8_t *ptr, size_t len);
+int _zn_uring_send(void *arg, const uint8_t *ptr, size_t len);
+int _zn_uring_sendv(void *arg, const z_bytes_t *bufs, size_t cnt);
+#endif
 
 #endif /* _ZENOH_PICO_SYSTEM_PRIVATE_COMMON_H */
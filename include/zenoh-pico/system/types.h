@@ -16,6 +16,8 @@
 #ifndef _ZENOH_PICO_SYSTEM_TYPES_H
 #define _ZENOH_PICO_SYSTEM_TYPES_H
 
+#include <stddef.h>
+
 #if defined(ZENOH_LINUX) || defined(ZENOH_MACOS)
 #include "zenoh-pico/system/private/unix/types.h"
 #elif defined(ZENOH_ZEPHYR)
@@ -36,4 +38,18 @@ typedef struct
     z_condvar_t can_get;
 } z_mvar_t;
 
+typedef struct
+{
+    size_t seq;
+    void *elem;
+} _z_lf_queue_cell_t;
+
+typedef struct
+{
+    _z_lf_queue_cell_t *cells;
+    size_t mask;
+    size_t enqueue_pos;
+    size_t dequeue_pos;
+} z_lf_queue_t;
+
 #endif /* _ZENOH_PICO_SYSTEM_TYPES_H */
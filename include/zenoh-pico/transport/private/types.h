@@ -0,0 +1,35 @@
+/*
+ * Copyright (c) 2017, 2021 ADLINK Technology Inc.
+ *
+ * This program and the accompanying materials are made available under the
+ * terms of the Eclipse Public License 2.0 which is available at
+ * http://www.eclipse.org/legal/epl-2.0, or the Apache License, Version 2.0
+ * which is available at https://www.apache.org/licenses/LICENSE-2.0.
+ *
+ * SPDX-License-Identifier: EPL-2.0 OR Apache-2.0
+ *
+ * Contributors:
+ *   ADLINK zenoh team, <zenoh@adlink-labs.tech>
+ */
+
+#ifndef _ZENOH_PICO_TRANSPORT_PRIVATE_TYPES_H
+#define _ZENOH_PICO_TRANSPORT_PRIVATE_TYPES_H
+
+#include "zenoh-pico/protocol/types.h"
+#include "zenoh-pico/protocol/private/iobuf.h"
+
+/**
+ * An entry of the transmission queue holding an encoded zenoh message.
+ * Messages larger than the entry buffer are encoded on the expandable fbf buffer.
+ */
+typedef struct
+{
+    _z_wbuf_t wbuf;
+    _z_wbuf_t fbf;
+    int has_fbf;
+    zn_priority_t priority;
+    zn_reliability_t reliability;
+    int is_express;
+} _zn_tx_entry_t;
+
+#endif /* _ZENOH_PICO_TRANSPORT_PRIVATE_TYPES_H */
@@ -21,17 +21,68 @@
 #include "zenoh-pico/protocol/types.h"
 #include "zenoh-pico/protocol/private/msg.h"
 #include "zenoh-pico/protocol/private/msgcodec.h"
+#include "zenoh-pico/transport/private/types.h"
 
 /*------------------ SN helpers ------------------*/
 int _zn_sn_precedes(z_zint_t sn_resolution_half, z_zint_t sn_left, z_zint_t sn_right);
+_zn_conduit_t *_zn_get_conduit(zn_session_t *zn, zn_priority_t priority);
 
 /*------------------ Transmission and Reception helpers ------------------*/
 int _zn_send_t_msg(zn_session_t *zn, _zn_transport_message_t *m);
-int _zn_send_z_msg(zn_session_t *zn, _zn_zenoh_message_t *m, zn_reliability_t reliability, zn_congestion_control_t cong_ctrl);
+int _zn_send_z_msg(zn_session_t *zn, _zn_zenoh_message_t *m, zn_reliability_t reliability, zn_congestion_control_t cong_ctrl, int is_express);
+int _zn_send_preencoded_data(zn_session_t *zn, const z_bytes_t *prefix, const uint8_t *payload, size_t len, zn_priority_t priority, zn_reliability_t reliability, zn_congestion_control_t cong_ctrl, int is_express);
+int _zn_flush_batch(zn_session_t *zn);
+int _zn_batch_begin(zn_session_t *zn);
+int _zn_batch_flush(zn_session_t *zn);
+size_t _zn_link_wbuf_capacity(const _zn_link_t *link);
+
+int __unsafe_zn_flush_batch(zn_session_t *zn);
+int __unsafe_zn_send_encoded_z_msg(zn_session_t *zn, _z_wbuf_t *src, zn_priority_t priority, zn_reliability_t reliability);
+int _zn_lock_tx(zn_session_t *zn, zn_priority_t priority, zn_congestion_control_t cong_ctrl);
+
+/*------------------ Transmission queue ------------------*/
+int _zn_tx_queue_push(zn_session_t *zn, _zn_zenoh_message_t *m, zn_reliability_t reliability, zn_congestion_control_t cong_ctrl, int is_express);
+int _zn_tx_queue_push_preencoded(zn_session_t *zn, const z_bytes_t *prefix, const uint8_t *payload, size_t len, zn_priority_t priority, zn_reliability_t reliability, zn_congestion_control_t cong_ctrl, int is_express);
+void _zn_tx_queue_free(zn_session_t *zn);
 
 _zn_transport_message_p_result_t _zn_recv_t_msg(zn_session_t *zn);
 void _zn_recv_t_msg_na(zn_session_t *zn, _zn_transport_message_p_result_t *r);
 
 int _zn_handle_transport_message(zn_session_t *zn, _zn_transport_message_t *msg);
+int _zn_handle_frame(zn_session_t *zn, _zn_transport_peer_t *peer, _zn_transport_message_t *msg);
+int _zn_handle_frame_payload(zn_session_t *zn, _zn_transport_peer_t *peer, _zn_conduit_t *c, _zn_transport_message_t *msg);
+int _zn_handle_batch(zn_session_t *zn, _z_zbuf_t *zbf);
+
+/*------------------ Defragmentation ------------------*/
+void _zn_defrag_init(_zn_defrag_t *d);
+void _zn_defrag_reset(_zn_defrag_t *d);
+void _zn_defrag_free(_zn_defrag_t *d);
+
+/*------------------ Reliability on datagram links ------------------*/
+int _zn_link_needs_retransmission(const _zn_link_t *link);
+void _zn_free_frame_windows(_zn_conduit_t *c);
+
+void __unsafe_zn_keep_frame(zn_session_t *zn, _zn_conduit_t *c, z_zint_t sn, const _z_wbuf_t *wbf);
+int _zn_handle_reliable_frame(zn_session_t *zn, _zn_conduit_t *c, _zn_transport_message_t *msg);
+int _zn_handle_sync(zn_session_t *zn, _zn_transport_message_t *msg);
+int _zn_handle_ack_nack(zn_session_t *zn, _zn_transport_message_t *msg);
+int _zn_send_syncs(zn_session_t *zn);
+
+/*------------------ Multicast peers ------------------*/
+int _zn_send_join(zn_session_t *zn);
+int _zn_handle_multicast_batch(zn_session_t *zn, _z_zbuf_t *zbf, const z_bytes_t *addr);
+int _zn_handle_peer_zenoh_message(zn_session_t *zn, _zn_transport_peer_t *peer, _zn_zenoh_message_t *z_msg);
+void _zn_expire_peers(zn_session_t *zn, unsigned long now);
+void _zn_flush_peers(zn_session_t *zn);
+z_string_t _zn_get_peer_pids(zn_session_t *zn);
+
+int __unsafe_zn_read_multicast(zn_session_t *zn);
+
+/*------------------ Event-driven helpers ------------------*/
+// Whether a deadline has been reached, the millisecond counters may wrap around
+#define _ZN_TIMER_EXPIRED(now, deadline) ((long)((now) - (deadline)) >= 0)
+
+int _zn_process_readable(zn_session_t *zn);
+int _zn_process_timers(zn_session_t *zn, unsigned long now);
 
 #endif /* _ZENOH_PICO_TRANSPORT_PRIVATE_UTILS_H */
@@ -0,0 +1,121 @@
+/*
+ * Copyright (c) 2017, 2021 ADLINK Technology Inc.
+ *
+ * This program and the accompanying materials are made available under the
+ * terms of the Eclipse Public License 2.0 which is available at
+ * http://www.eclipse.org/legal/epl-2.0, or the Apache License, Version 2.0
+ * which is available at https://www.apache.org/licenses/LICENSE-2.0.
+ *
+ * SPDX-License-Identifier: EPL-2.0 OR Apache-2.0
+ *
+ * Contributors:
+ *     ADLINK zenoh team, <zenoh@adlink-labs.tech>
+ */
+
+#include <stdint.h>
+#include <stdlib.h>
+#include "zenoh-pico/system/collections.h"
+
+/*-------- Lock-free bounded queue --------*/
+// NOTE: This is a bounded multi-producer multi-consumer queue where each cell carries a
+//       sequence number indicating whether it is ready to be written or to be read.
+//       Producers and consumers only synchronize on the cell they are operating on.
+z_lf_queue_t *z_lf_queue_make(size_t capacity)
+{
+    // The capacity is rounded up to the next power of two
+    size_t cap = 2;
+    while (cap < capacity)
+        cap <<= 1;
+
+    z_lf_queue_t *q = (z_lf_queue_t *)malloc(sizeof(z_lf_queue_t));
+    q->cells = (_z_lf_queue_cell_t *)malloc(cap * sizeof(_z_lf_queue_cell_t));
+    for (size_t i = 0; i < cap; i++)
+    {
+        q->cells[i].seq = i;
+        q->cells[i].elem = NULL;
+    }
+    q->mask = cap - 1;
+    q->enqueue_pos = 0;
+    q->dequeue_pos = 0;
+
+    return q;
+}
+
+size_t z_lf_queue_capacity(const z_lf_queue_t *q)
+{
+    return q->mask + 1;
+}
+
+int z_lf_queue_push(z_lf_queue_t *q, void *e)
+{
+    _z_lf_queue_cell_t *cell;
+    size_t pos = __atomic_load_n(&q->enqueue_pos, __ATOMIC_RELAXED);
+    do
+    {
+        cell = &q->cells[pos & q->mask];
+        size_t seq = __atomic_load_n(&cell->seq, __ATOMIC_ACQUIRE);
+        intptr_t diff = (intptr_t)seq - (intptr_t)pos;
+        if (diff == 0)
+        {
+            // The cell is free, try to reserve it
+            if (__atomic_compare_exchange_n(&q->enqueue_pos, &pos, pos + 1, 1, __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+                break;
+        }
+        else if (diff < 0)
+        {
+            // The queue is full
+            return -1;
+        }
+        else
+        {
+            // Another producer reserved the cell, retry
+            pos = __atomic_load_n(&q->enqueue_pos, __ATOMIC_RELAXED);
+        }
+    } while (1);
+
+    // Publish the element to the consumers
+    cell->elem = e;
+    __atomic_store_n(&cell->seq, pos + 1, __ATOMIC_RELEASE);
+
+    return 0;
+}
+
+void *z_lf_queue_pull(z_lf_queue_t *q)
+{
+    _z_lf_queue_cell_t *cell;
+    size_t pos = __atomic_load_n(&q->dequeue_pos, __ATOMIC_RELAXED);
+    do
+    {
+        cell = &q->cells[pos & q->mask];
+        size_t seq = __atomic_load_n(&cell->seq, __ATOMIC_ACQUIRE);
+        intptr_t diff = (intptr_t)seq - (intptr_t)(pos + 1);
+        if (diff == 0)
+        {
+            // The cell is ready, try to reserve it
+            if (__atomic_compare_exchange_n(&q->dequeue_pos, &pos, pos + 1, 1, __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+                break;
+        }
+        else if (diff < 0)
+        {
+            // The queue is empty
+            return NULL;
+        }
+        else
+        {
+            // Another consumer reserved the cell, retry
+            pos = __atomic_load_n(&q->dequeue_pos, __ATOMIC_RELAXED);
+        }
+    } while (1);
+
+    // Release the cell to the producers
+    void *e = cell->elem;
+    __atomic_store_n(&cell->seq, pos + q->mask + 1, __ATOMIC_RELEASE);
+
+    return e;
+}
+
+void z_lf_queue_free(z_lf_queue_t *q)
+{
+    free(q->cells);
+    free(q);
+}
@@ -32,9 +32,99 @@ int _zn_recv_exact_zbuf(_zn_link_t *link, _z_zbuf_t *zbf, size_t len)
     return rb;
 }
 
+int _zn_recv_from_zbuf(_zn_link_t *link, _z_zbuf_t *zbf, z_bytes_t *addr)
+{
+    int rb = link->read_from_f(link, _z_zbuf_get_wptr(zbf), _z_zbuf_space_left(zbf), addr);
+    if (rb > 0)
+        _z_zbuf_set_wpos(zbf, _z_zbuf_get_wpos(zbf) + rb);
+    return rb;
+}
+
 /*------------------ Socket Send ------------------*/
+int _zn_send_wbuf_vectored(_zn_link_t *link, const _z_wbuf_t *wbf)
+{
+    z_bytes_t bufs[ZN_LINK_IOV_MAX];
+    size_t n_slices = _z_wbuf_len_iosli(wbf);
+    size_t i = 0;
+
+    if (!link->is_streamed)
+    {
+        // A datagram must be sent whole by a single call, it can not be resumed
+        size_t cnt = 0;
+        size_t len = 0;
+        for (; i < n_slices; i++)
+        {
+            z_bytes_t bs = _z_iosli_to_bytes(_z_wbuf_get_iosli(wbf, i));
+            if (bs.len == 0)
+                continue;
+            if (cnt == ZN_LINK_IOV_MAX)
+            {
+                _Z_DEBUG("Too many slices to send the wbuf as a single datagram\n");
+                return -1;
+            }
+            bufs[cnt++] = bs;
+            len += bs.len;
+        }
+
+        _Z_DEBUG("Sending wbuf on socket...");
+        int wb = link->writev_f(link, bufs, cnt);
+        _Z_DEBUG_VA(" sent %d bytes\n", wb);
+        if (wb < 0 || (size_t)wb != len)
+        {
+            _Z_DEBUG_VA("Error while sending data over socket [%d]\n", wb);
+            return -1;
+        }
+        return 0;
+    }
+
+    while (i < n_slices)
+    {
+        // Gather up to ZN_LINK_IOV_MAX non-empty slices
+        size_t cnt = 0;
+        for (; i < n_slices && cnt < ZN_LINK_IOV_MAX; i++)
+        {
+            z_bytes_t bs = _z_iosli_to_bytes(_z_wbuf_get_iosli(wbf, i));
+            if (bs.len > 0)
+                bufs[cnt++] = bs;
+        }
+
+        // Submit the gathered slices, resuming after partial writes
+        z_bytes_t *it = bufs;
+        while (cnt > 0)
+        {
+            _Z_DEBUG("Sending wbuf on socket...");
+            int wb = link->writev_f(link, it, cnt);
+            _Z_DEBUG_VA(" sent %d bytes\n", wb);
+            if (wb <= 0)
+            {
+                _Z_DEBUG_VA("Error while sending data over socket [%d]\n", wb);
+                return -1;
+            }
+
+            size_t n = wb;
+            while (cnt > 0 && n >= it->len)
+            {
+                n -= it->len;
+                it++;
+                cnt--;
+            }
+            if (cnt > 0)
+            {
+                it->val += n;
+                it->len -= n;
+            }
+        }
+    }
+
+    return 0;
+}
+
 int _zn_send_wbuf(_zn_link_t *link, const _z_wbuf_t *wbf)
 {
+    // Submit all the slices in a single call if the link supports it
+    if (link->writev_f != NULL && _z_wbuf_len_iosli(wbf) > 1)
+        return _zn_send_wbuf_vectored(link, wbf);
+
     for (size_t i = 0; i < _z_wbuf_len_iosli(wbf); i++)
     {
         z_bytes_t bs = _z_iosli_to_bytes(_z_wbuf_get_iosli(wbf, i));
@@ -57,3 +147,25 @@ int _zn_send_wbuf(_zn_link_t *link, const _z_wbuf_t *wbf)
 
     return 0;
 }
+
+/*------------------ Link corking ------------------*/
+void _zn_cork_link(_zn_link_t *link)
+{
+    // Only the links able to queue the writes can be corked
+    if (link->flush_f != NULL)
+        link->is_corked = 1;
+}
+
+int _zn_flush_link(_zn_link_t *link)
+{
+    if (!link->is_corked)
+        return 0;
+    return link->flush_f(link);
+}
+
+int _zn_uncork_link(_zn_link_t *link)
+{
+    int res = _zn_flush_link(link);
+    link->is_corked = 0;
+    return res;
+}
@@ -67,7 +67,7 @@ void _zn_release_endpoint_udp(void *arg)
 }
 
 /*------------------ TCP sockets ------------------*/
-_zn_socket_result_t _zn_open_tcp(void *arg)
+_zn_socket_result_t _zn_open_tcp(void *arg, const _zn_link_opts_t *opts)
 {
     struct addrinfo *raddr = (struct addrinfo*)arg;
     _zn_socket_result_t r;
@@ -103,6 +103,17 @@ _zn_socket_result_t _zn_open_tcp(void *arg)
     }
 #endif
 
+    // Only the Nagle's algorithm can be tuned on this platform
+#ifdef TCP_NODELAY
+    if (opts->tcp_nodelay >= 0 && setsockopt(r.value.socket, IPPROTO_TCP, TCP_NODELAY, (void *)&opts->tcp_nodelay, sizeof(int)) < 0)
+    {
+        r.tag = _z_res_t_ERR;
+        r.value.error = errno;
+        close(r.value.socket);
+        return r;
+    }
+#endif
+
     struct addrinfo *it = NULL;
     for (it = raddr; it != NULL; it = it->ai_next)
     {
@@ -158,7 +169,7 @@ int _zn_send_tcp(_zn_socket_t sock, const uint8_t *ptr, size_t len)
 }
 
 /*------------------ UDP sockets ------------------*/
-_zn_socket_result_t _zn_open_udp(void *arg, const clock_t tout)
+_zn_socket_result_t _zn_open_udp(void *arg, const clock_t tout, const _zn_link_opts_t *opts)
 {
     struct addrinfo *raddr = (struct addrinfo*)arg;
     _zn_socket_result_t r;
@@ -209,3 +220,11 @@ int _zn_send_udp(_zn_socket_t sock, const uint8_t *ptr, size_t len, void *arg)
 
     return sendto(sock, ptr, len, 0, raddr->ai_addr, raddr->ai_addrlen);
 }
+
+size_t _zn_get_mtu_udp(void *arg)
+{
+    struct addrinfo *raddr = (struct addrinfo*) arg;
+
+    // The MTU of the route is not known, assume an Ethernet link minus the IP and UDP headers
+    return raddr->ai_family == AF_INET6 ? 1452 : 1472;
+}
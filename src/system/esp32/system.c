@@ -23,6 +23,11 @@ int z_task_init(pthread_t *task, pthread_attr_t *attr, void *(*fun)(void *), voi
     return pthread_create(task, attr, fun, arg);
 }
 
+int z_task_join(pthread_t *task)
+{
+    return pthread_join(*task, NULL);
+}
+
 /*------------------ Mutex ------------------*/
 int z_mutex_init(pthread_mutex_t *m)
 {
@@ -65,6 +70,11 @@ int z_condvar_signal(z_condvar_t *cv)
     return pthread_cond_signal(cv);
 }
 
+int z_condvar_broadcast(z_condvar_t *cv)
+{
+    return pthread_cond_broadcast(cv);
+}
+
 int z_condvar_wait(z_condvar_t *cv, z_mutex_t *m)
 {
     return pthread_cond_wait(cv, m);
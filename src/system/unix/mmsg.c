@@ -0,0 +1,266 @@
+/*
+ * Copyright (c) 2017, 2021 ADLINK Technology Inc.
+ *
+ * This program and the accompanying materials are made available under the
+ * terms of the Eclipse Public License 2.0 which is available at
+ * http://www.eclipse.org/legal/epl-2.0, or the Apache License, Version 2.0
+ * which is available at https://www.apache.org/licenses/LICENSE-2.0.
+ *
+ * SPDX-License-Identifier: EPL-2.0 OR Apache-2.0
+ *
+ * Contributors:
+ *   ADLINK zenoh team, <zenoh@adlink-labs.tech>
+ */
+
+#if defined(ZENOH_LINUX)
+
+// The batched socket calls are GNU extensions
+#define _GNU_SOURCE
+
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/udp.h>
+#include <sys/socket.h>
+
+#include "zenoh-pico/system/common.h"
+#include "zenoh-pico/utils/private/logging.h"
+
+/*------------------ Batched datagrams ------------------*/
+// NOTE: The datagrams received by a single recvmmsg are kept in a pool and handed over one
+//       by one to the reads, that only go to the socket once the pool is empty. The datagrams
+//       written while the link is corked are copied back to back on a send buffer and sent
+//       with a single sendmmsg on flush, or as a single GSO super datagram if they all but
+//       the last have the same size. The reception and the transmission are serialized by
+//       different session mutexes and never share any state.
+typedef struct
+{
+    _zn_socket_t sock;
+    const struct addrinfo *raddr;
+
+    // The datagrams received by the last recvmmsg
+    uint8_t *rx_bufs;
+    struct iovec rx_iov[ZN_UDP_MMSG_LEN];
+    struct mmsghdr rx_msgs[ZN_UDP_MMSG_LEN];
+    unsigned int rx_cnt;
+    unsigned int rx_next;
+
+    // The datagrams queued for the next sendmmsg
+    uint8_t *tx_buf;
+    size_t tx_len;
+    struct iovec tx_iov[ZN_UDP_MMSG_LEN];
+    struct mmsghdr tx_msgs[ZN_UDP_MMSG_LEN];
+    unsigned int tx_cnt;
+
+    // The largest segment size accepted by UDP_SEGMENT, 0 if GSO is not available
+    size_t gso_max;
+} _zn_mmsg_t;
+
+void *_zn_mmsg_open(_zn_socket_t sock, const void *raddr)
+{
+    _zn_mmsg_t *m = (_zn_mmsg_t *)malloc(sizeof(_zn_mmsg_t));
+    memset(m, 0, sizeof(_zn_mmsg_t));
+    m->sock = sock;
+    m->raddr = (const struct addrinfo *)raddr;
+
+    m->rx_bufs = (uint8_t *)malloc((size_t)ZN_UDP_MMSG_LEN * ZN_UDP_MMSG_BUF_SIZE);
+    for (int i = 0; i < ZN_UDP_MMSG_LEN; i++)
+    {
+        m->rx_iov[i].iov_base = m->rx_bufs + (size_t)i * ZN_UDP_MMSG_BUF_SIZE;
+        m->rx_iov[i].iov_len = ZN_UDP_MMSG_BUF_SIZE;
+        m->rx_msgs[i].msg_hdr.msg_iov = &m->rx_iov[i];
+        m->rx_msgs[i].msg_hdr.msg_iovlen = 1;
+    }
+
+    m->tx_buf = (uint8_t *)malloc(ZN_UDP_MMSG_TX_SIZE);
+    for (int i = 0; i < ZN_UDP_MMSG_LEN; i++)
+    {
+        m->tx_msgs[i].msg_hdr.msg_name = m->raddr->ai_addr;
+        m->tx_msgs[i].msg_hdr.msg_namelen = m->raddr->ai_addrlen;
+        m->tx_msgs[i].msg_hdr.msg_iov = &m->tx_iov[i];
+        m->tx_msgs[i].msg_hdr.msg_iovlen = 1;
+    }
+
+#if defined(UDP_SEGMENT)
+    // The kernels that do not know UDP_SEGMENT reject the option
+    int gso_size = 0;
+    socklen_t optlen = sizeof(gso_size);
+    if (getsockopt(sock, SOL_UDP, UDP_SEGMENT, &gso_size, &optlen) == 0)
+        m->gso_max = ZN_UDP_MMSG_TX_SIZE;
+#endif
+
+    return m;
+}
+
+void _zn_mmsg_free(void *arg)
+{
+    _zn_mmsg_t *m = (_zn_mmsg_t *)arg;
+
+    free(m->rx_bufs);
+    free(m->tx_buf);
+    free(m);
+}
+
+/*------------------ Reception ------------------*/
+int _zn_mmsg_read(void *arg, uint8_t *ptr, size_t len)
+{
+    _zn_mmsg_t *m = (_zn_mmsg_t *)arg;
+
+    if (m->rx_next == m->rx_cnt)
+    {
+        // Wait for a datagram and take all the others already received
+        m->rx_next = 0;
+        m->rx_cnt = 0;
+        int n = recvmmsg(m->sock, m->rx_msgs, ZN_UDP_MMSG_LEN, MSG_WAITFORONE, NULL);
+        if (n <= 0)
+            return -1;
+        m->rx_cnt = n;
+    }
+
+    // The bytes that do not fit are discarded, as with recv
+    struct mmsghdr *msg = &m->rx_msgs[m->rx_next];
+    size_t n = msg->msg_len <= len ? msg->msg_len : len;
+    memcpy(ptr, msg->msg_hdr.msg_iov->iov_base, n);
+    m->rx_next++;
+
+    return n;
+}
+
+int _zn_mmsg_read_exact(void *arg, uint8_t *ptr, size_t len)
+{
+    size_t n = 0;
+    while (n < len)
+    {
+        int rb = _zn_mmsg_read(arg, ptr + n, len - n);
+        if (rb < 0)
+            return rb;
+        n += rb;
+    }
+
+    return len;
+}
+
+size_t _zn_mmsg_buffered(void *arg)
+{
+    _zn_mmsg_t *m = (_zn_mmsg_t *)arg;
+
+    return m->rx_cnt - m->rx_next;
+}
+
+/*------------------ Transmission ------------------*/
+int _zn_mmsg_send_gso(_zn_mmsg_t *m)
+{
+#if defined(UDP_SEGMENT)
+    // All the datagrams but the last must have the segment size, the last one can be shorter
+    size_t seg = m->tx_iov[0].iov_len;
+    if (m->tx_cnt < 2 || seg > m->gso_max)
+        return -1;
+    for (unsigned int i = 1; i < m->tx_cnt; i++)
+    {
+        if (m->tx_iov[i].iov_len > seg || (i < m->tx_cnt - 1 && m->tx_iov[i].iov_len < seg))
+            return -1;
+    }
+
+    struct iovec iov;
+    iov.iov_base = m->tx_buf;
+    iov.iov_len = m->tx_len;
+
+    union
+    {
+        char buf[CMSG_SPACE(sizeof(uint16_t))];
+        struct cmsghdr align;
+    } ctrl;
+    memset(&ctrl, 0, sizeof(ctrl));
+
+    struct msghdr msg;
+    memset(&msg, 0, sizeof(msg));
+    msg.msg_name = m->raddr->ai_addr;
+    msg.msg_namelen = m->raddr->ai_addrlen;
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = ctrl.buf;
+    msg.msg_controllen = sizeof(ctrl.buf);
+
+    struct cmsghdr *cm = CMSG_FIRSTHDR(&msg);
+    cm->cmsg_level = SOL_UDP;
+    cm->cmsg_type = UDP_SEGMENT;
+    cm->cmsg_len = CMSG_LEN(sizeof(uint16_t));
+    uint16_t gso_size = (uint16_t)seg;
+    memcpy(CMSG_DATA(cm), &gso_size, sizeof(gso_size));
+
+    if (sendmsg(m->sock, &msg, 0) == (ssize_t)m->tx_len)
+        return 0;
+
+    // The segments may be larger than the path MTU or the device may not offload the
+    // checksum, do not try again with segments as large
+    _Z_DEBUG_VA("UDP GSO failed for %zu bytes segments [%d]\n", seg, errno);
+    m->gso_max = seg - 1;
+#else
+    (void)m;
+#endif
+    return -1;
+}
+
+int _zn_mmsg_flush(void *arg)
+{
+    _zn_mmsg_t *m = (_zn_mmsg_t *)arg;
+
+    int res = 0;
+    if (m->tx_cnt > 0 && _zn_mmsg_send_gso(m) != 0)
+    {
+        unsigned int i = 0;
+        while (i < m->tx_cnt)
+        {
+            int n = sendmmsg(m->sock, &m->tx_msgs[i], m->tx_cnt - i, 0);
+            if (n <= 0)
+            {
+                res = -1;
+                break;
+            }
+            i += n;
+        }
+    }
+
+    m->tx_len = 0;
+    m->tx_cnt = 0;
+
+    return res;
+}
+
+int _zn_mmsg_sendv(void *arg, const z_bytes_t *bufs, size_t cnt)
+{
+    _zn_mmsg_t *m = (_zn_mmsg_t *)arg;
+
+    size_t len = 0;
+    for (size_t i = 0; i < cnt; i++)
+        len += bufs[i].len;
+
+    // Make room for the datagram
+    if (m->tx_cnt == ZN_UDP_MMSG_LEN || m->tx_len + len > ZN_UDP_MMSG_TX_SIZE)
+    {
+        if (_zn_mmsg_flush(m) != 0)
+            return -1;
+    }
+
+    // A datagram larger than the send buffer is sent right away, after the queued ones
+    if (len > ZN_UDP_MMSG_TX_SIZE)
+        return _zn_sendv_udp(m->sock, bufs, cnt, (void *)m->raddr);
+
+    // Queue a copy of the datagram, the buffers are reused by the caller
+    uint8_t *ptr = m->tx_buf + m->tx_len;
+    for (size_t i = 0; i < cnt; i++)
+    {
+        memcpy(ptr, bufs[i].val, bufs[i].len);
+        ptr += bufs[i].len;
+    }
+    m->tx_iov[m->tx_cnt].iov_base = m->tx_buf + m->tx_len;
+    m->tx_iov[m->tx_cnt].iov_len = len;
+    m->tx_cnt++;
+    m->tx_len += len;
+
+    return len;
+}
+
+#endif /* ZENOH_LINUX */
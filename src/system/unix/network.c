@@ -13,8 +13,17 @@
  */
 
 #include <errno.h>
+#include <poll.h>
 #include <unistd.h>
 #include <netdb.h>
+#include <ifaddrs.h>
+#include <net/if.h>
+#include <arpa/inet.h>
+#include <sys/uio.h>
+#include <sys/ioctl.h>
+#include <sys/un.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
 
 #include "zenoh-pico/system/common.h"
 #include "zenoh-pico/utils/private/logging.h"
@@ -56,6 +65,21 @@ void* _zn_create_endpoint_udp(const char *s_addr, const char *port)
     return addr;
 }
 
+void* _zn_create_endpoint_unix(const char *path)
+{
+    struct sockaddr_un *addr = (struct sockaddr_un *)malloc(sizeof(struct sockaddr_un));
+    if (strlen(path) >= sizeof(addr->sun_path))
+    {
+        free(addr);
+        return NULL;
+    }
+
+    memset(addr, 0, sizeof(struct sockaddr_un));
+    addr->sun_family = AF_UNIX;
+    strncpy(addr->sun_path, path, sizeof(addr->sun_path) - 1);
+    return addr;
+}
+
 void _zn_release_endpoint_tcp(void *arg)
 {
     struct addrinfo *self = (struct addrinfo*)arg;
@@ -68,8 +92,57 @@ void _zn_release_endpoint_udp(void *arg)
     freeaddrinfo(self);
 }
 
+void _zn_release_endpoint_unix(void *arg)
+{
+    free(arg);
+}
+
+/*------------------ Socket readiness ------------------*/
+int _zn_socket_readable(_zn_socket_t sock)
+{
+    // Check without waiting if a read would not block
+    struct pollfd pfd;
+    pfd.fd = sock;
+    pfd.events = POLLIN;
+    pfd.revents = 0;
+    int res = poll(&pfd, 1, 0);
+    if (res < 0)
+        return -1;
+    return res > 0 && (pfd.revents & (POLLIN | POLLHUP | POLLERR));
+}
+
+/*------------------ Socket options ------------------*/
+int _zn_set_socket_opts(_zn_socket_t sock, int family, const _zn_link_opts_t *opts)
+{
+    if (opts->sndbuf >= 0 && setsockopt(sock, SOL_SOCKET, SO_SNDBUF, (void *)&opts->sndbuf, sizeof(int)) < 0)
+        return -1;
+
+    if (opts->rcvbuf >= 0 && setsockopt(sock, SOL_SOCKET, SO_RCVBUF, (void *)&opts->rcvbuf, sizeof(int)) < 0)
+        return -1;
+
+    if (opts->tos >= 0)
+    {
+        int res;
+        if (family == AF_INET6)
+            res = setsockopt(sock, IPPROTO_IPV6, IPV6_TCLASS, (void *)&opts->tos, sizeof(int));
+        else if (family == AF_INET)
+            res = setsockopt(sock, IPPROTO_IP, IP_TOS, (void *)&opts->tos, sizeof(int));
+        else
+            res = 0; // Local sockets carry no IP header
+        if (res < 0)
+            return -1;
+    }
+
+#if defined(ZENOH_LINUX)
+    if (opts->priority >= 0 && setsockopt(sock, SOL_SOCKET, SO_PRIORITY, (void *)&opts->priority, sizeof(int)) < 0)
+        return -1;
+#endif
+
+    return 0;
+}
+
 /*------------------ TCP sockets ------------------*/
-_zn_socket_result_t _zn_open_tcp(void *arg)
+_zn_socket_result_t _zn_open_tcp(void *arg, const _zn_link_opts_t *opts)
 {
     struct addrinfo *raddr = (struct addrinfo*)arg;
     _zn_socket_result_t r;
@@ -106,6 +179,24 @@ _zn_socket_result_t _zn_open_tcp(void *arg)
     setsockopt(r.value.socket, SOL_SOCKET, SO_NOSIGPIPE, (void *)0, sizeof(int));
 #endif
 
+    // Apply the socket options before connecting, the buffer sizes are taken into
+    // account when negotiating the TCP window
+    if (_zn_set_socket_opts(r.value.socket, raddr->ai_family, opts) < 0)
+    {
+        r.tag = _z_res_t_ERR;
+        r.value.error = errno;
+        close(r.value.socket);
+        return r;
+    }
+
+    if (opts->tcp_nodelay >= 0 && setsockopt(r.value.socket, IPPROTO_TCP, TCP_NODELAY, (void *)&opts->tcp_nodelay, sizeof(int)) < 0)
+    {
+        r.tag = _z_res_t_ERR;
+        r.value.error = errno;
+        close(r.value.socket);
+        return r;
+    }
+
     struct addrinfo *it = NULL;
     for (it = raddr; it != NULL; it = it->ai_next)
     {
@@ -124,9 +215,31 @@ _zn_socket_result_t _zn_open_tcp(void *arg)
         }
     }
 
+#if defined(ZENOH_LINUX)
+    // The quick ack mode is not permanent, it is set once connected and re-armed after each read
+    if (opts->tcp_quickack >= 0 && setsockopt(r.value.socket, IPPROTO_TCP, TCP_QUICKACK, (void *)&opts->tcp_quickack, sizeof(int)) < 0)
+    {
+        r.tag = _z_res_t_ERR;
+        r.value.error = errno;
+        close(r.value.socket);
+        return r;
+    }
+#endif
+
     return r;
 }
 
+void _zn_rearm_quickack_tcp(_zn_socket_t sock)
+{
+#if defined(ZENOH_LINUX)
+    // The kernel may fall back to delayed acknowledgments on its own
+    int flag = 1;
+    setsockopt(sock, IPPROTO_TCP, TCP_QUICKACK, (void *)&flag, sizeof(int));
+#else
+    (void)(sock);
+#endif
+}
+
 int _zn_close_tcp(_zn_socket_t sock)
 {
     return shutdown(sock, SHUT_RDWR);
@@ -164,8 +277,44 @@ int _zn_send_tcp(_zn_socket_t sock, const uint8_t *ptr, size_t len)
 #endif
 }
 
+int _zn_sendv_tcp(_zn_socket_t sock, const z_bytes_t *bufs, size_t cnt)
+{
+    struct iovec iov[cnt];
+    for (size_t i = 0; i < cnt; i++)
+    {
+        iov[i].iov_base = (void *)bufs[i].val;
+        iov[i].iov_len = bufs[i].len;
+    }
+
+    struct msghdr msg;
+    memset(&msg, 0, sizeof(msg));
+    msg.msg_iov = iov;
+    msg.msg_iovlen = cnt;
+
+#if defined(ZENOH_LINUX)
+    return sendmsg(sock, &msg, MSG_NOSIGNAL);
+#else
+    return sendmsg(sock, &msg, 0);
+#endif
+}
+
+size_t _zn_pending_tcp(_zn_socket_t sock)
+{
+    // The bytes queued in the socket send buffer, either not sent or not acknowledged yet
+    int pending = 0;
+#if defined(ZENOH_LINUX)
+    if (ioctl(sock, TIOCOUTQ, &pending) < 0)
+        return 0;
+#else
+    socklen_t len = sizeof(pending);
+    if (getsockopt(sock, SOL_SOCKET, SO_NWRITE, &pending, &len) < 0)
+        return 0;
+#endif
+    return pending > 0 ? (size_t)pending : 0;
+}
+
 /*------------------ UDP sockets ------------------*/
-_zn_socket_result_t _zn_open_udp(void *arg, const clock_t tout)
+_zn_socket_result_t _zn_open_udp(void *arg, const clock_t tout, const _zn_link_opts_t *opts)
 {
     struct addrinfo *raddr = (struct addrinfo*)arg;
     _zn_socket_result_t r;
@@ -179,6 +328,14 @@ _zn_socket_result_t _zn_open_udp(void *arg, const clock_t tout)
         return r;
     }
 
+    if (_zn_set_socket_opts(r.value.socket, raddr->ai_family, opts) < 0)
+    {
+        r.tag = _z_res_t_ERR;
+        r.value.error = errno;
+        close(r.value.socket);
+        return r;
+    }
+
     return r;
 }
 
@@ -216,3 +373,368 @@ int _zn_send_udp(_zn_socket_t sock, const uint8_t *ptr, size_t len, void *arg)
 
     return sendto(sock, ptr, len, 0, raddr->ai_addr, raddr->ai_addrlen);
 }
+
+int _zn_sendv_udp(_zn_socket_t sock, const z_bytes_t *bufs, size_t cnt, void *arg)
+{
+    struct addrinfo *raddr = (struct addrinfo*) arg;
+
+    struct iovec iov[cnt];
+    for (size_t i = 0; i < cnt; i++)
+    {
+        iov[i].iov_base = (void *)bufs[i].val;
+        iov[i].iov_len = bufs[i].len;
+    }
+
+    // All the buffers are gathered in a single datagram
+    struct msghdr msg;
+    memset(&msg, 0, sizeof(msg));
+    msg.msg_name = raddr->ai_addr;
+    msg.msg_namelen = raddr->ai_addrlen;
+    msg.msg_iov = iov;
+    msg.msg_iovlen = cnt;
+
+    return sendmsg(sock, &msg, 0);
+}
+
+size_t _zn_get_mtu_udp(void *arg)
+{
+    struct addrinfo *raddr = (struct addrinfo*) arg;
+
+    // The IP and UDP headers take 28 bytes over IPv4 and 48 bytes over IPv6
+    int hdr_len = raddr->ai_family == AF_INET6 ? 48 : 28;
+    // Without the MTU of the route, assume an Ethernet one
+    int mtu = 1500;
+#if defined(ZENOH_LINUX)
+    // The kernel reports the MTU of the route towards the address of a connected socket
+    int sock = socket(raddr->ai_family, raddr->ai_socktype, raddr->ai_protocol);
+    if (sock >= 0)
+    {
+        int val = 0;
+        socklen_t len = sizeof(val);
+        if (connect(sock, raddr->ai_addr, raddr->ai_addrlen) == 0)
+        {
+            int res = raddr->ai_family == AF_INET6 ? getsockopt(sock, IPPROTO_IPV6, IPV6_MTU, &val, &len)
+                                                   : getsockopt(sock, IPPROTO_IP, IP_MTU, &val, &len);
+            if (res == 0 && val > hdr_len)
+                mtu = val < 65535 ? val : 65535;
+        }
+        close(sock);
+    }
+#endif
+    return mtu - hdr_len;
+}
+
+size_t _zn_pending_udp(_zn_socket_t sock)
+{
+    // The bytes queued in the socket send buffer and not sent yet
+    int pending = 0;
+#if defined(ZENOH_LINUX)
+    if (ioctl(sock, TIOCOUTQ, &pending) < 0)
+        return 0;
+#else
+    socklen_t len = sizeof(pending);
+    if (getsockopt(sock, SOL_SOCKET, SO_NWRITE, &pending, &len) < 0)
+        return 0;
+#endif
+    return pending > 0 ? (size_t)pending : 0;
+}
+
+/*------------------ UDP multicast sockets ------------------*/
+typedef struct
+{
+    struct addrinfo *raddr; // The multicast group
+    struct sockaddr_storage iface; // The address of the interface, a zero address lets the system choose
+    unsigned int ifindex;
+    _zn_socket_t send_sock; // The datagrams are sent from their own socket, bound to an ephemeral port
+    struct sockaddr_storage src; // The sender of the last datagram read
+} _zn_udp_multicast_endpoint_t;
+
+int __zn_get_iface_addr(const char *iface, int family, struct sockaddr_storage *addr, unsigned int *ifindex)
+{
+    memset(addr, 0, sizeof(struct sockaddr_storage));
+    addr->ss_family = family;
+    *ifindex = 0;
+    if (iface == NULL || strcmp(iface, "auto") == 0)
+        return 0;
+
+    // The interface is either given by one of its addresses or by its name
+    void *dst = family == AF_INET6 ? (void *)&((struct sockaddr_in6 *)addr)->sin6_addr : (void *)&((struct sockaddr_in *)addr)->sin_addr;
+    if (inet_pton(family, iface, dst) == 1)
+        return 0;
+
+    *ifindex = if_nametoindex(iface);
+    if (*ifindex == 0)
+        return -1;
+    if (family == AF_INET6)
+        return 0;
+
+    struct ifaddrs *ifas = NULL;
+    if (getifaddrs(&ifas) < 0)
+        return -1;
+    int res = -1;
+    for (struct ifaddrs *ifa = ifas; ifa != NULL; ifa = ifa->ifa_next)
+    {
+        if (ifa->ifa_addr != NULL && ifa->ifa_addr->sa_family == AF_INET && strcmp(ifa->ifa_name, iface) == 0)
+        {
+            memcpy(addr, ifa->ifa_addr, sizeof(struct sockaddr_in));
+            res = 0;
+            break;
+        }
+    }
+    freeifaddrs(ifas);
+    return res;
+}
+
+void* _zn_create_endpoint_udp_multicast(const char *s_addr, const char *port, const char *iface)
+{
+    struct addrinfo *raddr = (struct addrinfo *)_zn_create_endpoint_udp(s_addr, port);
+    if (raddr == NULL)
+        return NULL;
+
+    _zn_udp_multicast_endpoint_t *ep = (_zn_udp_multicast_endpoint_t *)malloc(sizeof(_zn_udp_multicast_endpoint_t));
+    ep->raddr = raddr;
+    ep->send_sock = -1;
+    memset(&ep->src, 0, sizeof(struct sockaddr_storage));
+    if (__zn_get_iface_addr(iface, raddr->ai_family, &ep->iface, &ep->ifindex) < 0)
+    {
+        freeaddrinfo(raddr);
+        free(ep);
+        return NULL;
+    }
+
+    return ep;
+}
+
+void _zn_release_endpoint_udp_multicast(void *arg)
+{
+    _zn_udp_multicast_endpoint_t *ep = (_zn_udp_multicast_endpoint_t *)arg;
+    freeaddrinfo(ep->raddr);
+    free(ep);
+}
+
+_zn_socket_result_t _zn_open_udp_multicast(void *arg, const _zn_link_opts_t *opts)
+{
+    _zn_udp_multicast_endpoint_t *ep = (_zn_udp_multicast_endpoint_t *)arg;
+    struct addrinfo *raddr = ep->raddr;
+    _zn_socket_result_t r;
+    r.tag = _z_res_t_ERR;
+
+    // The receiving socket is bound to the group, several sessions of the same host may share its port
+    _zn_socket_t sock = socket(raddr->ai_family, raddr->ai_socktype, raddr->ai_protocol);
+    _zn_socket_t send_sock = socket(raddr->ai_family, raddr->ai_socktype, raddr->ai_protocol);
+    if (sock < 0 || send_sock < 0)
+        goto ERR;
+
+    int optval = 1;
+    if (setsockopt(sock, SOL_SOCKET, SO_REUSEADDR, &optval, sizeof(optval)) < 0)
+        goto ERR;
+#if defined(SO_REUSEPORT)
+    if (setsockopt(sock, SOL_SOCKET, SO_REUSEPORT, &optval, sizeof(optval)) < 0)
+        goto ERR;
+#endif
+    if (bind(sock, raddr->ai_addr, raddr->ai_addrlen) < 0)
+        goto ERR;
+
+    // Join the group and send on the selected interface, looping the datagrams back to the local sessions
+    if (raddr->ai_family == AF_INET6)
+    {
+        struct ipv6_mreq mreq;
+        memcpy(&mreq.ipv6mr_multiaddr, &((struct sockaddr_in6 *)raddr->ai_addr)->sin6_addr, sizeof(struct in6_addr));
+        mreq.ipv6mr_interface = ep->ifindex;
+        if (setsockopt(sock, IPPROTO_IPV6, IPV6_JOIN_GROUP, &mreq, sizeof(mreq)) < 0)
+            goto ERR;
+        if (setsockopt(send_sock, IPPROTO_IPV6, IPV6_MULTICAST_IF, &ep->ifindex, sizeof(ep->ifindex)) < 0)
+            goto ERR;
+        if (setsockopt(send_sock, IPPROTO_IPV6, IPV6_MULTICAST_LOOP, &optval, sizeof(optval)) < 0)
+            goto ERR;
+    }
+    else
+    {
+        struct ip_mreq mreq;
+        mreq.imr_multiaddr = ((struct sockaddr_in *)raddr->ai_addr)->sin_addr;
+        mreq.imr_interface = ((struct sockaddr_in *)&ep->iface)->sin_addr;
+        if (setsockopt(sock, IPPROTO_IP, IP_ADD_MEMBERSHIP, &mreq, sizeof(mreq)) < 0)
+            goto ERR;
+        if (setsockopt(send_sock, IPPROTO_IP, IP_MULTICAST_IF, &mreq.imr_interface, sizeof(struct in_addr)) < 0)
+            goto ERR;
+        unsigned char loop = 1;
+        if (setsockopt(send_sock, IPPROTO_IP, IP_MULTICAST_LOOP, &loop, sizeof(loop)) < 0)
+            goto ERR;
+    }
+
+    if (_zn_set_socket_opts(sock, raddr->ai_family, opts) < 0 || _zn_set_socket_opts(send_sock, raddr->ai_family, opts) < 0)
+        goto ERR;
+
+    ep->send_sock = send_sock;
+    r.tag = _z_res_t_OK;
+    r.value.socket = sock;
+    return r;
+
+ERR:
+    r.value.error = errno;
+    if (sock >= 0)
+        close(sock);
+    if (send_sock >= 0)
+        close(send_sock);
+    return r;
+}
+
+int _zn_close_udp_multicast(_zn_socket_t sock, void *arg)
+{
+    _zn_udp_multicast_endpoint_t *ep = (_zn_udp_multicast_endpoint_t *)arg;
+    if (ep->send_sock >= 0)
+        close(ep->send_sock);
+    ep->send_sock = -1;
+    return close(sock);
+}
+
+int _zn_read_udp_multicast(_zn_socket_t sock, uint8_t *ptr, size_t len, void *arg, z_bytes_t *addr)
+{
+    _zn_udp_multicast_endpoint_t *ep = (_zn_udp_multicast_endpoint_t *)arg;
+
+    // The address of the sender remains valid until the next read
+    socklen_t src_len = sizeof(struct sockaddr_storage);
+    memset(&ep->src, 0, sizeof(struct sockaddr_storage));
+    int rb = recvfrom(sock, ptr, len, 0, (struct sockaddr *)&ep->src, &src_len);
+    if (addr != NULL)
+    {
+        addr->val = (const uint8_t *)&ep->src;
+        addr->len = rb < 0 ? 0 : src_len;
+    }
+    return rb;
+}
+
+int _zn_read_exact_udp_multicast(_zn_socket_t sock, uint8_t *ptr, size_t len, void *arg)
+{
+    int n = len;
+    int rb;
+
+    do
+    {
+        rb = _zn_read_udp_multicast(sock, ptr, n, arg, NULL);
+        if (rb < 0)
+            return rb;
+
+        n -= rb;
+        ptr = ptr + (len - n);
+    } while (n > 0);
+
+    return len;
+}
+
+int _zn_send_udp_multicast(void *arg, const uint8_t *ptr, size_t len)
+{
+    _zn_udp_multicast_endpoint_t *ep = (_zn_udp_multicast_endpoint_t *)arg;
+
+    return _zn_send_udp(ep->send_sock, ptr, len, ep->raddr);
+}
+
+int _zn_sendv_udp_multicast(void *arg, const z_bytes_t *bufs, size_t cnt)
+{
+    _zn_udp_multicast_endpoint_t *ep = (_zn_udp_multicast_endpoint_t *)arg;
+
+    return _zn_sendv_udp(ep->send_sock, bufs, cnt, ep->raddr);
+}
+
+size_t _zn_pending_udp_multicast(void *arg)
+{
+    _zn_udp_multicast_endpoint_t *ep = (_zn_udp_multicast_endpoint_t *)arg;
+
+    return _zn_pending_udp(ep->send_sock);
+}
+
+size_t _zn_get_mtu_udp_multicast(void *arg)
+{
+    _zn_udp_multicast_endpoint_t *ep = (_zn_udp_multicast_endpoint_t *)arg;
+
+    return _zn_get_mtu_udp(ep->raddr);
+}
+
+/*------------------ Unix domain sockets ------------------*/
+_zn_socket_result_t _zn_open_unix(void *arg, const _zn_link_opts_t *opts)
+{
+    struct sockaddr_un *raddr = (struct sockaddr_un *)arg;
+    _zn_socket_result_t r;
+    r.tag = _z_res_t_OK;
+
+    r.value.socket = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (r.value.socket < 0)
+    {
+        r.tag = _z_res_t_ERR;
+        r.value.error = r.value.socket;
+        return r;
+    }
+#if defined(ZENOH_MACOS)
+    setsockopt(r.value.socket, SOL_SOCKET, SO_NOSIGPIPE, (void *)0, sizeof(int));
+#endif
+
+    // Only the buffer sizes and the priority are meaningful on a local socket
+    if (_zn_set_socket_opts(r.value.socket, AF_UNIX, opts) < 0)
+    {
+        r.tag = _z_res_t_ERR;
+        r.value.error = errno;
+        close(r.value.socket);
+        return r;
+    }
+
+    if (connect(r.value.socket, (struct sockaddr *)raddr, sizeof(struct sockaddr_un)) < 0)
+    {
+        close(r.value.socket);
+        r.tag = _z_res_t_ERR;
+        r.value.error = _zn_err_t_TX_CONNECTION;
+        return r;
+    }
+
+    return r;
+}
+
+int _zn_close_unix(_zn_socket_t sock)
+{
+    shutdown(sock, SHUT_RDWR);
+    return close(sock);
+}
+
+int _zn_read_unix(_zn_socket_t sock, uint8_t *ptr, size_t len)
+{
+    return recv(sock, ptr, len, 0);
+}
+
+int _zn_read_exact_unix(_zn_socket_t sock, uint8_t *ptr, size_t len)
+{
+    int n = len;
+    int rb;
+
+    do
+    {
+        rb = _zn_read_unix(sock, ptr, n);
+        // The peer has closed the socket
+        if (rb <= 0)
+            return -1;
+
+        n -= rb;
+        ptr = ptr + rb;
+    } while (n > 0);
+
+    return len;
+}
+
+int _zn_send_unix(_zn_socket_t sock, const uint8_t *ptr, size_t len)
+{
+#if defined(ZENOH_LINUX)
+    return send(sock, ptr, len, MSG_NOSIGNAL);
+#else
+    return send(sock, ptr, len, 0);
+#endif
+}
+
+int _zn_sendv_unix(_zn_socket_t sock, const z_bytes_t *bufs, size_t cnt)
+{
+    // Once connected, a stream socket is written as a TCP one
+    return _zn_sendv_tcp(sock, bufs, cnt);
+}
+
+size_t _zn_pending_unix(_zn_socket_t sock)
+{
+    // The bytes written and not read by the peer yet
+    return _zn_pending_tcp(sock);
+}
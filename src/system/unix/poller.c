@@ -0,0 +1,122 @@
+/*
+ * Copyright (c) 2017, 2021 ADLINK Technology Inc.
+ *
+ * This program and the accompanying materials are made available under the
+ * terms of the Eclipse Public License 2.0 which is available at
+ * http://www.eclipse.org/legal/epl-2.0, or the Apache License, Version 2.0
+ * which is available at https://www.apache.org/licenses/LICENSE-2.0.
+ *
+ * SPDX-License-Identifier: EPL-2.0 OR Apache-2.0
+ *
+ * Contributors:
+ *   ADLINK zenoh team, <zenoh@adlink-labs.tech>
+ */
+
+#if defined(ZENOH_LINUX)
+
+#include <errno.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+
+#include "zenoh-pico/system/common.h"
+
+/*------------------ Poller ------------------*/
+// NOTE: The sockets are registered in one-shot mode, so that a readable socket wakes up
+//       a single thread and is not reported again until that thread rearms it.
+typedef struct
+{
+    int efd;
+    int wfd;
+} _zn_poller_t;
+
+void *_zn_poller_open(void)
+{
+    _zn_poller_t *p = (_zn_poller_t *)malloc(sizeof(_zn_poller_t));
+    p->efd = epoll_create1(EPOLL_CLOEXEC);
+    p->wfd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    if (p->efd < 0 || p->wfd < 0)
+        goto ERR_POLLER_OPEN;
+
+    // The wake up event is reported to all the waiting threads until it is reset
+    struct epoll_event ev;
+    ev.events = EPOLLIN;
+    ev.data.ptr = NULL;
+    if (epoll_ctl(p->efd, EPOLL_CTL_ADD, p->wfd, &ev) < 0)
+        goto ERR_POLLER_OPEN;
+
+    return p;
+
+ERR_POLLER_OPEN:
+    if (p->efd >= 0)
+        close(p->efd);
+    if (p->wfd >= 0)
+        close(p->wfd);
+    free(p);
+    return NULL;
+}
+
+void _zn_poller_close(void *arg)
+{
+    _zn_poller_t *p = (_zn_poller_t *)arg;
+    close(p->efd);
+    close(p->wfd);
+    free(p);
+}
+
+int _zn_poller_add(void *arg, _zn_socket_t sock, void *data)
+{
+    _zn_poller_t *p = (_zn_poller_t *)arg;
+    struct epoll_event ev;
+    ev.events = EPOLLIN | EPOLLONESHOT;
+    ev.data.ptr = data;
+    return epoll_ctl(p->efd, EPOLL_CTL_ADD, sock, &ev);
+}
+
+int _zn_poller_rearm(void *arg, _zn_socket_t sock, void *data)
+{
+    _zn_poller_t *p = (_zn_poller_t *)arg;
+    struct epoll_event ev;
+    ev.events = EPOLLIN | EPOLLONESHOT;
+    ev.data.ptr = data;
+    return epoll_ctl(p->efd, EPOLL_CTL_MOD, sock, &ev);
+}
+
+int _zn_poller_del(void *arg, _zn_socket_t sock)
+{
+    _zn_poller_t *p = (_zn_poller_t *)arg;
+    return epoll_ctl(p->efd, EPOLL_CTL_DEL, sock, NULL);
+}
+
+int _zn_poller_wait(void *arg, void **ready, int max, int timeout)
+{
+    _zn_poller_t *p = (_zn_poller_t *)arg;
+    struct epoll_event evs[max];
+    int n = epoll_wait(p->efd, evs, max, timeout);
+    if (n < 0)
+        return errno == EINTR ? 0 : -1;
+
+    // The wake up event is reported with a NULL data
+    for (int i = 0; i < n; i++)
+        ready[i] = evs[i].data.ptr;
+
+    return n;
+}
+
+int _zn_poller_wakeup(void *arg)
+{
+    _zn_poller_t *p = (_zn_poller_t *)arg;
+    uint64_t one = 1;
+    return write(p->wfd, &one, sizeof(one)) == sizeof(one) ? 0 : -1;
+}
+
+int _zn_poller_reset(void *arg)
+{
+    _zn_poller_t *p = (_zn_poller_t *)arg;
+    uint64_t cnt;
+    return read(p->wfd, &cnt, sizeof(cnt)) == sizeof(cnt) ? 0 : -1;
+}
+
+#endif
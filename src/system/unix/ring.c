@@ -0,0 +1,95 @@
+/*
+ * Copyright (c) 2017, 2021 ADLINK Technology Inc.
+ *
+ * This program and the accompanying materials are made available under the
+ * terms of the Eclipse Public License 2.0 which is available at
+ * http://www.eclipse.org/legal/epl-2.0, or the Apache License, Version 2.0
+ * which is available at https://www.apache.org/licenses/LICENSE-2.0.
+ *
+ * SPDX-License-Identifier: EPL-2.0 OR Apache-2.0
+ *
+ * Contributors:
+ *   ADLINK zenoh team, <zenoh@adlink-labs.tech>
+ */
+
+#if defined(ZENOH_LINUX) || defined(ZENOH_MACOS)
+
+#if defined(ZENOH_LINUX)
+// The anonymous memory files are a GNU extension
+#define _GNU_SOURCE
+#endif
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "zenoh-pico/system/common.h"
+#include "zenoh-pico/utils/private/logging.h"
+
+/*------------------ Double mapped rings ------------------*/
+// NOTE: The same pages are mapped twice, back to back, in a reserved region of twice their size.
+//       Any span of at most the ring capacity starting in the first mapping is then contiguous
+//       in memory, even when it wraps around the end of the ring.
+int __zn_ring_open_fd(size_t capacity)
+{
+#if defined(ZENOH_LINUX)
+    int fd = memfd_create("zenoh-pico-ring", MFD_CLOEXEC);
+#else
+    static unsigned int cnt = 0;
+    char name[64];
+    snprintf(name, sizeof(name), "/zn-ring-%d-%u", (int)getpid(), __atomic_fetch_add(&cnt, 1, __ATOMIC_RELAXED));
+    int fd = shm_open(name, O_CREAT | O_EXCL | O_RDWR, S_IRUSR | S_IWUSR);
+    if (fd >= 0)
+        shm_unlink(name);
+#endif
+    if (fd < 0)
+        return -1;
+
+    if (ftruncate(fd, (off_t)capacity) < 0)
+    {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+uint8_t *_zn_ring_map(size_t *capacity)
+{
+    // The capacity is rounded up to whole pages
+    size_t page = (size_t)sysconf(_SC_PAGESIZE);
+    size_t len = (*capacity + page - 1) / page * page;
+
+    int fd = __zn_ring_open_fd(len);
+    if (fd < 0)
+        return NULL;
+
+    uint8_t *base = (uint8_t *)mmap(NULL, 2 * len, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (base == MAP_FAILED)
+        goto ERR_CLOSE;
+
+    if (mmap(base, len, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, fd, 0) == MAP_FAILED)
+        goto ERR_UNMAP;
+    if (mmap(base + len, len, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, fd, 0) == MAP_FAILED)
+        goto ERR_UNMAP;
+
+    // The mappings keep the memory alive
+    close(fd);
+    *capacity = len;
+    return base;
+
+ERR_UNMAP:
+    munmap(base, 2 * len);
+ERR_CLOSE:
+    _Z_DEBUG("Unable to map a receive ring\n");
+    close(fd);
+    return NULL;
+}
+
+void _zn_ring_unmap(uint8_t *buf, size_t capacity)
+{
+    munmap(buf, 2 * capacity);
+}
+
+#endif
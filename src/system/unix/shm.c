@@ -0,0 +1,360 @@
+/*
+ * Copyright (c) 2017, 2021 ADLINK Technology Inc.
+ *
+ * This program and the accompanying materials are made available under the
+ * terms of the Eclipse Public License 2.0 which is available at
+ * http://www.eclipse.org/legal/epl-2.0, or the Apache License, Version 2.0
+ * which is available at https://www.apache.org/licenses/LICENSE-2.0.
+ *
+ * SPDX-License-Identifier: EPL-2.0 OR Apache-2.0
+ *
+ * Contributors:
+ *   ADLINK zenoh team, <zenoh@adlink-labs.tech>
+ */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#if defined(ZENOH_LINUX)
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#endif
+
+#include "zenoh-pico/system/common.h"
+#include "zenoh-pico/utils/private/logging.h"
+
+/*------------------ Shared memory rings ------------------*/
+// NOTE: A shared memory segment holds two single-producer single-consumer byte rings,
+//       one per direction. The head and tail are free running counters of the bytes
+//       written and read. The seq word is bumped on every change of the ring and is
+//       used as a futex to put the reader or the writer to sleep when there is nothing to do.
+#define _ZN_SHM_STATE_LISTENING 0
+#define _ZN_SHM_STATE_CONNECTED 1
+#define _ZN_SHM_STATE_CLOSED 2
+
+typedef struct
+{
+    volatile uint32_t head;
+    volatile uint32_t tail;
+    volatile uint32_t seq;
+    volatile uint32_t waiters;
+    uint8_t buf[ZN_SHM_RING_SIZE];
+} _zn_shm_ring_t;
+
+typedef struct
+{
+    volatile uint32_t state;
+    _zn_shm_ring_t rings[2];
+} _zn_shm_segment_t;
+
+typedef struct
+{
+    char *name;
+    int is_listener;
+    int fd;
+    _zn_shm_segment_t *seg;
+} _zn_shm_endpoint_t;
+
+void _zn_shm_wait(volatile uint32_t *word, uint32_t val)
+{
+#if defined(ZENOH_LINUX)
+    // The segment is shared across processes, the futex can not be private
+    struct timespec tout = {0, 100000000};
+    syscall(SYS_futex, word, FUTEX_WAIT, val, &tout, NULL, 0);
+#else
+    if (__atomic_load_n(word, __ATOMIC_ACQUIRE) == val)
+        z_sleep_us(50);
+#endif
+}
+
+void _zn_shm_wake(volatile uint32_t *word)
+{
+#if defined(ZENOH_LINUX)
+    syscall(SYS_futex, word, FUTEX_WAKE, INT_MAX, NULL, NULL, 0);
+#else
+    (void)word;
+#endif
+}
+
+void _zn_shm_ring_notify(_zn_shm_ring_t *ring)
+{
+    __atomic_add_fetch(&ring->seq, 1, __ATOMIC_SEQ_CST);
+    if (__atomic_load_n(&ring->waiters, __ATOMIC_SEQ_CST) > 0)
+        _zn_shm_wake(&ring->seq);
+}
+
+_zn_shm_ring_t *_zn_shm_tx_ring(_zn_shm_endpoint_t *ep)
+{
+    // The connector writes on the first ring, the listener on the second one
+    return &ep->seg->rings[ep->is_listener ? 1 : 0];
+}
+
+_zn_shm_ring_t *_zn_shm_rx_ring(_zn_shm_endpoint_t *ep)
+{
+    return &ep->seg->rings[ep->is_listener ? 0 : 1];
+}
+
+/*------------------ Shared memory endpoints ------------------*/
+void *_zn_create_endpoint_shm(const char *name, int is_listener)
+{
+    _zn_shm_endpoint_t *ep = (_zn_shm_endpoint_t *)malloc(sizeof(_zn_shm_endpoint_t));
+    // POSIX shared memory object names start with a slash
+    ep->name = (char *)malloc(strlen(name) + 2);
+    ep->name[0] = '/';
+    strcpy(ep->name + 1, name);
+    ep->is_listener = is_listener;
+    ep->fd = -1;
+    ep->seg = NULL;
+
+    if (is_listener)
+    {
+        // The listener creates the segment, so that it exists once the endpoint is returned
+        ep->fd = shm_open(ep->name, O_CREAT | O_EXCL | O_RDWR, S_IRUSR | S_IWUSR);
+        if (ep->fd < 0 && errno == EEXIST)
+        {
+            // A segment left by a listener that did not terminate cleanly is replaced
+            _Z_DEBUG_VA("Replacing the stale shared memory segment %s\n", ep->name);
+            shm_unlink(ep->name);
+            ep->fd = shm_open(ep->name, O_CREAT | O_EXCL | O_RDWR, S_IRUSR | S_IWUSR);
+        }
+        if (ep->fd < 0 || ftruncate(ep->fd, sizeof(_zn_shm_segment_t)) < 0)
+        {
+            _Z_DEBUG_VA("Unable to create the shared memory segment %s\n", ep->name);
+            return ep;
+        }
+
+        void *addr = mmap(NULL, sizeof(_zn_shm_segment_t), PROT_READ | PROT_WRITE, MAP_SHARED, ep->fd, 0);
+        if (addr == MAP_FAILED)
+            return ep;
+
+        // A newly truncated object is zero filled, so both rings start empty
+        ep->seg = (_zn_shm_segment_t *)addr;
+        __atomic_store_n(&ep->seg->state, _ZN_SHM_STATE_LISTENING, __ATOMIC_SEQ_CST);
+    }
+
+    return ep;
+}
+
+void _zn_release_endpoint_shm(void *arg)
+{
+    _zn_shm_endpoint_t *ep = (_zn_shm_endpoint_t *)arg;
+
+    if (ep->seg != NULL)
+        munmap((void *)ep->seg, sizeof(_zn_shm_segment_t));
+    if (ep->fd >= 0)
+        close(ep->fd);
+    if (ep->is_listener)
+        shm_unlink(ep->name);
+
+    free(ep->name);
+    free(ep);
+}
+
+/*------------------ Shared memory links ------------------*/
+_zn_socket_result_t _zn_open_shm(void *arg, const clock_t tout)
+{
+    _zn_shm_endpoint_t *ep = (_zn_shm_endpoint_t *)arg;
+    _zn_socket_result_t r;
+    r.tag = _z_res_t_OK;
+    z_clock_t start = z_clock_now();
+
+    if (ep->is_listener)
+    {
+        if (ep->seg == NULL)
+        {
+            r.tag = _z_res_t_ERR;
+            r.value.error = _zn_err_t_OPEN_TRANSPORT_FAILED;
+            return r;
+        }
+
+        // Wait for a connector to attach to the segment, without limit if there is no timeout
+        uint32_t state;
+        while ((state = __atomic_load_n(&ep->seg->state, __ATOMIC_ACQUIRE)) == _ZN_SHM_STATE_LISTENING)
+        {
+            if (tout > 0 && z_clock_elapsed_ms(&start) >= tout)
+            {
+                r.tag = _z_res_t_ERR;
+                r.value.error = _zn_err_t_OPEN_TRANSPORT_FAILED;
+                return r;
+            }
+            _zn_shm_wait(&ep->seg->state, state);
+        }
+
+        r.value.socket = ep->fd;
+        return r;
+    }
+
+    // Attach to the segment created by the listener, retrying until the timeout if any
+    if (ep->seg == NULL)
+    {
+        ep->fd = shm_open(ep->name, O_RDWR, 0);
+        while (ep->fd < 0 && errno == ENOENT && tout > 0 && z_clock_elapsed_ms(&start) < tout)
+        {
+            z_sleep_ms(1);
+            ep->fd = shm_open(ep->name, O_RDWR, 0);
+        }
+        if (ep->fd < 0)
+        {
+            r.tag = _z_res_t_ERR;
+            r.value.error = _zn_err_t_TX_CONNECTION;
+            return r;
+        }
+
+        void *addr = mmap(NULL, sizeof(_zn_shm_segment_t), PROT_READ | PROT_WRITE, MAP_SHARED, ep->fd, 0);
+        if (addr == MAP_FAILED)
+        {
+            close(ep->fd);
+            ep->fd = -1;
+            r.tag = _z_res_t_ERR;
+            r.value.error = _zn_err_t_TX_CONNECTION;
+            return r;
+        }
+        ep->seg = (_zn_shm_segment_t *)addr;
+    }
+
+    // Only one connector can attach to a segment
+    uint32_t expected = _ZN_SHM_STATE_LISTENING;
+    if (!__atomic_compare_exchange_n(&ep->seg->state, &expected, _ZN_SHM_STATE_CONNECTED, 0, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST))
+    {
+        r.tag = _z_res_t_ERR;
+        r.value.error = _zn_err_t_TX_CONNECTION;
+        return r;
+    }
+    _zn_shm_wake(&ep->seg->state);
+
+    r.value.socket = ep->fd;
+    return r;
+}
+
+int _zn_close_shm(void *arg)
+{
+    _zn_shm_endpoint_t *ep = (_zn_shm_endpoint_t *)arg;
+    if (ep->seg == NULL)
+        return 0;
+
+    // Wake up the peer and the local threads blocked on the rings
+    __atomic_store_n(&ep->seg->state, _ZN_SHM_STATE_CLOSED, __ATOMIC_SEQ_CST);
+    _zn_shm_wake(&ep->seg->state);
+    for (int i = 0; i < 2; i++)
+        _zn_shm_ring_notify(&ep->seg->rings[i]);
+
+    return 0;
+}
+
+int _zn_read_shm(void *arg, uint8_t *ptr, size_t len)
+{
+    _zn_shm_endpoint_t *ep = (_zn_shm_endpoint_t *)arg;
+    _zn_shm_ring_t *ring = _zn_shm_rx_ring(ep);
+
+    uint32_t tail = ring->tail;
+    uint32_t head;
+    while ((head = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE)) == tail)
+    {
+        // Return the pending bytes before reporting the closure
+        if (__atomic_load_n(&ep->seg->state, __ATOMIC_ACQUIRE) == _ZN_SHM_STATE_CLOSED)
+            return -1;
+
+        uint32_t seq = __atomic_load_n(&ring->seq, __ATOMIC_SEQ_CST);
+        __atomic_add_fetch(&ring->waiters, 1, __ATOMIC_SEQ_CST);
+        if (__atomic_load_n(&ring->head, __ATOMIC_SEQ_CST) == tail)
+            _zn_shm_wait(&ring->seq, seq);
+        __atomic_sub_fetch(&ring->waiters, 1, __ATOMIC_SEQ_CST);
+    }
+
+    size_t n = head - tail;
+    if (n > len)
+        n = len;
+
+    // Copy the bytes, eventually wrapping around the end of the ring
+    size_t off = tail % ZN_SHM_RING_SIZE;
+    size_t first = ZN_SHM_RING_SIZE - off < n ? ZN_SHM_RING_SIZE - off : n;
+    memcpy(ptr, ring->buf + off, first);
+    memcpy(ptr + first, ring->buf, n - first);
+
+    __atomic_store_n(&ring->tail, tail + (uint32_t)n, __ATOMIC_RELEASE);
+    _zn_shm_ring_notify(ring);
+
+    return n;
+}
+
+int _zn_read_exact_shm(void *arg, uint8_t *ptr, size_t len)
+{
+    int n = len;
+    int rb;
+
+    do
+    {
+        rb = _zn_read_shm(arg, ptr, n);
+        if (rb < 0)
+            return rb;
+
+        n -= rb;
+        ptr = ptr + rb;
+    } while (n > 0);
+
+    return len;
+}
+
+int _zn_sendv_shm(void *arg, const z_bytes_t *bufs, size_t cnt)
+{
+    _zn_shm_endpoint_t *ep = (_zn_shm_endpoint_t *)arg;
+    _zn_shm_ring_t *ring = _zn_shm_tx_ring(ep);
+
+    uint32_t head = ring->head;
+    uint32_t tail;
+    while (head - (tail = __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE)) == ZN_SHM_RING_SIZE)
+    {
+        if (__atomic_load_n(&ep->seg->state, __ATOMIC_ACQUIRE) == _ZN_SHM_STATE_CLOSED)
+            return -1;
+
+        // The ring is full, wait for the peer to consume some bytes
+        uint32_t seq = __atomic_load_n(&ring->seq, __ATOMIC_SEQ_CST);
+        __atomic_add_fetch(&ring->waiters, 1, __ATOMIC_SEQ_CST);
+        if (head - __atomic_load_n(&ring->tail, __ATOMIC_SEQ_CST) == ZN_SHM_RING_SIZE)
+            _zn_shm_wait(&ring->seq, seq);
+        __atomic_sub_fetch(&ring->waiters, 1, __ATOMIC_SEQ_CST);
+    }
+
+    if (__atomic_load_n(&ep->seg->state, __ATOMIC_ACQUIRE) == _ZN_SHM_STATE_CLOSED)
+        return -1;
+
+    // Gather as many bytes as fit in the ring
+    size_t space = ZN_SHM_RING_SIZE - (head - tail);
+    size_t n = 0;
+    for (size_t i = 0; i < cnt && n < space; i++)
+    {
+        size_t len = bufs[i].len <= space - n ? bufs[i].len : space - n;
+        size_t off = (head + n) % ZN_SHM_RING_SIZE;
+        size_t first = ZN_SHM_RING_SIZE - off < len ? ZN_SHM_RING_SIZE - off : len;
+        memcpy(ring->buf + off, bufs[i].val, first);
+        memcpy(ring->buf, bufs[i].val + first, len - first);
+        n += len;
+    }
+
+    __atomic_store_n(&ring->head, head + (uint32_t)n, __ATOMIC_RELEASE);
+    _zn_shm_ring_notify(ring);
+
+    return n;
+}
+
+int _zn_send_shm(void *arg, const uint8_t *ptr, size_t len)
+{
+    z_bytes_t bs;
+    bs.val = ptr;
+    bs.len = len;
+    return _zn_sendv_shm(arg, &bs, 1);
+}
+
+size_t _zn_pending_shm(void *arg)
+{
+    _zn_shm_endpoint_t *ep = (_zn_shm_endpoint_t *)arg;
+    _zn_shm_ring_t *ring = _zn_shm_tx_ring(ep);
+
+    // The bytes not yet consumed by the peer
+    return __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE) - __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE);
+}
@@ -0,0 +1,424 @@
+/*
+ * Copyright (c) 2017, 2021 ADLINK Technology Inc.
+ *
+ * This program and the accompanying materials are made available under the
+ * terms of the Eclipse Public License 2.0 which is available at
+ * http://www.eclipse.org/legal/epl-2.0, or the Apache License, Version 2.0
+ * which is available at https://www.apache.org/licenses/LICENSE-2.0.
+ *
+ * SPDX-License-Identifier: EPL-2.0 OR Apache-2.0
+ *
+ * Contributors:
+ *   ADLINK zenoh team, <zenoh@adlink-labs.tech>
+ */
+
+#if defined(ZENOH_LINUX) && defined(ZENOH_IO_URING)
+
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <netdb.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/syscall.h>
+#include <linux/io_uring.h>
+
+#include "zenoh-pico/system/common.h"
+#include "zenoh-pico/utils/private/logging.h"
+
+/*------------------ io_uring queues ------------------*/
+// NOTE: Each link has two rings, so that the reception and the transmission, which are
+//       serialized by different session mutexes, never reap each other's completions.
+//       The socket is registered as fixed file 0 on both rings.
+typedef struct
+{
+    int fd;
+    unsigned entries;
+    unsigned *sq_head;
+    unsigned *sq_tail;
+    unsigned *sq_mask;
+    unsigned *sq_array;
+    struct io_uring_sqe *sqes;
+    unsigned *cq_head;
+    unsigned *cq_tail;
+    unsigned *cq_mask;
+    struct io_uring_cqe *cqes;
+    void *ring;
+    size_t ring_size;
+} _zn_uring_queue_t;
+
+typedef struct
+{
+    _zn_uring_queue_t rx;
+    _zn_uring_queue_t tx;
+    _zn_socket_t sock;
+    int is_streamed;
+    const struct addrinfo *raddr;
+
+    // The buffers provided to the multishot receive
+    struct io_uring_buf_ring *br;
+    uint8_t *bufs;
+    int is_armed;
+
+    // The received buffer being consumed
+    int cur_bid;
+    size_t cur_pos;
+    size_t cur_len;
+} _zn_uring_t;
+
+int _zn_uring_queue_init(_zn_uring_queue_t *q, unsigned entries, int sock)
+{
+    struct io_uring_params p;
+    memset(&p, 0, sizeof(p));
+    q->fd = syscall(__NR_io_uring_setup, entries, &p);
+    if (q->fd < 0)
+        return -1;
+
+    // Only the kernels mapping both rings at once are supported
+    if (!(p.features & IORING_FEAT_SINGLE_MMAP))
+    {
+        close(q->fd);
+        return -1;
+    }
+
+    size_t sq_size = p.sq_off.array + p.sq_entries * sizeof(unsigned);
+    size_t cq_size = p.cq_off.cqes + p.cq_entries * sizeof(struct io_uring_cqe);
+    q->ring_size = sq_size > cq_size ? sq_size : cq_size;
+    q->ring = mmap(NULL, q->ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, q->fd, IORING_OFF_SQ_RING);
+    if (q->ring == MAP_FAILED)
+    {
+        close(q->fd);
+        return -1;
+    }
+
+    q->sqes = (struct io_uring_sqe *)mmap(NULL, p.sq_entries * sizeof(struct io_uring_sqe), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, q->fd, IORING_OFF_SQES);
+    if (q->sqes == MAP_FAILED)
+    {
+        munmap(q->ring, q->ring_size);
+        close(q->fd);
+        return -1;
+    }
+
+    uint8_t *ring = (uint8_t *)q->ring;
+    q->entries = p.sq_entries;
+    q->sq_head = (unsigned *)(ring + p.sq_off.head);
+    q->sq_tail = (unsigned *)(ring + p.sq_off.tail);
+    q->sq_mask = (unsigned *)(ring + p.sq_off.ring_mask);
+    q->sq_array = (unsigned *)(ring + p.sq_off.array);
+    q->cq_head = (unsigned *)(ring + p.cq_off.head);
+    q->cq_tail = (unsigned *)(ring + p.cq_off.tail);
+    q->cq_mask = (unsigned *)(ring + p.cq_off.ring_mask);
+    q->cqes = (struct io_uring_cqe *)(ring + p.cq_off.cqes);
+
+    // Register the socket to skip the file lookup on each operation
+    if (syscall(__NR_io_uring_register, q->fd, IORING_REGISTER_FILES, &sock, 1) < 0)
+    {
+        munmap(q->sqes, q->entries * sizeof(struct io_uring_sqe));
+        munmap(q->ring, q->ring_size);
+        close(q->fd);
+        return -1;
+    }
+
+    return 0;
+}
+
+void _zn_uring_queue_free(_zn_uring_queue_t *q)
+{
+    munmap(q->sqes, q->entries * sizeof(struct io_uring_sqe));
+    munmap(q->ring, q->ring_size);
+    close(q->fd);
+}
+
+struct io_uring_sqe *_zn_uring_queue_sqe(_zn_uring_queue_t *q, unsigned i)
+{
+    // The i-th entry after the current tail, not submitted until the tail is moved
+    unsigned tail = *q->sq_tail + i;
+    unsigned idx = tail & *q->sq_mask;
+    q->sq_array[idx] = idx;
+
+    struct io_uring_sqe *sqe = &q->sqes[idx];
+    memset(sqe, 0, sizeof(struct io_uring_sqe));
+    return sqe;
+}
+
+int _zn_uring_queue_submit(_zn_uring_queue_t *q, unsigned n, unsigned wait)
+{
+    __atomic_store_n(q->sq_tail, *q->sq_tail + n, __ATOMIC_RELEASE);
+
+    int res;
+    do
+    {
+        res = syscall(__NR_io_uring_enter, q->fd, n, wait, wait > 0 ? IORING_ENTER_GETEVENTS : 0, NULL, 0);
+    } while (res < 0 && errno == EINTR);
+
+    return res < 0 ? -1 : 0;
+}
+
+struct io_uring_cqe *_zn_uring_queue_cqe(_zn_uring_queue_t *q)
+{
+    unsigned head = *q->cq_head;
+    if (head == __atomic_load_n(q->cq_tail, __ATOMIC_ACQUIRE))
+        return NULL;
+    return &q->cqes[head & *q->cq_mask];
+}
+
+void _zn_uring_queue_seen(_zn_uring_queue_t *q)
+{
+    __atomic_store_n(q->cq_head, *q->cq_head + 1, __ATOMIC_RELEASE);
+}
+
+struct io_uring_cqe *_zn_uring_queue_wait(_zn_uring_queue_t *q)
+{
+    struct io_uring_cqe *cqe;
+    while ((cqe = _zn_uring_queue_cqe(q)) == NULL)
+    {
+        int res = syscall(__NR_io_uring_enter, q->fd, 0, 1, IORING_ENTER_GETEVENTS, NULL, 0);
+        if (res < 0 && errno != EINTR)
+            return NULL;
+    }
+    return cqe;
+}
+
+/*------------------ io_uring links ------------------*/
+void _zn_uring_provide(_zn_uring_t *u, int bid)
+{
+    unsigned short tail = u->br->tail;
+    struct io_uring_buf *buf = &u->br->bufs[tail & (ZN_IO_URING_BUF_NUM - 1)];
+    buf->addr = (unsigned long)(u->bufs + (size_t)bid * ZN_IO_URING_BUF_SIZE);
+    buf->len = ZN_IO_URING_BUF_SIZE;
+    buf->bid = bid;
+    __atomic_store_n(&u->br->tail, tail + 1, __ATOMIC_RELEASE);
+}
+
+void *_zn_uring_open(_zn_socket_t sock, int is_streamed, const void *raddr)
+{
+    _zn_uring_t *u = (_zn_uring_t *)malloc(sizeof(_zn_uring_t));
+    u->sock = sock;
+    u->is_streamed = is_streamed;
+    u->raddr = (const struct addrinfo *)raddr;
+    u->is_armed = 0;
+    u->cur_bid = -1;
+    u->cur_pos = 0;
+    u->cur_len = 0;
+
+    // Fall back to the plain socket calls if io_uring is not available
+    if (_zn_uring_queue_init(&u->rx, 4, sock) < 0)
+    {
+        _Z_DEBUG("io_uring is not available, using plain socket calls\n");
+        free(u);
+        return NULL;
+    }
+    if (_zn_uring_queue_init(&u->tx, ZN_LINK_IOV_MAX, sock) < 0)
+    {
+        _zn_uring_queue_free(&u->rx);
+        free(u);
+        return NULL;
+    }
+
+    // Register the ring of the buffers selected by the kernel on reception
+    u->br = (struct io_uring_buf_ring *)mmap(NULL, ZN_IO_URING_BUF_NUM * sizeof(struct io_uring_buf), PROT_READ | PROT_WRITE, MAP_ANONYMOUS | MAP_PRIVATE, -1, 0);
+    struct io_uring_buf_reg reg;
+    memset(&reg, 0, sizeof(reg));
+    reg.ring_addr = (unsigned long)u->br;
+    reg.ring_entries = ZN_IO_URING_BUF_NUM;
+    reg.bgid = 0;
+    if (u->br == MAP_FAILED || syscall(__NR_io_uring_register, u->rx.fd, IORING_REGISTER_PBUF_RING, &reg, 1) < 0)
+    {
+        _Z_DEBUG("io_uring provided buffers are not available, using plain socket calls\n");
+        if (u->br != MAP_FAILED)
+            munmap(u->br, ZN_IO_URING_BUF_NUM * sizeof(struct io_uring_buf));
+        _zn_uring_queue_free(&u->tx);
+        _zn_uring_queue_free(&u->rx);
+        free(u);
+        return NULL;
+    }
+
+    u->bufs = (uint8_t *)malloc((size_t)ZN_IO_URING_BUF_NUM * ZN_IO_URING_BUF_SIZE);
+    for (int i = 0; i < ZN_IO_URING_BUF_NUM; i++)
+        _zn_uring_provide(u, i);
+
+    return u;
+}
+
+void _zn_uring_cancel(void *arg)
+{
+    _zn_uring_t *u = (_zn_uring_t *)arg;
+
+    // Closing the socket does not terminate the pending receive, that holds a reference to it
+    shutdown(u->sock, SHUT_RDWR);
+}
+
+void _zn_uring_free(void *arg)
+{
+    _zn_uring_t *u = (_zn_uring_t *)arg;
+
+    // Closing the rings cancels any pending receive
+    _zn_uring_queue_free(&u->tx);
+    _zn_uring_queue_free(&u->rx);
+    munmap(u->br, ZN_IO_URING_BUF_NUM * sizeof(struct io_uring_buf));
+    free(u->bufs);
+    free(u);
+}
+
+int _zn_uring_read(void *arg, uint8_t *ptr, size_t len)
+{
+    _zn_uring_t *u = (_zn_uring_t *)arg;
+
+    while (u->cur_bid < 0)
+    {
+        // A single receive keeps filling the provided buffers until it is terminated
+        if (!u->is_armed)
+        {
+            struct io_uring_sqe *sqe = _zn_uring_queue_sqe(&u->rx, 0);
+            sqe->opcode = IORING_OP_RECV;
+            sqe->fd = 0;
+            sqe->flags = IOSQE_FIXED_FILE | IOSQE_BUFFER_SELECT;
+            sqe->ioprio = IORING_RECV_MULTISHOT;
+            sqe->buf_group = 0;
+            if (_zn_uring_queue_submit(&u->rx, 1, 0) < 0)
+                return -1;
+            u->is_armed = 1;
+        }
+
+        struct io_uring_cqe *cqe = _zn_uring_queue_wait(&u->rx);
+        if (cqe == NULL)
+            return -1;
+
+        int res = cqe->res;
+        unsigned flags = cqe->flags;
+        _zn_uring_queue_seen(&u->rx);
+
+        if (!(flags & IORING_CQE_F_MORE))
+            u->is_armed = 0;
+
+        if (res == -ENOBUFS)
+            continue; // All the buffers were filled, rearm once some are consumed
+        if (res <= 0)
+            return -1; // The socket has been closed
+
+        u->cur_bid = flags >> IORING_CQE_BUFFER_SHIFT;
+        u->cur_pos = 0;
+        u->cur_len = res;
+    }
+
+    size_t n = u->cur_len - u->cur_pos < len ? u->cur_len - u->cur_pos : len;
+    memcpy(ptr, u->bufs + (size_t)u->cur_bid * ZN_IO_URING_BUF_SIZE + u->cur_pos, n);
+    u->cur_pos += n;
+
+    // Give the buffer back, a datagram is never split across reads
+    if (u->cur_pos == u->cur_len || !u->is_streamed)
+    {
+        _zn_uring_provide(u, u->cur_bid);
+        u->cur_bid = -1;
+    }
+
+    return n;
+}
+
+int _zn_uring_read_exact(void *arg, uint8_t *ptr, size_t len)
+{
+    size_t n = len;
+    do
+    {
+        int rb = _zn_uring_read(arg, ptr, n);
+        if (rb < 0)
+            return rb;
+
+        n -= rb;
+        ptr = ptr + rb;
+    } while (n > 0);
+
+    return len;
+}
+
+int _zn_uring_sendv(void *arg, const z_bytes_t *bufs, size_t cnt)
+{
+    _zn_uring_t *u = (_zn_uring_t *)arg;
+    if (cnt > u->tx.entries)
+        cnt = u->tx.entries;
+
+    if (!u->is_streamed)
+    {
+        // All the buffers are gathered in a single datagram
+        struct iovec iov[cnt];
+        for (size_t i = 0; i < cnt; i++)
+        {
+            iov[i].iov_base = (void *)bufs[i].val;
+            iov[i].iov_len = bufs[i].len;
+        }
+
+        struct msghdr msg;
+        memset(&msg, 0, sizeof(msg));
+        msg.msg_name = u->raddr->ai_addr;
+        msg.msg_namelen = u->raddr->ai_addrlen;
+        msg.msg_iov = iov;
+        msg.msg_iovlen = cnt;
+
+        struct io_uring_sqe *sqe = _zn_uring_queue_sqe(&u->tx, 0);
+        sqe->opcode = IORING_OP_SENDMSG;
+        sqe->fd = 0;
+        sqe->flags = IOSQE_FIXED_FILE;
+        sqe->addr = (unsigned long)&msg;
+        sqe->len = 1;
+        if (_zn_uring_queue_submit(&u->tx, 1, 1) < 0)
+            return -1;
+
+        struct io_uring_cqe *cqe = _zn_uring_queue_wait(&u->tx);
+        if (cqe == NULL)
+            return -1;
+        int res = cqe->res;
+        _zn_uring_queue_seen(&u->tx);
+        return res;
+    }
+
+    // Link the sends of the buffers, a short send cancels the following ones
+    for (size_t i = 0; i < cnt; i++)
+    {
+        struct io_uring_sqe *sqe = _zn_uring_queue_sqe(&u->tx, i);
+        sqe->opcode = IORING_OP_SEND;
+        sqe->fd = 0;
+        sqe->flags = IOSQE_FIXED_FILE | (i + 1 < cnt ? IOSQE_IO_LINK : 0);
+        sqe->addr = (unsigned long)bufs[i].val;
+        sqe->len = bufs[i].len;
+        sqe->msg_flags = MSG_NOSIGNAL;
+        sqe->user_data = i;
+    }
+    if (_zn_uring_queue_submit(&u->tx, cnt, cnt) < 0)
+        return -1;
+
+    // The completions may come in any order
+    int res[cnt];
+    for (size_t i = 0; i < cnt; i++)
+    {
+        struct io_uring_cqe *cqe = _zn_uring_queue_wait(&u->tx);
+        if (cqe == NULL)
+            return -1;
+        res[cqe->user_data] = cqe->res;
+        _zn_uring_queue_seen(&u->tx);
+    }
+
+    // Count the bytes sent up to the first short or failed send
+    int sent = 0;
+    for (size_t i = 0; i < cnt; i++)
+    {
+        if (res[i] < 0)
+            return sent > 0 ? sent : res[i];
+
+        sent += res[i];
+        if ((size_t)res[i] < bufs[i].len)
+            break;
+    }
+
+    return sent;
+}
+
+int _zn_uring_send(void *arg, const uint8_t *ptr, size_t len)
+{
+    z_bytes_t bs;
+    bs.val = ptr;
+    bs.len = len;
+    return _zn_uring_sendv(arg, &bs, 1);
+}
+
+#endif
@@ -12,6 +12,8 @@
  *   ADLINK zenoh team, <zenoh@adlink-labs.tech>
  */
 
+#include <errno.h>
+#include <limits.h>
 #include "zenoh-pico/protocol/private/utils.h"
 #include "zenoh-pico/system/common.h"
 #include "zenoh-pico/utils/private/logging.h"
@@ -55,6 +57,15 @@ zn_properties_t *zn_config_client(const char *locator)
     return ps;
 }
 
+zn_properties_t *zn_config_peer(const char *locator)
+{
+    zn_properties_t *ps = zn_config_empty();
+    zn_properties_insert(ps, ZN_CONFIG_MODE_KEY, z_string_make("peer"));
+    zn_properties_insert(ps, ZN_CONFIG_PEER_KEY, z_string_make(locator ? locator : ZN_CONFIG_MULTICAST_PEER_DEFAULT));
+    zn_properties_insert(ps, ZN_CONFIG_MULTICAST_INTERFACE_KEY, z_string_make(ZN_CONFIG_MULTICAST_INTERFACE_DEFAULT));
+    return ps;
+}
+
 zn_properties_t *zn_config_default()
 {
     return zn_config_client(NULL);
@@ -89,10 +100,152 @@ void zn_close(zn_session_t *zn)
     return;
 }
 
+int _zn_config_int(zn_properties_t *config, unsigned int key, int base, long min, long max, int *value)
+{
+    // The value is left untouched if not configured
+    const char *str = zn_properties_get(config, key).val;
+    if (str == NULL)
+        return 0;
+
+    char *end = NULL;
+    errno = 0;
+    long v = strtol(str, &end, base);
+    if (errno != 0 || end == str || *end != '\0' || v < min || v > max)
+    {
+        _Z_DEBUG_VA("Invalid value for the configuration key 0x%x: %s\n", key, str);
+        return -1;
+    }
+
+    *value = (int)v;
+    return 0;
+}
+
+int _zn_link_opts_from_config(zn_properties_t *config, _zn_link_opts_t *opts)
+{
+    *opts = _zn_link_opts_default();
+
+    const char *nodelay = zn_properties_get(config, ZN_CONFIG_TCP_NODELAY_KEY).val;
+    if (nodelay == NULL)
+        nodelay = ZN_CONFIG_TCP_NODELAY_DEFAULT;
+    opts->tcp_nodelay = strcmp(nodelay, "true") == 0;
+
+    const char *quickack = zn_properties_get(config, ZN_CONFIG_TCP_QUICKACK_KEY).val;
+    if (quickack == NULL)
+        quickack = ZN_CONFIG_TCP_QUICKACK_DEFAULT;
+    if (strcmp(quickack, "true") == 0)
+        opts->tcp_quickack = 1;
+
+    // The other options keep the system default if not configured
+    if (_zn_config_int(config, ZN_CONFIG_SO_SNDBUF_KEY, 10, 1, INT_MAX, &opts->sndbuf) != 0)
+        return -1;
+    if (_zn_config_int(config, ZN_CONFIG_SO_RCVBUF_KEY, 10, 1, INT_MAX, &opts->rcvbuf) != 0)
+        return -1;
+    if (_zn_config_int(config, ZN_CONFIG_IP_TOS_KEY, 0, 0, 255, &opts->tos) != 0)
+        return -1;
+    if (_zn_config_int(config, ZN_CONFIG_SO_PRIORITY_KEY, 10, 0, INT_MAX, &opts->priority) != 0)
+        return -1;
+
+    if (_zn_config_int(config, ZN_CONFIG_MTU_KEY, 10, ZN_LINK_MTU_MIN, INT_MAX, &opts->mtu) != 0)
+        return -1;
+
+    return 0;
+}
+
+void _zn_config_batching(zn_session_t *zn, zn_properties_t *config)
+{
+    const char *batching = zn_properties_get(config, ZN_CONFIG_BATCHING_KEY).val;
+    if (batching == NULL)
+        batching = ZN_CONFIG_BATCHING_DEFAULT;
+    zn->batch_is_adaptive = strcmp(batching, "adaptive") == 0;
+    zn->batching = strcmp(batching, "true") == 0 || zn->batch_is_adaptive;
+
+    const char *batch_to = zn_properties_get(config, ZN_CONFIG_BATCHING_TIMEOUT_KEY).val;
+    if (batch_to == NULL)
+        batch_to = ZN_CONFIG_BATCHING_TIMEOUT_DEFAULT;
+    zn->batch_timeout = (unsigned int)strtoul(batch_to, NULL, 10);
+}
+
+int _zn_config_qos(zn_properties_t *config)
+{
+    const char *qos = zn_properties_get(config, ZN_CONFIG_QOS_KEY).val;
+    if (qos == NULL)
+        qos = ZN_CONFIG_QOS_DEFAULT;
+    return strcmp(qos, "true") == 0;
+}
+
+zn_session_t *_zn_open_multicast(zn_properties_t *config)
+{
+#if defined(ZENOH_LINUX) || defined(ZENOH_MACOS)
+    const char *locator = zn_properties_get(config, ZN_CONFIG_PEER_KEY).val;
+    if (locator == NULL)
+        locator = ZN_CONFIG_MULTICAST_PEER_DEFAULT;
+    const char *iface = zn_properties_get(config, ZN_CONFIG_MULTICAST_INTERFACE_KEY).val;
+    if (iface == NULL)
+        iface = ZN_CONFIG_MULTICAST_INTERFACE_DEFAULT;
+
+    // Join the multicast group
+    _zn_link_opts_t opts;
+    if (_zn_link_opts_from_config(config, &opts) != 0)
+        return NULL;
+    _zn_link_p_result_t r_link = _zn_open_link_multicast(locator, iface, 0, &opts);
+    if (r_link.tag == _z_res_t_ERR)
+        return NULL;
+
+    // Initialize the session, the peers are discovered from their JOIN messages
+    zn_session_t *zn = _zn_session_init();
+    zn->link = r_link.value.link;
+    zn->locator = strdup(locator);
+
+    // Initialize the PRNG, the sessions of a process joining the group in the same second need distinct peer IDs
+    srand((unsigned int)time(NULL) ^ (unsigned int)(uintptr_t)zn);
+
+    // Randomly generate a peer ID
+    zn->local_pid = _z_bytes_make(ZN_PID_LENGTH);
+    for (unsigned int i = 0; i < zn->local_pid.len; i++)
+        ((uint8_t *)zn->local_pid.val)[i] = rand() % 255;
+
+    // The frames sent on the group must fit in the link MTU
+    _z_wbuf_free(&zn->wbuf);
+    zn->wbuf = _z_wbuf_make(_zn_link_wbuf_capacity(zn->link), 0);
+
+    _zn_config_batching(zn, config);
+
+    // There is no negotiation, the peers follow the parameters announced in the JOIN messages
+    zn->is_qos = _zn_config_qos(config);
+    zn->sn_resolution = ZN_SN_RESOLUTION;
+    zn->sn_resolution_half = zn->sn_resolution / 2;
+    z_zint_t initial_sn = (z_zint_t)rand() % zn->sn_resolution;
+    for (int i = 0; i < _ZN_PRIORITIES_NUM; i++)
+    {
+        zn->conduits[i].sn_tx_reliable = initial_sn;
+        zn->conduits[i].sn_tx_best_effort = initial_sn;
+    }
+
+    // Announce the session to the group
+    if (_zn_send_join(zn) != 0)
+    {
+        _zn_close_link(zn->link);
+        _zn_session_free(zn);
+        return NULL;
+    }
+
+    return zn;
+#else
+    (void)(config);
+    _Z_DEBUG("Peer mode is not supported on this platform\n");
+    return NULL;
+#endif
+}
+
 zn_session_t *zn_open(zn_properties_t *config)
 {
     zn_session_t *zn = NULL;
 
+    // In peer mode the session joins a multicast group instead of connecting to a router
+    const char *mode = zn_properties_get(config, ZN_CONFIG_MODE_KEY).val;
+    if (mode != NULL && strcmp(mode, "peer") == 0)
+        return _zn_open_multicast(config);
+
     int locator_is_scouted = 0;
     const char *locator = zn_properties_get(config, ZN_CONFIG_PEER_KEY).val;
 
@@ -100,7 +253,6 @@ zn_session_t *zn_open(zn_properties_t *config)
     {
         // Scout for routers
         unsigned int what = ZN_ROUTER;
-        const char *mode = zn_properties_get(config, ZN_CONFIG_MODE_KEY).val;
         if (mode == NULL)
         {
             return zn;
@@ -143,7 +295,12 @@ zn_session_t *zn_open(zn_properties_t *config)
     srand(time(NULL));
 
     // Attempt to configure the link
-    _zn_link_p_result_t r_link = _zn_open_link(locator, 0);
+    _zn_link_opts_t opts;
+    _zn_link_p_result_t r_link;
+    if (_zn_link_opts_from_config(config, &opts) != 0)
+        r_link.tag = _z_res_t_ERR;
+    else
+        r_link = _zn_open_link(locator, 0, &opts);
     if (r_link.tag == _z_res_t_ERR)
     {
         if (locator_is_scouted)
@@ -173,6 +330,20 @@ zn_session_t *zn_open(zn_properties_t *config)
     zn = _zn_session_init();
     zn->link = r_link.value.link;
 
+    // The frames sent on a datagram link must fit in the link MTU
+    _z_wbuf_free(&zn->wbuf);
+    zn->wbuf = _z_wbuf_make(_zn_link_wbuf_capacity(zn->link), 0);
+
+    // Configure the transmission batching
+    _zn_config_batching(zn, config);
+
+    // Ask the router for a conduit per priority if QoS is enabled
+    if (_zn_config_qos(config))
+    {
+        _ZN_SET_FLAG(ism.body.init.options, _ZN_OPT_INIT_QOS);
+        _ZN_SET_FLAG(ism.header, _ZN_FLAG_T_O);
+    }
+
     _Z_DEBUG("Sending InitSyn\n");
     // Encode and send the message
     int res = _zn_send_t_msg(zn, &ism);
@@ -239,10 +410,16 @@ zn_session_t *zn_open(zn_properties_t *config)
                 }
             }
 
+            // QoS is in place only if both sides support it
+            zn->is_qos = _ZN_HAS_FLAG(ism.body.init.options, _ZN_OPT_INIT_QOS) && _ZN_HAS_FLAG(p_iam->body.init.options, _ZN_OPT_INIT_QOS);
+
             // The initial SN at TX side
             z_zint_t initial_sn = (z_zint_t)rand() % zn->sn_resolution;
-            zn->sn_tx_reliable = initial_sn;
-            zn->sn_tx_best_effort = initial_sn;
+            for (int i = 0; i < _ZN_PRIORITIES_NUM; i++)
+            {
+                zn->conduits[i].sn_tx_reliable = initial_sn;
+                zn->conduits[i].sn_tx_best_effort = initial_sn;
+            }
 
             // Create the OpenSyn message
             _zn_transport_message_t osm = _zn_transport_message_init(_ZN_MID_OPEN);
@@ -304,7 +481,10 @@ zn_properties_t *zn_info(zn_session_t *zn)
 {
     zn_properties_t *ps = zn_properties_make();
     zn_properties_insert(ps, ZN_INFO_PID_KEY, _z_string_from_bytes(&zn->local_pid));
-    zn_properties_insert(ps, ZN_INFO_ROUTER_PID_KEY, _z_string_from_bytes(&zn->remote_pid));
+    if (zn->link->is_multicast)
+        zn_properties_insert(ps, ZN_INFO_PEER_PID_KEY, _zn_get_peer_pids(zn));
+    else
+        zn_properties_insert(ps, ZN_INFO_ROUTER_PID_KEY, _z_string_from_bytes(&zn->remote_pid));
     return ps;
 }
 
@@ -370,11 +550,11 @@ z_zint_t zn_declare_resource(zn_session_t *zn, zn_reskey_t reskey)
     if (r->key.rname)
         _ZN_SET_FLAG(z_msg.body.declare.declarations.val[0].header, _ZN_FLAG_Z_K);
 
-    if (_zn_send_z_msg(zn, &z_msg, zn_reliability_t_RELIABLE, zn_congestion_control_t_BLOCK) != 0)
+    if (_zn_send_z_msg(zn, &z_msg, zn_reliability_t_RELIABLE, zn_congestion_control_t_BLOCK, 1) != 0)
     {
         _Z_DEBUG("Trying to reconnect...\n");
         zn->on_disconnect(zn);
-        _zn_send_z_msg(zn, &z_msg, zn_reliability_t_RELIABLE, zn_congestion_control_t_BLOCK);
+        _zn_send_z_msg(zn, &z_msg, zn_reliability_t_RELIABLE, zn_congestion_control_t_BLOCK, 1);
     }
 
     _zn_zenoh_message_free(&z_msg);
@@ -398,11 +578,11 @@ void zn_undeclare_resource(zn_session_t *zn, z_zint_t rid)
         z_msg.body.declare.declarations.val[0].header = _ZN_DECL_FORGET_RESOURCE;
         z_msg.body.declare.declarations.val[0].body.forget_res.rid = rid;
 
-        if (_zn_send_z_msg(zn, &z_msg, zn_reliability_t_RELIABLE, zn_congestion_control_t_BLOCK) != 0)
+        if (_zn_send_z_msg(zn, &z_msg, zn_reliability_t_RELIABLE, zn_congestion_control_t_BLOCK, 1) != 0)
         {
             _Z_DEBUG("Trying to reconnect...\n");
             zn->on_disconnect(zn);
-            _zn_send_z_msg(zn, &z_msg, zn_reliability_t_RELIABLE, zn_congestion_control_t_BLOCK);
+            _zn_send_z_msg(zn, &z_msg, zn_reliability_t_RELIABLE, zn_congestion_control_t_BLOCK, 1);
         }
 
         _zn_zenoh_message_free(&z_msg);
@@ -412,12 +592,39 @@ void zn_undeclare_resource(zn_session_t *zn, z_zint_t rid)
 }
 
 /*------------------  Publisher Declaration ------------------*/
+void _zn_publisher_encode_header(zn_publisher_t *pub)
+{
+    // The key of the data messages, eventually using the resource id
+    zn_reskey_t key = pub->rid != ZN_RESOURCE_ID_NONE ? zn_rid(pub->rid) : pub->key;
+
+    _zn_zenoh_message_t d_msg = _zn_zenoh_message_init(_ZN_MID_DATA);
+    d_msg.priority = pub->priority;
+    // Eventually mark the message for congestion control
+    if (pub->cong_ctrl == zn_congestion_control_t_DROP)
+        _ZN_SET_FLAG(d_msg.header, _ZN_FLAG_Z_D);
+    d_msg.body.data.key = key;
+    _ZN_SET_FLAG(d_msg.header, key.rname ? _ZN_FLAG_Z_K : 0);
+
+    // Encode the data message up to the payload
+    _z_wbuf_t wbf = _z_wbuf_make(ZN_FRAG_BUF_TX_CHUNK, 1);
+    _zn_zenoh_message_encode_prefix(&wbf, &d_msg);
+    _z_zbuf_t zbf = _z_wbuf_to_zbuf(&wbf);
+    _z_wbuf_free(&wbf);
+
+    free((uint8_t *)pub->header.val);
+    pub->header.val = _z_zbuf_get_rptr(&zbf);
+    pub->header.len = _z_zbuf_len(&zbf);
+}
+
 zn_publisher_t *zn_declare_publisher(zn_session_t *zn, zn_reskey_t reskey)
 {
     zn_publisher_t *pub = (zn_publisher_t *)malloc(sizeof(zn_publisher_t));
     pub->zn = zn;
     pub->key = reskey;
     pub->id = _zn_get_entity_id(zn);
+    pub->priority = ZN_PRIORITY_DEFAULT;
+    pub->reliability = zn_reliability_t_RELIABLE;
+    pub->cong_ctrl = ZN_CONGESTION_CONTROL_DEFAULT;
 
     _zn_zenoh_message_t z_msg = _zn_zenoh_message_init(_ZN_MID_DECLARE);
 
@@ -434,15 +641,24 @@ zn_publisher_t *zn_declare_publisher(zn_session_t *zn, zn_reskey_t reskey)
     if (pub->key.rname)
         _ZN_SET_FLAG(z_msg.body.declare.declarations.val[0].header, _ZN_FLAG_Z_K);
 
-    if (_zn_send_z_msg(zn, &z_msg, zn_reliability_t_RELIABLE, zn_congestion_control_t_BLOCK) != 0)
+    if (_zn_send_z_msg(zn, &z_msg, zn_reliability_t_RELIABLE, zn_congestion_control_t_BLOCK, 1) != 0)
     {
         _Z_DEBUG("Trying to reconnect...\n");
         zn->on_disconnect(zn);
-        _zn_send_z_msg(zn, &z_msg, zn_reliability_t_RELIABLE, zn_congestion_control_t_BLOCK);
+        _zn_send_z_msg(zn, &z_msg, zn_reliability_t_RELIABLE, zn_congestion_control_t_BLOCK, 1);
     }
 
     _zn_zenoh_message_free(&z_msg);
 
+    // Use a numerical id on the wire for resource names
+    pub->rid = ZN_RESOURCE_ID_NONE;
+    if (reskey.rid == ZN_RESOURCE_ID_NONE)
+        pub->rid = zn_declare_resource(zn, reskey);
+
+    // Pre-encode the data message up to the payload
+    pub->header.val = NULL;
+    _zn_publisher_encode_header(pub);
+
     return pub;
 }
 
@@ -462,18 +678,45 @@ void zn_undeclare_publisher(zn_publisher_t *pub)
     if (pub->key.rname)
         _ZN_SET_FLAG(z_msg.body.declare.declarations.val[0].header, _ZN_FLAG_Z_K);
 
-    if (_zn_send_z_msg(pub->zn, &z_msg, zn_reliability_t_RELIABLE, zn_congestion_control_t_BLOCK) != 0)
+    if (_zn_send_z_msg(pub->zn, &z_msg, zn_reliability_t_RELIABLE, zn_congestion_control_t_BLOCK, 1) != 0)
     {
         _Z_DEBUG("Trying to reconnect...\n");
         pub->zn->on_disconnect(pub->zn);
-        _zn_send_z_msg(pub->zn, &z_msg, zn_reliability_t_RELIABLE, zn_congestion_control_t_BLOCK);
+        _zn_send_z_msg(pub->zn, &z_msg, zn_reliability_t_RELIABLE, zn_congestion_control_t_BLOCK, 1);
     }
 
     _zn_zenoh_message_free(&z_msg);
 
+    if (pub->rid != ZN_RESOURCE_ID_NONE)
+        zn_undeclare_resource(pub->zn, pub->rid);
+
+    free((uint8_t *)pub->header.val);
     free(pub);
 }
 
+int zn_publisher_set_priority(zn_publisher_t *pub, zn_priority_t priority)
+{
+    if ((unsigned int)priority >= _ZN_PRIORITIES_NUM)
+        return -1;
+
+    // The priority decorator is part of the pre-encoded message header
+    pub->priority = priority;
+    _zn_publisher_encode_header(pub);
+    return 0;
+}
+
+void zn_publisher_set_reliability(zn_publisher_t *pub, zn_reliability_t reliability)
+{
+    pub->reliability = reliability;
+}
+
+void zn_publisher_set_congestion_control(zn_publisher_t *pub, zn_congestion_control_t cong_ctrl)
+{
+    // The congestion control is part of the pre-encoded message header
+    pub->cong_ctrl = cong_ctrl;
+    _zn_publisher_encode_header(pub);
+}
+
 /*------------------ Subscriber Declaration ------------------*/
 zn_subinfo_t zn_subinfo_default()
 {
@@ -492,6 +735,11 @@ zn_subscriber_t *zn_declare_subscriber(zn_session_t *zn, zn_reskey_t reskey, zn_
     rs->info = sub_info;
     rs->callback = callback;
     rs->arg = arg;
+    rs->jobs_head = NULL;
+    rs->jobs_tail = NULL;
+    rs->is_scheduled = 0;
+    rs->is_undeclared = 0;
+    rs->next_ready = NULL;
 
     int res = _zn_register_subscription(zn, _ZN_IS_LOCAL, rs);
     if (res != 0)
@@ -523,11 +771,11 @@ zn_subscriber_t *zn_declare_subscriber(zn_session_t *zn, zn_reskey_t reskey, zn_
     z_msg.body.declare.declarations.val[0].body.sub.subinfo.reliability = sub_info.reliability;
     z_msg.body.declare.declarations.val[0].body.sub.subinfo.period = sub_info.period;
 
-    if (_zn_send_z_msg(zn, &z_msg, zn_reliability_t_RELIABLE, zn_congestion_control_t_BLOCK) != 0)
+    if (_zn_send_z_msg(zn, &z_msg, zn_reliability_t_RELIABLE, zn_congestion_control_t_BLOCK, 1) != 0)
     {
         _Z_DEBUG("Trying to reconnect....\n");
         zn->on_disconnect(zn);
-        _zn_send_z_msg(zn, &z_msg, zn_reliability_t_RELIABLE, zn_congestion_control_t_BLOCK);
+        _zn_send_z_msg(zn, &z_msg, zn_reliability_t_RELIABLE, zn_congestion_control_t_BLOCK, 1);
     }
 
     _zn_zenoh_message_free(&z_msg);
@@ -558,11 +806,11 @@ void zn_undeclare_subscriber(zn_subscriber_t *sub)
 
         z_msg.body.declare.declarations.val[0].body.forget_sub.key = _zn_reskey_clone(&s->key);
 
-        if (_zn_send_z_msg(sub->zn, &z_msg, zn_reliability_t_RELIABLE, zn_congestion_control_t_BLOCK) != 0)
+        if (_zn_send_z_msg(sub->zn, &z_msg, zn_reliability_t_RELIABLE, zn_congestion_control_t_BLOCK, 1) != 0)
         {
             _Z_DEBUG("Trying to reconnect....\n");
             sub->zn->on_disconnect(sub->zn);
-            _zn_send_z_msg(sub->zn, &z_msg, zn_reliability_t_RELIABLE, zn_congestion_control_t_BLOCK);
+            _zn_send_z_msg(sub->zn, &z_msg, zn_reliability_t_RELIABLE, zn_congestion_control_t_BLOCK, 1);
         }
 
         _zn_zenoh_message_free(&z_msg);
@@ -574,13 +822,13 @@ void zn_undeclare_subscriber(zn_subscriber_t *sub)
 }
 
 /*------------------ Write ------------------*/
-int zn_write_ext(zn_session_t *zn, zn_reskey_t reskey, const unsigned char *payload, size_t length, uint8_t encoding, uint8_t kind, zn_congestion_control_t cong_ctrl)
+int _zn_write(zn_session_t *zn, zn_reskey_t reskey, const uint8_t *payload, size_t length, const _zn_data_info_t *info, zn_priority_t priority, zn_reliability_t reliability, zn_congestion_control_t cong_ctrl, int is_express)
 {
     // @TODO: Need to verify that I have declared a publisher with the same resource key.
     //        Then, need to verify there are active subscriptions matching the publisher.
-    // @TODO: Need to check subscriptions to determine the right reliability value.
 
     _zn_zenoh_message_t z_msg = _zn_zenoh_message_init(_ZN_MID_DATA);
+    z_msg.priority = priority;
     // Eventually mark the message for congestion control
     if (cong_ctrl == zn_congestion_control_t_DROP)
         _ZN_SET_FLAG(z_msg.header, _ZN_FLAG_Z_D);
@@ -588,8 +836,23 @@ int zn_write_ext(zn_session_t *zn, zn_reskey_t reskey, const unsigned char *payl
     z_msg.body.data.key = reskey;
     _ZN_SET_FLAG(z_msg.header, reskey.rname ? _ZN_FLAG_Z_K : 0);
 
+    // Set the data info if any
+    if (info != NULL)
+    {
+        _ZN_SET_FLAG(z_msg.header, _ZN_FLAG_Z_I);
+        z_msg.body.data.info = *info;
+    }
+
+    // Set the payload
+    z_msg.body.data.payload.len = length;
+    z_msg.body.data.payload.val = (uint8_t *)payload;
+
+    return _zn_send_z_msg(zn, &z_msg, reliability, cong_ctrl, is_express);
+}
+
+int zn_write_ext(zn_session_t *zn, zn_reskey_t reskey, const unsigned char *payload, size_t length, uint8_t encoding, uint8_t kind, zn_congestion_control_t cong_ctrl)
+{
     // Set the data info
-    _ZN_SET_FLAG(z_msg.header, _ZN_FLAG_Z_I);
     _zn_data_info_t info;
     info.flags = 0;
     info.encoding.prefix = encoding;
@@ -597,34 +860,58 @@ int zn_write_ext(zn_session_t *zn, zn_reskey_t reskey, const unsigned char *payl
     _ZN_SET_FLAG(info.flags, _ZN_DATA_INFO_ENC);
     info.kind = kind;
     _ZN_SET_FLAG(info.flags, _ZN_DATA_INFO_KIND);
-    z_msg.body.data.info = info;
 
-    // Set the payload
-    z_msg.body.data.payload.len = length;
-    z_msg.body.data.payload.val = (uint8_t *)payload;
+    return _zn_write(zn, reskey, payload, length, &info, ZN_PRIORITY_DEFAULT, zn_reliability_t_RELIABLE, cong_ctrl, 0);
+}
+
+int zn_write_qos(zn_session_t *zn, zn_reskey_t reskey, const uint8_t *payload, size_t length, zn_priority_t priority, zn_reliability_t reliability, zn_congestion_control_t cong_ctrl)
+{
+    // The priority indexes the conduits of the session
+    if ((unsigned int)priority >= _ZN_PRIORITIES_NUM)
+        return -1;
 
-    return _zn_send_z_msg(zn, &z_msg, zn_reliability_t_RELIABLE, cong_ctrl);
+    return _zn_write(zn, reskey, payload, length, NULL, priority, reliability, cong_ctrl, 0);
 }
 
 int zn_write(zn_session_t *zn, zn_reskey_t reskey, const uint8_t *payload, size_t length)
 {
-    // @TODO: Need to verify that I have declared a publisher with the same resource key.
-    //        Then, need to verify there are active subscriptions matching the publisher.
-    // @TODO: Need to check subscriptions to determine the right reliability value.
+    return _zn_write(zn, reskey, payload, length, NULL, ZN_PRIORITY_DEFAULT, zn_reliability_t_RELIABLE, ZN_CONGESTION_CONTROL_DEFAULT, 0);
+}
 
-    _zn_zenoh_message_t z_msg = _zn_zenoh_message_init(_ZN_MID_DATA);
-    // Eventually mark the message for congestion control
-    if (ZN_CONGESTION_CONTROL_DEFAULT == zn_congestion_control_t_DROP)
-        _ZN_SET_FLAG(z_msg.header, _ZN_FLAG_Z_D);
-    // Set the resource key
-    z_msg.body.data.key = reskey;
-    _ZN_SET_FLAG(z_msg.header, reskey.rname ? _ZN_FLAG_Z_K : 0);
+int zn_write_express(zn_session_t *zn, zn_reskey_t reskey, const uint8_t *payload, size_t length)
+{
+    // Bypass the batching and send the data right away
+    return _zn_write(zn, reskey, payload, length, NULL, ZN_PRIORITY_DEFAULT, zn_reliability_t_RELIABLE, ZN_CONGESTION_CONTROL_DEFAULT, 1);
+}
 
-    // Set the payload
-    z_msg.body.data.payload.len = length;
-    z_msg.body.data.payload.val = (uint8_t *)payload;
+int zn_publish(zn_publisher_t *pub, const uint8_t *payload, size_t length)
+{
+    return _zn_send_preencoded_data(pub->zn, &pub->header, payload, length, pub->priority, pub->reliability, pub->cong_ctrl, 0);
+}
 
-    return _zn_send_z_msg(zn, &z_msg, zn_reliability_t_RELIABLE, ZN_CONGESTION_CONTROL_DEFAULT);
+int zn_batch_begin(zn_session_t *zn)
+{
+    return _zn_batch_begin(zn);
+}
+
+int zn_batch_flush(zn_session_t *zn)
+{
+    return _zn_batch_flush(zn);
+}
+
+zn_batch_stats_t zn_batch_stats(zn_session_t *zn)
+{
+    z_mutex_lock(&zn->mutex_tx);
+    zn_batch_stats_t stats = zn->batch_stats;
+    z_mutex_unlock(&zn->mutex_tx);
+    return stats;
+}
+
+void zn_batch_stats_reset(zn_session_t *zn)
+{
+    z_mutex_lock(&zn->mutex_tx);
+    memset(&zn->batch_stats, 0, sizeof(zn_batch_stats_t));
+    z_mutex_unlock(&zn->mutex_tx);
 }
 
 /*------------------ Query/Queryable ------------------*/
@@ -719,7 +1006,7 @@ void zn_query(zn_session_t *zn, zn_reskey_t reskey, const char *predicate, zn_qu
 
     z_msg.body.query.consolidation = consolidation;
 
-    int res = _zn_send_z_msg(zn, &z_msg, zn_reliability_t_RELIABLE, zn_congestion_control_t_BLOCK);
+    int res = _zn_send_z_msg(zn, &z_msg, zn_reliability_t_RELIABLE, zn_congestion_control_t_BLOCK, 1);
     if (res != 0)
         _zn_unregister_pending_query(zn, pq);
 }
@@ -839,11 +1126,11 @@ zn_queryable_t *zn_declare_queryable(zn_session_t *zn, zn_reskey_t reskey, unsig
     z_msg.body.declare.declarations.val[0]
         .body.qle.distance = distance;
 
-    if (_zn_send_z_msg(zn, &z_msg, zn_reliability_t_RELIABLE, zn_congestion_control_t_BLOCK) != 0)
+    if (_zn_send_z_msg(zn, &z_msg, zn_reliability_t_RELIABLE, zn_congestion_control_t_BLOCK, 1) != 0)
     {
         _Z_DEBUG("Trying to reconnect....\n");
         zn->on_disconnect(zn);
-        _zn_send_z_msg(zn, &z_msg, zn_reliability_t_RELIABLE, zn_congestion_control_t_BLOCK);
+        _zn_send_z_msg(zn, &z_msg, zn_reliability_t_RELIABLE, zn_congestion_control_t_BLOCK, 1);
     }
 
     _zn_zenoh_message_free(&z_msg);
@@ -875,11 +1162,11 @@ void zn_undeclare_queryable(zn_queryable_t *qle)
         z_msg.body.declare.declarations.val[0].body.forget_qle.key = _zn_reskey_clone(&q->key);
         z_msg.body.declare.declarations.val[0].body.forget_qle.kind = q->kind;
 
-        if (_zn_send_z_msg(qle->zn, &z_msg, zn_reliability_t_RELIABLE, zn_congestion_control_t_BLOCK) != 0)
+        if (_zn_send_z_msg(qle->zn, &z_msg, zn_reliability_t_RELIABLE, zn_congestion_control_t_BLOCK, 1) != 0)
         {
             _Z_DEBUG("Trying to reconnect....\n");
             qle->zn->on_disconnect(qle->zn);
-            _zn_send_z_msg(qle->zn, &z_msg, zn_reliability_t_RELIABLE, zn_congestion_control_t_BLOCK);
+            _zn_send_z_msg(qle->zn, &z_msg, zn_reliability_t_RELIABLE, zn_congestion_control_t_BLOCK, 1);
         }
 
         _zn_zenoh_message_free(&z_msg);
@@ -910,11 +1197,11 @@ void zn_send_reply(zn_query_t *query, const char *key, const uint8_t *payload, s
         _ZN_SET_FLAG(z_msg.header, _ZN_FLAG_Z_K);
     // Do not set any data_info
 
-    if (_zn_send_z_msg(query->zn, &z_msg, zn_reliability_t_RELIABLE, zn_congestion_control_t_BLOCK) != 0)
+    if (_zn_send_z_msg(query->zn, &z_msg, zn_reliability_t_RELIABLE, zn_congestion_control_t_BLOCK, 1) != 0)
     {
         _Z_DEBUG("Trying to reconnect....\n");
         query->zn->on_disconnect(query->zn);
-        _zn_send_z_msg(query->zn, &z_msg, zn_reliability_t_RELIABLE, zn_congestion_control_t_BLOCK);
+        _zn_send_z_msg(query->zn, &z_msg, zn_reliability_t_RELIABLE, zn_congestion_control_t_BLOCK, 1);
     }
 
     free(z_msg.reply_context);
@@ -936,11 +1223,11 @@ int zn_pull(zn_subscriber_t *sub)
         z_msg.body.pull.max_samples = 0;
         // _ZN_SET_FLAG(z_msg.header, _ZN_FLAG_Z_N);
 
-        if (_zn_send_z_msg(sub->zn, &z_msg, zn_reliability_t_RELIABLE, zn_congestion_control_t_BLOCK) != 0)
+        if (_zn_send_z_msg(sub->zn, &z_msg, zn_reliability_t_RELIABLE, zn_congestion_control_t_BLOCK, 1) != 0)
         {
             _Z_DEBUG("Trying to reconnect....\n");
             sub->zn->on_disconnect(sub->zn);
-            _zn_send_z_msg(sub->zn, &z_msg, zn_reliability_t_RELIABLE, zn_congestion_control_t_BLOCK);
+            _zn_send_z_msg(sub->zn, &z_msg, zn_reliability_t_RELIABLE, zn_congestion_control_t_BLOCK, 1);
         }
 
         _zn_zenoh_message_free(&z_msg);
@@ -959,6 +1246,14 @@ int zn_pull(zn_subscriber_t *sub)
 /*------------------ Read ------------------*/
 int znp_read(zn_session_t *zn)
 {
+    if (zn->link->is_multicast)
+    {
+        z_mutex_lock(&zn->mutex_rx);
+        int res = __unsafe_zn_read_multicast(zn);
+        z_mutex_unlock(&zn->mutex_rx);
+        return res;
+    }
+
     _zn_transport_message_p_result_t r_s = _zn_recv_t_msg(zn);
     if (r_s.tag == _z_res_t_OK)
     {
@@ -974,6 +1269,48 @@ int znp_read(zn_session_t *zn)
     }
 }
 
+/*------------------ Event loop ------------------*/
+int znp_get_fd(zn_session_t *zn)
+{
+    // The sessions on shared memory, in-process or io_uring links have no file descriptor to wait for
+    if (!zn->link->is_pollable)
+        return -1;
+    return zn->link->sock;
+}
+
+int znp_process_readable(zn_session_t *zn)
+{
+    if (!zn->link->is_pollable)
+        return _z_res_t_ERR;
+
+    // Each read only takes what is already available, until the socket is drained
+    int is_readable;
+    do
+    {
+        if (_zn_process_readable(zn) != _z_res_t_OK)
+            return _z_res_t_ERR;
+#if defined(ZENOH_LINUX) || defined(ZENOH_MACOS)
+        is_readable = _zn_socket_readable(zn->link->sock) > 0;
+#else
+        is_readable = 0;
+#endif
+    } while (is_readable);
+
+    return _z_res_t_OK;
+}
+
+int znp_process_timers(zn_session_t *zn, unsigned long now)
+{
+    int interval = _zn_process_timers(zn, now);
+    if (interval < 0)
+    {
+        _Z_DEBUG_VA("Closing session because it has expired after %zums", zn->lease);
+        _zn_session_close(zn, _ZN_CLOSE_EXPIRED);
+    }
+
+    return interval;
+}
+
 /*------------------ Keep Alive ------------------*/
 int znp_send_keep_alive(zn_session_t *zn)
 {
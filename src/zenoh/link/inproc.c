@@ -0,0 +1,472 @@
+/*
+ * Copyright (c) 2017, 2021 ADLINK Technology Inc.
+ *
+ * This program and the accompanying materials are made available under the
+ * terms of the Eclipse Public License 2.0 which is available at
+ * http://www.eclipse.org/legal/epl-2.0, or the Apache License, Version 2.0
+ * which is available at https://www.apache.org/licenses/LICENSE-2.0.
+ *
+ * SPDX-License-Identifier: EPL-2.0 OR Apache-2.0
+ *
+ * Contributors:
+ *   ADLINK zenoh team, <zenoh@adlink-labs.tech>
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "zenoh-pico/system/common.h"
+#include "zenoh-pico/link/private/manager.h"
+#include "zenoh-pico/protocol/private/msgcodec.h"
+#include "zenoh-pico/protocol/private/utils.h"
+#include "zenoh-pico/utils/private/logging.h"
+
+/*------------------ In-process pipes ------------------*/
+// NOTE: An in-process link is a pair of in-memory pipes between a session and a minimal
+//       scripted peer. The peer runs synchronously in the writer thread: it completes the
+//       INIT/OPEN handshake, answers the keep alives and forwards the frames to the other
+//       sessions connected to the same name, or back to the sender when it is alone.
+//       The frames are forwarded with the peer's own sequence numbers but the resource and
+//       query identifiers are forwarded as is, and the fragments of large messages sent at
+//       the same time by several sessions on the same conduit are not kept apart.
+typedef struct
+{
+    z_mutex_t mutex;
+    z_condvar_t cond;
+    uint8_t *buf;
+    size_t r_pos;
+    size_t w_pos;
+    size_t capacity;
+    int is_closed;
+} _zn_inproc_pipe_t;
+
+typedef struct _zn_inproc_endpoint_t
+{
+    char *name;
+    int is_open;
+    int is_qos;
+    z_zint_t sn_resolution;
+    z_zint_t sn_reliable[_ZN_PRIORITIES_NUM];
+    z_zint_t sn_best_effort[_ZN_PRIORITIES_NUM];
+
+    // The bytes towards the session
+    _zn_inproc_pipe_t rx;
+    _z_wbuf_t wbuf;
+
+    // The bytes written by the session, not forming a complete message yet
+    uint8_t *tx;
+    size_t tx_len;
+    size_t tx_capacity;
+
+    struct _zn_inproc_endpoint_t *next;
+} _zn_inproc_endpoint_t;
+
+// The sessions that completed the handshake, protected by a spin lock since the
+// peer only holds it to encode and copy the forwarded messages
+_zn_inproc_endpoint_t *_zn_inproc_sessions = NULL;
+volatile int _zn_inproc_sessions_lock = 0;
+
+void _zn_inproc_lock(void)
+{
+    while (__atomic_exchange_n(&_zn_inproc_sessions_lock, 1, __ATOMIC_ACQUIRE))
+        ;
+}
+
+void _zn_inproc_unlock(void)
+{
+    __atomic_store_n(&_zn_inproc_sessions_lock, 0, __ATOMIC_RELEASE);
+}
+
+void _zn_inproc_pipe_init(_zn_inproc_pipe_t *p)
+{
+    z_mutex_init(&p->mutex);
+    z_condvar_init(&p->cond);
+    p->capacity = ZN_READ_BUF_LEN;
+    p->buf = (uint8_t *)malloc(p->capacity);
+    p->r_pos = 0;
+    p->w_pos = 0;
+    p->is_closed = 0;
+}
+
+void _zn_inproc_pipe_free(_zn_inproc_pipe_t *p)
+{
+    z_condvar_free(&p->cond);
+    z_mutex_free(&p->mutex);
+    free(p->buf);
+}
+
+void _zn_inproc_pipe_close(_zn_inproc_pipe_t *p)
+{
+    z_mutex_lock(&p->mutex);
+    p->is_closed = 1;
+    z_condvar_broadcast(&p->cond);
+    z_mutex_unlock(&p->mutex);
+}
+
+void __unsafe_zn_inproc_pipe_reserve(_zn_inproc_pipe_t *p, size_t len)
+{
+    if (p->capacity - p->w_pos >= len)
+        return;
+
+    // Move the unread bytes at the beginning and grow the buffer if still needed
+    memmove(p->buf, p->buf + p->r_pos, p->w_pos - p->r_pos);
+    p->w_pos -= p->r_pos;
+    p->r_pos = 0;
+    while (p->capacity - p->w_pos < len)
+        p->capacity *= 2;
+    p->buf = (uint8_t *)realloc(p->buf, p->capacity);
+}
+
+void _zn_inproc_pipe_write_wbuf(_zn_inproc_pipe_t *p, const _z_wbuf_t *wbf)
+{
+    z_mutex_lock(&p->mutex);
+    if (!p->is_closed)
+    {
+        // The pipe is unbounded, a session which is not reading only accumulates bytes
+        __unsafe_zn_inproc_pipe_reserve(p, _z_wbuf_len(wbf));
+        for (size_t i = 0; i < _z_wbuf_len_iosli(wbf); i++)
+        {
+            z_bytes_t bs = _z_iosli_to_bytes(_z_wbuf_get_iosli(wbf, i));
+            memcpy(p->buf + p->w_pos, bs.val, bs.len);
+            p->w_pos += bs.len;
+        }
+        z_condvar_signal(&p->cond);
+    }
+    z_mutex_unlock(&p->mutex);
+}
+
+int _zn_inproc_pipe_read(_zn_inproc_pipe_t *p, uint8_t *ptr, size_t len)
+{
+    z_mutex_lock(&p->mutex);
+    while (p->r_pos == p->w_pos && !p->is_closed)
+        z_condvar_wait(&p->cond, &p->mutex);
+
+    // Return the pending bytes before reporting the closure
+    int rb = -1;
+    if (p->r_pos < p->w_pos)
+    {
+        size_t n = p->w_pos - p->r_pos < len ? p->w_pos - p->r_pos : len;
+        memcpy(ptr, p->buf + p->r_pos, n);
+        p->r_pos += n;
+        if (p->r_pos == p->w_pos)
+        {
+            p->r_pos = 0;
+            p->w_pos = 0;
+        }
+        rb = n;
+    }
+    z_mutex_unlock(&p->mutex);
+
+    return rb;
+}
+
+/*------------------ Scripted peer ------------------*/
+void __unsafe_zn_inproc_send(_zn_inproc_endpoint_t *ep, _zn_transport_message_t *t_msg)
+{
+    // Reserve the space for the message length, links are streamed
+    _z_wbuf_clear(&ep->wbuf);
+    for (size_t i = 0; i < _ZN_MSG_LEN_ENC_SIZE; i++)
+        _z_wbuf_put(&ep->wbuf, 0, i);
+    _z_wbuf_set_wpos(&ep->wbuf, _ZN_MSG_LEN_ENC_SIZE);
+
+    // The buffer is not expandable, frames grown by a larger SN may no longer fit
+    if (_zn_transport_message_encode(&ep->wbuf, t_msg) != 0)
+    {
+        _Z_DEBUG("Dropping in-process message because it is too large");
+        return;
+    }
+
+    size_t len = _z_wbuf_len(&ep->wbuf) - _ZN_MSG_LEN_ENC_SIZE;
+    _z_wbuf_put(&ep->wbuf, (uint8_t)(len & 0xFF), 0);
+    _z_wbuf_put(&ep->wbuf, (uint8_t)((len >> 8) & 0xFF), 1);
+
+    _zn_inproc_pipe_write_wbuf(&ep->rx, &ep->wbuf);
+}
+
+void __unsafe_zn_inproc_forward(_zn_inproc_endpoint_t *ep, _zn_transport_message_t *t_msg)
+{
+    // Use the conduit of the frame only if the destination negotiated QoS
+    zn_priority_t priority = t_msg->priority;
+    int cid = 0;
+    if (ep->is_qos)
+        cid = priority;
+    else
+        t_msg->priority = ZN_PRIORITY_DEFAULT;
+
+    z_zint_t *sn = _ZN_HAS_FLAG(t_msg->header, _ZN_FLAG_T_R) ? &ep->sn_reliable[cid] : &ep->sn_best_effort[cid];
+    t_msg->body.frame.sn = *sn;
+    *sn = (*sn + 1) % ep->sn_resolution;
+
+    __unsafe_zn_inproc_send(ep, t_msg);
+    t_msg->priority = priority;
+}
+
+void __unsafe_zn_inproc_handle(_zn_inproc_endpoint_t *ep, _zn_transport_message_t *t_msg)
+{
+    switch (_ZN_MID(t_msg->header))
+    {
+    case _ZN_MID_INIT:
+    {
+        if (_ZN_HAS_FLAG(t_msg->header, _ZN_FLAG_T_A))
+            break;
+
+        // Accept the session with the same resolution and QoS
+        ep->sn_resolution = _ZN_HAS_FLAG(t_msg->header, _ZN_FLAG_T_S) ? t_msg->body.init.sn_resolution : ZN_SN_RESOLUTION_DEFAULT;
+        ep->is_qos = _ZN_HAS_FLAG(t_msg->header, _ZN_FLAG_T_O) && _ZN_HAS_FLAG(t_msg->body.init.options, _ZN_OPT_INIT_QOS);
+
+        z_bytes_t cookie = _z_bytes_make(strlen(ep->name));
+        memcpy((uint8_t *)cookie.val, ep->name, strlen(ep->name));
+        _zn_transport_message_t iam = _zn_init_ack_make(ep->sn_resolution, ep->is_qos, cookie);
+        __unsafe_zn_inproc_send(ep, &iam);
+        _zn_transport_message_free(&iam);
+        break;
+    }
+
+    case _ZN_MID_OPEN:
+    {
+        if (_ZN_HAS_FLAG(t_msg->header, _ZN_FLAG_T_A) || ep->is_open)
+            break;
+
+        // The frames towards the session start from a zero SN on every conduit
+        for (int i = 0; i < _ZN_PRIORITIES_NUM; i++)
+        {
+            ep->sn_reliable[i] = 0;
+            ep->sn_best_effort[i] = 0;
+        }
+
+        _zn_transport_message_t oam = _zn_open_ack_make(ZN_TRANSPORT_LEASE, 0);
+        __unsafe_zn_inproc_send(ep, &oam);
+        _zn_transport_message_free(&oam);
+
+        ep->is_open = 1;
+        ep->next = _zn_inproc_sessions;
+        _zn_inproc_sessions = ep;
+        break;
+    }
+
+    case _ZN_MID_KEEP_ALIVE:
+    {
+        // Keep the session lease alive
+        _zn_transport_message_t kam = _zn_transport_message_init(_ZN_MID_KEEP_ALIVE);
+        __unsafe_zn_inproc_send(ep, &kam);
+        _zn_transport_message_free(&kam);
+        break;
+    }
+
+    case _ZN_MID_FRAME:
+    {
+        if (!ep->is_open)
+            break;
+
+        // Route to the other sessions with the same name, echo when alone
+        int is_routed = 0;
+        for (_zn_inproc_endpoint_t *it = _zn_inproc_sessions; it != NULL; it = it->next)
+        {
+            if (it != ep && strcmp(it->name, ep->name) == 0)
+            {
+                __unsafe_zn_inproc_forward(it, t_msg);
+                is_routed = 1;
+            }
+        }
+        if (!is_routed)
+            __unsafe_zn_inproc_forward(ep, t_msg);
+        break;
+    }
+
+    default:
+        break;
+    }
+}
+
+void __unsafe_zn_inproc_remove(_zn_inproc_endpoint_t *ep)
+{
+    _zn_inproc_endpoint_t **it = &_zn_inproc_sessions;
+    while (*it != NULL)
+    {
+        if (*it == ep)
+        {
+            *it = ep->next;
+            break;
+        }
+        it = &(*it)->next;
+    }
+    ep->is_open = 0;
+}
+
+int _zn_inproc_process(_zn_inproc_endpoint_t *ep, const uint8_t *ptr, size_t len)
+{
+    if (ep->tx_capacity - ep->tx_len < len)
+    {
+        while (ep->tx_capacity - ep->tx_len < len)
+            ep->tx_capacity *= 2;
+        ep->tx = (uint8_t *)realloc(ep->tx, ep->tx_capacity);
+    }
+    memcpy(ep->tx + ep->tx_len, ptr, len);
+    ep->tx_len += len;
+
+    _zn_inproc_lock();
+
+    // Handle all the complete messages
+    size_t r_pos = 0;
+    while (ep->tx_len - r_pos >= _ZN_MSG_LEN_ENC_SIZE)
+    {
+        size_t m_len = ep->tx[r_pos] | (ep->tx[r_pos + 1] << 8);
+        if (ep->tx_len - r_pos - _ZN_MSG_LEN_ENC_SIZE < m_len)
+            break;
+
+        _z_zbuf_t zbf = _z_zbuf_wrap(ep->tx + r_pos + _ZN_MSG_LEN_ENC_SIZE, m_len);
+        while (_z_zbuf_len(&zbf) > 0)
+        {
+            _zn_transport_message_p_result_t r_msg = _zn_transport_message_decode(&zbf);
+            if (r_msg.tag == _z_res_t_ERR)
+                break;
+
+            _zn_transport_message_t *t_msg = r_msg.value.transport_message;
+            if (_ZN_MID(t_msg->header) == _ZN_MID_CLOSE)
+                __unsafe_zn_inproc_remove(ep);
+            else
+                __unsafe_zn_inproc_handle(ep, t_msg);
+
+            _zn_transport_message_free(t_msg);
+            _zn_transport_message_p_result_free(&r_msg);
+        }
+
+        r_pos += _ZN_MSG_LEN_ENC_SIZE + m_len;
+    }
+
+    _zn_inproc_unlock();
+
+    // Keep the incomplete message for the next write
+    memmove(ep->tx, ep->tx + r_pos, ep->tx_len - r_pos);
+    ep->tx_len -= r_pos;
+
+    return len;
+}
+
+/*------------------ In-process links ------------------*/
+_zn_socket_result_t _zn_f_link_open_inproc(void *arg, const clock_t tout)
+{
+    (void)tout;
+    _zn_link_t *self = (_zn_link_t*)arg;
+    (void)self;
+
+    // The pipes are ready as soon as the link is created
+    _zn_socket_result_t r_sock;
+    r_sock.tag = _z_res_t_OK;
+    r_sock.value.socket = 0;
+    return r_sock;
+}
+
+int _zn_f_link_close_inproc(void *arg)
+{
+    _zn_link_t *self = (_zn_link_t*)arg;
+    _zn_inproc_endpoint_t *ep = (_zn_inproc_endpoint_t *)self->endpoint;
+
+    _zn_inproc_lock();
+    __unsafe_zn_inproc_remove(ep);
+    _zn_inproc_unlock();
+
+    // Wake up any blocked reader
+    _zn_inproc_pipe_close(&ep->rx);
+
+    return 0;
+}
+
+void _zn_f_link_release_inproc(void *arg)
+{
+    _zn_link_t *self = (_zn_link_t*)arg;
+    _zn_inproc_endpoint_t *ep = (_zn_inproc_endpoint_t *)self->endpoint;
+
+    _zn_inproc_lock();
+    __unsafe_zn_inproc_remove(ep);
+    _zn_inproc_unlock();
+
+    _zn_inproc_pipe_free(&ep->rx);
+    _z_wbuf_free(&ep->wbuf);
+    free(ep->tx);
+    free(ep->name);
+    free(ep);
+}
+
+size_t _zn_f_link_write_inproc(void *arg, const uint8_t *ptr, size_t len)
+{
+    _zn_link_t *self = (_zn_link_t*)arg;
+
+    return _zn_inproc_process((_zn_inproc_endpoint_t *)self->endpoint, ptr, len);
+}
+
+size_t _zn_f_link_write_all_inproc(void *arg, const uint8_t *ptr, size_t len)
+{
+    _zn_link_t *self = (_zn_link_t*)arg;
+
+    return _zn_inproc_process((_zn_inproc_endpoint_t *)self->endpoint, ptr, len);
+}
+
+size_t _zn_f_link_read_inproc(void *arg, uint8_t *ptr, size_t len)
+{
+    _zn_link_t *self = (_zn_link_t*)arg;
+    _zn_inproc_endpoint_t *ep = (_zn_inproc_endpoint_t *)self->endpoint;
+
+    return _zn_inproc_pipe_read(&ep->rx, ptr, len);
+}
+
+size_t _zn_f_link_read_exact_inproc(void *arg, uint8_t *ptr, size_t len)
+{
+    _zn_link_t *self = (_zn_link_t*)arg;
+    _zn_inproc_endpoint_t *ep = (_zn_inproc_endpoint_t *)self->endpoint;
+
+    size_t n = len;
+    do
+    {
+        int rb = _zn_inproc_pipe_read(&ep->rx, ptr, n);
+        if (rb < 0)
+            return rb;
+
+        n -= rb;
+        ptr = ptr + rb;
+    } while (n > 0);
+
+    return len;
+}
+
+_zn_link_t *_zn_new_link_inproc(const char *name)
+{
+    _zn_inproc_endpoint_t *ep = (_zn_inproc_endpoint_t *)malloc(sizeof(_zn_inproc_endpoint_t));
+    ep->name = strdup(name);
+    ep->is_open = 0;
+    ep->is_qos = 0;
+    ep->sn_resolution = ZN_SN_RESOLUTION_DEFAULT;
+    _zn_inproc_pipe_init(&ep->rx);
+    ep->wbuf = _z_wbuf_make(ZN_WRITE_BUF_LEN, 0);
+    ep->tx_capacity = ZN_WRITE_BUF_LEN;
+    ep->tx = (uint8_t *)malloc(ep->tx_capacity);
+    ep->tx_len = 0;
+    ep->next = NULL;
+
+    _zn_link_t *lt = (_zn_link_t *)malloc(sizeof(_zn_link_t));
+    // The pipes never lose nor reorder bytes, messages are delimited by their length
+    lt->is_reliable = 1;
+    lt->is_streamed = 1;
+    lt->is_pollable = 0;
+    lt->is_corked = 0;
+    lt->is_multicast = 0;
+
+    lt->endpoint = ep;
+    lt->mtu = -1;
+    lt->opts = _zn_link_opts_default();
+
+    lt->open_f = _zn_f_link_open_inproc;
+    lt->close_f = _zn_f_link_close_inproc;
+    lt->release_f = _zn_f_link_release_inproc;
+
+    lt->write_f = _zn_f_link_write_inproc;
+    lt->write_all_f = _zn_f_link_write_all_inproc;
+    lt->writev_f = NULL;
+    lt->pending_f = NULL;
+    lt->flush_f = NULL;
+    lt->read_f = _zn_f_link_read_inproc;
+    lt->read_exact_f = _zn_f_link_read_exact_inproc;
+    lt->buffered_f = NULL;
+    lt->read_from_f = NULL;
+
+    return lt;
+}
@@ -67,54 +67,118 @@ char* _zn_parse_address_segment(const char *locator, size_t skip_l, size_t skip_
     return NULL;
 }
 
-_zn_link_p_result_t _zn_open_link(const char *locator, clock_t tout)
+_zn_link_opts_t _zn_link_opts_default(void)
+{
+    // Keep the system defaults
+    _zn_link_opts_t opts;
+    opts.tcp_nodelay = -1;
+    opts.tcp_quickack = -1;
+    opts.sndbuf = -1;
+    opts.rcvbuf = -1;
+    opts.tos = -1;
+    opts.priority = -1;
+    opts.mtu = -1;
+    return opts;
+}
+
+_zn_link_p_result_t __zn_open_new_link(_zn_link_t *link, clock_t tout, const _zn_link_opts_t *opts)
+{
+    _zn_link_p_result_t r;
+    if (link == NULL)
+    {
+        r.tag = _z_res_t_ERR;
+        r.value.error = _zn_err_t_INVALID_LOCATOR;
+        return r;
+    }
+
+    // The socket options are applied each time the link is opened
+    link->opts = opts != NULL ? *opts : _zn_link_opts_default();
+
+    // A configured path MTU can only lower the MTU of a datagram link, down to ZN_LINK_MTU_MIN
+    if (!link->is_streamed && link->opts.mtu > 0 && link->opts.mtu < link->mtu)
+        link->mtu = link->opts.mtu < ZN_LINK_MTU_MIN ? ZN_LINK_MTU_MIN : link->opts.mtu;
+
+    // Open transport link for communication
+    _zn_socket_result_t r_sock = link->open_f(link, tout);
+    if (r_sock.tag == _z_res_t_ERR)
+    {
+        _zn_close_link(link);
+        r.tag = _z_res_t_ERR;
+        r.value.error = r_sock.value.error;
+        return r;
+    }
+
+    link->sock = r_sock.value.socket;
+    r.tag = _z_res_t_OK;
+    r.value.link = link;
+    return r;
+}
+
+_zn_link_p_result_t _zn_open_link(const char *locator, clock_t tout, const _zn_link_opts_t *opts)
 {
     _zn_link_p_result_t r;
     r.tag = _z_res_t_OK;
     char *protocol = NULL;
     char *s_addr = NULL;
     char *s_port = NULL;
+    _zn_link_t *link = NULL;
 
     // Parse locator
     protocol = _zn_parse_protocol_segment(locator);
-    s_port = _zn_parse_port_segment(locator);
-    if (protocol == NULL || s_port == NULL)
+    if (protocol == NULL)
     {
         r.tag = _z_res_t_ERR;
         r.value.error = _zn_err_t_INVALID_LOCATOR;
         goto EXIT_OPEN_LINK;
     }
 
-    s_addr = _zn_parse_address_segment(locator, strlen(protocol), strlen(s_port));
-    if (s_addr == NULL)
+    if (strcmp(protocol, INPROC_SCHEMA) == 0)
     {
-        r.tag = _z_res_t_ERR;
-        r.value.error = _zn_err_t_INVALID_LOCATOR;
-        goto EXIT_OPEN_LINK;
+        // In-process locators only carry a name, the sessions with the same name are connected
+        link = _zn_new_link_inproc(locator + strlen(protocol) + 1);
     }
-
-    // Create transport link
-    _zn_link_t *link = NULL;
-    if (strcmp(protocol, TCP_SCHEMA) == 0)
+#if defined(ZENOH_LINUX) || defined(ZENOH_MACOS)
+    else if (strcmp(protocol, SHM_SCHEMA) == 0)
     {
-        link = _zn_new_link_tcp(s_addr, s_port);
+        // Shared memory locators carry the name of the segment instead of an address and a port
+        link = _zn_new_link_shm(locator + strlen(protocol) + 1, 0);
     }
-    else if (strcmp(protocol, UDP_SCHEMA) == 0)
+    else if (strcmp(protocol, UNIXSOCK_STREAM_SCHEMA) == 0)
     {
-        link = _zn_new_link_udp(s_addr, s_port);
+        // The socket path follows the protocol, e.g. unixsock-stream//tmp/zenoh.sock
+        link = _zn_new_link_unix(locator + strlen(protocol) + 1);
     }
-
-    // Open transport link for communication
-    _zn_socket_result_t r_sock = link->open_f(link, tout);
-    if (r_sock.tag == _z_res_t_ERR)
+#endif
+    else
     {
-        _zn_close_link(link);
-        r.tag = _z_res_t_ERR;
-        r.value.error = r_sock.value.error;
+        s_port = _zn_parse_port_segment(locator);
+        if (s_port == NULL)
+        {
+            r.tag = _z_res_t_ERR;
+            r.value.error = _zn_err_t_INVALID_LOCATOR;
+            goto EXIT_OPEN_LINK;
+        }
+
+        s_addr = _zn_parse_address_segment(locator, strlen(protocol), strlen(s_port));
+        if (s_addr == NULL)
+        {
+            r.tag = _z_res_t_ERR;
+            r.value.error = _zn_err_t_INVALID_LOCATOR;
+            goto EXIT_OPEN_LINK;
+        }
+
+        // Create transport link
+        if (strcmp(protocol, TCP_SCHEMA) == 0)
+        {
+            link = _zn_new_link_tcp(s_addr, s_port);
+        }
+        else if (strcmp(protocol, UDP_SCHEMA) == 0)
+        {
+            link = _zn_new_link_udp(s_addr, s_port);
+        }
     }
 
-    link->sock = r_sock.value.socket;
-    r.value.link = link;
+    r = __zn_open_new_link(link, tout, opts);
 
 EXIT_OPEN_LINK:
     free(protocol);
@@ -124,6 +188,39 @@ EXIT_OPEN_LINK:
     return r;
 }
 
+#if defined(ZENOH_LINUX) || defined(ZENOH_MACOS)
+_zn_link_p_result_t _zn_open_link_multicast(const char *locator, const char *iface, clock_t tout, const _zn_link_opts_t *opts)
+{
+    _zn_link_p_result_t r;
+    r.tag = _z_res_t_ERR;
+    r.value.error = _zn_err_t_INVALID_LOCATOR;
+    char *s_addr = NULL;
+    char *s_port = NULL;
+
+    // Only the UDP groups are supported, e.g. udp/224.0.0.225:7447
+    char *protocol = _zn_parse_protocol_segment(locator);
+    if (protocol == NULL || strcmp(protocol, UDP_SCHEMA) != 0)
+        goto EXIT_OPEN_MCAST_LINK;
+
+    s_port = _zn_parse_port_segment(locator);
+    if (s_port == NULL)
+        goto EXIT_OPEN_MCAST_LINK;
+
+    s_addr = _zn_parse_address_segment(locator, strlen(protocol), strlen(s_port));
+    if (s_addr == NULL)
+        goto EXIT_OPEN_MCAST_LINK;
+
+    r = __zn_open_new_link(_zn_new_link_udp_multicast(s_addr, s_port, iface), tout, opts);
+
+EXIT_OPEN_MCAST_LINK:
+    free(protocol);
+    free(s_port);
+    free(s_addr);
+
+    return r;
+}
+#endif
+
 void _zn_close_link(_zn_link_t *link)
 {
     link->close_f(link);
@@ -0,0 +1,128 @@
+/*
+ * Copyright (c) 2017, 2021 ADLINK Technology Inc.
+ *
+ * This program and the accompanying materials are made available under the
+ * terms of the Eclipse Public License 2.0 which is available at
+ * http://www.eclipse.org/legal/epl-2.0, or the Apache License, Version 2.0
+ * which is available at https://www.apache.org/licenses/LICENSE-2.0.
+ *
+ * SPDX-License-Identifier: EPL-2.0 OR Apache-2.0
+ *
+ * Contributors:
+ *   ADLINK zenoh team, <zenoh@adlink-labs.tech>
+ */
+
+#if defined(ZENOH_LINUX) || defined(ZENOH_MACOS)
+
+#include <stdlib.h>
+#include "zenoh-pico/system/common.h"
+#include "zenoh-pico/link/private/manager.h"
+
+_zn_socket_result_t _zn_f_link_open_shm(void *arg, const clock_t tout)
+{
+    _zn_link_t *self = (_zn_link_t*)arg;
+
+    _zn_socket_result_t r_sock = _zn_open_shm(self->endpoint, tout);
+    return r_sock;
+}
+
+int _zn_f_link_close_shm(void *arg)
+{
+    _zn_link_t *self = (_zn_link_t*)arg;
+
+    return _zn_close_shm(self->endpoint);
+}
+
+void _zn_f_link_release_shm(void *arg)
+{
+    _zn_link_t *self = (_zn_link_t*)arg;
+
+    _zn_release_endpoint_shm(self->endpoint);
+}
+
+size_t _zn_f_link_write_shm(void *arg, const uint8_t *ptr, size_t len)
+{
+    _zn_link_t *self = (_zn_link_t*)arg;
+
+    return _zn_send_shm(self->endpoint, ptr, len);
+}
+
+size_t _zn_f_link_write_all_shm(void *arg, const uint8_t *ptr, size_t len)
+{
+    _zn_link_t *self = (_zn_link_t*)arg;
+
+    size_t n = len;
+    do
+    {
+        int wb = _zn_send_shm(self->endpoint, ptr, n);
+        if (wb < 0)
+            return wb;
+
+        n -= wb;
+        ptr = ptr + wb;
+    } while (n > 0);
+
+    return len;
+}
+
+size_t _zn_f_link_writev_shm(void *arg, const z_bytes_t *bufs, size_t cnt)
+{
+    _zn_link_t *self = (_zn_link_t*)arg;
+
+    return _zn_sendv_shm(self->endpoint, bufs, cnt);
+}
+
+size_t _zn_f_link_pending_shm(void *arg)
+{
+    _zn_link_t *self = (_zn_link_t*)arg;
+
+    return _zn_pending_shm(self->endpoint);
+}
+
+size_t _zn_f_link_read_shm(void *arg, uint8_t *ptr, size_t len)
+{
+    _zn_link_t *self = (_zn_link_t*)arg;
+
+    return _zn_read_shm(self->endpoint, ptr, len);
+}
+
+size_t _zn_f_link_read_exact_shm(void *arg, uint8_t *ptr, size_t len)
+{
+    _zn_link_t *self = (_zn_link_t*)arg;
+
+    return _zn_read_exact_shm(self->endpoint, ptr, len);
+}
+
+_zn_link_t *_zn_new_link_shm(const char *name, int is_listener)
+{
+    _zn_link_t *lt = (_zn_link_t *)malloc(sizeof(_zn_link_t));
+    // The rings preserve the order and never drop bytes, but do not preserve message boundaries
+    lt->is_reliable = 1;
+    lt->is_streamed = 1;
+    lt->is_pollable = 0;
+    lt->is_corked = 0;
+    lt->is_multicast = 0;
+
+    lt->endpoint = _zn_create_endpoint_shm(name, is_listener);
+    // The frames of a streamed link are not sized after the MTU
+    lt->mtu = -1;
+    lt->opts = _zn_link_opts_default();
+
+    lt->open_f = _zn_f_link_open_shm;
+    lt->close_f = _zn_f_link_close_shm;
+    lt->release_f = _zn_f_link_release_shm;
+
+    lt->write_f = _zn_f_link_write_shm;
+    lt->write_all_f = _zn_f_link_write_all_shm;
+    lt->writev_f = _zn_f_link_writev_shm;
+    lt->pending_f = _zn_f_link_pending_shm;
+    lt->flush_f = NULL;
+    lt->read_f = _zn_f_link_read_shm;
+    lt->read_exact_f = _zn_f_link_read_exact_shm;
+    lt->buffered_f = NULL;
+    lt->read_from_f = NULL;
+
+    return lt;
+}
+
+#endif
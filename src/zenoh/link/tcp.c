@@ -19,7 +19,17 @@ _zn_socket_result_t _zn_f_link_open_tcp(void *arg, const clock_t tout)
 {
     _zn_link_t *self = (_zn_link_t*)arg;
 
-    _zn_socket_result_t r_sock = _zn_open_tcp(self->endpoint);
+    _zn_socket_result_t r_sock = _zn_open_tcp(self->endpoint, &self->opts);
+#if defined(ZENOH_LINUX) && defined(ZENOH_IO_URING)
+    // A reopened link gets new queues for its new socket
+    if (self->uring != NULL)
+        _zn_uring_free(self->uring);
+    self->uring = NULL;
+    if (r_sock.tag == _z_res_t_OK)
+        self->uring = _zn_uring_open(r_sock.value.socket, 1, NULL);
+    // The received bytes are taken by io_uring before the socket is reported as readable
+    self->is_pollable = self->uring == NULL;
+#endif
     return r_sock;
 }
 
@@ -34,6 +44,10 @@ void _zn_f_link_release_tcp(void *arg)
 {
     _zn_link_t *self = (_zn_link_t*)arg;
 
+#if defined(ZENOH_LINUX) && defined(ZENOH_IO_URING)
+    if (self->uring != NULL)
+        _zn_uring_free(self->uring);
+#endif
     _zn_release_endpoint_tcp(self->endpoint);
 }
 
@@ -41,6 +55,10 @@ size_t _zn_f_link_write_tcp(void *arg, const uint8_t *ptr, size_t len)
 {
     _zn_link_t *self = (_zn_link_t*)arg;
 
+#if defined(ZENOH_LINUX) && defined(ZENOH_IO_URING)
+    if (self->uring != NULL)
+        return _zn_uring_send(self->uring, ptr, len);
+#endif
     return _zn_send_tcp(self->sock, ptr, len);
 }
 
@@ -48,21 +66,65 @@ size_t _zn_f_link_write_all_tcp(void *arg, const uint8_t *ptr, size_t len)
 {
     _zn_link_t *self = (_zn_link_t*)arg;
 
+#if defined(ZENOH_LINUX) && defined(ZENOH_IO_URING)
+    if (self->uring != NULL)
+        return _zn_uring_send(self->uring, ptr, len);
+#endif
     return _zn_send_tcp(self->sock, ptr, len);
 }
 
+#if defined(ZENOH_LINUX) || defined(ZENOH_MACOS)
+size_t _zn_f_link_writev_tcp(void *arg, const z_bytes_t *bufs, size_t cnt)
+{
+    _zn_link_t *self = (_zn_link_t*)arg;
+
+#if defined(ZENOH_LINUX) && defined(ZENOH_IO_URING)
+    if (self->uring != NULL)
+        return _zn_uring_sendv(self->uring, bufs, cnt);
+#endif
+    return _zn_sendv_tcp(self->sock, bufs, cnt);
+}
+
+size_t _zn_f_link_pending_tcp(void *arg)
+{
+    _zn_link_t *self = (_zn_link_t*)arg;
+
+    return _zn_pending_tcp(self->sock);
+}
+#endif
+
 size_t _zn_f_link_read_tcp(void *arg, uint8_t *ptr, size_t len)
 {
     _zn_link_t *self = (_zn_link_t*)arg;
 
-    return _zn_read_tcp(self->sock, ptr, len);
+    int rb;
+#if defined(ZENOH_LINUX) && defined(ZENOH_IO_URING)
+    if (self->uring != NULL)
+        rb = _zn_uring_read(self->uring, ptr, len);
+    else
+#endif
+        rb = _zn_read_tcp(self->sock, ptr, len);
+
+    if (rb > 0 && self->opts.tcp_quickack > 0)
+        _zn_rearm_quickack_tcp(self->sock);
+    return rb;
 }
 
 size_t _zn_f_link_read_exact_tcp(void *arg, uint8_t *ptr, size_t len)
 {
     _zn_link_t *self = (_zn_link_t*)arg;
 
-    return _zn_read_exact_tcp(self->sock, ptr, len);
+    int rb;
+#if defined(ZENOH_LINUX) && defined(ZENOH_IO_URING)
+    if (self->uring != NULL)
+        rb = _zn_uring_read_exact(self->uring, ptr, len);
+    else
+#endif
+        rb = _zn_read_exact_tcp(self->sock, ptr, len);
+
+    if (rb > 0 && self->opts.tcp_quickack > 0)
+        _zn_rearm_quickack_tcp(self->sock);
+    return rb;
 }
 
 size_t _zn_get_link_mtu_tcp()
@@ -76,9 +138,15 @@ _zn_link_t *_zn_new_link_tcp(const char *s_addr, const char *port)
     _zn_link_t *lt = (_zn_link_t *)malloc(sizeof(_zn_link_t));
     lt->is_reliable = 1;
     lt->is_streamed = 1;
+    lt->is_pollable = 1;
+    lt->is_corked = 0;
+    lt->is_multicast = 0;
 
     lt->endpoint = _zn_create_endpoint_tcp(s_addr, port);
     lt->mtu = _zn_get_link_mtu_tcp();
+#if defined(ZENOH_LINUX) && defined(ZENOH_IO_URING)
+    lt->uring = NULL;
+#endif
 
     lt->open_f = _zn_f_link_open_tcp;
     lt->close_f = _zn_f_link_close_tcp;
@@ -86,8 +154,18 @@ _zn_link_t *_zn_new_link_tcp(const char *s_addr, const char *port)
 
     lt->write_f = _zn_f_link_write_tcp;
     lt->write_all_f = _zn_f_link_write_all_tcp;
+#if defined(ZENOH_LINUX) || defined(ZENOH_MACOS)
+    lt->writev_f = _zn_f_link_writev_tcp;
+    lt->pending_f = _zn_f_link_pending_tcp;
+#else
+    lt->writev_f = NULL;
+    lt->pending_f = NULL;
+#endif
+    lt->flush_f = NULL;
     lt->read_f = _zn_f_link_read_tcp;
     lt->read_exact_f = _zn_f_link_read_exact_tcp;
+    lt->buffered_f = NULL;
+    lt->read_from_f = NULL;
 
     return lt;
 }
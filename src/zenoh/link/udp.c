@@ -15,11 +15,57 @@
 #include "zenoh-pico/system/common.h"
 #include "zenoh-pico/link/private/manager.h"
 
+#if defined(ZENOH_LINUX)
+int _zn_f_link_flush_udp(void *arg)
+{
+    _zn_link_t *self = (_zn_link_t*)arg;
+
+    if (self->mmsg == NULL)
+        return 0;
+    return _zn_mmsg_flush(self->mmsg);
+}
+
+size_t _zn_f_link_buffered_udp(void *arg)
+{
+    _zn_link_t *self = (_zn_link_t*)arg;
+
+    if (self->mmsg == NULL)
+        return 0;
+    return _zn_mmsg_buffered(self->mmsg);
+}
+#endif
+
 _zn_socket_result_t _zn_f_link_open_udp(void *arg, const clock_t tout)
 {
     _zn_link_t *self = (_zn_link_t*)arg;
 
-    _zn_socket_result_t r_sock = _zn_open_udp(self->endpoint, tout);
+    _zn_socket_result_t r_sock = _zn_open_udp(self->endpoint, tout, &self->opts);
+#if defined(ZENOH_LINUX) && defined(ZENOH_IO_URING)
+    // A reopened link gets new queues for its new socket
+    if (self->uring != NULL)
+        _zn_uring_free(self->uring);
+    self->uring = NULL;
+    if (r_sock.tag == _z_res_t_OK)
+        self->uring = _zn_uring_open(r_sock.value.socket, 0, self->endpoint);
+    // The received bytes are taken by io_uring before the socket is reported as readable
+    self->is_pollable = self->uring == NULL;
+#endif
+#if defined(ZENOH_LINUX)
+    if (self->mmsg != NULL)
+        _zn_mmsg_free(self->mmsg);
+    self->mmsg = NULL;
+#if defined(ZENOH_IO_URING)
+    // io_uring already batches the socket calls
+    if (r_sock.tag == _z_res_t_OK && self->uring == NULL)
+#else
+    if (r_sock.tag == _z_res_t_OK)
+#endif
+        self->mmsg = _zn_mmsg_open(r_sock.value.socket, self->endpoint);
+
+    // The datagrams are only queued while corked, and read ahead, if they are batched
+    self->flush_f = self->mmsg != NULL ? _zn_f_link_flush_udp : NULL;
+    self->buffered_f = self->mmsg != NULL ? _zn_f_link_buffered_udp : NULL;
+#endif
     return r_sock;
 }
 
@@ -27,6 +73,10 @@ int _zn_f_link_close_udp(void *arg)
 {
     _zn_link_t *self = (_zn_link_t*)arg;
 
+#if defined(ZENOH_LINUX) && defined(ZENOH_IO_URING)
+    if (self->uring != NULL)
+        _zn_uring_cancel(self->uring);
+#endif
     return _zn_close_udp(self->sock);
 }
 
@@ -34,6 +84,14 @@ void _zn_f_link_release_udp(void *arg)
 {
     _zn_link_t *self = (_zn_link_t*)arg;
 
+#if defined(ZENOH_LINUX) && defined(ZENOH_IO_URING)
+    if (self->uring != NULL)
+        _zn_uring_free(self->uring);
+#endif
+#if defined(ZENOH_LINUX)
+    if (self->mmsg != NULL)
+        _zn_mmsg_free(self->mmsg);
+#endif
     _zn_release_endpoint_udp(self->endpoint);
 }
 
@@ -41,6 +99,19 @@ size_t _zn_f_link_write_udp(void *arg, const uint8_t *ptr, size_t len)
 {
     _zn_link_t *self = (_zn_link_t*)arg;
 
+#if defined(ZENOH_LINUX) && defined(ZENOH_IO_URING)
+    if (self->uring != NULL)
+        return _zn_uring_send(self->uring, ptr, len);
+#endif
+#if defined(ZENOH_LINUX)
+    if (self->mmsg != NULL && self->is_corked)
+    {
+        z_bytes_t bs;
+        bs.val = ptr;
+        bs.len = len;
+        return _zn_mmsg_sendv(self->mmsg, &bs, 1);
+    }
+#endif
     return _zn_send_udp(self->sock, ptr, len, self->endpoint);
 }
 
@@ -48,13 +119,58 @@ size_t _zn_f_link_write_all_udp(void *arg, const uint8_t *ptr, size_t len)
 {
     _zn_link_t *self = (_zn_link_t*)arg;
 
+#if defined(ZENOH_LINUX) && defined(ZENOH_IO_URING)
+    if (self->uring != NULL)
+        return _zn_uring_send(self->uring, ptr, len);
+#endif
+#if defined(ZENOH_LINUX)
+    if (self->mmsg != NULL && self->is_corked)
+    {
+        z_bytes_t bs;
+        bs.val = ptr;
+        bs.len = len;
+        return _zn_mmsg_sendv(self->mmsg, &bs, 1);
+    }
+#endif
     return _zn_send_udp(self->sock, ptr, len, self->endpoint);
 }
 
+#if defined(ZENOH_LINUX) || defined(ZENOH_MACOS)
+size_t _zn_f_link_writev_udp(void *arg, const z_bytes_t *bufs, size_t cnt)
+{
+    _zn_link_t *self = (_zn_link_t*)arg;
+
+#if defined(ZENOH_LINUX) && defined(ZENOH_IO_URING)
+    if (self->uring != NULL)
+        return _zn_uring_sendv(self->uring, bufs, cnt);
+#endif
+#if defined(ZENOH_LINUX)
+    if (self->mmsg != NULL && self->is_corked)
+        return _zn_mmsg_sendv(self->mmsg, bufs, cnt);
+#endif
+    return _zn_sendv_udp(self->sock, bufs, cnt, self->endpoint);
+}
+
+size_t _zn_f_link_pending_udp(void *arg)
+{
+    _zn_link_t *self = (_zn_link_t*)arg;
+
+    return _zn_pending_udp(self->sock);
+}
+#endif
+
 size_t _zn_f_link_read_udp(void *arg, uint8_t *ptr, size_t len)
 {
     _zn_link_t *self = (_zn_link_t*)arg;
 
+#if defined(ZENOH_LINUX) && defined(ZENOH_IO_URING)
+    if (self->uring != NULL)
+        return _zn_uring_read(self->uring, ptr, len);
+#endif
+#if defined(ZENOH_LINUX)
+    if (self->mmsg != NULL)
+        return _zn_mmsg_read(self->mmsg, ptr, len);
+#endif
     return _zn_read_udp(self->sock, ptr, len);
 }
 
@@ -62,13 +178,23 @@ size_t _zn_f_link_read_exact_udp(void *arg, uint8_t *ptr, size_t len)
 {
     _zn_link_t *self = (_zn_link_t*)arg;
 
+#if defined(ZENOH_LINUX) && defined(ZENOH_IO_URING)
+    if (self->uring != NULL)
+        return _zn_uring_read_exact(self->uring, ptr, len);
+#endif
+#if defined(ZENOH_LINUX)
+    if (self->mmsg != NULL)
+        return _zn_mmsg_read_exact(self->mmsg, ptr, len);
+#endif
     return _zn_read_exact_udp(self->sock, ptr, len);
 }
 
-size_t _zn_get_link_mtu_udp()
+size_t _zn_get_link_mtu_udp(void *endpoint)
 {
-    // TODO
-    return -1;
+    // The largest datagram payload not fragmented by IP on the route towards the endpoint
+    if (endpoint == NULL)
+        return -1;
+    return _zn_get_mtu_udp(endpoint);
 }
 
 _zn_link_t *_zn_new_link_udp(const char *s_addr, const char *port)
@@ -76,9 +202,18 @@ _zn_link_t *_zn_new_link_udp(const char *s_addr, const char *port)
     _zn_link_t *lt = (_zn_link_t *)malloc(sizeof(_zn_link_t));
     lt->is_reliable = 0;
     lt->is_streamed = 0;
+    lt->is_pollable = 1;
+    lt->is_corked = 0;
+    lt->is_multicast = 0;
 
     lt->endpoint = _zn_create_endpoint_udp(s_addr, port);
-    lt->mtu = _zn_get_link_mtu_udp();
+    lt->mtu = _zn_get_link_mtu_udp(lt->endpoint);
+#if defined(ZENOH_LINUX) && defined(ZENOH_IO_URING)
+    lt->uring = NULL;
+#endif
+#if defined(ZENOH_LINUX)
+    lt->mmsg = NULL;
+#endif
 
     lt->open_f = _zn_f_link_open_udp;
     lt->close_f = _zn_f_link_close_udp;
@@ -86,8 +221,127 @@ _zn_link_t *_zn_new_link_udp(const char *s_addr, const char *port)
 
     lt->write_f = _zn_f_link_write_udp;
     lt->write_all_f = _zn_f_link_write_all_udp;
+#if defined(ZENOH_LINUX) || defined(ZENOH_MACOS)
+    lt->writev_f = _zn_f_link_writev_udp;
+    lt->pending_f = _zn_f_link_pending_udp;
+#else
+    lt->writev_f = NULL;
+    lt->pending_f = NULL;
+#endif
+    // Set once the link is open, if its datagrams are batched
+    lt->flush_f = NULL;
     lt->read_f = _zn_f_link_read_udp;
     lt->read_exact_f = _zn_f_link_read_exact_udp;
+    lt->buffered_f = NULL;
+    lt->read_from_f = NULL;
+
+    return lt;
+}
+
+#if defined(ZENOH_LINUX) || defined(ZENOH_MACOS)
+/*------------------ UDP multicast ------------------*/
+_zn_socket_result_t _zn_f_link_open_udp_multicast(void *arg, const clock_t tout)
+{
+    _zn_link_t *self = (_zn_link_t*)arg;
+
+    (void)(tout);
+    return _zn_open_udp_multicast(self->endpoint, &self->opts);
+}
+
+int _zn_f_link_close_udp_multicast(void *arg)
+{
+    _zn_link_t *self = (_zn_link_t*)arg;
+
+    return _zn_close_udp_multicast(self->sock, self->endpoint);
+}
+
+void _zn_f_link_release_udp_multicast(void *arg)
+{
+    _zn_link_t *self = (_zn_link_t*)arg;
+
+    _zn_release_endpoint_udp_multicast(self->endpoint);
+}
+
+size_t _zn_f_link_write_udp_multicast(void *arg, const uint8_t *ptr, size_t len)
+{
+    _zn_link_t *self = (_zn_link_t*)arg;
+
+    return _zn_send_udp_multicast(self->endpoint, ptr, len);
+}
+
+size_t _zn_f_link_writev_udp_multicast(void *arg, const z_bytes_t *bufs, size_t cnt)
+{
+    _zn_link_t *self = (_zn_link_t*)arg;
+
+    return _zn_sendv_udp_multicast(self->endpoint, bufs, cnt);
+}
+
+size_t _zn_f_link_pending_udp_multicast(void *arg)
+{
+    _zn_link_t *self = (_zn_link_t*)arg;
+
+    return _zn_pending_udp_multicast(self->endpoint);
+}
+
+size_t _zn_f_link_read_udp_multicast(void *arg, uint8_t *ptr, size_t len)
+{
+    _zn_link_t *self = (_zn_link_t*)arg;
+
+    return _zn_read_udp_multicast(self->sock, ptr, len, self->endpoint, NULL);
+}
+
+size_t _zn_f_link_read_exact_udp_multicast(void *arg, uint8_t *ptr, size_t len)
+{
+    _zn_link_t *self = (_zn_link_t*)arg;
+
+    return _zn_read_exact_udp_multicast(self->sock, ptr, len, self->endpoint);
+}
+
+size_t _zn_f_link_read_from_udp_multicast(void *arg, uint8_t *ptr, size_t len, z_bytes_t *addr)
+{
+    _zn_link_t *self = (_zn_link_t*)arg;
+
+    return _zn_read_udp_multicast(self->sock, ptr, len, self->endpoint, addr);
+}
+
+_zn_link_t *_zn_new_link_udp_multicast(const char *s_addr, const char *port, const char *iface)
+{
+    void *endpoint = _zn_create_endpoint_udp_multicast(s_addr, port, iface);
+    if (endpoint == NULL)
+        return NULL;
+
+    _zn_link_t *lt = (_zn_link_t *)malloc(sizeof(_zn_link_t));
+    lt->is_reliable = 0;
+    lt->is_streamed = 0;
+    lt->is_pollable = 1;
+    lt->is_corked = 0;
+    lt->is_multicast = 1;
+
+    // The socket is only valid once the group has been joined
+    lt->sock = -1;
+    lt->endpoint = endpoint;
+    lt->mtu = _zn_get_mtu_udp_multicast(lt->endpoint);
+#if defined(ZENOH_LINUX) && defined(ZENOH_IO_URING)
+    lt->uring = NULL;
+#endif
+#if defined(ZENOH_LINUX)
+    lt->mmsg = NULL;
+#endif
+
+    lt->open_f = _zn_f_link_open_udp_multicast;
+    lt->close_f = _zn_f_link_close_udp_multicast;
+    lt->release_f = _zn_f_link_release_udp_multicast;
+
+    lt->write_f = _zn_f_link_write_udp_multicast;
+    lt->write_all_f = _zn_f_link_write_udp_multicast;
+    lt->writev_f = _zn_f_link_writev_udp_multicast;
+    lt->pending_f = _zn_f_link_pending_udp_multicast;
+    lt->flush_f = NULL;
+    lt->read_f = _zn_f_link_read_udp_multicast;
+    lt->read_exact_f = _zn_f_link_read_exact_udp_multicast;
+    lt->buffered_f = NULL;
+    lt->read_from_f = _zn_f_link_read_from_udp_multicast;
 
     return lt;
 }
+#endif
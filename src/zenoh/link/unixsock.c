@@ -0,0 +1,122 @@
+/*
+ * Copyright (c) 2017, 2021 ADLINK Technology Inc.
+ *
+ * This program and the accompanying materials are made available under the
+ * terms of the Eclipse Public License 2.0 which is available at
+ * http://www.eclipse.org/legal/epl-2.0, or the Apache License, Version 2.0
+ * which is available at https://www.apache.org/licenses/LICENSE-2.0.
+ *
+ * SPDX-License-Identifier: EPL-2.0 OR Apache-2.0
+ *
+ * Contributors:
+ *   ADLINK zenoh team, <zenoh@adlink-labs.tech>
+ */
+
+#if defined(ZENOH_LINUX) || defined(ZENOH_MACOS)
+
+#include <stdlib.h>
+#include "zenoh-pico/system/common.h"
+#include "zenoh-pico/link/private/manager.h"
+
+_zn_socket_result_t _zn_f_link_open_unix(void *arg, const clock_t tout)
+{
+    (void)tout;
+    _zn_link_t *self = (_zn_link_t*)arg;
+
+    _zn_socket_result_t r_sock = _zn_open_unix(self->endpoint, &self->opts);
+    return r_sock;
+}
+
+int _zn_f_link_close_unix(void *arg)
+{
+    _zn_link_t *self = (_zn_link_t*)arg;
+
+    return _zn_close_unix(self->sock);
+}
+
+void _zn_f_link_release_unix(void *arg)
+{
+    _zn_link_t *self = (_zn_link_t*)arg;
+
+    _zn_release_endpoint_unix(self->endpoint);
+}
+
+size_t _zn_f_link_write_unix(void *arg, const uint8_t *ptr, size_t len)
+{
+    _zn_link_t *self = (_zn_link_t*)arg;
+
+    return _zn_send_unix(self->sock, ptr, len);
+}
+
+size_t _zn_f_link_write_all_unix(void *arg, const uint8_t *ptr, size_t len)
+{
+    _zn_link_t *self = (_zn_link_t*)arg;
+
+    return _zn_send_unix(self->sock, ptr, len);
+}
+
+size_t _zn_f_link_writev_unix(void *arg, const z_bytes_t *bufs, size_t cnt)
+{
+    _zn_link_t *self = (_zn_link_t*)arg;
+
+    return _zn_sendv_unix(self->sock, bufs, cnt);
+}
+
+size_t _zn_f_link_pending_unix(void *arg)
+{
+    _zn_link_t *self = (_zn_link_t*)arg;
+
+    return _zn_pending_unix(self->sock);
+}
+
+size_t _zn_f_link_read_unix(void *arg, uint8_t *ptr, size_t len)
+{
+    _zn_link_t *self = (_zn_link_t*)arg;
+
+    return _zn_read_unix(self->sock, ptr, len);
+}
+
+size_t _zn_f_link_read_exact_unix(void *arg, uint8_t *ptr, size_t len)
+{
+    _zn_link_t *self = (_zn_link_t*)arg;
+
+    return _zn_read_exact_unix(self->sock, ptr, len);
+}
+
+_zn_link_t *_zn_new_link_unix(const char *path)
+{
+    void *endpoint = _zn_create_endpoint_unix(path);
+    if (endpoint == NULL)
+        return NULL;
+
+    _zn_link_t *lt = (_zn_link_t *)malloc(sizeof(_zn_link_t));
+    // The socket is closed, not only shut down, so it must be valid even if the link fails to open
+    lt->sock = -1;
+    lt->is_reliable = 1;
+    lt->is_streamed = 1;
+    lt->is_pollable = 1;
+    lt->is_corked = 0;
+    lt->is_multicast = 0;
+
+    lt->endpoint = endpoint;
+    // The frames of a streamed link are not sized after the MTU
+    lt->mtu = -1;
+
+    lt->open_f = _zn_f_link_open_unix;
+    lt->close_f = _zn_f_link_close_unix;
+    lt->release_f = _zn_f_link_release_unix;
+
+    lt->write_f = _zn_f_link_write_unix;
+    lt->write_all_f = _zn_f_link_write_all_unix;
+    lt->writev_f = _zn_f_link_writev_unix;
+    lt->pending_f = _zn_f_link_pending_unix;
+    lt->flush_f = NULL;
+    lt->read_f = _zn_f_link_read_unix;
+    lt->read_exact_f = _zn_f_link_read_exact_unix;
+    lt->buffered_f = NULL;
+    lt->read_from_f = NULL;
+
+    return lt;
+}
+
+#endif
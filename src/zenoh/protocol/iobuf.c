@@ -15,6 +15,7 @@
 #include <assert.h>
 #include <stdlib.h>
 #include "zenoh-pico/protocol/private/iobuf.h"
+#include "zenoh-pico/system/common.h"
 
 /*------------------ IOSli ------------------*/
 _z_iosli_t _z_iosli_wrap(uint8_t *buf, size_t capacity, size_t r_pos, size_t w_pos)
@@ -105,29 +106,135 @@ void _z_iosli_free(_z_iosli_t *ios)
     ios = NULL;
 }
 
+/*------------------ Arena ------------------*/
+// The allocations are aligned as the ones of malloc on the usual platforms
+#define _Z_ARENA_ALIGN (2 * sizeof(void *))
+
+_z_arena_t _z_arena_make(size_t capacity)
+{
+    _z_arena_t a;
+    a.buf = capacity > 0 ? (uint8_t *)malloc(capacity) : NULL;
+    a.capacity = a.buf != NULL ? capacity : 0;
+    a.len = 0;
+    a.overflow = z_list_empty;
+    a.overflow_len = 0;
+    return a;
+}
+
+void *_z_arena_alloc(_z_arena_t *a, size_t size)
+{
+    size = (size + _Z_ARENA_ALIGN - 1) & ~(_Z_ARENA_ALIGN - 1);
+    if (size <= a->capacity - a->len)
+    {
+        void *ptr = a->buf + a->len;
+        a->len += size;
+        return ptr;
+    }
+
+    // The memory is exhausted, the block is kept apart until the next reset
+    void *ptr = malloc(size);
+    a->overflow = z_list_cons(a->overflow, ptr);
+    a->overflow_len += size;
+    return ptr;
+}
+
+size_t _z_arena_mark(const _z_arena_t *a)
+{
+    return a->len;
+}
+
+void _z_arena_rewind(_z_arena_t *a, size_t mark)
+{
+    // Release the memory allocated since the mark, the blocks apart are released at the next reset
+    if (mark < a->len)
+        a->len = mark;
+}
+
+void _z_arena_reset(_z_arena_t *a)
+{
+    // Grow the memory so that the same allocations fit in it the next time
+    if (a->overflow != z_list_empty)
+    {
+        z_list_free_deep(a->overflow);
+        a->overflow = z_list_empty;
+
+        free(a->buf);
+        a->capacity += a->overflow_len;
+        a->buf = (uint8_t *)malloc(a->capacity);
+        a->overflow_len = 0;
+    }
+    a->len = 0;
+}
+
+void _z_arena_free(_z_arena_t *a)
+{
+    z_list_free_deep(a->overflow);
+    a->overflow = z_list_empty;
+    a->overflow_len = 0;
+
+    free(a->buf);
+    a->buf = NULL;
+    a->capacity = 0;
+    a->len = 0;
+}
+
 /*------------------ ZBuf ------------------*/
 _z_zbuf_t _z_zbuf_make(size_t capacity)
 {
     _z_zbuf_t zbf;
     zbf.ios = _z_iosli_make(capacity);
+    zbf.arena = NULL;
+    zbf.ring = 0;
     return zbf;
 }
 
+_z_zbuf_t _z_zbuf_make_ring(size_t capacity)
+{
+#if defined(ZENOH_LINUX) || defined(ZENOH_MACOS)
+    // The readable bytes are always contiguous, in the first mapping or across the two,
+    // so that the compaction only has to move the positions back by the ring capacity
+    uint8_t *buf = _zn_ring_map(&capacity);
+    if (buf != NULL)
+    {
+        _z_zbuf_t zbf;
+        zbf.ios = _z_iosli_wrap(buf, 2 * capacity, 0, 0);
+        zbf.arena = NULL;
+        zbf.ring = capacity;
+        return zbf;
+    }
+#endif
+    return _z_zbuf_make(capacity);
+}
+
 _z_zbuf_t _z_zbuf_view(_z_zbuf_t *zbf, size_t length)
 {
     assert(_z_iosli_readable(&zbf->ios) >= length);
-    _z_zbuf_t v;
-    v.ios = _z_iosli_wrap(_z_zbuf_get_rptr(zbf), length, 0, length);
+    _z_zbuf_t v = _z_zbuf_wrap(_z_zbuf_get_rptr(zbf), length);
+    v.arena = zbf->arena;
     return v;
 }
 
+_z_zbuf_t _z_zbuf_wrap(uint8_t *buf, size_t length)
+{
+    // All the bytes are readable, the buffer is not owned
+    _z_zbuf_t zbf;
+    zbf.ios = _z_iosli_wrap(buf, length, 0, length);
+    zbf.arena = NULL;
+    zbf.ring = 0;
+    return zbf;
+}
+
 size_t _z_zbuf_capacity(const _z_zbuf_t *zbf)
 {
+    if (zbf->ring > 0)
+        return zbf->ring;
     return zbf->ios.capacity;
 }
 
 size_t _z_zbuf_space_left(const _z_zbuf_t *zbf)
 {
+    if (zbf->ring > 0)
+        return zbf->ring - _z_iosli_readable(&zbf->ios);
     return _z_iosli_writable(&zbf->ios);
 }
 
@@ -188,6 +295,47 @@ uint8_t *_z_zbuf_get_wptr(const _z_zbuf_t *zbf)
     return zbf->ios.buf + zbf->ios.w_pos;
 }
 
+void *_z_zbuf_alloc(_z_zbuf_t *zbf, size_t size)
+{
+    if (zbf->arena != NULL)
+        return _z_arena_alloc(zbf->arena, size);
+    return malloc(size);
+}
+
+void _z_zbuf_dealloc(_z_zbuf_t *zbf, void *ptr)
+{
+    // The allocations in an arena are released when the arena is reset
+    if (zbf->arena == NULL)
+        free(ptr);
+}
+
+int _z_zbuf_append(_z_zbuf_t *zbf, const uint8_t *bs, size_t len, size_t limit)
+{
+    assert(zbf->ios.is_alloc && zbf->ring == 0);
+    size_t w_pos = zbf->ios.w_pos + len;
+    if (w_pos > limit)
+        return -1;
+
+    if (w_pos > zbf->ios.capacity)
+    {
+        // Grow geometrically, so that a large message is appended in amortized constant time
+        size_t capacity = 2 * zbf->ios.capacity;
+        if (capacity < w_pos)
+            capacity = w_pos;
+        if (capacity > limit)
+            capacity = limit;
+
+        uint8_t *buf = (uint8_t *)realloc(zbf->ios.buf, capacity);
+        if (buf == NULL)
+            return -1;
+        zbf->ios.buf = buf;
+        zbf->ios.capacity = capacity;
+    }
+
+    _z_iosli_write_bytes(&zbf->ios, bs, 0, len);
+    return 0;
+}
+
 void _z_zbuf_clear(_z_zbuf_t *zbf)
 {
     _z_iosli_clear(&zbf->ios);
@@ -198,6 +346,17 @@ void _z_zbuf_compact(_z_zbuf_t *zbf)
     if (zbf->ios.r_pos == 0 && zbf->ios.w_pos == 0)
         return;
 
+    // The bytes past the end of a ring are also at its beginning, nothing is moved
+    if (zbf->ring > 0)
+    {
+        if (zbf->ios.r_pos >= zbf->ring)
+        {
+            zbf->ios.r_pos -= zbf->ring;
+            zbf->ios.w_pos -= zbf->ring;
+        }
+        return;
+    }
+
     size_t len = _z_iosli_readable(&zbf->ios);
     memcpy(zbf->ios.buf, _z_zbuf_get_rptr(zbf), len * sizeof(uint8_t));
     _z_zbuf_set_rpos(zbf, 0);
@@ -206,6 +365,10 @@ void _z_zbuf_compact(_z_zbuf_t *zbf)
 
 void _z_zbuf_free(_z_zbuf_t *zbf)
 {
+#if defined(ZENOH_LINUX) || defined(ZENOH_MACOS)
+    if (zbf->ring > 0)
+        _zn_ring_unmap(zbf->ios.buf, zbf->ring);
+#endif
     _z_iosli_free(&zbf->ios);
     zbf = NULL;
 }
@@ -236,6 +399,16 @@ void _z_wbuf_add_iosli_from(_z_wbuf_t *wbf, const uint8_t *buf, size_t capacity)
     _z_wbuf_add_iosli(wbf, pios);
 }
 
+void _z_wbuf_add_iosli_wrap(_z_wbuf_t *wbf, uint8_t *buf, size_t len)
+{
+    // The slice only references the buffer, the bytes are neither copied nor freed
+    _z_iosli_t sios = _z_iosli_wrap(buf, len, 0, len);
+    _z_iosli_t *pios = (_z_iosli_t *)malloc(sizeof(_z_iosli_t));
+    memcpy(pios, &sios, sizeof(_z_iosli_t));
+
+    _z_wbuf_add_iosli(wbf, pios);
+}
+
 void _z_wbuf_new_iosli(_z_wbuf_t *wbf, size_t capacity)
 {
     _z_iosli_t sios = _z_iosli_make(capacity);
@@ -517,11 +690,25 @@ _z_zbuf_t _z_wbuf_to_zbuf(const _z_wbuf_t *wbf)
 
 int _z_wbuf_copy_into(_z_wbuf_t *dst, _z_wbuf_t *src, size_t length)
 {
-    for (size_t i = 0; i < length; i++)
+    while (length > 0)
     {
-        int res = _z_wbuf_write(dst, __z_wbuf_read(src));
-        if (res != 0)
-            return -1;
+        assert(src->r_idx <= src->w_idx);
+        _z_iosli_t *ios = _z_wbuf_get_iosli(src, src->r_idx);
+        size_t readable = _z_iosli_readable(ios);
+        if (readable > 0)
+        {
+            // Copy a whole slice at once
+            size_t to_copy = readable <= length ? readable : length;
+            int res = _z_wbuf_write_bytes(dst, ios->buf, ios->r_pos, to_copy);
+            if (res != 0)
+                return -1;
+            ios->r_pos += to_copy;
+            length -= to_copy;
+        }
+        else
+        {
+            src->r_idx++;
+        }
     }
     return 0;
 }
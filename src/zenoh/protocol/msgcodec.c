@@ -16,6 +16,16 @@
 #include "zenoh-pico/protocol/private/msgcodec.h"
 #include "zenoh-pico/utils/private/logging.h"
 
+// The decoded values are allocated by the buffer they are decoded from, see _z_zbuf_alloc
+#define _ZN_ASSURE_DEALLOC_P_RESULT(zbf, in_r, out_r, e, name) \
+    if (in_r.tag == _z_res_t_ERR)                               \
+    {                                                           \
+        _z_zbuf_dealloc(zbf, out_r->value.name);                \
+        out_r->tag = _z_res_t_ERR;                              \
+        out_r->value.error = e;                                 \
+        return;                                                 \
+    }
+
 /*=============================*/
 /*           Fields            */
 /*=============================*/
@@ -126,7 +136,7 @@ void _zn_subinfo_decode_na(_z_zbuf_t *zbf, uint8_t header, _zn_subinfo_result_t
     {
         _zn_period_result_t r_tp = _zn_period_decode(zbf);
         _ASSURE_P_RESULT(r_tp, r, _zn_err_t_PARSE_PERIOD)
-        zn_period_t *p_per = (zn_period_t *)malloc(sizeof(zn_period_t));
+        zn_period_t *p_per = (zn_period_t *)_z_zbuf_alloc(zbf, sizeof(zn_period_t));
         memcpy(p_per, &r_tp.value.period, sizeof(zn_period_t));
         r->value.subinfo.period = p_per;
     }
@@ -225,7 +235,8 @@ void _zn_locators_decode_na(_z_zbuf_t *zbf, _zn_locators_result_t *r)
     _ASSURE_P_RESULT(r_n, r, _z_err_t_PARSE_ZINT)
     size_t len = (size_t)r_n.value.zint;
 
-    _z_str_array_init(&r->value.locators, len);
+    r->value.locators.val = (const char *const *)_z_zbuf_alloc(zbf, len * sizeof(z_str_t));
+    r->value.locators.len = len;
 
     // Decode the elements
     for (size_t i = 0; i < len; ++i)
@@ -284,14 +295,14 @@ void _zn_attachment_decode_na(_z_zbuf_t *zbf, uint8_t header, _zn_attachment_p_r
     }
 
     _zn_payload_result_t r_pld = _zn_payload_decode(zbf);
-    _ASSURE_FREE_P_RESULT(r_pld, r, _zn_err_t_PARSE_PAYLOAD, attachment)
+    _ZN_ASSURE_DEALLOC_P_RESULT(zbf, r_pld, r, _zn_err_t_PARSE_PAYLOAD, attachment)
     r->value.attachment->payload = r_pld.value.payload;
 }
 
 _zn_attachment_p_result_t _zn_attachment_decode(_z_zbuf_t *zbf, uint8_t header)
 {
     _zn_attachment_p_result_t r;
-    _zn_attachment_p_result_init(&r);
+    r.value.attachment = (_zn_attachment_t *)_z_zbuf_alloc(zbf, sizeof(_zn_attachment_t));
     _zn_attachment_decode_na(zbf, header, &r);
     return r;
 }
@@ -330,17 +341,17 @@ void _zn_reply_context_decode_na(_z_zbuf_t *zbf, uint8_t header, _zn_reply_conte
 
     // Decode the body
     _z_zint_result_t r_zint = _z_zint_decode(zbf);
-    _ASSURE_FREE_P_RESULT(r_zint, r, _z_err_t_PARSE_ZINT, reply_context);
+    _ZN_ASSURE_DEALLOC_P_RESULT(zbf, r_zint, r, _z_err_t_PARSE_ZINT, reply_context)
     r->value.reply_context->qid = r_zint.value.zint;
 
     if (!_ZN_HAS_FLAG(header, _ZN_FLAG_Z_F))
     {
         r_zint = _z_zint_decode(zbf);
-        _ASSURE_FREE_P_RESULT(r_zint, r, _z_err_t_PARSE_ZINT, reply_context)
+        _ZN_ASSURE_DEALLOC_P_RESULT(zbf, r_zint, r, _z_err_t_PARSE_ZINT, reply_context)
         r->value.reply_context->replier_kind = r_zint.value.zint;
 
         _z_bytes_result_t r_arr = _z_bytes_decode(zbf);
-        _ASSURE_FREE_P_RESULT(r_arr, r, _z_err_t_PARSE_BYTES, reply_context)
+        _ZN_ASSURE_DEALLOC_P_RESULT(zbf, r_arr, r, _z_err_t_PARSE_BYTES, reply_context)
         r->value.reply_context->replier_id = r_arr.value.bytes;
     }
 }
@@ -348,7 +359,7 @@ void _zn_reply_context_decode_na(_z_zbuf_t *zbf, uint8_t header, _zn_reply_conte
 _zn_reply_context_p_result_t _zn_reply_context_decode(_z_zbuf_t *zbf, uint8_t header)
 {
     _zn_reply_context_p_result_t r;
-    _zn_reply_context_p_result_init(&r);
+    r.value.reply_context = (_zn_reply_context_t *)_z_zbuf_alloc(zbf, sizeof(_zn_reply_context_t));
     _zn_reply_context_decode_na(zbf, header, &r);
     return r;
 }
@@ -845,30 +856,34 @@ void _zn_declare_decode_na(_z_zbuf_t *zbf, _zn_declare_result_t *r)
     _ASSURE_P_RESULT(r_dlen, r, _z_err_t_PARSE_ZINT)
     size_t len = (size_t)r_dlen.value.zint;
 
-    r->value.declare.declarations.val = (_zn_declaration_t *)malloc(len * sizeof(_zn_declaration_t));
+    r->value.declare.declarations.val = (_zn_declaration_t *)_z_zbuf_alloc(zbf, len * sizeof(_zn_declaration_t));
     r->value.declare.declarations.len = len;
 
-    _zn_declaration_result_t *r_decl = (_zn_declaration_result_t *)malloc(sizeof(_zn_declaration_result_t));
+    _zn_declaration_result_t r_decl;
     for (size_t i = 0; i < len; ++i)
     {
-        _zn_declaration_decode_na(zbf, r_decl);
-        if (r_decl->tag == _z_res_t_OK)
+        _zn_declaration_decode_na(zbf, &r_decl);
+        if (r_decl.tag == _z_res_t_OK)
         {
-            r->value.declare.declarations.val[i] = r_decl->value.declaration;
+            r->value.declare.declarations.val[i] = r_decl.value.declaration;
         }
         else
         {
+            // The declarations decoded in an arena are released with it
+            _zn_declaration_t *declarations = r->value.declare.declarations.val;
             r->tag = _z_res_t_ERR;
             r->value.error = _zn_err_t_PARSE_ZENOH_MESSAGE;
 
-            for (size_t j = 0; j < i; ++j)
-                _zn_declaration_free(&r->value.declare.declarations.val[j]);
-            free(r->value.declare.declarations.val);
+            if (zbf->arena == NULL)
+            {
+                for (size_t j = 0; j < i; ++j)
+                    _zn_declaration_free(&declarations[j]);
+            }
+            _z_zbuf_dealloc(zbf, declarations);
 
             break;
         }
     }
-    free(r_decl);
 }
 
 _zn_declare_result_t _zn_declare_decode(_z_zbuf_t *zbf)
@@ -1038,6 +1053,19 @@ int _zn_data_encode(_z_wbuf_t *wbf, uint8_t header, const _zn_data_t *msg)
     return _zn_payload_encode(wbf, &msg->payload);
 }
 
+int _zn_data_encode_prefix(_z_wbuf_t *wbf, uint8_t header, const _zn_data_t *msg)
+{
+    _Z_DEBUG("Encoding _ZN_MID_DATA prefix\n");
+
+    // Encode the body up to the payload, the payload is left to the caller
+    _ZN_EC(_zn_reskey_encode(wbf, header, &msg->key))
+
+    if (_ZN_HAS_FLAG(header, _ZN_FLAG_Z_I))
+        return _zn_data_info_encode(wbf, &msg->info);
+
+    return 0;
+}
+
 void _zn_data_decode_na(_z_zbuf_t *zbf, uint8_t header, _zn_data_result_t *r)
 {
     _Z_DEBUG("Decoding _ZN_MID_DATA\n");
@@ -1296,6 +1324,9 @@ int _zn_zenoh_message_encode(_z_wbuf_t *wbf, const _zn_zenoh_message_t *msg)
     if (msg->attachment)
         _ZN_EC(_zn_attachment_encode(wbf, msg->attachment))
 
+    if (msg->priority != ZN_PRIORITY_DEFAULT)
+        _ZN_EC(_z_wbuf_write(wbf, _ZN_DECO_PRIORITY(msg->priority)))
+
     if (msg->reply_context)
         _ZN_EC(_zn_reply_context_encode(wbf, msg->reply_context))
 
@@ -1323,12 +1354,44 @@ int _zn_zenoh_message_encode(_z_wbuf_t *wbf, const _zn_zenoh_message_t *msg)
     }
 }
 
+int _zn_zenoh_message_encode_prefix(_z_wbuf_t *wbf, const _zn_zenoh_message_t *msg)
+{
+    // Only data messages carry a payload that can be streamed
+    if (_ZN_MID(msg->header) != _ZN_MID_DATA)
+        return -1;
+
+    // Encode the decorators if present
+    if (msg->attachment)
+        _ZN_EC(_zn_attachment_encode(wbf, msg->attachment))
+
+    if (msg->priority != ZN_PRIORITY_DEFAULT)
+        _ZN_EC(_z_wbuf_write(wbf, _ZN_DECO_PRIORITY(msg->priority)))
+
+    if (msg->reply_context)
+        _ZN_EC(_zn_reply_context_encode(wbf, msg->reply_context))
+
+    // Encode the header
+    _ZN_EC(_z_wbuf_write(wbf, msg->header))
+
+    // Encode the body without the payload
+    return _zn_data_encode_prefix(wbf, msg->header, &msg->body.data);
+}
+
+int _zn_zenoh_message_encode_preencoded(_z_wbuf_t *wbf, const z_bytes_t *prefix, const uint8_t *payload, size_t len)
+{
+    // Append the payload to a prefix encoded by _zn_zenoh_message_encode_prefix
+    _ZN_EC(_z_wbuf_write_bytes(wbf, prefix->val, 0, prefix->len))
+    _ZN_EC(_z_zint_encode(wbf, len))
+    return _z_wbuf_write_bytes(wbf, payload, 0, len);
+}
+
 void _zn_zenoh_message_decode_na(_z_zbuf_t *zbf, _zn_zenoh_message_p_result_t *r)
 {
     r->tag = _z_res_t_OK;
 
     r->value.zenoh_message->attachment = NULL;
     r->value.zenoh_message->reply_context = NULL;
+    r->value.zenoh_message->priority = ZN_PRIORITY_DEFAULT;
     do
     {
         _z_uint8_result_t r_uint8 = _z_uint8_decode(zbf);
@@ -1388,13 +1451,12 @@ void _zn_zenoh_message_decode_na(_z_zbuf_t *zbf, _zn_zenoh_message_p_result_t *r
         }
         case _ZN_MID_PRIORITY:
         {
-            // Ignore the priority decorator for the time being since zenoh-pico does not
-            // perform any routing. Hence, priority information does not need to be propagated.
+            r->value.zenoh_message->priority = _ZN_PRIORITY(r->value.zenoh_message->header);
             continue;
         }
         case _ZN_MID_LINK_STATE_LIST:
         {
-            _zn_zenoh_message_p_result_free(r);
+            _z_zbuf_dealloc(zbf, r->value.zenoh_message);
             r->tag = _z_res_t_ERR;
             r->value.error = _zn_err_t_PARSE_ZENOH_MESSAGE;
             _Z_ERROR("WARNING: Link state not supported in zenoh-pico\n");
@@ -1402,7 +1464,7 @@ void _zn_zenoh_message_decode_na(_z_zbuf_t *zbf, _zn_zenoh_message_p_result_t *r
         }
         default:
         {
-            _zn_zenoh_message_p_result_free(r);
+            _z_zbuf_dealloc(zbf, r->value.zenoh_message);
             r->tag = _z_res_t_ERR;
             r->value.error = _zn_err_t_PARSE_ZENOH_MESSAGE;
             _Z_ERROR("WARNING: Trying to decode zenoh message with unknown ID(%d)\n", mid);
@@ -1415,7 +1477,7 @@ void _zn_zenoh_message_decode_na(_z_zbuf_t *zbf, _zn_zenoh_message_p_result_t *r
 _zn_zenoh_message_p_result_t _zn_zenoh_message_decode(_z_zbuf_t *zbf)
 {
     _zn_zenoh_message_p_result_t r;
-    _zn_zenoh_message_p_result_init(&r);
+    r.value.zenoh_message = (_zn_zenoh_message_t *)_z_zbuf_alloc(zbf, sizeof(_zn_zenoh_message_t));
     _zn_zenoh_message_decode_na(zbf, &r);
     return r;
 }
@@ -2035,7 +2097,7 @@ int _zn_frame_encode(_z_wbuf_t *wbf, uint8_t header, const _zn_frame_t *msg)
     // Encode the body
     _ZN_EC(_z_zint_encode(wbf, msg->sn))
 
-    if (_ZN_HAS_FLAG(header, _ZN_FLAG_T_F))
+    if (_ZN_HAS_FLAG(header, _ZN_FLAG_T_F) || msg->is_lazy)
     {
         // Do not write the fragment as z_bytes_t since the total frame length
         // is eventually prepended to the frame. There is no need to encode the fragment length.
@@ -2051,7 +2113,32 @@ int _zn_frame_encode(_z_wbuf_t *wbf, uint8_t header, const _zn_frame_t *msg)
     }
 }
 
-void _zn_frame_decode_na(_z_zbuf_t *zbf, uint8_t header, _zn_frame_result_t *r)
+z_vec_t __zn_frame_messages_make(_z_zbuf_t *zbf, size_t capacity)
+{
+    z_vec_t v;
+    v._capacity = capacity;
+    v._len = 0;
+    v._val = (void **)_z_zbuf_alloc(zbf, capacity * sizeof(void *));
+    return v;
+}
+
+void __zn_frame_messages_append(_z_zbuf_t *zbf, z_vec_t *v, _zn_zenoh_message_t *msg)
+{
+    // Grow the vector as z_vec_append does, but from the buffer allocator
+    if (v->_len == v->_capacity)
+    {
+        z_vec_t u = __zn_frame_messages_make(zbf, 2 * v->_capacity);
+        memcpy(u._val, v->_val, v->_len * sizeof(void *));
+        u._len = v->_len;
+        _z_zbuf_dealloc(zbf, v->_val);
+        *v = u;
+    }
+
+    v->_val[v->_len] = msg;
+    v->_len++;
+}
+
+void __zn_frame_decode_na(_z_zbuf_t *zbf, uint8_t header, int is_lazy, _zn_frame_result_t *r)
 {
     _Z_DEBUG("Decoding _ZN_MID_FRAME\n");
     r->tag = _z_res_t_OK;
@@ -2060,11 +2147,12 @@ void _zn_frame_decode_na(_z_zbuf_t *zbf, uint8_t header, _zn_frame_result_t *r)
     _z_zint_result_t r_zint = _z_zint_decode(zbf);
     _ASSURE_P_RESULT(r_zint, r, _z_err_t_PARSE_ZINT)
     r->value.frame.sn = r_zint.value.zint;
+    r->value.frame.is_lazy = is_lazy && !_ZN_HAS_FLAG(header, _ZN_FLAG_T_F);
 
     // Decode the payload
-    if (_ZN_HAS_FLAG(header, _ZN_FLAG_T_F))
+    if (_ZN_HAS_FLAG(header, _ZN_FLAG_T_F) || r->value.frame.is_lazy)
     {
-        // Read all the remaining bytes in the buffer as the fragment
+        // Read all the remaining bytes in the buffer as the fragment, or as the encoded messages
         r->value.frame.payload.fragment.len = _z_zbuf_len(zbf);
         r->value.frame.payload.fragment.val = _z_zbuf_get_rptr(zbf);
 
@@ -2073,7 +2161,7 @@ void _zn_frame_decode_na(_z_zbuf_t *zbf, uint8_t header, _zn_frame_result_t *r)
     }
     else
     {
-        r->value.frame.payload.messages = z_vec_make(_ZENOH_PICO_FRAME_MESSAGES_VEC_SIZE);
+        r->value.frame.payload.messages = __zn_frame_messages_make(zbf, _ZENOH_PICO_FRAME_MESSAGES_VEC_SIZE);
         while (_z_zbuf_len(zbf))
         {
             // Mark the reading position of the iobfer
@@ -2081,7 +2169,7 @@ void _zn_frame_decode_na(_z_zbuf_t *zbf, uint8_t header, _zn_frame_result_t *r)
             _zn_zenoh_message_p_result_t r_zm = _zn_zenoh_message_decode(zbf);
             if (r_zm.tag == _z_res_t_OK)
             {
-                z_vec_append(&r->value.frame.payload.messages, r_zm.value.zenoh_message);
+                __zn_frame_messages_append(zbf, &r->value.frame.payload.messages, r_zm.value.zenoh_message);
             }
             else
             {
@@ -2093,6 +2181,11 @@ void _zn_frame_decode_na(_z_zbuf_t *zbf, uint8_t header, _zn_frame_result_t *r)
     }
 }
 
+void _zn_frame_decode_na(_z_zbuf_t *zbf, uint8_t header, _zn_frame_result_t *r)
+{
+    __zn_frame_decode_na(zbf, header, 0, r);
+}
+
 _zn_frame_result_t _zn_frame_decode(_z_zbuf_t *zbf, uint8_t header)
 {
     _zn_frame_result_t r;
@@ -2102,7 +2195,7 @@ _zn_frame_result_t _zn_frame_decode(_z_zbuf_t *zbf, uint8_t header)
 
 void _zn_frame_free(_zn_frame_t *msg, uint8_t header)
 {
-    if (_ZN_HAS_FLAG(header, _ZN_FLAG_T_F))
+    if (_ZN_HAS_FLAG(header, _ZN_FLAG_T_F) || msg->is_lazy)
     {
         _zn_payload_free(&msg->payload.fragment);
     }
@@ -2121,6 +2214,9 @@ int _zn_transport_message_encode(_z_wbuf_t *wbf, const _zn_transport_message_t *
     if (msg->attachment)
         _ZN_EC(_zn_attachment_encode(wbf, msg->attachment))
 
+    if (msg->priority != ZN_PRIORITY_DEFAULT)
+        _ZN_EC(_z_wbuf_write(wbf, _ZN_DECO_PRIORITY(msg->priority)))
+
     // Encode the header
     _ZN_EC(_z_wbuf_write(wbf, msg->header))
 
@@ -2155,11 +2251,12 @@ int _zn_transport_message_encode(_z_wbuf_t *wbf, const _zn_transport_message_t *
     }
 }
 
-void _zn_transport_message_decode_na(_z_zbuf_t *zbf, _zn_transport_message_p_result_t *r)
+void __zn_transport_message_decode_na(_z_zbuf_t *zbf, int is_lazy, _zn_transport_message_p_result_t *r)
 {
     r->tag = _z_res_t_OK;
 
     r->value.transport_message->attachment = NULL;
+    r->value.transport_message->priority = ZN_PRIORITY_DEFAULT;
     do
     {
         // Decode the header
@@ -2173,7 +2270,8 @@ void _zn_transport_message_decode_na(_z_zbuf_t *zbf, _zn_transport_message_p_res
         {
         case _ZN_MID_FRAME:
         {
-            _zn_frame_result_t r_fr = _zn_frame_decode(zbf, r->value.transport_message->header);
+            _zn_frame_result_t r_fr;
+            __zn_frame_decode_na(zbf, r->value.transport_message->header, is_lazy, &r_fr);
             _ASSURE_P_RESULT(r_fr, r, _zn_err_t_PARSE_TRANSPORT_MESSAGE)
             r->value.transport_message->body.frame = r_fr.value.frame;
             return;
@@ -2257,10 +2355,8 @@ void _zn_transport_message_decode_na(_z_zbuf_t *zbf, _zn_transport_message_p_res
         }
         case _ZN_MID_PRIORITY:
         {
-            r->tag = _z_res_t_ERR;
-            r->value.error = _zn_err_t_PARSE_TRANSPORT_MESSAGE;
-            _Z_ERROR("WARNING: Priorities are not supported in zenoh-pico\n");
-            return;
+            r->value.transport_message->priority = _ZN_PRIORITY(r->value.transport_message->header);
+            break;
         }
         default:
         {
@@ -2273,14 +2369,28 @@ void _zn_transport_message_decode_na(_z_zbuf_t *zbf, _zn_transport_message_p_res
     } while (1);
 }
 
+void _zn_transport_message_decode_na(_z_zbuf_t *zbf, _zn_transport_message_p_result_t *r)
+{
+    __zn_transport_message_decode_na(zbf, 0, r);
+}
+
 _zn_transport_message_p_result_t _zn_transport_message_decode(_z_zbuf_t *zbf)
 {
     _zn_transport_message_p_result_t r;
-    _zn_transport_message_p_result_init(&r);
+    r.value.transport_message = (_zn_transport_message_t *)_z_zbuf_alloc(zbf, sizeof(_zn_transport_message_t));
     _zn_transport_message_decode_na(zbf, &r);
     return r;
 }
 
+_zn_transport_message_p_result_t _zn_transport_message_decode_lazy(_z_zbuf_t *zbf)
+{
+    // The zenoh messages of a frame are decoded one at a time when they are handled
+    _zn_transport_message_p_result_t r;
+    r.value.transport_message = (_zn_transport_message_t *)_z_zbuf_alloc(zbf, sizeof(_zn_transport_message_t));
+    __zn_transport_message_decode_na(zbf, 1, &r);
+    return r;
+}
+
 void _zn_transport_message_free(_zn_transport_message_t *msg)
 {
     if (msg->attachment)
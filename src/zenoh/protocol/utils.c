@@ -20,6 +20,7 @@ _zn_transport_message_t _zn_transport_message_init(uint8_t header)
 {
     _zn_transport_message_t sm;
     memset(&sm, 0, sizeof(_zn_transport_message_t));
+    sm.priority = ZN_PRIORITY_DEFAULT;
     sm.header = header;
     return sm;
 }
@@ -28,6 +29,7 @@ _zn_zenoh_message_t _zn_zenoh_message_init(uint8_t header)
 {
     _zn_zenoh_message_t zm;
     memset(&zm, 0, sizeof(_zn_zenoh_message_t));
+    zm.priority = ZN_PRIORITY_DEFAULT;
     zm.header = header;
     return zm;
 }
@@ -47,3 +49,32 @@ _zn_attachment_t *_zn_attachment_init(void)
     att->header = _ZN_MID_ATTACHMENT;
     return att;
 }
+
+_zn_transport_message_t _zn_init_ack_make(z_zint_t sn_resolution, int is_qos, z_bytes_t cookie)
+{
+    // The InitAck of a router accepting the session, the message owns the cookie
+    _zn_transport_message_t iam = _zn_transport_message_init(_ZN_MID_INIT);
+    _ZN_SET_FLAG(iam.header, _ZN_FLAG_T_A);
+    iam.body.init.options = 0;
+    if (is_qos)
+    {
+        _ZN_SET_FLAG(iam.header, _ZN_FLAG_T_O);
+        _ZN_SET_FLAG(iam.body.init.options, _ZN_OPT_INIT_QOS);
+    }
+    iam.body.init.version = ZN_PROTO_VERSION;
+    iam.body.init.whatami = ZN_ROUTER;
+    iam.body.init.sn_resolution = sn_resolution;
+    iam.body.init.pid = _z_bytes_make(ZN_PID_LENGTH);
+    memset((uint8_t *)iam.body.init.pid.val, 0, ZN_PID_LENGTH);
+    iam.body.init.cookie = cookie;
+    return iam;
+}
+
+_zn_transport_message_t _zn_open_ack_make(z_zint_t lease, z_zint_t initial_sn)
+{
+    _zn_transport_message_t oam = _zn_transport_message_init(_ZN_MID_OPEN);
+    _ZN_SET_FLAG(oam.header, _ZN_FLAG_T_A);
+    oam.body.open.lease = lease;
+    oam.body.open.initial_sn = initial_sn;
+    return oam;
+}
@@ -455,11 +455,11 @@ void _zn_trigger_queryables(zn_session_t *zn, const _zn_query_t *query)
     z_msg.reply_context->qid = query->qid;
     z_msg.reply_context->replier_kind = 0;
 
-    if (_zn_send_z_msg(zn, &z_msg, zn_reliability_t_RELIABLE, zn_congestion_control_t_BLOCK) != 0)
+    if (_zn_send_z_msg(zn, &z_msg, zn_reliability_t_RELIABLE, zn_congestion_control_t_BLOCK, 1) != 0)
     {
         _Z_DEBUG("Trying to reconnect...\n");
         zn->on_disconnect(zn);
-        _zn_send_z_msg(zn, &z_msg, zn_reliability_t_RELIABLE, zn_congestion_control_t_BLOCK);
+        _zn_send_z_msg(zn, &z_msg, zn_reliability_t_RELIABLE, zn_congestion_control_t_BLOCK, 1);
     }
 
     _zn_zenoh_message_free(&z_msg);
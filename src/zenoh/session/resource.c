@@ -31,14 +31,8 @@ z_zint_t _zn_get_entity_id(zn_session_t *zn)
 }
 
 /*------------------ Resource ------------------*/
-/**
- * This function is unsafe because it operates in potentially concurrent data.
- * Make sure that the following mutexes are locked before calling this function:
- *  - zn->mutex_inner
- */
-_zn_resource_t *__unsafe_zn_get_resource_by_id(zn_session_t *zn, int is_local, z_zint_t id)
+_zn_resource_t *__zn_get_resource_by_id_from_list(z_list_t *decls, z_zint_t id)
 {
-    z_list_t *decls = is_local ? zn->local_resources : zn->remote_resources;
     while (decls)
     {
         _zn_resource_t *decl = (_zn_resource_t *)z_list_head(decls);
@@ -52,6 +46,17 @@ _zn_resource_t *__unsafe_zn_get_resource_by_id(zn_session_t *zn, int is_local, z
     return NULL;
 }
 
+/**
+ * This function is unsafe because it operates in potentially concurrent data.
+ * Make sure that the following mutexes are locked before calling this function:
+ *  - zn->mutex_inner
+ */
+_zn_resource_t *__unsafe_zn_get_resource_by_id(zn_session_t *zn, int is_local, z_zint_t id)
+{
+    z_list_t *decls = is_local ? zn->local_resources : zn->remote_resources;
+    return __zn_get_resource_by_id_from_list(decls, id);
+}
+
 /**
  * This function is unsafe because it operates in potentially concurrent data.
  * Make sure that the following mutexes are locked before calling this function:
@@ -73,12 +78,7 @@ _zn_resource_t *__unsafe_zn_get_resource_by_key(zn_session_t *zn, int is_local,
     return NULL;
 }
 
-/**
- * This function is unsafe because it operates in potentially concurrent data.
- * Make sure that the following mutexes are locked before calling this function:
- *  - zn->mutex_inner
- */
-z_str_t __unsafe_zn_get_resource_name_from_key(zn_session_t *zn, int is_local, const zn_reskey_t *reskey)
+z_str_t __zn_get_resource_name_from_list(z_list_t *decls, const zn_reskey_t *reskey)
 {
     z_str_t rname = NULL;
 
@@ -104,7 +104,7 @@ z_str_t __unsafe_zn_get_resource_name_from_key(zn_session_t *zn, int is_local, c
     z_zint_t id = reskey->rid;
     do
     {
-        _zn_resource_t *res = __unsafe_zn_get_resource_by_id(zn, is_local, id);
+        _zn_resource_t *res = __zn_get_resource_by_id_from_list(decls, id);
         if (res == NULL)
         {
             z_list_free(strs);
@@ -134,6 +134,17 @@ z_str_t __unsafe_zn_get_resource_name_from_key(zn_session_t *zn, int is_local, c
     return rname;
 }
 
+/**
+ * This function is unsafe because it operates in potentially concurrent data.
+ * Make sure that the following mutexes are locked before calling this function:
+ *  - zn->mutex_inner
+ */
+z_str_t __unsafe_zn_get_resource_name_from_key(zn_session_t *zn, int is_local, const zn_reskey_t *reskey)
+{
+    z_list_t *decls = is_local ? zn->local_resources : zn->remote_resources;
+    return __zn_get_resource_name_from_list(decls, reskey);
+}
+
 /**
  * This function is unsafe because it operates in potentially concurrent data.
  * Make sure that the following mutexes are locked before calling this function:
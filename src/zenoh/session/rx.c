@@ -61,6 +61,10 @@ int _zn_handle_zenoh_message(zn_session_t *zn, _zn_zenoh_message_t *msg)
             {
                 _Z_DEBUG("Received declare-resource message\n");
 
+                // The resources of the multicast peers are resolved by the transport
+                if (zn->link->is_multicast)
+                    break;
+
                 z_zint_t id = decl.body.res.id;
                 zn_reskey_t key = decl.body.res.key;
 
@@ -83,7 +87,7 @@ int _zn_handle_zenoh_message(zn_session_t *zn, _zn_zenoh_message_t *msg)
             case _ZN_DECL_PUBLISHER:
             {
                 // Check if there are matching local subscriptions
-                z_list_t *subs = _zn_get_subscriptions_from_remote_key(zn, &msg->body.data.key);
+                z_list_t *subs = _zn_get_subscriptions_from_remote_key(zn, &decl.body.pub.key);
                 unsigned int len = z_list_len(subs);
                 if (len > 0)
                 {
@@ -92,19 +96,33 @@ int _zn_handle_zenoh_message(zn_session_t *zn, _zn_zenoh_message_t *msg)
                     z_msg.body.declare.declarations.len = len;
                     z_msg.body.declare.declarations.val = (_zn_declaration_t *)malloc(len * sizeof(_zn_declaration_t));
 
+                    unsigned int i = 0;
                     while (subs)
                     {
                         _zn_subscriber_t *sub = (_zn_subscriber_t *)z_list_head(subs);
 
-                        z_msg.body.declare.declarations.val[len].header = _ZN_DECL_SUBSCRIBER;
-                        z_msg.body.declare.declarations.val[len].body.sub.key = sub->key;
-                        z_msg.body.declare.declarations.val[len].body.sub.subinfo = sub->info;
+                        // The declarations are freed with the message, do not share the subscriber ones
+                        _zn_declaration_t *d = &z_msg.body.declare.declarations.val[i++];
+                        d->header = _ZN_DECL_SUBSCRIBER;
+                        if (sub->key.rname)
+                            _ZN_SET_FLAG(d->header, _ZN_FLAG_Z_K);
+                        if (sub->info.mode != zn_submode_t_PUSH || sub->info.period)
+                            _ZN_SET_FLAG(d->header, _ZN_FLAG_Z_S);
+                        if (sub->info.reliability == zn_reliability_t_RELIABLE)
+                            _ZN_SET_FLAG(d->header, _ZN_FLAG_Z_R);
+                        d->body.sub.key = _zn_reskey_clone(&sub->key);
+                        d->body.sub.subinfo = sub->info;
+                        if (sub->info.period)
+                        {
+                            d->body.sub.subinfo.period = (zn_period_t *)malloc(sizeof(zn_period_t));
+                            *d->body.sub.subinfo.period = *sub->info.period;
+                        }
 
                         subs = z_list_pop(subs);
                     }
 
                     // Send the message
-                    _zn_send_z_msg(zn, &z_msg, zn_reliability_t_RELIABLE, zn_congestion_control_t_BLOCK);
+                    _zn_send_z_msg(zn, &z_msg, zn_reliability_t_RELIABLE, zn_congestion_control_t_BLOCK, 1);
 
                     // Free the message
                     _zn_zenoh_message_free(&z_msg);
@@ -135,6 +153,9 @@ int _zn_handle_zenoh_message(zn_session_t *zn, _zn_zenoh_message_t *msg)
             }
             case _ZN_DECL_FORGET_RESOURCE:
             {
+                if (zn->link->is_multicast)
+                    break;
+
                 _zn_resource_t *rd = _zn_get_resource_by_id(zn, _ZN_IS_REMOTE, decl.body.forget_res.rid);
                 if (rd)
                     _zn_unregister_resource(zn, _ZN_IS_REMOTE, rd);
@@ -33,7 +33,7 @@ zn_hello_array_t _zn_scout_loop(
     ls.len = 0;
     ls.val = NULL;
 
-    _zn_link_p_result_t r_scout = _zn_open_link(locator, period);
+    _zn_link_p_result_t r_scout = _zn_open_link(locator, period, NULL);
     if (r_scout.tag == _z_res_t_ERR)
         return ls;
 
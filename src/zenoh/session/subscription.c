@@ -18,6 +18,7 @@
 #include "zenoh-pico/session/types.h"
 #include "zenoh-pico/session/private/types.h"
 #include "zenoh-pico/session/private/resource.h"
+#include "zenoh-pico/session/private/subscription.h"
 #include "zenoh-pico/system/common.h"
 #include "zenoh-pico/utils/private/logging.h"
 #include "zenoh-pico/utils/collections.h"
@@ -333,10 +334,14 @@ void _zn_unregister_subscription(zn_session_t *zn, int is_local, _zn_subscriber_
         zn->local_subscriptions = z_list_remove(zn->local_subscriptions, __unsafe_zn_subscription_predicate, s);
     else
         zn->remote_subscriptions = z_list_remove(zn->remote_subscriptions, __unsafe_zn_subscription_predicate, s);
-    free(s);
 
     // Release the lock
     z_mutex_unlock(&zn->mutex_inner);
+
+    // No more samples are dispatched to the subscription, wait for those being delivered.
+    // A subscription undeclared from a callback while scheduled is freed by its dispatch task.
+    if (_zn_dispatch_forget(zn, s) == 0)
+        free(s);
 }
 
 void _zn_flush_subscriptions(zn_session_t *zn)
@@ -404,7 +409,7 @@ void _zn_trigger_subscriptions(zn_session_t *zn, const zn_reskey_t reskey, const
         while (subs)
         {
             _zn_subscriber_t *sub = (_zn_subscriber_t *)z_list_head(subs);
-            sub->callback(&s, sub->arg);
+            __unsafe_zn_dispatch_sample(zn, sub, &s);
             subs = z_list_tail(subs);
         }
 
@@ -441,7 +446,7 @@ void _zn_trigger_subscriptions(zn_session_t *zn, const zn_reskey_t reskey, const
             }
 
             if (zn_rname_intersect(rname, reskey.rname))
-                sub->callback(&s, sub->arg);
+                __unsafe_zn_dispatch_sample(zn, sub, &s);
 
             if (sub->key.rid != ZN_RESOURCE_ID_NONE)
                 free(rname);
@@ -484,7 +489,7 @@ void _zn_trigger_subscriptions(zn_session_t *zn, const zn_reskey_t reskey, const
             }
 
             if (zn_rname_intersect(lname, rname))
-                sub->callback(&s, sub->arg);
+                __unsafe_zn_dispatch_sample(zn, sub, &s);
 
             if (sub->key.rid != ZN_RESOURCE_ID_NONE)
                 free(lname);
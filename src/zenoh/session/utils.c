@@ -19,6 +19,7 @@
 #include "zenoh-pico/protocol/utils.h"
 #include "zenoh-pico/utils/private/logging.h"
 #include "zenoh-pico/system/common.h"
+#include "zenoh-pico/session/api.h"
 #include "zenoh-pico/session/types.h"
 #include "zenoh-pico/session/private/resource.h"
 #include "zenoh-pico/session/private/subscription.h"
@@ -73,28 +74,77 @@ zn_session_t *_zn_session_init()
 
     // Initialize the read and write buffers
     zn->wbuf = _z_wbuf_make(ZN_WRITE_BUF_LEN, 0);
-    zn->zbuf = _z_zbuf_make(ZN_READ_BUF_LEN);
-
-    // Initialize the defragmentation buffers
-    zn->dbuf_reliable = _z_wbuf_make(0, 1);
-    zn->dbuf_best_effort = _z_wbuf_make(0, 1);
+    zn->zbuf = _z_zbuf_make_ring(ZN_READ_BUF_LEN);
+    zn->arena = _z_arena_make(ZN_READ_ARENA_SIZE);
 
     // Initialize the mutexes
     z_mutex_init(&zn->mutex_rx);
     z_mutex_init(&zn->mutex_tx);
     z_mutex_init(&zn->mutex_inner);
 
+    // The PIDs and the locator are set once the session is opened
+    _z_bytes_reset(&zn->local_pid);
+    _z_bytes_reset(&zn->remote_pid);
+    zn->locator = NULL;
+
     // The initial SN at RX side
     zn->lease = 0;
     zn->sn_resolution = 0;
 
-    // The initial SN at RX side
-    zn->sn_rx_reliable = 0;
-    zn->sn_rx_best_effort = 0;
+    // QoS is enabled only if negotiated with the router
+    zn->is_qos = 0;
+    for (int i = 0; i < _ZN_PRIORITIES_NUM; i++)
+    {
+        _zn_conduit_t *c = &zn->conduits[i];
+
+        // The initial SN at RX and TX side
+        c->sn_rx_reliable = 0;
+        c->sn_rx_best_effort = 0;
+        c->sn_tx_reliable = 0;
+        c->sn_tx_best_effort = 0;
+
+        // Initialize the defragmentation buffers
+        _zn_defrag_init(&c->dbuf_reliable);
+        _zn_defrag_init(&c->dbuf_best_effort);
+
+        // The first conduit uses the session write buffer
+        c->wbuf = i == 0 ? &zn->wbuf : NULL;
+        c->batch_is_open = 0;
+        c->batch_msgs = 0;
+        c->batch_reliability = zn_reliability_t_RELIABLE;
+        c->batch_sn = 0;
+
+        // The reliability windows of the datagram links
+        c->tx_window = NULL;
+        c->tx_first = 0;
+        c->tx_count = 0;
+        c->rx_window = NULL;
+        c->rx_count = 0;
+        c->rx_unacked = 0;
+    }
 
-    // The initial SN at TX side
-    zn->sn_tx_reliable = 0;
-    zn->sn_tx_best_effort = 0;
+    // The transmission batching is disabled by default
+    zn->batching = 0;
+    zn->batch_is_adaptive = 0;
+    zn->batch_timeout = 0;
+    zn->batch_is_held = 0;
+    memset(&zn->batch_stats, 0, sizeof(zn_batch_stats_t));
+
+    // No fragmented message is being sent
+    memset((void *)zn->tx_waiting, 0, sizeof(zn->tx_waiting));
+    zn->tx_frag_cid = -1;
+    zn->tx_cid_busy = 0;
+    z_condvar_init(&zn->tx_cid_free);
+    z_condvar_init(&zn->tx_preempted);
+
+    // The transmission queue is allocated when starting the tx task
+    zn->tx_queue = NULL;
+    zn->tx_pool = NULL;
+    z_mutex_init(&zn->mutex_tx_queue);
+    z_condvar_init(&zn->tx_queue_not_empty);
+    z_condvar_init(&zn->tx_queue_not_full);
+    zn->tx_queue_waiters = 0;
+    zn->tx_task_idle = 0;
 
     // Initialize the counters to 1
     zn->entity_id = 1;
@@ -115,6 +165,11 @@ zn_session_t *_zn_session_init()
 
     zn->pending_queries = z_list_empty;
 
+    // The peers are only known in peer mode
+    zn->peers = z_list_empty;
+    z_mutex_init(&zn->mutex_peers);
+    _z_bytes_reset(&zn->self_addr);
+
     zn->read_task_running = 0;
     zn->read_task = NULL;
 
@@ -122,6 +177,12 @@ zn_session_t *_zn_session_init()
     zn->transmitted = 0;
     zn->lease_task_running = 0;
     zn->lease_task = NULL;
+    zn->timers_started = 0;
+
+    zn->tx_task_running = 0;
+    zn->tx_task = NULL;
+
+    zn->dispatcher = NULL;
 
     zn->on_disconnect = &_zn_default_on_disconnect;
 
@@ -130,6 +191,12 @@ zn_session_t *_zn_session_init()
 
 void _zn_session_free(zn_session_t *zn)
 {
+    // Send the messages still waiting in the transmission queue
+    znp_stop_tx_task(zn);
+
+    // Deliver the samples still waiting for the dispatch tasks
+    znp_stop_dispatch_tasks(zn);
+
     // Clean up link
     zn->link->release_f(zn->link);
     free(zn->link);
@@ -139,18 +206,40 @@ void _zn_session_free(zn_session_t *zn)
     _zn_flush_subscriptions(zn);
     _zn_flush_queryables(zn);
     _zn_flush_pending_queries(zn);
+    _zn_flush_peers(zn);
+    _z_bytes_free(&zn->self_addr);
 
     // Clean up the mutexes
+    z_mutex_free(&zn->mutex_peers);
     z_mutex_free(&zn->mutex_inner);
     z_mutex_free(&zn->mutex_tx);
     z_mutex_free(&zn->mutex_rx);
+    z_condvar_free(&zn->tx_cid_free);
+    z_condvar_free(&zn->tx_preempted);
+
+    // Clean up the transmission queue
+    _zn_tx_queue_free(zn);
+    z_condvar_free(&zn->tx_queue_not_full);
+    z_condvar_free(&zn->tx_queue_not_empty);
+    z_mutex_free(&zn->mutex_tx_queue);
 
     // Clean up the buffers
     _z_wbuf_free(&zn->wbuf);
     _z_zbuf_free(&zn->zbuf);
+    _z_arena_free(&zn->arena);
 
-    _z_wbuf_free(&zn->dbuf_reliable);
-    _z_wbuf_free(&zn->dbuf_best_effort);
+    for (int i = 0; i < _ZN_PRIORITIES_NUM; i++)
+    {
+        _zn_conduit_t *c = &zn->conduits[i];
+        _zn_defrag_free(&c->dbuf_reliable);
+        _zn_defrag_free(&c->dbuf_best_effort);
+        _zn_free_frame_windows(c);
+        if (c->wbuf != &zn->wbuf && c->wbuf != NULL)
+        {
+            _z_wbuf_free(c->wbuf);
+            free(c->wbuf);
+        }
+    }
 
     // Clean up the PIDs
     _z_bytes_free(&zn->local_pid);
@@ -187,6 +276,9 @@ int _zn_send_close(zn_session_t *zn, uint8_t reason, int link_only)
 
 int _zn_session_close(zn_session_t *zn, uint8_t reason)
 {
+    // The queued messages are sent before the close message
+    znp_stop_tx_task(zn);
+
     int res = _zn_send_close(zn, reason, 0);
 
     // Free the session
@@ -94,3 +94,92 @@ _zn_transport_message_p_result_t _zn_recv_t_msg(zn_session_t *zn)
     _zn_recv_t_msg_na(zn, &r);
     return r;
 }
+
+int _zn_handle_batch(zn_session_t *zn, _z_zbuf_t *zbf)
+{
+    // Decode the messages in the arena of the session, nothing is freed but the arena is reset
+    zbf->arena = &zn->arena;
+
+    int res = _z_res_t_OK;
+    while (res == _z_res_t_OK && _z_zbuf_len(zbf) > 0)
+    {
+        // Mark the session that we have received data
+        zn->received = 1;
+
+        // Decode one session message, the zenoh messages of a frame are decoded when handled
+        _zn_transport_message_p_result_t r = _zn_transport_message_decode_lazy(zbf);
+        if (r.tag == _z_res_t_OK)
+        {
+            res = _zn_handle_transport_message(zn, r.value.transport_message);
+        }
+        else
+        {
+            _Z_DEBUG("Connection closed due to malformed message");
+            res = _z_res_t_ERR;
+        }
+        _z_arena_reset(&zn->arena);
+    }
+
+    zbf->arena = NULL;
+    return res;
+}
+
+/*------------------ Readiness helper ------------------*/
+int _zn_process_readable(zn_session_t *zn)
+{
+    int res = _z_res_t_OK;
+
+    // Acquire the lock
+    z_mutex_lock(&zn->mutex_rx);
+
+    if (zn->link->is_multicast)
+    {
+        res = __unsafe_zn_read_multicast(zn);
+    }
+    else if (zn->link->is_streamed == 1)
+    {
+        // Make room after the incomplete batch, if any, and read what is available
+        _z_zbuf_compact(&zn->zbuf);
+        if (_zn_recv_zbuf(zn->link, &zn->zbuf) <= 0)
+        {
+            res = _z_res_t_ERR;
+            goto EXIT_READABLE_PROC;
+        }
+
+        // Handle the complete batches, each one prefixed by its length
+        while (_z_zbuf_len(&zn->zbuf) >= _ZN_MSG_LEN_ENC_SIZE)
+        {
+            uint8_t *len_ptr = _z_zbuf_get_rptr(&zn->zbuf);
+            size_t len = (size_t)((uint16_t)len_ptr[0] | ((uint16_t)len_ptr[1] << 8));
+            if (_z_zbuf_len(&zn->zbuf) < _ZN_MSG_LEN_ENC_SIZE + len)
+                break;
+
+            _z_zbuf_set_rpos(&zn->zbuf, _z_zbuf_get_rpos(&zn->zbuf) + _ZN_MSG_LEN_ENC_SIZE);
+            _z_zbuf_t zbf = _z_zbuf_view(&zn->zbuf, len);
+            res = _zn_handle_batch(zn, &zbf);
+            if (res != _z_res_t_OK)
+                goto EXIT_READABLE_PROC;
+            _z_zbuf_set_rpos(&zn->zbuf, _z_zbuf_get_rpos(&zn->zbuf) + len);
+        }
+    }
+    else
+    {
+        // Each datagram is a batch, handle also those already received by the link
+        do
+        {
+            _z_zbuf_clear(&zn->zbuf);
+            if (_zn_recv_zbuf(zn->link, &zn->zbuf) <= 0)
+            {
+                res = _z_res_t_ERR;
+                goto EXIT_READABLE_PROC;
+            }
+            res = _zn_handle_batch(zn, &zn->zbuf);
+        } while (res == _z_res_t_OK && zn->link->buffered_f != NULL && zn->link->buffered_f(zn->link) > 0);
+    }
+
+EXIT_READABLE_PROC:
+    // Release the lock
+    z_mutex_unlock(&zn->mutex_rx);
+
+    return res;
+}
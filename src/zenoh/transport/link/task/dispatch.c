@@ -0,0 +1,373 @@
+/*
+ * Copyright (c) 2017, 2021 ADLINK Technology Inc.
+ *
+ * This program and the accompanying materials are made available under the
+ * terms of the Eclipse Public License 2.0 which is available at
+ * http://www.eclipse.org/legal/epl-2.0, or the Apache License, Version 2.0
+ * which is available at https://www.apache.org/licenses/LICENSE-2.0.
+ *
+ * SPDX-License-Identifier: EPL-2.0 OR Apache-2.0
+ *
+ * Contributors:
+ *   ADLINK zenoh team, <zenoh@adlink-labs.tech>
+ */
+
+#include "zenoh-pico/session/api.h"
+#include "zenoh-pico/session/types.h"
+#include "zenoh-pico/session/private/subscription.h"
+#include "zenoh-pico/system/common.h"
+#include "zenoh-pico/utils/private/logging.h"
+
+// The subscriber whose samples are being delivered by the calling dispatch task, if any
+static __thread _zn_subscriber_t *_zn_dispatch_current = NULL;
+
+/*------------------ Dispatch queues ------------------*/
+// NOTE: A subscriber with samples waiting is ready on the list of a single task at a time,
+//       and is only taken off by the task that delivers them. Its samples are thus delivered
+//       in order, even when an idle task steals it. The lock of a task only protects its list,
+//       the lock of the dispatcher is always taken first.
+void __zn_dispatch_push_ready(_zn_dispatcher_t *d, _zn_dispatch_worker_t *w, _zn_subscriber_t *sub)
+{
+    sub->next_ready = NULL;
+    z_mutex_lock(&w->mutex);
+    if (w->ready_tail == NULL)
+        w->ready_head = sub;
+    else
+        w->ready_tail->next_ready = sub;
+    w->ready_tail = sub;
+    z_mutex_unlock(&w->mutex);
+
+    __atomic_add_fetch(&d->ready_num, 1, __ATOMIC_SEQ_CST);
+}
+
+_zn_subscriber_t *__zn_dispatch_pop_ready(_zn_dispatcher_t *d, _zn_dispatch_worker_t *w)
+{
+    z_mutex_lock(&w->mutex);
+    _zn_subscriber_t *sub = w->ready_head;
+    if (sub != NULL)
+    {
+        w->ready_head = sub->next_ready;
+        if (w->ready_head == NULL)
+            w->ready_tail = NULL;
+    }
+    z_mutex_unlock(&w->mutex);
+
+    if (sub != NULL)
+        __atomic_sub_fetch(&d->ready_num, 1, __ATOMIC_SEQ_CST);
+    return sub;
+}
+
+_zn_subscriber_t *__zn_dispatch_next_ready(_zn_dispatcher_t *d, _zn_dispatch_worker_t *w)
+{
+    _zn_subscriber_t *sub = __zn_dispatch_pop_ready(d, w);
+    if (sub != NULL || __atomic_load_n(&d->ready_num, __ATOMIC_SEQ_CST) == 0)
+        return sub;
+
+    // Steal a subscriber waiting on another task
+    unsigned int idx = (unsigned int)(w - d->workers);
+    for (unsigned int i = 1; i < d->workers_num && sub == NULL; i++)
+        sub = __zn_dispatch_pop_ready(d, &d->workers[(idx + i) % d->workers_num]);
+    return sub;
+}
+
+/**
+ * This function is unsafe because it operates in potentially concurrent data.
+ * Make sure that the following mutexes are locked before calling this function:
+ *  - zn->mutex_inner
+ */
+void __unsafe_zn_dispatch_sample(zn_session_t *zn, _zn_subscriber_t *sub, const zn_sample_t *s)
+{
+    _zn_dispatcher_t *d = (_zn_dispatcher_t *)zn->dispatcher;
+    if (d == NULL)
+    {
+        sub->callback(s, sub->arg);
+        return;
+    }
+
+    // Copy the sample, its key and payload reference the reception buffers
+    _zn_dispatch_job_t *job = (_zn_dispatch_job_t *)malloc(sizeof(_zn_dispatch_job_t) + s->key.len + 1 + s->value.len);
+    char *key = (char *)(job + 1);
+    memcpy(key, s->key.val, s->key.len);
+    key[s->key.len] = '\0';
+    uint8_t *value = (uint8_t *)key + s->key.len + 1;
+    memcpy(value, s->value.val, s->value.len);
+    job->next = NULL;
+    job->sample.key.val = key;
+    job->sample.key.len = s->key.len;
+    job->sample.value.val = value;
+    job->sample.value.len = s->value.len;
+
+    z_mutex_lock(&d->mutex);
+    if (sub->jobs_tail == NULL)
+        sub->jobs_head = job;
+    else
+        sub->jobs_tail->next = job;
+    sub->jobs_tail = job;
+
+    if (!sub->is_scheduled)
+    {
+        // A subscriber is preferably served by the same task
+        sub->is_scheduled = 1;
+        __zn_dispatch_push_ready(d, &d->workers[sub->id % d->workers_num], sub);
+        z_condvar_signal(&d->ready);
+    }
+    z_mutex_unlock(&d->mutex);
+}
+
+void __unsafe_zn_dispatch_drop_jobs(_zn_subscriber_t *sub)
+{
+    while (sub->jobs_head != NULL)
+    {
+        _zn_dispatch_job_t *job = sub->jobs_head;
+        sub->jobs_head = job->next;
+        free(job);
+    }
+    sub->jobs_tail = NULL;
+}
+
+/**
+ * Returns 0 once the subscriber can be freed, 1 if it is undeclared from a callback while it
+ * is scheduled: the dispatch task running it, or popping it, frees it instead.
+ */
+int _zn_dispatch_forget(zn_session_t *zn, _zn_subscriber_t *sub)
+{
+    // The pool is not freed while an undeclaration is waiting on it
+    z_mutex_lock(&zn->mutex_inner);
+    _zn_dispatcher_t *d = (_zn_dispatcher_t *)zn->dispatcher;
+    if (d != NULL)
+    {
+        z_mutex_lock(&d->mutex);
+        d->forgetting++;
+        z_mutex_unlock(&d->mutex);
+    }
+    z_mutex_unlock(&zn->mutex_inner);
+
+    if (d == NULL)
+        return 0;
+
+    z_mutex_lock(&d->mutex);
+    // Drop the samples waiting and wait for those being delivered. A dispatch task must not
+    // wait: it may be the only one able to deliver them, or to run its own callback to the end.
+    __unsafe_zn_dispatch_drop_jobs(sub);
+    int is_deferred = _zn_dispatch_current != NULL && sub->is_scheduled;
+    if (is_deferred)
+        __atomic_store_n(&sub->is_undeclared, 1, __ATOMIC_SEQ_CST);
+    while (!is_deferred && sub->is_scheduled)
+        z_condvar_wait(&d->idle, &d->mutex);
+    d->forgetting--;
+    z_condvar_broadcast(&d->idle);
+    z_mutex_unlock(&d->mutex);
+
+    return is_deferred;
+}
+
+/*------------------ Dispatch tasks ------------------*/
+void *_znp_dispatch_task(void *arg)
+{
+    _zn_dispatch_worker_t *w = (_zn_dispatch_worker_t *)arg;
+    _zn_dispatcher_t *d = (_zn_dispatcher_t *)w->dispatcher;
+
+    while (1)
+    {
+        _zn_subscriber_t *sub = __zn_dispatch_next_ready(d, w);
+        if (sub == NULL)
+        {
+            // The tasks only terminate once all the samples have been delivered
+            z_mutex_lock(&d->mutex);
+            int is_done = !d->running && d->ready_num == 0;
+            if (!is_done && d->ready_num == 0)
+                z_condvar_wait(&d->ready, &d->mutex);
+            z_mutex_unlock(&d->mutex);
+            if (is_done)
+                break;
+            continue;
+        }
+
+        // Take all the samples waiting on the subscriber
+        z_mutex_lock(&d->mutex);
+        _zn_dispatch_job_t *job = sub->jobs_head;
+        sub->jobs_head = NULL;
+        sub->jobs_tail = NULL;
+        z_mutex_unlock(&d->mutex);
+
+        _zn_dispatch_current = sub;
+        while (job != NULL)
+        {
+            _zn_dispatch_job_t *next = job->next;
+            if (!__atomic_load_n(&sub->is_undeclared, __ATOMIC_SEQ_CST))
+                sub->callback(&job->sample, sub->arg);
+            free(job);
+            job = next;
+        }
+        _zn_dispatch_current = NULL;
+
+        z_mutex_lock(&d->mutex);
+        if (sub->is_undeclared)
+        {
+            // The subscriber has been undeclared from a callback, nothing references it anymore
+            z_mutex_unlock(&d->mutex);
+            free(sub);
+            continue;
+        }
+        if (sub->jobs_head != NULL)
+        {
+            // More samples have been received meanwhile
+            __zn_dispatch_push_ready(d, w, sub);
+        }
+        else
+        {
+            sub->is_scheduled = 0;
+            z_condvar_broadcast(&d->idle);
+        }
+        z_mutex_unlock(&d->mutex);
+    }
+
+    return 0;
+}
+
+void __zn_dispatcher_join(_zn_dispatcher_t *d)
+{
+    for (unsigned int i = 0; i < d->tasks_num; i++)
+        z_task_join(&d->workers[i].task);
+}
+
+/**
+ * This function is unsafe because it operates in potentially concurrent data.
+ * Make sure that the following mutexes are locked before calling this function:
+ *  - zn->mutex_inner
+ */
+void __unsafe_zn_dispatcher_drain(_zn_dispatcher_t *d)
+{
+    // Deliver the samples queued once the tasks terminated, as the reception would
+    for (unsigned int i = 0; i < d->workers_num; i++)
+    {
+        _zn_subscriber_t *sub;
+        while ((sub = __zn_dispatch_pop_ready(d, &d->workers[i])) != NULL)
+        {
+            z_mutex_lock(&d->mutex);
+            _zn_dispatch_job_t *job = sub->jobs_head;
+            sub->jobs_head = NULL;
+            sub->jobs_tail = NULL;
+            z_mutex_unlock(&d->mutex);
+
+            // A subscriber undeclared from a callback of the tasks has no samples left
+            if (sub->is_undeclared)
+            {
+                free(sub);
+                continue;
+            }
+
+            while (job != NULL)
+            {
+                _zn_dispatch_job_t *next = job->next;
+                sub->callback(&job->sample, sub->arg);
+                free(job);
+                job = next;
+            }
+
+            z_mutex_lock(&d->mutex);
+            sub->is_scheduled = 0;
+            z_condvar_broadcast(&d->idle);
+            z_mutex_unlock(&d->mutex);
+        }
+    }
+}
+
+void __zn_dispatcher_free(_zn_dispatcher_t *d)
+{
+    for (unsigned int i = 0; i < d->workers_num; i++)
+        z_mutex_free(&d->workers[i].mutex);
+    free(d->workers);
+
+    z_condvar_free(&d->idle);
+    z_condvar_free(&d->ready);
+    z_mutex_free(&d->mutex);
+    free(d);
+}
+
+int znp_start_dispatch_tasks(zn_session_t *zn, unsigned int threads)
+{
+    if (zn->dispatcher != NULL || threads == 0)
+        return -1;
+
+    _zn_dispatcher_t *d = (_zn_dispatcher_t *)malloc(sizeof(_zn_dispatcher_t));
+    z_mutex_init(&d->mutex);
+    z_condvar_init(&d->ready);
+    z_condvar_init(&d->idle);
+    d->ready_num = 0;
+    d->running = 1;
+    d->forgetting = 0;
+
+    d->workers = (_zn_dispatch_worker_t *)malloc(threads * sizeof(_zn_dispatch_worker_t));
+    d->workers_num = threads;
+    for (unsigned int i = 0; i < threads; i++)
+    {
+        z_mutex_init(&d->workers[i].mutex);
+        d->workers[i].ready_head = NULL;
+        d->workers[i].ready_tail = NULL;
+        d->workers[i].dispatcher = d;
+    }
+
+    d->tasks_num = 0;
+    for (unsigned int i = 0; i < threads; i++)
+    {
+        if (z_task_init(&d->workers[i].task, NULL, _znp_dispatch_task, &d->workers[i]) != 0)
+        {
+            z_mutex_lock(&d->mutex);
+            d->running = 0;
+            z_condvar_broadcast(&d->ready);
+            z_mutex_unlock(&d->mutex);
+            __zn_dispatcher_join(d);
+            __zn_dispatcher_free(d);
+            return -1;
+        }
+        d->tasks_num++;
+    }
+
+    // The samples are queued for the tasks from now on
+    z_mutex_lock(&zn->mutex_inner);
+    zn->dispatcher = d;
+    z_mutex_unlock(&zn->mutex_inner);
+
+    return 0;
+}
+
+int znp_stop_dispatch_tasks(zn_session_t *zn)
+{
+    // NOTE: The samples keep being queued while the tasks deliver those waiting, so that
+    //       the samples of a subscriber are never delivered by the reception and a task
+    //       at the same time, nor out of order.
+    z_mutex_lock(&zn->mutex_inner);
+    _zn_dispatcher_t *d = (_zn_dispatcher_t *)zn->dispatcher;
+    int is_running = 0;
+    if (d != NULL)
+    {
+        z_mutex_lock(&d->mutex);
+        is_running = d->running;
+        d->running = 0;
+        z_condvar_broadcast(&d->ready);
+        z_mutex_unlock(&d->mutex);
+    }
+    z_mutex_unlock(&zn->mutex_inner);
+
+    if (!is_running)
+        return -1;
+
+    __zn_dispatcher_join(d);
+
+    // The samples are delivered by the reception from now on, once those queued
+    // after the tasks terminated have been
+    z_mutex_lock(&zn->mutex_inner);
+    __unsafe_zn_dispatcher_drain(d);
+    zn->dispatcher = NULL;
+
+    // Wait for the undeclarations still referencing the pool
+    z_mutex_lock(&d->mutex);
+    while (d->forgetting > 0)
+        z_condvar_wait(&d->idle, &d->mutex);
+    z_mutex_unlock(&d->mutex);
+    z_mutex_unlock(&zn->mutex_inner);
+
+    __zn_dispatcher_free(d);
+    return 0;
+}
@@ -15,75 +15,106 @@
 #include "zenoh-pico/session/api.h"
 #include "zenoh-pico/session/types.h"
 #include "zenoh-pico/session/private/utils.h"
+#include "zenoh-pico/transport/private/utils.h"
 #include "zenoh-pico/protocol/private/msg.h"
 #include "zenoh-pico/utils/private/logging.h"
 #include "zenoh-pico/system/common.h"
 
-void *_znp_lease_task(void *arg)
+int _zn_process_timers(zn_session_t *zn, unsigned long now)
 {
-    zn_session_t *zn = (zn_session_t *)arg;
-    zn->lease_task_running = 1;
+    // The timers start on the first call
+    if (!zn->timers_started)
+    {
+        zn->received = 0;
+        zn->transmitted = 0;
+        zn->lease_deadline = now + zn->lease;
+        zn->keep_alive_deadline = now + ZN_KEEP_ALIVE_INTERVAL;
+        zn->batch_deadline = now + zn->batch_timeout;
+        zn->join_deadline = now + ZN_JOIN_INTERVAL;
+        zn->sync_deadline = now + ZN_RELIABLE_SYNC_INTERVAL;
+        zn->timers_started = 1;
+    }
 
-    zn->received = 0;
-    zn->transmitted = 0;
+    // Send the messages that have been batched in the meantime
+    if (zn->batching && _ZN_TIMER_EXPIRED(now, zn->batch_deadline))
+    {
+        _zn_flush_batch(zn);
+        zn->batch_deadline = now + zn->batch_timeout;
+    }
 
-    unsigned int next_lease = zn->lease;
-    unsigned int next_keep_alive = ZN_KEEP_ALIVE_INTERVAL;
-    while (zn->lease_task_running)
+    if (zn->lease > 0 && _ZN_TIMER_EXPIRED(now, zn->lease_deadline))
     {
-        // Compute the target interval
-        unsigned int interval;
-        if (zn->lease > 0)
-        {
-            if (next_lease < next_keep_alive)
-                interval = next_lease;
-            else if (next_keep_alive < ZN_KEEP_ALIVE_INTERVAL)
-                interval = next_keep_alive;
-            else
-                interval = ZN_KEEP_ALIVE_INTERVAL;
-        }
-        else
-        {
-            interval = ZN_KEEP_ALIVE_INTERVAL;
-        }
+        // Check if received data
+        if (zn->received == 0)
+            return -1;
 
-        // The keep alive and lease intervals are expressed in milliseconds
-        z_sleep_ms(interval);
+        // Reset the lease parameters
+        zn->received = 0;
+        zn->lease_deadline = now + zn->lease;
+    }
 
-        // Decrement the interval
-        if (zn->lease > 0)
-        {
-            next_lease -= interval;
-        }
-        next_keep_alive -= interval;
+    if (_ZN_TIMER_EXPIRED(now, zn->keep_alive_deadline))
+    {
+        // Check if need to send a keep alive
+        if (zn->transmitted == 0)
+            znp_send_keep_alive(zn);
+
+        // Reset the keep alive parameters
+        zn->transmitted = 0;
+        zn->keep_alive_deadline = now + ZN_KEEP_ALIVE_INTERVAL;
+    }
 
-        if (zn->lease > 0 && next_lease == 0)
+    if (zn->link->is_multicast)
+    {
+        // Announce the session to the group and forget the silent peers
+        if (_ZN_TIMER_EXPIRED(now, zn->join_deadline))
         {
-            // Check if received data
-            if (zn->received == 0)
-            {
-                _Z_DEBUG_VA("Closing session because it has expired after %zums", zn->lease);
-                _zn_session_close(zn, _ZN_CLOSE_EXPIRED);
-                return 0;
-            }
-
-            // Reset the lease parameters
-            zn->received = 0;
-            next_lease = zn->lease;
+            _zn_send_join(zn);
+            zn->join_deadline = now + ZN_JOIN_INTERVAL;
         }
+        _zn_expire_peers(zn, now);
+    }
+
+    // Recover the last reliable frames lost on a datagram link
+    if (_zn_link_needs_retransmission(zn->link) && _ZN_TIMER_EXPIRED(now, zn->sync_deadline))
+    {
+        _zn_send_syncs(zn);
+        zn->sync_deadline = now + ZN_RELIABLE_SYNC_INTERVAL;
+    }
+
+    // Compute the interval until the next deadline
+    unsigned long interval = zn->keep_alive_deadline - now;
+    if (zn->lease > 0 && zn->lease_deadline - now < interval)
+        interval = zn->lease_deadline - now;
+    if (zn->batching && zn->batch_timeout > 0 && zn->batch_deadline - now < interval)
+        interval = zn->batch_deadline - now;
+    if (zn->link->is_multicast && zn->join_deadline - now < interval)
+        interval = zn->join_deadline - now;
+    if (_zn_link_needs_retransmission(zn->link) && zn->sync_deadline - now < interval)
+        interval = zn->sync_deadline - now;
 
-        if (next_keep_alive == 0)
+    return (int)interval;
+}
+
+void *_znp_lease_task(void *arg)
+{
+    zn_session_t *zn = (zn_session_t *)arg;
+    zn->lease_task_running = 1;
+    zn->timers_started = 0;
+
+    z_clock_t start = z_clock_now();
+    while (zn->lease_task_running)
+    {
+        // The keep alive and lease intervals are expressed in milliseconds
+        int interval = _zn_process_timers(zn, (unsigned long)z_clock_elapsed_ms(&start));
+        if (interval < 0)
         {
-            // Check if need to send a keep alive
-            if (zn->transmitted == 0)
-            {
-                znp_send_keep_alive(zn);
-            }
-
-            // Reset the keep alive parameters
-            zn->transmitted = 0;
-            next_keep_alive = ZN_KEEP_ALIVE_INTERVAL;
+            _Z_DEBUG_VA("Closing session because it has expired after %zums", zn->lease);
+            _zn_session_close(zn, _ZN_CLOSE_EXPIRED);
+            return 0;
         }
+
+        z_sleep_ms(interval);
     }
 
     return 0;
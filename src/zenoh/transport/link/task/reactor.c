@@ -0,0 +1,315 @@
+/*
+ * Copyright (c) 2017, 2021 ADLINK Technology Inc.
+ *
+ * This program and the accompanying materials are made available under the
+ * terms of the Eclipse Public License 2.0 which is available at
+ * http://www.eclipse.org/legal/epl-2.0, or the Apache License, Version 2.0
+ * which is available at https://www.apache.org/licenses/LICENSE-2.0.
+ *
+ * SPDX-License-Identifier: EPL-2.0 OR Apache-2.0
+ *
+ * Contributors:
+ *   ADLINK zenoh team, <zenoh@adlink-labs.tech>
+ */
+
+#include "zenoh-pico/session/api.h"
+#include "zenoh-pico/session/types.h"
+#include "zenoh-pico/session/private/utils.h"
+#include "zenoh-pico/transport/private/utils.h"
+#include "zenoh-pico/protocol/private/msg.h"
+#include "zenoh-pico/utils/collections.h"
+#include "zenoh-pico/utils/private/logging.h"
+#include "zenoh-pico/system/common.h"
+
+#if defined(ZENOH_LINUX)
+
+// NOTE: The entries are referenced by the poller and by the threads waiting on it, hence they
+//       are only released when no thread is running. A detached or expired session leaves
+//       behind an entry with a NULL session.
+typedef struct
+{
+    zn_session_t *zn;
+    z_mutex_t mutex;
+    int is_readable;
+} _znp_reactor_entry_t;
+
+void _znp_reactor_process_readable(znp_reactor_t *r, _znp_reactor_entry_t *e)
+{
+    z_mutex_lock(&e->mutex);
+    if (e->zn != NULL && e->is_readable)
+    {
+        if (_zn_process_readable(e->zn) == _z_res_t_OK)
+        {
+            _zn_poller_rearm(r->poller, e->zn->link->sock, e);
+        }
+        else
+        {
+            // Stop polling the failed link, the session expires with its lease
+            _zn_poller_del(r->poller, e->zn->link->sock);
+            e->is_readable = 0;
+        }
+    }
+    z_mutex_unlock(&e->mutex);
+}
+
+unsigned long __unsafe_znp_reactor_process_timers(znp_reactor_t *r, unsigned long now)
+{
+    unsigned long next = ZN_KEEP_ALIVE_INTERVAL;
+    z_list_t *xs = r->entries;
+    while (xs != z_list_empty)
+    {
+        _znp_reactor_entry_t *e = (_znp_reactor_entry_t *)z_list_head(xs);
+        z_mutex_lock(&e->mutex);
+        if (e->zn != NULL)
+        {
+            int interval = _zn_process_timers(e->zn, now);
+            if (interval < 0)
+            {
+                _Z_DEBUG_VA("Closing session because it has expired after %zums", e->zn->lease);
+                if (e->is_readable)
+                    _zn_poller_del(r->poller, e->zn->link->sock);
+                _zn_session_close(e->zn, _ZN_CLOSE_EXPIRED);
+                e->zn = NULL;
+            }
+            else if ((unsigned long)interval < next)
+            {
+                next = interval;
+            }
+        }
+        z_mutex_unlock(&e->mutex);
+        xs = z_list_tail(xs);
+    }
+
+    return next;
+}
+
+void *_znp_reactor_task(void *arg)
+{
+    znp_reactor_t *r = (znp_reactor_t *)arg;
+    void *ready[ZN_REACTOR_EVENTS];
+
+    while (r->running)
+    {
+        // A single thread runs the timers at a time, the others only wait for the sockets
+        unsigned long now = (unsigned long)z_clock_elapsed_ms(&r->start);
+        if (z_mutex_trylock(&r->mutex) == 0)
+        {
+            if (_ZN_TIMER_EXPIRED(now, r->next_timer))
+                r->next_timer = now + __unsafe_znp_reactor_process_timers(r, now);
+            z_mutex_unlock(&r->mutex);
+        }
+
+        long timeout = (long)(r->next_timer - now);
+        int n = _zn_poller_wait(r->poller, ready, ZN_REACTOR_EVENTS, timeout > 0 ? (int)timeout : 0);
+        if (n < 0)
+            break;
+
+        for (int i = 0; i < n; i++)
+        {
+            // A wake up is reset only while running, so that a stop reaches all the threads
+            if (ready[i] == NULL)
+            {
+                if (r->running)
+                    _zn_poller_reset(r->poller);
+                continue;
+            }
+
+            _znp_reactor_process_readable(r, (_znp_reactor_entry_t *)ready[i]);
+        }
+    }
+
+    return 0;
+}
+
+znp_reactor_t *znp_reactor_new(void)
+{
+    void *poller = _zn_poller_open();
+    if (poller == NULL)
+        return NULL;
+
+    znp_reactor_t *r = (znp_reactor_t *)malloc(sizeof(znp_reactor_t));
+    r->poller = poller;
+    z_mutex_init(&r->mutex);
+    r->entries = z_list_empty;
+    r->start = z_clock_now();
+    r->next_timer = 0;
+
+    r->running = 0;
+    r->tasks = NULL;
+    r->tasks_num = 0;
+
+    return r;
+}
+
+int znp_reactor_attach(znp_reactor_t *r, zn_session_t *zn)
+{
+    // The reception of the link must be driven by the readiness of its socket
+    if (!zn->link->is_pollable)
+        return -1;
+
+    _znp_reactor_entry_t *e = (_znp_reactor_entry_t *)malloc(sizeof(_znp_reactor_entry_t));
+    e->zn = zn;
+    z_mutex_init(&e->mutex);
+    e->is_readable = 1;
+
+    z_mutex_lock(&r->mutex);
+    r->entries = z_list_cons(r->entries, e);
+    if (_zn_poller_add(r->poller, zn->link->sock, e) < 0)
+    {
+        e->zn = NULL;
+        z_mutex_unlock(&r->mutex);
+        return -1;
+    }
+
+    // Start the timers of the session right away
+    zn->timers_started = 0;
+    r->next_timer = (unsigned long)z_clock_elapsed_ms(&r->start);
+    z_mutex_unlock(&r->mutex);
+
+    _zn_poller_wakeup(r->poller);
+    return 0;
+}
+
+int znp_reactor_detach(znp_reactor_t *r, zn_session_t *zn)
+{
+    int res = -1;
+
+    z_mutex_lock(&r->mutex);
+    z_list_t *xs = r->entries;
+    while (xs != z_list_empty)
+    {
+        _znp_reactor_entry_t *e = (_znp_reactor_entry_t *)z_list_head(xs);
+        z_mutex_lock(&e->mutex);
+        if (e->zn == zn)
+        {
+            if (e->is_readable)
+                _zn_poller_del(r->poller, zn->link->sock);
+            e->zn = NULL;
+            res = 0;
+        }
+        z_mutex_unlock(&e->mutex);
+        xs = z_list_tail(xs);
+    }
+    z_mutex_unlock(&r->mutex);
+
+    return res;
+}
+
+int znp_reactor_start(znp_reactor_t *r, unsigned int threads)
+{
+    if (r->running || threads == 0)
+        return -1;
+
+    r->running = 1;
+    r->tasks = (z_task_t *)malloc(threads * sizeof(z_task_t));
+    r->tasks_num = 0;
+    for (unsigned int i = 0; i < threads; i++)
+    {
+        if (z_task_init(&r->tasks[i], NULL, _znp_reactor_task, r) != 0)
+        {
+            znp_reactor_stop(r);
+            return -1;
+        }
+        r->tasks_num++;
+    }
+
+    return 0;
+}
+
+int znp_reactor_stop(znp_reactor_t *r)
+{
+    if (r->tasks == NULL)
+        return -1;
+
+    r->running = 0;
+    _zn_poller_wakeup(r->poller);
+    for (unsigned int i = 0; i < r->tasks_num; i++)
+        z_task_join(&r->tasks[i]);
+    free(r->tasks);
+    r->tasks = NULL;
+    r->tasks_num = 0;
+    _zn_poller_reset(r->poller);
+
+    // Release the entries left behind by the detached and expired sessions
+    z_list_t *entries = z_list_empty;
+    z_list_t *xs = r->entries;
+    while (xs != z_list_empty)
+    {
+        _znp_reactor_entry_t *e = (_znp_reactor_entry_t *)z_list_head(xs);
+        if (e->zn != NULL)
+        {
+            entries = z_list_cons(entries, e);
+        }
+        else
+        {
+            z_mutex_free(&e->mutex);
+            free(e);
+        }
+        xs = z_list_tail(xs);
+    }
+    z_list_free(r->entries);
+    r->entries = entries;
+
+    return 0;
+}
+
+void znp_reactor_free(znp_reactor_t *r)
+{
+    znp_reactor_stop(r);
+
+    // The sessions still attached are left open
+    while (r->entries != z_list_empty)
+    {
+        _znp_reactor_entry_t *e = (_znp_reactor_entry_t *)z_list_head(r->entries);
+        if (e->zn != NULL && e->is_readable)
+            _zn_poller_del(r->poller, e->zn->link->sock);
+        z_mutex_free(&e->mutex);
+        free(e);
+        r->entries = z_list_pop(r->entries);
+    }
+
+    _zn_poller_close(r->poller);
+    z_mutex_free(&r->mutex);
+    free(r);
+}
+
+#else
+
+znp_reactor_t *znp_reactor_new(void)
+{
+    return NULL;
+}
+
+int znp_reactor_attach(znp_reactor_t *r, zn_session_t *zn)
+{
+    (void)r;
+    (void)zn;
+    return -1;
+}
+
+int znp_reactor_detach(znp_reactor_t *r, zn_session_t *zn)
+{
+    (void)r;
+    (void)zn;
+    return -1;
+}
+
+int znp_reactor_start(znp_reactor_t *r, unsigned int threads)
+{
+    (void)r;
+    (void)threads;
+    return -1;
+}
+
+int znp_reactor_stop(znp_reactor_t *r)
+{
+    (void)r;
+    return -1;
+}
+
+void znp_reactor_free(znp_reactor_t *r)
+{
+    (void)r;
+}
+
+#endif
@@ -22,9 +22,6 @@ void *_znp_read_task(void *arg)
     zn_session_t *z = (zn_session_t *)arg;
     z->read_task_running = 1;
 
-    _zn_transport_message_p_result_t r;
-    _zn_transport_message_p_result_init(&r);
-
     // Acquire and keep the lock
     z_mutex_lock(&z->mutex_rx);
     // Prepare the buffer
@@ -32,7 +29,13 @@ void *_znp_read_task(void *arg)
     while (z->read_task_running)
     {
         size_t to_read = 0;
-        if (z->link->is_streamed == 1)
+        if (z->link->is_multicast)
+        {
+            // The datagrams are handled one by one, each one for the peer that sent it
+            __unsafe_zn_read_multicast(z);
+            continue;
+        }
+        else if (z->link->is_streamed == 1)
         {
             // NOTE: 16 bits (2 bytes) may be prepended to the serialized message indicating the total length
             //       in bytes of the message, resulting in the maximum length of a message being 65_535 bytes.
@@ -76,38 +79,13 @@ void *_znp_read_task(void *arg)
 
         // Wrap the main buffer for to_read bytes
         _z_zbuf_t zbuf = _z_zbuf_view(&z->zbuf, to_read);
-
-        while (_z_zbuf_len(&zbuf) > 0)
-        {
-            // Mark the session that we have received data
-            z->received = 1;
-
-            // Decode one session message
-            _zn_transport_message_decode_na(&zbuf, &r);
-
-            if (r.tag == _z_res_t_OK)
-            {
-                int res = _zn_handle_transport_message(z, r.value.transport_message);
-                if (res == _z_res_t_OK)
-                    _zn_transport_message_free(r.value.transport_message);
-                else
-                    goto EXIT_RECV_LOOP_RELEASE;
-            }
-            else
-            {
-                _Z_DEBUG("Connection closed due to malformed message");
-                goto EXIT_RECV_LOOP;
-            }
-        }
+        if (_zn_handle_batch(z, &zbuf) != _z_res_t_OK)
+            goto EXIT_RECV_LOOP;
 
         // Move the read position of the read buffer
         _z_zbuf_set_rpos(&z->zbuf, _z_zbuf_get_rpos(&z->zbuf) + to_read);
     }
 
-EXIT_RECV_LOOP_RELEASE:
-    // Free the result
-    _zn_transport_message_p_result_free(&r);
-
 EXIT_RECV_LOOP:
     if (z)
     {
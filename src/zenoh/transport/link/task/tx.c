@@ -0,0 +1,300 @@
+/*
+ * Copyright (c) 2017, 2021 ADLINK Technology Inc.
+ *
+ * This program and the accompanying materials are made available under the
+ * terms of the Eclipse Public License 2.0 which is available at
+ * http://www.eclipse.org/legal/epl-2.0, or the Apache License, Version 2.0
+ * which is available at https://www.apache.org/licenses/LICENSE-2.0.
+ *
+ * SPDX-License-Identifier: EPL-2.0 OR Apache-2.0
+ *
+ * Contributors:
+ *   ADLINK zenoh team, <zenoh@adlink-labs.tech>
+ */
+
+#include "zenoh-pico/session/api.h"
+#include "zenoh-pico/session/types.h"
+#include "zenoh-pico/system/collections.h"
+#include "zenoh-pico/system/common.h"
+#include "zenoh-pico/transport/private/utils.h"
+#include "zenoh-pico/utils/private/logging.h"
+
+/*------------------ Transmission queue ------------------*/
+// NOTE: The publishers and the tx task exchange the encoded messages through two lock-free
+//       queues of the same capacity: the pool holding the free entries and the queue holding
+//       the entries ready to be sent. The mutex and the condvars are only used to put the tx
+//       task or a blocking publisher to sleep when there is nothing to do.
+void _zn_tx_queue_init(zn_session_t *zn)
+{
+    zn->tx_queue = z_lf_queue_make(ZN_TX_QUEUE_LEN);
+    zn->tx_pool = z_lf_queue_make(ZN_TX_QUEUE_LEN);
+
+    // Fill the pool with the free entries
+    for (size_t i = 0; i < z_lf_queue_capacity(zn->tx_pool); i++)
+    {
+        _zn_tx_entry_t *e = (_zn_tx_entry_t *)malloc(sizeof(_zn_tx_entry_t));
+        e->wbuf = _z_wbuf_make(ZN_TX_QUEUE_ENTRY_SIZE, 0);
+        e->has_fbf = 0;
+        z_lf_queue_push(zn->tx_pool, e);
+    }
+}
+
+void _zn_tx_queue_free(zn_session_t *zn)
+{
+    if (zn->tx_pool == NULL)
+        return;
+
+    _zn_tx_entry_t *e;
+    while ((e = (_zn_tx_entry_t *)z_lf_queue_pull(zn->tx_queue)) != NULL)
+        z_lf_queue_push(zn->tx_pool, e);
+
+    while ((e = (_zn_tx_entry_t *)z_lf_queue_pull(zn->tx_pool)) != NULL)
+    {
+        _z_wbuf_free(&e->wbuf);
+        if (e->has_fbf)
+            _z_wbuf_free(&e->fbf);
+        free(e);
+    }
+
+    z_lf_queue_free(zn->tx_queue);
+    z_lf_queue_free(zn->tx_pool);
+    zn->tx_queue = NULL;
+    zn->tx_pool = NULL;
+}
+
+_zn_tx_entry_t *_zn_tx_entry_acquire(zn_session_t *zn, zn_congestion_control_t cong_ctrl)
+{
+    _zn_tx_entry_t *e = (_zn_tx_entry_t *)z_lf_queue_pull(zn->tx_pool);
+    if (e != NULL || cong_ctrl == zn_congestion_control_t_DROP)
+        return e;
+
+    // The queue is full, wait for the tx task to release an entry
+    z_mutex_lock(&zn->mutex_tx_queue);
+    __atomic_add_fetch(&zn->tx_queue_waiters, 1, __ATOMIC_SEQ_CST);
+    while ((e = (_zn_tx_entry_t *)z_lf_queue_pull(zn->tx_pool)) == NULL)
+        z_condvar_wait(&zn->tx_queue_not_full, &zn->mutex_tx_queue);
+    __atomic_sub_fetch(&zn->tx_queue_waiters, 1, __ATOMIC_SEQ_CST);
+    z_mutex_unlock(&zn->mutex_tx_queue);
+
+    return e;
+}
+
+void _zn_tx_entry_release(zn_session_t *zn, _zn_tx_entry_t *e)
+{
+    if (e->has_fbf)
+    {
+        _z_wbuf_free(&e->fbf);
+        e->has_fbf = 0;
+    }
+    z_lf_queue_push(zn->tx_pool, e);
+
+    // Wake up a publisher waiting for a free entry, if any
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    if (__atomic_load_n(&zn->tx_queue_waiters, __ATOMIC_SEQ_CST) > 0)
+    {
+        z_mutex_lock(&zn->mutex_tx_queue);
+        z_condvar_signal(&zn->tx_queue_not_full);
+        z_mutex_unlock(&zn->mutex_tx_queue);
+    }
+}
+
+void _zn_tx_entry_commit(zn_session_t *zn, _zn_tx_entry_t *e)
+{
+    // The queue and the pool have the same capacity, the push can not fail
+    z_lf_queue_push(zn->tx_queue, e);
+
+    // Wake up the tx task if it is waiting for messages
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    if (__atomic_load_n(&zn->tx_task_idle, __ATOMIC_SEQ_CST))
+    {
+        z_mutex_lock(&zn->mutex_tx_queue);
+        z_condvar_signal(&zn->tx_queue_not_empty);
+        z_mutex_unlock(&zn->mutex_tx_queue);
+    }
+}
+
+int _zn_tx_queue_push(zn_session_t *zn, _zn_zenoh_message_t *z_msg, zn_reliability_t reliability, zn_congestion_control_t cong_ctrl, int is_express)
+{
+    _zn_tx_entry_t *e = _zn_tx_entry_acquire(zn, cong_ctrl);
+    if (e == NULL)
+    {
+        _Z_DEBUG("Dropping zenoh message because the transmission queue is full\n");
+        return 0;
+    }
+
+    e->priority = z_msg->priority;
+    e->reliability = reliability;
+    e->is_express = is_express;
+
+    // Encode the message on the entry
+    _z_wbuf_clear(&e->wbuf);
+    int res = _zn_zenoh_message_encode(&e->wbuf, z_msg);
+    if (res != 0)
+    {
+        // The message does not fit in the entry, encode it on an expandable wbuf
+        e->fbf = _z_wbuf_make(ZN_FRAG_BUF_TX_CHUNK, 1);
+        e->has_fbf = 1;
+        res = _zn_zenoh_message_encode(&e->fbf, z_msg);
+        if (res != 0)
+        {
+            _Z_DEBUG("Dropping zenoh message because it can not be encoded\n");
+            _zn_tx_entry_release(zn, e);
+            return res;
+        }
+    }
+
+    _zn_tx_entry_commit(zn, e);
+    return 0;
+}
+
+int _zn_tx_queue_push_preencoded(zn_session_t *zn, const z_bytes_t *prefix, const uint8_t *payload, size_t len, zn_priority_t priority, zn_reliability_t reliability, zn_congestion_control_t cong_ctrl, int is_express)
+{
+    _zn_tx_entry_t *e = _zn_tx_entry_acquire(zn, cong_ctrl);
+    if (e == NULL)
+    {
+        _Z_DEBUG("Dropping zenoh message because the transmission queue is full\n");
+        return 0;
+    }
+
+    e->priority = priority;
+    e->reliability = reliability;
+    e->is_express = is_express;
+
+    // Copy the message on the entry
+    _z_wbuf_clear(&e->wbuf);
+    int res = _zn_zenoh_message_encode_preencoded(&e->wbuf, prefix, payload, len);
+    if (res != 0)
+    {
+        // The message does not fit in the entry, copy it on an expandable wbuf
+        e->fbf = _z_wbuf_make(ZN_FRAG_BUF_TX_CHUNK, 1);
+        e->has_fbf = 1;
+        res = _zn_zenoh_message_encode_preencoded(&e->fbf, prefix, payload, len);
+        if (res != 0)
+        {
+            _Z_DEBUG("Dropping zenoh message because it can not be encoded\n");
+            _zn_tx_entry_release(zn, e);
+            return res;
+        }
+    }
+
+    _zn_tx_entry_commit(zn, e);
+    return 0;
+}
+
+/*------------------ Transmission task ------------------*/
+void __zn_tx_entry_send(zn_session_t *zn, _zn_tx_entry_t *e)
+{
+    // Append the message to the current batch
+    _zn_lock_tx(zn, e->priority, zn_congestion_control_t_BLOCK);
+    // Send the frames of the drained messages at once if the link can queue them
+    _zn_cork_link(zn->link);
+    int res = __unsafe_zn_send_encoded_z_msg(zn, e->has_fbf ? &e->fbf : &e->wbuf, e->priority, e->reliability);
+    if (res == 0 && e->is_express)
+    {
+        res = __unsafe_zn_flush_batch(zn);
+        if (_zn_uncork_link(zn->link) != 0)
+            res = -1;
+    }
+    z_mutex_unlock(&zn->mutex_tx);
+
+    if (res != 0)
+        _Z_DEBUG("Dropping zenoh message because it can not be sent\n");
+
+    _zn_tx_entry_release(zn, e);
+}
+
+void __zn_tx_flush(zn_session_t *zn)
+{
+    // Send the batched messages and the datagrams queued by the link meanwhile
+    _zn_flush_batch(zn);
+    z_mutex_lock(&zn->mutex_tx);
+    if (_zn_uncork_link(zn->link) != 0)
+        _Z_DEBUG("Error while sending the queued datagrams\n");
+    z_mutex_unlock(&zn->mutex_tx);
+}
+
+void *_znp_tx_task(void *arg)
+{
+    zn_session_t *zn = (zn_session_t *)arg;
+
+    while (1)
+    {
+        _zn_tx_entry_t *e = (_zn_tx_entry_t *)z_lf_queue_pull(zn->tx_queue);
+        if (e == NULL)
+        {
+            // The queue has been drained, the task only terminates at this point
+            __zn_tx_flush(zn);
+            if (!zn->tx_task_running)
+                break;
+
+            // Wait for new messages
+            z_mutex_lock(&zn->mutex_tx_queue);
+            __atomic_store_n(&zn->tx_task_idle, 1, __ATOMIC_SEQ_CST);
+            __atomic_thread_fence(__ATOMIC_SEQ_CST);
+            e = (_zn_tx_entry_t *)z_lf_queue_pull(zn->tx_queue);
+            if (e == NULL && zn->tx_task_running)
+                z_condvar_wait(&zn->tx_queue_not_empty, &zn->mutex_tx_queue);
+            __atomic_store_n(&zn->tx_task_idle, 0, __ATOMIC_SEQ_CST);
+            z_mutex_unlock(&zn->mutex_tx_queue);
+
+            if (e == NULL)
+                continue;
+        }
+
+        __zn_tx_entry_send(zn, e);
+    }
+
+    return 0;
+}
+
+int znp_start_tx_task(zn_session_t *zn)
+{
+    if (zn->tx_task != NULL)
+        return -1;
+
+    if (zn->tx_pool == NULL)
+        _zn_tx_queue_init(zn);
+
+    z_task_t *task = (z_task_t *)malloc(sizeof(z_task_t));
+    memset(task, 0, sizeof(pthread_t));
+    // The flag is set before the task starts so that a stop right after the start is not lost
+    zn->tx_task_running = 1;
+    if (z_task_init(task, NULL, _znp_tx_task, zn) != 0)
+    {
+        zn->tx_task_running = 0;
+        free(task);
+        return -1;
+    }
+    zn->tx_task = task;
+    return 0;
+}
+
+int znp_stop_tx_task(zn_session_t *zn)
+{
+    if (zn->tx_task == NULL)
+        return -1;
+
+    zn->tx_task_running = 0;
+
+    // Wake up the tx task to drain the queue and exit
+    z_mutex_lock(&zn->mutex_tx_queue);
+    z_condvar_signal(&zn->tx_queue_not_empty);
+    z_mutex_unlock(&zn->mutex_tx_queue);
+
+    z_task_join(zn->tx_task);
+    free(zn->tx_task);
+    zn->tx_task = NULL;
+
+    // Send the messages committed by the publishers that were racing with the stop
+    _zn_tx_entry_t *e;
+    int is_pending = 0;
+    while ((e = (_zn_tx_entry_t *)z_lf_queue_pull(zn->tx_queue)) != NULL)
+    {
+        __zn_tx_entry_send(zn, e);
+        is_pending = 1;
+    }
+    if (is_pending)
+        __zn_tx_flush(zn);
+
+    return 0;
+}
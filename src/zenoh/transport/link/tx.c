@@ -18,24 +18,30 @@
 #include "zenoh-pico/transport/private/utils.h"
 
 /*------------------ SN helper ------------------*/
+_zn_conduit_t *_zn_get_conduit(zn_session_t *zn, zn_priority_t priority)
+{
+    // Without QoS all the priorities share the first conduit
+    return zn->is_qos ? &zn->conduits[priority] : &zn->conduits[0];
+}
+
 /**
  * This function is unsafe because it operates in potentially concurrent data.
  * Make sure that the following mutexes are locked before calling this function:
- *  - zn->mutex_inner
+ *  - zn->mutex_tx
  */
-z_zint_t __unsafe_zn_get_sn(zn_session_t *zn, zn_reliability_t reliability)
+z_zint_t __unsafe_zn_get_sn(zn_session_t *zn, _zn_conduit_t *c, zn_reliability_t reliability)
 {
     z_zint_t sn;
     // Get the sequence number and update it in modulo operation
     if (reliability == zn_reliability_t_RELIABLE)
     {
-        sn = zn->sn_tx_reliable;
-        zn->sn_tx_reliable = (zn->sn_tx_reliable + 1) % zn->sn_resolution;
+        sn = c->sn_tx_reliable;
+        c->sn_tx_reliable = (c->sn_tx_reliable + 1) % zn->sn_resolution;
     }
     else
     {
-        sn = zn->sn_tx_best_effort;
-        zn->sn_tx_best_effort = (zn->sn_tx_best_effort + 1) % zn->sn_resolution;
+        sn = c->sn_tx_best_effort;
+        c->sn_tx_best_effort = (c->sn_tx_best_effort + 1) % zn->sn_resolution;
     }
     return sn;
 }
@@ -91,6 +97,302 @@ void __unsafe_zn_finalize_wbuf(_z_wbuf_t *buf, int is_streamed)
     }
 }
 
+/*------------------ Batching helper ------------------*/
+size_t _zn_link_wbuf_capacity(const _zn_link_t *link)
+{
+    // A frame lost on a datagram link costs a single datagram only if IP does not fragment it
+    if (link->is_streamed || link->mtu >= ZN_BATCH_SIZE)
+        return ZN_WRITE_BUF_LEN;
+    // The frames must still leave room for the fragments
+    if (link->mtu < ZN_LINK_MTU_MIN)
+        return ZN_LINK_MTU_MIN;
+    return link->mtu;
+}
+
+/**
+ * This function is unsafe because it operates in potentially concurrent data.
+ * Make sure that the following mutexes are locked before calling this function:
+ *  - zn->mutex_tx
+ */
+_z_wbuf_t *__unsafe_zn_conduit_wbuf(zn_session_t *zn, _zn_conduit_t *c)
+{
+    // The buffers of the priority conduits are only allocated when used
+    if (c->wbuf == NULL)
+    {
+        c->wbuf = (_z_wbuf_t *)malloc(sizeof(_z_wbuf_t));
+        *c->wbuf = _z_wbuf_make(_zn_link_wbuf_capacity(zn->link), 0);
+    }
+    return c->wbuf;
+}
+
+/**
+ * This function is unsafe because it operates in potentially concurrent data.
+ * Make sure that the following mutexes are locked before calling this function:
+ *  - zn->mutex_tx
+ */
+int __unsafe_zn_flush_conduit(zn_session_t *zn, _zn_conduit_t *c)
+{
+    if (!c->batch_is_open)
+        return 0;
+
+    // Close the batch, any following message will be serialized on a new frame
+    c->batch_is_open = 0;
+
+    // Account for the batch in the batch size distribution
+    size_t bucket = 0;
+    while ((c->batch_msgs >> (bucket + 1)) > 0 && bucket < ZN_BATCH_STATS_BUCKETS - 1)
+        bucket++;
+    zn->batch_stats.hist[bucket]++;
+    zn->batch_stats.batches++;
+    zn->batch_stats.messages += c->batch_msgs;
+    zn->batch_stats.bytes += _z_wbuf_len(c->wbuf);
+
+    // Write the message length in the reserved space if needed
+    __unsafe_zn_finalize_wbuf(c->wbuf, zn->link->is_streamed);
+
+    // Keep the reliable frame until it is acknowledged
+    if (c->batch_reliability == zn_reliability_t_RELIABLE)
+        __unsafe_zn_keep_frame(zn, c, c->batch_sn, c->wbuf);
+
+    // Send the wbuf on the socket
+    int res = _zn_send_wbuf(zn->link, c->wbuf);
+    if (res == 0)
+        // Mark the session that we have transmitted data
+        zn->transmitted = 1;
+
+    return res;
+}
+
+/**
+ * This function is unsafe because it operates in potentially concurrent data.
+ * Make sure that the following mutexes are locked before calling this function:
+ *  - zn->mutex_tx
+ */
+int __unsafe_zn_flush_batch(zn_session_t *zn)
+{
+    // Send the open batches from the highest to the lowest priority
+    int res = 0;
+    for (int i = 0; i < _ZN_PRIORITIES_NUM; i++)
+    {
+        if (__unsafe_zn_flush_conduit(zn, &zn->conduits[i]) != 0)
+            res = -1;
+    }
+    return res;
+}
+
+int _zn_flush_batch(zn_session_t *zn)
+{
+    // Acquire the lock
+    z_mutex_lock(&zn->mutex_tx);
+    // A held batch is only sent upon explicit flush
+    int res = 0;
+    if (!zn->batch_is_held)
+        res = __unsafe_zn_flush_batch(zn);
+    // Release the lock
+    z_mutex_unlock(&zn->mutex_tx);
+    return res;
+}
+
+int _zn_batch_begin(zn_session_t *zn)
+{
+    // Acquire the lock
+    z_mutex_lock(&zn->mutex_tx);
+    // Keep the batch open across the following writes
+    zn->batch_is_held = 1;
+    // Release the lock
+    z_mutex_unlock(&zn->mutex_tx);
+    return 0;
+}
+
+int _zn_batch_flush(zn_session_t *zn)
+{
+    // Acquire the lock
+    z_mutex_lock(&zn->mutex_tx);
+    zn->batch_is_held = 0;
+    int res = __unsafe_zn_flush_batch(zn);
+    // Release the lock
+    z_mutex_unlock(&zn->mutex_tx);
+    return res;
+}
+
+/**
+ * This function is unsafe because it operates in potentially concurrent data.
+ * Make sure that the following mutexes are locked before calling this function:
+ *  - zn->mutex_tx
+ */
+int __unsafe_zn_batch_z_msg(_zn_conduit_t *c, _zn_zenoh_message_t *z_msg, zn_reliability_t reliability)
+{
+    if (!c->batch_is_open)
+        return -1;
+
+    // A frame carries messages of a single reliability channel
+    if (c->batch_reliability != reliability)
+        return -1;
+
+    // Mark the buffer for the writing operation
+    size_t w_pos = _z_wbuf_get_wpos(c->wbuf);
+    // Append the zenoh message to the open frame
+    int res = _zn_zenoh_message_encode(c->wbuf, z_msg);
+    if (res == 0)
+        c->batch_msgs++;
+    else
+        // The message does not fit in the current batch, revert the buffer
+        _z_wbuf_set_wpos(c->wbuf, w_pos);
+
+    return res;
+}
+
+/**
+ * This function is unsafe because it operates in potentially concurrent data.
+ * Make sure that the following mutexes are locked before calling this function:
+ *  - zn->mutex_tx
+ */
+void __unsafe_zn_open_batch(_zn_conduit_t *c, zn_reliability_t reliability)
+{
+    // Keep the frame open for the following messages
+    c->batch_is_open = 1;
+    c->batch_msgs = 1;
+    c->batch_reliability = reliability;
+    c->batch_start = z_clock_now();
+}
+
+/**
+ * This function is unsafe because it operates in potentially concurrent data.
+ * Make sure that the following mutexes are locked before calling this function:
+ *  - zn->mutex_tx
+ */
+int __unsafe_zn_link_is_busy(zn_session_t *zn)
+{
+    // Other writers are waiting to send their messages
+    for (int i = 0; i < _ZN_PRIORITIES_NUM; i++)
+    {
+        if (__atomic_load_n(&zn->tx_waiting[i], __ATOMIC_SEQ_CST) > 0)
+            return 1;
+    }
+
+    // The previous writes are still in flight
+    return zn->link->pending_f != NULL && zn->link->pending_f(zn->link) > 0;
+}
+
+/**
+ * This function is unsafe because it operates in potentially concurrent data.
+ * Make sure that the following mutexes are locked before calling this function:
+ *  - zn->mutex_tx
+ */
+int __unsafe_zn_batch_is_due(zn_session_t *zn, _zn_conduit_t *c, int is_express)
+{
+    // Send the batch right away for express messages or if the deadline has passed.
+    // A held batch is only subject to the deadline once it is explicitly flushed.
+    if (is_express)
+        return 1;
+    if (zn->batch_is_held)
+        return 0;
+    if (zn->batch_timeout > 0 && z_clock_elapsed_ms(&c->batch_start) >= zn->batch_timeout)
+        return 1;
+
+    // Like Nagle's algorithm, the adaptive batching only coalesces messages while the link is busy
+    return zn->batch_is_adaptive && !__unsafe_zn_link_is_busy(zn);
+}
+
+/*------------------ Preemption helper ------------------*/
+// NOTE: A fragmented message holds the tx mutex until its last fragment is sent. Between two
+//       fragments the writer lets the messages waiting on a higher priority conduit go first.
+//       The other writers of the same conduit are kept out while the message is incomplete,
+//       since the fragments need consecutive sequence numbers on their conduit.
+int __zn_conduit_id(zn_session_t *zn, zn_priority_t priority)
+{
+    return (int)(_zn_get_conduit(zn, priority) - zn->conduits);
+}
+
+int __zn_has_preemptors(zn_session_t *zn, int cid)
+{
+    for (int i = 0; i < cid; i++)
+    {
+        if (__atomic_load_n(&zn->tx_waiting[i], __ATOMIC_SEQ_CST) > 0)
+            return 1;
+    }
+    return 0;
+}
+
+int _zn_lock_tx(zn_session_t *zn, zn_priority_t priority, zn_congestion_control_t cong_ctrl)
+{
+    int cid = __zn_conduit_id(zn, priority);
+
+    if (z_mutex_trylock(&zn->mutex_tx) != 0)
+    {
+        // Drop the message if needed, unless a lower priority message is being fragmented:
+        // in that case the fragmentation will be suspended to let the message go first
+        int frag_cid = zn->tx_frag_cid;
+        if (cong_ctrl == zn_congestion_control_t_DROP && (frag_cid < 0 || frag_cid <= cid))
+            return -1;
+
+        __atomic_add_fetch(&zn->tx_waiting[cid], 1, __ATOMIC_SEQ_CST);
+        z_mutex_lock(&zn->mutex_tx);
+        // Wake up the suspended fragmentation, it resumes once the lock is released
+        if (__atomic_sub_fetch(&zn->tx_waiting[cid], 1, __ATOMIC_SEQ_CST) == 0)
+            z_condvar_broadcast(&zn->tx_preempted);
+    }
+
+    // Wait for the fragmented message suspended on the same conduit, if any
+    while (zn->tx_cid_busy & (1u << cid))
+    {
+        if (cong_ctrl == zn_congestion_control_t_DROP)
+        {
+            z_mutex_unlock(&zn->mutex_tx);
+            return -1;
+        }
+        z_condvar_wait(&zn->tx_cid_free, &zn->mutex_tx);
+    }
+
+    return 0;
+}
+
+/**
+ * This function is unsafe because it operates in potentially concurrent data.
+ * Make sure that the following mutexes are locked before calling this function:
+ *  - zn->mutex_tx
+ */
+void __unsafe_zn_yield_fragments(zn_session_t *zn, int cid)
+{
+    if (!__zn_has_preemptors(zn, cid))
+        return;
+
+    // Send the queued fragments, the preempting messages must not be queued behind the others
+    int is_corked = zn->link->is_corked;
+    if (_zn_uncork_link(zn->link) != 0)
+        _Z_DEBUG("Error while sending the queued fragments\n");
+
+    // Keep the other writers of the conduit out until the message is complete, and
+    // release the lock until the preempting writers have all acquired it
+    zn->tx_cid_busy |= 1u << cid;
+    while (__zn_has_preemptors(zn, cid))
+        z_condvar_wait(&zn->tx_preempted, &zn->mutex_tx);
+
+    if (is_corked)
+        _zn_cork_link(zn->link);
+
+    // A preempting message may have been fragmented in the meanwhile
+    zn->tx_frag_cid = cid;
+}
+
+/**
+ * This function is unsafe because it operates in potentially concurrent data.
+ * Make sure that the following mutexes are locked before calling this function:
+ *  - zn->mutex_tx
+ */
+void __unsafe_zn_end_fragments(zn_session_t *zn, int cid)
+{
+    zn->tx_frag_cid = -1;
+
+    // Wake up the writers of the conduit kept out during the fragmentation
+    if (zn->tx_cid_busy & (1u << cid))
+    {
+        zn->tx_cid_busy &= ~(1u << cid);
+        z_condvar_broadcast(&zn->tx_cid_free);
+    }
+}
+
+/*------------------ Transmission ------------------*/
 int _zn_send_t_msg(zn_session_t *zn, _zn_transport_message_t *t_msg)
 {
     _Z_DEBUG(">> send session message\n");
@@ -98,6 +400,9 @@ int _zn_send_t_msg(zn_session_t *zn, _zn_transport_message_t *t_msg)
     // Acquire the lock
     z_mutex_lock(&zn->mutex_tx);
 
+    // Send any batched message before reusing the buffer
+    __unsafe_zn_flush_batch(zn);
+
     // Prepare the buffer eventually reserving space for the message length
     __unsafe_zn_prepare_wbuf(&zn->wbuf, zn->link->is_streamed);
 
@@ -123,12 +428,16 @@ int _zn_send_t_msg(zn_session_t *zn, _zn_transport_message_t *t_msg)
     return res;
 }
 
-_zn_transport_message_t __zn_frame_header(zn_reliability_t reliability, int is_fragment, int is_final, z_zint_t sn)
+_zn_transport_message_t __zn_frame_header(zn_session_t *zn, zn_priority_t priority, zn_reliability_t reliability, int is_fragment, int is_final, z_zint_t sn)
 {
     // Create the frame session message that carries the zenoh message
     _zn_transport_message_t t_msg = _zn_transport_message_init(_ZN_MID_FRAME);
     t_msg.body.frame.sn = sn;
 
+    // The priority of the frame selects the conduit on the receiving side
+    if (zn->is_qos)
+        t_msg.priority = priority;
+
     if (reliability == zn_reliability_t_RELIABLE)
         _ZN_SET_FLAG(t_msg.header, _ZN_FLAG_T_R);
 
@@ -159,7 +468,35 @@ _zn_transport_message_t __zn_frame_header(zn_reliability_t reliability, int is_f
  * Make sure that the following mutexes are locked before calling this function:
  *  - zn->mutex_tx
  */
-int __unsafe_zn_serialize_zenoh_fragment(_z_wbuf_t *dst, _z_wbuf_t *src, zn_reliability_t reliability, size_t sn)
+int __unsafe_zn_open_frame(zn_session_t *zn, zn_priority_t priority, zn_reliability_t reliability, z_zint_t *sn)
+{
+    _zn_conduit_t *c = _zn_get_conduit(zn, priority);
+
+    // Send the pending messages of the conduit first
+    int res = __unsafe_zn_flush_conduit(zn, c);
+    if (res != 0)
+        return res;
+
+    // Prepare the buffer eventually reserving space for the message length
+    _z_wbuf_t *wbf = __unsafe_zn_conduit_wbuf(zn, c);
+    __unsafe_zn_prepare_wbuf(wbf, zn->link->is_streamed);
+
+    // Get the next sequence number
+    *sn = __unsafe_zn_get_sn(zn, c, reliability);
+    c->batch_sn = *sn;
+    // Create the frame header that carries the zenoh message
+    _zn_transport_message_t t_msg = __zn_frame_header(zn, priority, reliability, 0, 0, *sn);
+
+    // Encode the frame header
+    return _zn_transport_message_encode(wbf, &t_msg);
+}
+
+/**
+ * This function is unsafe because it operates in potentially concurrent data.
+ * Make sure that the following mutexes are locked before calling this function:
+ *  - zn->mutex_tx
+ */
+int __unsafe_zn_serialize_zenoh_fragment(zn_session_t *zn, _z_wbuf_t *dst, _z_wbuf_t *src, zn_priority_t priority, zn_reliability_t reliability, size_t sn)
 {
     // Assume first that this is not the final fragment
     int is_final = 0;
@@ -168,7 +505,7 @@ int __unsafe_zn_serialize_zenoh_fragment(_z_wbuf_t *dst, _z_wbuf_t *src, zn_reli
         // Mark the buffer for the writing operation
         size_t w_pos = _z_wbuf_get_wpos(dst);
         // Get the frame header
-        _zn_transport_message_t f_hdr = __zn_frame_header(reliability, 1, is_final, sn);
+        _zn_transport_message_t f_hdr = __zn_frame_header(zn, priority, reliability, 1, is_final, sn);
         // Encode the frame header
         int res = _zn_transport_message_encode(dst, &f_hdr);
         if (res == 0)
@@ -184,65 +521,301 @@ int __unsafe_zn_serialize_zenoh_fragment(_z_wbuf_t *dst, _z_wbuf_t *src, zn_reli
                 is_final = 1;
                 continue;
             }
-            // Write the fragment
+            // Write the fragment, the message can not be fragmented if no byte fits
             size_t to_copy = bytes_left <= space_left ? bytes_left : space_left;
+            if (to_copy == 0)
+                return -1;
             return _z_wbuf_copy_into(dst, src, to_copy);
         }
         else
         {
-            return 0;
+            return res;
         }
     } while (1);
 }
 
-int _zn_send_z_msg(zn_session_t *zn, _zn_zenoh_message_t *z_msg, zn_reliability_t reliability, zn_congestion_control_t cong_ctrl)
+/**
+ * This function is unsafe because it operates in potentially concurrent data.
+ * Make sure that the following mutexes are locked before calling this function:
+ *  - zn->mutex_tx
+ */
+int __unsafe_zn_send_zenoh_fragments(zn_session_t *zn, _z_wbuf_t *fbf, zn_priority_t priority, zn_reliability_t reliability, z_zint_t sn)
 {
-    _Z_DEBUG(">> send zenoh message\n");
+    _zn_conduit_t *c = _zn_get_conduit(zn, priority);
+    int cid = __zn_conduit_id(zn, priority);
+    zn->tx_frag_cid = cid;
+
+    // Send all the fragments at once if the link can queue them
+    int is_corked = zn->link->is_corked;
+    _zn_cork_link(zn->link);
+
+    // Fragment and send the message
+    int res = 0;
+    int is_first = 1;
+    while (_z_wbuf_len(fbf) > 0)
+    {
+        // Get the fragment sequence number
+        if (!is_first)
+        {
+            __unsafe_zn_yield_fragments(zn, cid);
+            sn = __unsafe_zn_get_sn(zn, c, reliability);
+        }
+        is_first = 0;
 
-    // Acquire the lock and drop the message if needed
-    if (cong_ctrl == zn_congestion_control_t_BLOCK)
+        // Clear the buffer for serialization
+        __unsafe_zn_prepare_wbuf(c->wbuf, zn->link->is_streamed);
+
+        // Serialize one fragment
+        res = __unsafe_zn_serialize_zenoh_fragment(zn, c->wbuf, fbf, priority, reliability, sn);
+        if (res != 0)
+        {
+            _Z_DEBUG("Dropping zenoh message because it can not be fragmented\n");
+            break;
+        }
+
+        // Write the message length in the reserved space if needed
+        __unsafe_zn_finalize_wbuf(c->wbuf, zn->link->is_streamed);
+
+        // Keep the reliable fragment until it is acknowledged
+        if (reliability == zn_reliability_t_RELIABLE)
+            __unsafe_zn_keep_frame(zn, c, sn, c->wbuf);
+
+        // Send the wbuf on the socket
+        res = _zn_send_wbuf(zn->link, c->wbuf);
+        if (res != 0)
+        {
+            _Z_DEBUG("Dropping zenoh message because it can not sent\n");
+            break;
+        }
+
+        // Mark the session that we have transmitted data
+        zn->transmitted = 1;
+    }
+
+    if (!is_corked && _zn_uncork_link(zn->link) != 0)
+        res = -1;
+
+    __unsafe_zn_end_fragments(zn, cid);
+
+    return res;
+}
+
+/**
+ * This function is unsafe because it operates in potentially concurrent data.
+ * Make sure that the following mutexes are locked before calling this function:
+ *  - zn->mutex_tx
+ */
+int __unsafe_zn_stream_zenoh_fragments(zn_session_t *zn, _z_wbuf_t *pbf, const uint8_t *payload, size_t len, zn_priority_t priority, zn_reliability_t reliability, z_zint_t sn)
+{
+    // The prefix holds everything but the payload, complete it with the payload length
+    // so that the message size is known up front
+    int res = _z_zint_encode(pbf, len);
+    if (res != 0)
     {
-        z_mutex_lock(&zn->mutex_tx);
+        _Z_DEBUG("Dropping zenoh message because it can not be fragmented\n");
+        return res;
     }
-    else
+
+    _zn_conduit_t *c = _zn_get_conduit(zn, priority);
+    int cid = __zn_conduit_id(zn, priority);
+    zn->tx_frag_cid = cid;
+
+    // Send all the fragments at once if the link can queue them
+    int is_corked = zn->link->is_corked;
+    _zn_cork_link(zn->link);
+
+    size_t pld_left = len;
+
+    // Each fragment is sent as the frame header and the remaining prefix bytes
+    // serialized on the conduit buffer, followed by a slice of the user payload
+    _z_wbuf_t frag = _z_wbuf_make(0, 1);
+
+    int is_first = 1;
+    while (res == 0 && (_z_wbuf_len(pbf) > 0 || pld_left > 0))
     {
-        int locked = z_mutex_trylock(&zn->mutex_tx);
-        if (locked != 0)
+        // Get the fragment sequence number
+        if (!is_first)
         {
-            _Z_DEBUG("Dropping zenoh message because of congestion control\n");
-            // We failed to acquire the lock, drop the message
-            return 0;
+            __unsafe_zn_yield_fragments(zn, cid);
+            sn = __unsafe_zn_get_sn(zn, c, reliability);
         }
+        is_first = 0;
+
+        // Clear the buffer for serialization
+        __unsafe_zn_prepare_wbuf(c->wbuf, zn->link->is_streamed);
+
+        // Encode the frame header, assume first that this is not the final fragment
+        size_t w_pos = _z_wbuf_get_wpos(c->wbuf);
+        _zn_transport_message_t f_hdr = __zn_frame_header(zn, priority, reliability, 1, 0, sn);
+        res = _zn_transport_message_encode(c->wbuf, &f_hdr);
+        if (res != 0)
+            break;
+
+        size_t pfx_left = _z_wbuf_len(pbf);
+        if (pfx_left + pld_left <= _z_wbuf_space_left(c->wbuf))
+        {
+            // It is really the final fragment, reserialize the header
+            _z_wbuf_set_wpos(c->wbuf, w_pos);
+            f_hdr = __zn_frame_header(zn, priority, reliability, 1, 1, sn);
+            res = _zn_transport_message_encode(c->wbuf, &f_hdr);
+            if (res != 0)
+                break;
+        }
+
+        // Serialize what is left of the prefix
+        size_t space_left = _z_wbuf_space_left(c->wbuf);
+        size_t to_copy = pfx_left <= space_left ? pfx_left : space_left;
+        res = _z_wbuf_copy_into(c->wbuf, pbf, to_copy);
+        if (res != 0)
+            break;
+        space_left -= to_copy;
+
+        size_t chunk = pld_left <= space_left ? pld_left : space_left;
+        if (to_copy == 0 && chunk == 0)
+        {
+            res = -1;
+            break;
+        }
+
+        _z_wbuf_reset(&frag);
+        if (!zn->link->is_streamed && zn->link->writev_f == NULL)
+        {
+            // A datagram link must send the fragment in a single write, copy the payload chunk
+            _z_wbuf_write_bytes(c->wbuf, payload, 0, chunk);
+            _z_wbuf_add_iosli_wrap(&frag, _z_wbuf_get_iosli(c->wbuf, 0)->buf, _z_wbuf_len(c->wbuf));
+        }
+        else
+        {
+            // Reference the payload chunk without copying it
+            _z_wbuf_add_iosli_wrap(&frag, _z_wbuf_get_iosli(c->wbuf, 0)->buf, _z_wbuf_len(c->wbuf));
+            if (chunk > 0)
+                _z_wbuf_add_iosli_wrap(&frag, (uint8_t *)payload, chunk);
+        }
+
+        // Write the fragment length in the reserved space if needed
+        __unsafe_zn_finalize_wbuf(&frag, zn->link->is_streamed);
+
+        // Keep the reliable fragment until it is acknowledged
+        if (reliability == zn_reliability_t_RELIABLE)
+            __unsafe_zn_keep_frame(zn, c, sn, &frag);
+
+        // Send the fragment on the socket
+        res = _zn_send_wbuf(zn->link, &frag);
+        if (res != 0)
+        {
+            _Z_DEBUG("Dropping zenoh message because it can not sent\n");
+            break;
+        }
+
+        // Mark the session that we have transmitted data
+        zn->transmitted = 1;
+
+        payload += chunk;
+        pld_left -= chunk;
     }
 
-    // Prepare the buffer eventually reserving space for the message length
-    __unsafe_zn_prepare_wbuf(&zn->wbuf, zn->link->is_streamed);
+    _z_wbuf_free(&frag);
 
-    // Get the next sequence number
-    z_zint_t sn = __unsafe_zn_get_sn(zn, reliability);
-    // Create the frame header that carries the zenoh message
-    _zn_transport_message_t t_msg = __zn_frame_header(reliability, 0, 0, sn);
+    if (!is_corked && _zn_uncork_link(zn->link) != 0)
+        res = -1;
 
-    // Encode the frame header
-    int res = _zn_transport_message_encode(&zn->wbuf, &t_msg);
+    __unsafe_zn_end_fragments(zn, cid);
+
+    return res;
+}
+
+/**
+ * This function is unsafe because it operates in potentially concurrent data.
+ * Make sure that the following mutexes are locked before calling this function:
+ *  - zn->mutex_tx
+ */
+int __unsafe_zn_send_encoded_z_msg(zn_session_t *zn, _z_wbuf_t *src, zn_priority_t priority, zn_reliability_t reliability)
+{
+    _zn_conduit_t *c = _zn_get_conduit(zn, priority);
+    size_t len = _z_wbuf_len(src);
+
+    // Try to append the message to the open batch
+    if (c->batch_is_open && c->batch_reliability == reliability && len <= _z_wbuf_space_left(c->wbuf))
+    {
+        c->batch_msgs++;
+        return _z_wbuf_copy_into(c->wbuf, src, len);
+    }
+
+    // The message can not be batched, open a new frame
+    z_zint_t sn;
+    int res = __unsafe_zn_open_frame(zn, priority, reliability, &sn);
+    if (res != 0)
+        return res;
+
+    if (len <= _z_wbuf_space_left(c->wbuf))
+    {
+        __unsafe_zn_open_batch(c, reliability);
+        return _z_wbuf_copy_into(c->wbuf, src, len);
+    }
+
+    // The message does not fit in a frame, let's fragment it
+    return __unsafe_zn_send_zenoh_fragments(zn, src, priority, reliability, sn);
+}
+
+int _zn_send_z_msg(zn_session_t *zn, _zn_zenoh_message_t *z_msg, zn_reliability_t reliability, zn_congestion_control_t cong_ctrl, int is_express)
+{
+    _Z_DEBUG(">> send zenoh message\n");
+
+    // Hand the message over to the tx task if running
+    if (zn->tx_task_running)
+        return _zn_tx_queue_push(zn, z_msg, reliability, cong_ctrl, is_express);
+
+    // Acquire the lock and drop the message if needed
+    zn_priority_t priority = z_msg->priority;
+    if (_zn_lock_tx(zn, priority, cong_ctrl) != 0)
+    {
+        _Z_DEBUG("Dropping zenoh message because of congestion control\n");
+        // We failed to acquire the lock, drop the message
+        return 0;
+    }
+
+    _zn_conduit_t *c = _zn_get_conduit(zn, priority);
+
+    int res;
+    int is_batching = zn->batching || zn->batch_is_held;
+    if (is_batching)
+    {
+        // Try to append the message to the open batch
+        res = __unsafe_zn_batch_z_msg(c, z_msg, reliability);
+        if (res == 0)
+            goto EXIT_ZBATCH_PROC;
+    }
+
+    // The message can not be batched, open a new frame
+    z_zint_t sn;
+    res = __unsafe_zn_open_frame(zn, priority, reliability, &sn);
     if (res != 0)
     {
         _Z_DEBUG("Dropping zenoh message because the session frame can not be encoded\n");
         goto EXIT_ZSND_PROC;
     }
 
+    // Data messages whose payload alone exceeds the frame are streamed in fragments
+    // straight from the user payload, without encoding them first
+    if (_ZN_MID(z_msg->header) == _ZN_MID_DATA && z_msg->body.data.payload.len >= _z_wbuf_space_left(c->wbuf))
+    {
+        // Encode everything but the payload, the payload is streamed from the user buffer
+        _z_wbuf_t pbf = _z_wbuf_make(ZN_FRAG_BUF_TX_CHUNK, 1);
+        res = _zn_zenoh_message_encode_prefix(&pbf, z_msg);
+        if (res == 0)
+            res = __unsafe_zn_stream_zenoh_fragments(zn, &pbf, z_msg->body.data.payload.val, z_msg->body.data.payload.len, priority, reliability, sn);
+        else
+            _Z_DEBUG("Dropping zenoh message because it can not be fragmented\n");
+        _z_wbuf_free(&pbf);
+        goto EXIT_ZSND_PROC;
+    }
+
     // Encode the zenoh message
-    res = _zn_zenoh_message_encode(&zn->wbuf, z_msg);
+    res = _zn_zenoh_message_encode(c->wbuf, z_msg);
     if (res == 0)
     {
-        // Write the message legnth in the reserved space if needed
-        __unsafe_zn_finalize_wbuf(&zn->wbuf, zn->link->is_streamed);
-
-        // Send the wbuf on the socket
-        res = _zn_send_wbuf(zn->link, &zn->wbuf);
-        if (res == 0)
-            // Mark the session that we have transmitted data
-            zn->transmitted = 1;
+        __unsafe_zn_open_batch(c, reliability);
+        goto EXIT_ZBATCH_PROC;
     }
     else
     {
@@ -252,53 +825,94 @@ int _zn_send_z_msg(zn_session_t *zn, _zn_zenoh_message_t *z_msg, zn_reliability_
 
         // Encode the message on the expandable wbuf
         res = _zn_zenoh_message_encode(&fbf, z_msg);
-        if (res != 0)
-        {
+        if (res == 0)
+            res = __unsafe_zn_send_zenoh_fragments(zn, &fbf, priority, reliability, sn);
+        else
             _Z_DEBUG("Dropping zenoh message because it can not be fragmented");
-            goto EXIT_FRAG_PROC;
-        }
 
-        // Fragment and send the message
-        int is_first = 1;
-        while (_z_wbuf_len(&fbf) > 0)
-        {
-            // Get the fragment sequence number
-            if (!is_first)
-                sn = __unsafe_zn_get_sn(zn, reliability);
-            is_first = 0;
+        // Free the fragmentation buffer memory
+        _z_wbuf_free(&fbf);
+    }
+    goto EXIT_ZSND_PROC;
 
-            // Clear the buffer for serialization
-            __unsafe_zn_prepare_wbuf(&zn->wbuf, zn->link->is_streamed);
+EXIT_ZBATCH_PROC:
+    // Without batching the frame is sent right away
+    if (!is_batching || __unsafe_zn_batch_is_due(zn, c, is_express))
+        res = __unsafe_zn_flush_conduit(zn, c);
 
-            // Serialize one fragment
-            res = __unsafe_zn_serialize_zenoh_fragment(&zn->wbuf, &fbf, reliability, sn);
-            if (res != 0)
-            {
-                _Z_DEBUG("Dropping zenoh message because it can not be fragmented\n");
-                goto EXIT_FRAG_PROC;
-            }
+EXIT_ZSND_PROC:
+    // Release the lock
+    z_mutex_unlock(&zn->mutex_tx);
 
-            // Write the message length in the reserved space if needed
-            __unsafe_zn_finalize_wbuf(&zn->wbuf, zn->link->is_streamed);
+    return res;
+}
 
-            // Send the wbuf on the socket
-            res = _zn_send_wbuf(zn->link, &zn->wbuf);
-            if (res != 0)
-            {
-                _Z_DEBUG("Dropping zenoh message because it can not sent\n");
-                goto EXIT_FRAG_PROC;
-            }
+int _zn_send_preencoded_data(zn_session_t *zn, const z_bytes_t *prefix, const uint8_t *payload, size_t len, zn_priority_t priority, zn_reliability_t reliability, zn_congestion_control_t cong_ctrl, int is_express)
+{
+    _Z_DEBUG(">> send pre-encoded data message\n");
+
+    // Hand the message over to the tx task if running
+    if (zn->tx_task_running)
+        return _zn_tx_queue_push_preencoded(zn, prefix, payload, len, priority, reliability, cong_ctrl, is_express);
+
+    // Acquire the lock and drop the message if needed
+    if (_zn_lock_tx(zn, priority, cong_ctrl) != 0)
+    {
+        _Z_DEBUG("Dropping zenoh message because of congestion control\n");
+        // We failed to acquire the lock, drop the message
+        return 0;
+    }
 
-            // Mark the session that we have transmitted data
-            zn->transmitted = 1;
+    _zn_conduit_t *c = _zn_get_conduit(zn, priority);
+
+    int res;
+    int is_batching = zn->batching || zn->batch_is_held;
+    if (is_batching && c->batch_is_open && c->batch_reliability == reliability)
+    {
+        // Try to append the message to the open batch
+        size_t w_pos = _z_wbuf_get_wpos(c->wbuf);
+        res = _zn_zenoh_message_encode_preencoded(c->wbuf, prefix, payload, len);
+        if (res == 0)
+        {
+            c->batch_msgs++;
+            goto EXIT_PBATCH_PROC;
         }
+        _z_wbuf_set_wpos(c->wbuf, w_pos);
+    }
 
-    EXIT_FRAG_PROC:
-        // Free the fragmentation buffer memory
-        _z_wbuf_free(&fbf);
+    // The message can not be batched, open a new frame
+    z_zint_t sn;
+    res = __unsafe_zn_open_frame(zn, priority, reliability, &sn);
+    if (res != 0)
+    {
+        _Z_DEBUG("Dropping zenoh message because the session frame can not be encoded\n");
+        goto EXIT_PSND_PROC;
     }
 
-EXIT_ZSND_PROC:
+    // Append the pre-encoded message and the payload
+    res = _zn_zenoh_message_encode_preencoded(c->wbuf, prefix, payload, len);
+    if (res == 0)
+    {
+        __unsafe_zn_open_batch(c, reliability);
+        goto EXIT_PBATCH_PROC;
+    }
+    else
+    {
+        // The message does not fit in a frame, stream it in fragments
+        _z_wbuf_t pbf = _z_wbuf_make(ZN_FRAG_BUF_TX_CHUNK, 1);
+        res = _z_wbuf_write_bytes(&pbf, prefix->val, 0, prefix->len);
+        if (res == 0)
+            res = __unsafe_zn_stream_zenoh_fragments(zn, &pbf, payload, len, priority, reliability, sn);
+        _z_wbuf_free(&pbf);
+    }
+    goto EXIT_PSND_PROC;
+
+EXIT_PBATCH_PROC:
+    // Without batching the frame is sent right away
+    if (!is_batching || __unsafe_zn_batch_is_due(zn, c, is_express))
+        res = __unsafe_zn_flush_conduit(zn, c);
+
+EXIT_PSND_PROC:
     // Release the lock
     z_mutex_unlock(&zn->mutex_tx);
 
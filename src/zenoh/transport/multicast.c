@@ -0,0 +1,531 @@
+/*
+ * Copyright (c) 2017, 2021 ADLINK Technology Inc.
+ *
+ * This program and the accompanying materials are made available under the
+ * terms of the Eclipse Public License 2.0 which is available at
+ * http://www.eclipse.org/legal/epl-2.0, or the Apache License, Version 2.0
+ * which is available at https://www.apache.org/licenses/LICENSE-2.0.
+ *
+ * SPDX-License-Identifier: EPL-2.0 OR Apache-2.0
+ *
+ * Contributors:
+ *   ADLINK zenoh team, <zenoh@adlink-labs.tech>
+ */
+
+#include "zenoh-pico/protocol/private/utils.h"
+#include "zenoh-pico/session/private/resource.h"
+#include "zenoh-pico/session/private/utils.h"
+#include "zenoh-pico/system/common.h"
+#include "zenoh-pico/transport/private/utils.h"
+#include "zenoh-pico/utils/collections.h"
+#include "zenoh-pico/utils/private/logging.h"
+
+/*------------------ Peers ------------------*/
+int __zn_bytes_eq(const z_bytes_t *left, const z_bytes_t *right)
+{
+    return left->len == right->len && memcmp(left->val, right->val, left->len) == 0;
+}
+
+/**
+ * This function is unsafe because it operates in potentially concurrent data.
+ * Make sure that the following mutexes are locked before calling this function:
+ *  - zn->mutex_peers
+ */
+_zn_transport_peer_t *__unsafe_zn_get_peer_by_addr(zn_session_t *zn, const z_bytes_t *addr)
+{
+    z_list_t *peers = zn->peers;
+    while (peers)
+    {
+        _zn_transport_peer_t *peer = (_zn_transport_peer_t *)z_list_head(peers);
+
+        if (__zn_bytes_eq(&peer->addr, addr))
+            return peer;
+
+        peers = z_list_tail(peers);
+    }
+
+    return NULL;
+}
+
+_zn_transport_peer_t *__zn_new_peer(const z_bytes_t *addr, const _zn_transport_message_t *t_msg)
+{
+    const _zn_join_t *join = &t_msg->body.join;
+    _zn_transport_peer_t *peer = (_zn_transport_peer_t *)malloc(sizeof(_zn_transport_peer_t));
+
+    // The PID references the reception buffer, keep a copy
+    _z_bytes_copy(&peer->addr, addr);
+    _z_bytes_copy(&peer->pid, &join->pid);
+
+    peer->sn_resolution = _ZN_HAS_FLAG(t_msg->header, _ZN_FLAG_T_S) ? join->sn_resolution : ZN_SN_RESOLUTION_DEFAULT;
+    peer->sn_resolution_half = peer->sn_resolution / 2;
+    peer->lease = join->lease;
+
+    peer->is_qos = join->next_sns.is_qos;
+    for (int i = 0; i < _ZN_PRIORITIES_NUM; i++)
+    {
+        _zn_conduit_t *c = &peer->conduits[i];
+
+        // Initialize the conduit as we had already received a message with a SN equal to next_sn - 1
+        z_zint_t next_sn = join->next_sns.is_qos ? join->next_sns.val.sns[i] : join->next_sns.val.sn;
+        z_zint_t sn_rx = next_sn > 0 ? next_sn - 1 : peer->sn_resolution - 1;
+        c->sn_rx_reliable = sn_rx;
+        c->sn_rx_best_effort = sn_rx;
+        peer->is_best_effort_synced[i] = 0;
+
+        _zn_defrag_init(&c->dbuf_reliable);
+        _zn_defrag_init(&c->dbuf_best_effort);
+
+        // Nothing is sent to a single peer
+        c->sn_tx_reliable = 0;
+        c->sn_tx_best_effort = 0;
+        c->wbuf = NULL;
+        c->batch_is_open = 0;
+        c->batch_msgs = 0;
+        c->batch_reliability = zn_reliability_t_RELIABLE;
+        c->batch_sn = 0;
+
+        // The frames sent to a multicast group are not retransmitted
+        c->tx_window = NULL;
+        c->tx_first = 0;
+        c->tx_count = 0;
+        c->rx_window = NULL;
+        c->rx_count = 0;
+        c->rx_unacked = 0;
+    }
+
+    peer->resources = z_list_empty;
+
+    peer->received = 1;
+    peer->lease_started = 0;
+    peer->lease_deadline = 0;
+
+    return peer;
+}
+
+void __zn_free_peer(_zn_transport_peer_t *peer)
+{
+    _z_bytes_free(&peer->addr);
+    _z_bytes_free(&peer->pid);
+
+    for (int i = 0; i < _ZN_PRIORITIES_NUM; i++)
+    {
+        _zn_defrag_free(&peer->conduits[i].dbuf_reliable);
+        _zn_defrag_free(&peer->conduits[i].dbuf_best_effort);
+    }
+
+    while (peer->resources)
+    {
+        _zn_resource_t *res = (_zn_resource_t *)z_list_head(peer->resources);
+        _zn_reskey_free(&res->key);
+        free(res);
+        peer->resources = z_list_pop(peer->resources);
+    }
+
+    free(peer);
+}
+
+int __zn_same_ptr_predicate(void *other, void *this)
+{
+    return other == this;
+}
+
+/**
+ * This function is unsafe because it operates in potentially concurrent data.
+ * Make sure that the following mutexes are locked before calling this function:
+ *  - zn->mutex_peers
+ */
+void __unsafe_zn_remove_peer(zn_session_t *zn, _zn_transport_peer_t *peer)
+{
+    zn->peers = z_list_remove(zn->peers, __zn_same_ptr_predicate, peer);
+    __zn_free_peer(peer);
+}
+
+void _zn_flush_peers(zn_session_t *zn)
+{
+    z_mutex_lock(&zn->mutex_peers);
+
+    while (zn->peers)
+    {
+        __zn_free_peer((_zn_transport_peer_t *)z_list_head(zn->peers));
+        zn->peers = z_list_pop(zn->peers);
+    }
+
+    z_mutex_unlock(&zn->mutex_peers);
+}
+
+void _zn_expire_peers(zn_session_t *zn, unsigned long now)
+{
+    z_mutex_lock(&zn->mutex_peers);
+
+    z_list_t *peers = zn->peers;
+    while (peers)
+    {
+        _zn_transport_peer_t *peer = (_zn_transport_peer_t *)z_list_head(peers);
+        peers = z_list_tail(peers);
+
+        if (!peer->lease_started)
+        {
+            peer->received = 0;
+            peer->lease_deadline = now + peer->lease;
+            peer->lease_started = 1;
+        }
+        else if (_ZN_TIMER_EXPIRED(now, peer->lease_deadline))
+        {
+            // A silent peer has left the group
+            if (peer->received == 0)
+            {
+                _Z_DEBUG("Removing multicast peer because its lease has expired");
+                __unsafe_zn_remove_peer(zn, peer);
+                continue;
+            }
+
+            peer->received = 0;
+            peer->lease_deadline = now + peer->lease;
+        }
+    }
+
+    z_mutex_unlock(&zn->mutex_peers);
+}
+
+z_string_t _zn_get_peer_pids(zn_session_t *zn)
+{
+    z_mutex_lock(&zn->mutex_peers);
+
+    // The PIDs are hex encoded and separated by commas
+    size_t len = 0;
+    z_list_t *peers = zn->peers;
+    while (peers)
+    {
+        len += 2 * ((_zn_transport_peer_t *)z_list_head(peers))->pid.len + 1;
+        peers = z_list_tail(peers);
+    }
+
+    char *val = (char *)malloc(len + 1);
+    val[0] = '\0';
+    peers = zn->peers;
+    while (peers)
+    {
+        z_string_t pid = _z_string_from_bytes(&((_zn_transport_peer_t *)z_list_head(peers))->pid);
+        if (val[0] != '\0')
+            strcat(val, ",");
+        strcat(val, pid.val);
+        _z_string_free(&pid);
+        peers = z_list_tail(peers);
+    }
+
+    z_mutex_unlock(&zn->mutex_peers);
+
+    z_string_t s;
+    s.val = val;
+    s.len = strlen(val);
+    return s;
+}
+
+/*------------------ Join ------------------*/
+int _zn_send_join(zn_session_t *zn)
+{
+    _zn_transport_message_t t_msg = _zn_transport_message_init(_ZN_MID_JOIN);
+    _zn_join_t *join = &t_msg.body.join;
+
+    join->options = 0;
+    join->version = ZN_PROTO_VERSION;
+    join->whatami = ZN_PEER;
+    join->pid = zn->local_pid;
+    join->lease = ZN_TRANSPORT_LEASE;
+    if (ZN_TRANSPORT_LEASE % 1000 == 0)
+        _ZN_SET_FLAG(t_msg.header, _ZN_FLAG_T_T1);
+    join->sn_resolution = zn->sn_resolution;
+    if (zn->sn_resolution != ZN_SN_RESOLUTION_DEFAULT)
+        _ZN_SET_FLAG(t_msg.header, _ZN_FLAG_T_S);
+
+    // The next reliable SNs of the conduits, the best effort ones are synchronized on reception
+    z_mutex_lock(&zn->mutex_tx);
+    join->next_sns.is_qos = zn->is_qos;
+    if (zn->is_qos)
+    {
+        _ZN_SET_FLAG(join->options, _ZN_OPT_JOIN_QOS);
+        _ZN_SET_FLAG(t_msg.header, _ZN_FLAG_T_O);
+        for (int i = 0; i < _ZN_PRIORITIES_NUM; i++)
+            join->next_sns.val.sns[i] = zn->conduits[i].sn_tx_reliable;
+    }
+    else
+    {
+        join->next_sns.val.sn = zn->conduits[0].sn_tx_reliable;
+    }
+    z_mutex_unlock(&zn->mutex_tx);
+
+    int res = _zn_send_t_msg(zn, &t_msg);
+    _zn_transport_message_free(&t_msg);
+
+    return res;
+}
+
+int __zn_send_local_resources(zn_session_t *zn)
+{
+    // Copy the declarations so that the lock is not held while sending
+    z_mutex_lock(&zn->mutex_inner);
+    unsigned int len = z_list_len(zn->local_resources);
+    if (len == 0)
+    {
+        z_mutex_unlock(&zn->mutex_inner);
+        return 0;
+    }
+
+    _zn_zenoh_message_t z_msg = _zn_zenoh_message_init(_ZN_MID_DECLARE);
+    z_msg.body.declare.declarations.len = len;
+    z_msg.body.declare.declarations.val = (_zn_declaration_t *)malloc(len * sizeof(_zn_declaration_t));
+
+    // The declarations are listed from the latest one, declare the earliest first
+    unsigned int i = len;
+    z_list_t *decls = zn->local_resources;
+    while (decls)
+    {
+        _zn_resource_t *r = (_zn_resource_t *)z_list_head(decls);
+        _zn_declaration_t *d = &z_msg.body.declare.declarations.val[--i];
+        d->header = _ZN_DECL_RESOURCE;
+        d->body.res.id = r->id;
+        d->body.res.key = _zn_reskey_clone(&r->key);
+        if (r->key.rname)
+            _ZN_SET_FLAG(d->header, _ZN_FLAG_Z_K);
+        decls = z_list_tail(decls);
+    }
+    z_mutex_unlock(&zn->mutex_inner);
+
+    int res = _zn_send_z_msg(zn, &z_msg, zn_reliability_t_RELIABLE, zn_congestion_control_t_BLOCK, 1);
+    _zn_zenoh_message_free(&z_msg);
+
+    return res;
+}
+
+/*------------------ Resource keys of the peers ------------------*/
+int __zn_resolve_peer_reskey(_zn_transport_peer_t *peer, zn_reskey_t *key)
+{
+    if (key->rid == ZN_RESOURCE_ID_NONE)
+        return 0;
+
+    // The numerical ids are only meaningful to the peer that declared them
+    z_str_t rname = __zn_get_resource_name_from_list(peer->resources, key);
+    if (rname == NULL)
+        return -1;
+
+    _zn_reskey_free(key);
+    key->rid = ZN_RESOURCE_ID_NONE;
+    key->rname = rname;
+    return 0;
+}
+
+int __zn_resolve_peer_declaration(_zn_transport_peer_t *peer, _zn_declaration_t *decl)
+{
+    switch (_ZN_MID(decl->header))
+    {
+    case _ZN_DECL_RESOURCE:
+    {
+        zn_reskey_t key = _zn_reskey_clone(&decl->body.res.key);
+        if (__zn_resolve_peer_reskey(peer, &key) != 0)
+            return -1;
+
+        // A redeclared id replaces the previous resource
+        _zn_resource_t *res = __zn_get_resource_by_id_from_list(peer->resources, decl->body.res.id);
+        if (res == NULL)
+        {
+            res = (_zn_resource_t *)malloc(sizeof(_zn_resource_t));
+            res->id = decl->body.res.id;
+            peer->resources = z_list_cons(peer->resources, res);
+        }
+        else
+        {
+            _zn_reskey_free(&res->key);
+        }
+        res->key = key;
+        return 0;
+    }
+    case _ZN_DECL_FORGET_RESOURCE:
+    {
+        _zn_resource_t *res = __zn_get_resource_by_id_from_list(peer->resources, decl->body.forget_res.rid);
+        if (res != NULL)
+        {
+            peer->resources = z_list_remove(peer->resources, __zn_same_ptr_predicate, res);
+            _zn_reskey_free(&res->key);
+            free(res);
+        }
+        return 0;
+    }
+    case _ZN_DECL_PUBLISHER:
+        return __zn_resolve_peer_reskey(peer, &decl->body.pub.key);
+    case _ZN_DECL_SUBSCRIBER:
+        return __zn_resolve_peer_reskey(peer, &decl->body.sub.key);
+    case _ZN_DECL_QUERYABLE:
+        return __zn_resolve_peer_reskey(peer, &decl->body.qle.key);
+    case _ZN_DECL_FORGET_PUBLISHER:
+        return __zn_resolve_peer_reskey(peer, &decl->body.forget_pub.key);
+    case _ZN_DECL_FORGET_SUBSCRIBER:
+        return __zn_resolve_peer_reskey(peer, &decl->body.forget_sub.key);
+    case _ZN_DECL_FORGET_QUERYABLE:
+        return __zn_resolve_peer_reskey(peer, &decl->body.forget_qle.key);
+    default:
+        return -1;
+    }
+}
+
+int _zn_handle_peer_zenoh_message(zn_session_t *zn, _zn_transport_peer_t *peer, _zn_zenoh_message_t *z_msg)
+{
+    // Replace the resource ids of the peer with the complete resource names
+    int res = 0;
+    switch (_ZN_MID(z_msg->header))
+    {
+    case _ZN_MID_DATA:
+        res = __zn_resolve_peer_reskey(peer, &z_msg->body.data.key);
+        break;
+    case _ZN_MID_QUERY:
+        res = __zn_resolve_peer_reskey(peer, &z_msg->body.query.key);
+        break;
+    case _ZN_MID_PULL:
+        res = __zn_resolve_peer_reskey(peer, &z_msg->body.pull.key);
+        break;
+    case _ZN_MID_DECLARE:
+        for (unsigned int i = 0; i < z_msg->body.declare.declarations.len && res == 0; i++)
+            res = __zn_resolve_peer_declaration(peer, &z_msg->body.declare.declarations.val[i]);
+        break;
+    default:
+        break;
+    }
+
+    if (res != 0)
+    {
+        _Z_DEBUG("Message dropped because it refers to a resource unknown from the multicast peer");
+        return _z_res_t_OK;
+    }
+
+    // A malformed message of a peer does not close the session
+    if (_zn_handle_zenoh_message(zn, z_msg) != _z_res_t_OK)
+        _Z_DEBUG("Message of the multicast peer dropped");
+    return _z_res_t_OK;
+}
+
+/*------------------ Reception ------------------*/
+/**
+ * This function is unsafe because it operates in potentially concurrent data.
+ * Make sure that the following mutexes are locked before calling this function:
+ *  - zn->mutex_peers
+ */
+void __unsafe_zn_handle_multicast_message(zn_session_t *zn, const z_bytes_t *addr, _zn_transport_message_t *t_msg)
+{
+    _zn_transport_peer_t *peer = __unsafe_zn_get_peer_by_addr(zn, addr);
+
+    switch (_ZN_MID(t_msg->header))
+    {
+    case _ZN_MID_JOIN:
+    {
+        _zn_join_t *join = &t_msg->body.join;
+
+        // The datagrams of the session are looped back by the group
+        if (__zn_bytes_eq(&join->pid, &zn->local_pid))
+        {
+            if (zn->self_addr.len == 0)
+                _z_bytes_copy(&zn->self_addr, addr);
+            return;
+        }
+
+        // A peer restarted with the same address is a new peer
+        z_zint_t sn_resolution = _ZN_HAS_FLAG(t_msg->header, _ZN_FLAG_T_S) ? join->sn_resolution : ZN_SN_RESOLUTION_DEFAULT;
+        if (peer != NULL && (!__zn_bytes_eq(&peer->pid, &join->pid) || peer->sn_resolution != sn_resolution || peer->is_qos != join->next_sns.is_qos))
+        {
+            __unsafe_zn_remove_peer(zn, peer);
+            peer = NULL;
+        }
+
+        if (peer == NULL)
+        {
+            _Z_DEBUG("New multicast peer");
+            peer = __zn_new_peer(addr, t_msg);
+            zn->peers = z_list_cons(zn->peers, peer);
+
+            // Let the new peer know about this session and its resources right away
+            _zn_send_join(zn);
+            __zn_send_local_resources(zn);
+        }
+
+        peer->lease = join->lease;
+        peer->received = 1;
+        return;
+    }
+
+    case _ZN_MID_FRAME:
+    {
+        // The frames are only accepted once the JOIN of the peer has been received
+        if (peer == NULL)
+        {
+            _Z_DEBUG("Frame dropped because it is sent by an unknown multicast peer");
+            return;
+        }
+
+        peer->received = 1;
+        _zn_handle_frame(zn, peer, t_msg);
+        return;
+    }
+
+    case _ZN_MID_CLOSE:
+    {
+        if (peer != NULL)
+        {
+            _Z_DEBUG("Removing multicast peer as requested by the peer");
+            __unsafe_zn_remove_peer(zn, peer);
+        }
+        return;
+    }
+
+    default:
+    {
+        if (peer != NULL)
+            peer->received = 1;
+        return;
+    }
+    }
+}
+
+int _zn_handle_multicast_batch(zn_session_t *zn, _z_zbuf_t *zbf, const z_bytes_t *addr)
+{
+    // Skip the datagrams looped back from this session
+    if (zn->self_addr.len > 0 && __zn_bytes_eq(&zn->self_addr, addr))
+        return _z_res_t_OK;
+
+    // Decode the messages in the arena of the session, nothing is freed but the arena is reset
+    zbf->arena = &zn->arena;
+
+    z_mutex_lock(&zn->mutex_peers);
+    while (_z_zbuf_len(zbf) > 0)
+    {
+        // Decode one session message, the zenoh messages of a frame are decoded when handled
+        _zn_transport_message_p_result_t r = _zn_transport_message_decode_lazy(zbf);
+        if (r.tag == _z_res_t_ERR)
+        {
+            // A malformed datagram is only dropped
+            _Z_DEBUG("Datagram dropped because it is malformed");
+            break;
+        }
+
+        __unsafe_zn_handle_multicast_message(zn, addr, r.value.transport_message);
+        _z_arena_reset(&zn->arena);
+    }
+    z_mutex_unlock(&zn->mutex_peers);
+
+    _z_arena_reset(&zn->arena);
+    zbf->arena = NULL;
+    return _z_res_t_OK;
+}
+
+/**
+ * This function is unsafe because it operates in potentially concurrent data.
+ * Make sure that the following mutexes are locked before calling this function:
+ *  - zn->mutex_rx
+ */
+int __unsafe_zn_read_multicast(zn_session_t *zn)
+{
+    // Each datagram is a batch, its sender selects the peer
+    z_bytes_t addr;
+    _z_zbuf_clear(&zn->zbuf);
+    if (_zn_recv_from_zbuf(zn->link, &zn->zbuf, &addr) <= 0)
+        return _z_res_t_ERR;
+
+    return _zn_handle_multicast_batch(zn, &zn->zbuf, &addr);
+}
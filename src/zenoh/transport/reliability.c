@@ -0,0 +1,464 @@
+/*
+ * Copyright (c) 2017, 2021 ADLINK Technology Inc.
+ *
+ * This program and the accompanying materials are made available under the
+ * terms of the Eclipse Public License 2.0 which is available at
+ * http://www.eclipse.org/legal/epl-2.0, or the Apache License, Version 2.0
+ * which is available at https://www.apache.org/licenses/LICENSE-2.0.
+ *
+ * SPDX-License-Identifier: EPL-2.0 OR Apache-2.0
+ *
+ * Contributors:
+ *   ADLINK zenoh team, <zenoh@adlink-labs.tech>
+ */
+
+#include <string.h>
+#include "zenoh-pico/protocol/private/msgcodec.h"
+#include "zenoh-pico/protocol/private/utils.h"
+#include "zenoh-pico/system/common.h"
+#include "zenoh-pico/transport/private/utils.h"
+#include "zenoh-pico/utils/private/logging.h"
+
+// NOTE: On the datagram links each conduit keeps the reliable frames it sends until the peer
+//       acknowledges them, and the reliable frames it receives ahead of a missing one.
+//       - An ACK_NACK carries the next SN expected by the receiver, acknowledging the previous
+//         frames, and a mask of the frames it misses from that SN on: bit i for the SN + i.
+//       - The receiver acknowledges the frames every half window, and asks for the missing ones
+//         as soon as a gap appears.
+//       - The sender periodically sends a SYNC with its next SN and the number of frames it still
+//         keeps, to recover the last frames lost. The frames preceding the kept ones are given up.
+
+/*------------------ Frame windows ------------------*/
+int _zn_link_needs_retransmission(const _zn_link_t *link)
+{
+    // The frames sent to a multicast group are best effort
+    return !link->is_reliable && !link->is_multicast;
+}
+
+z_zint_t __zn_sn_distance(zn_session_t *zn, z_zint_t sn_from, z_zint_t sn_to)
+{
+    return (sn_to + zn->sn_resolution - sn_from) % zn->sn_resolution;
+}
+
+_zn_frame_slot_t *__zn_make_frame_window(void)
+{
+    _zn_frame_slot_t *window = (_zn_frame_slot_t *)malloc(ZN_RELIABLE_WINDOW * sizeof(_zn_frame_slot_t));
+    for (unsigned int i = 0; i < ZN_RELIABLE_WINDOW; i++)
+    {
+        window[i].sn = 0;
+        window[i].buf = NULL;
+        window[i].len = 0;
+        window[i].capacity = 0;
+    }
+    return window;
+}
+
+void __zn_free_frame_window(_zn_frame_slot_t **window)
+{
+    if (*window == NULL)
+        return;
+
+    for (unsigned int i = 0; i < ZN_RELIABLE_WINDOW; i++)
+        free((*window)[i].buf);
+    free(*window);
+    *window = NULL;
+}
+
+void _zn_free_frame_windows(_zn_conduit_t *c)
+{
+    __zn_free_frame_window(&c->tx_window);
+    c->tx_first = 0;
+    c->tx_count = 0;
+
+    __zn_free_frame_window(&c->rx_window);
+    c->rx_count = 0;
+    c->rx_unacked = 0;
+}
+
+void __zn_fill_frame_slot(_zn_frame_slot_t *slot, z_zint_t sn, const _z_wbuf_t *wbf)
+{
+    // Grow the buffer of the slot if needed, it is kept for the following frames
+    size_t len = _z_wbuf_len(wbf);
+    if (slot->capacity < len)
+    {
+        free(slot->buf);
+        slot->buf = (uint8_t *)malloc(len);
+        slot->capacity = len;
+    }
+
+    slot->sn = sn;
+    slot->len = 0;
+    for (size_t i = 0; i < _z_wbuf_len_iosli(wbf); i++)
+    {
+        z_bytes_t bs = _z_iosli_to_bytes(_z_wbuf_get_iosli(wbf, i));
+        memcpy(slot->buf + slot->len, bs.val, bs.len);
+        slot->len += bs.len;
+    }
+}
+
+/*------------------ Transmission ------------------*/
+/**
+ * This function is unsafe because it operates in potentially concurrent data.
+ * Make sure that the following mutexes are locked before calling this function:
+ *  - zn->mutex_tx
+ */
+void __unsafe_zn_keep_frame(zn_session_t *zn, _zn_conduit_t *c, z_zint_t sn, const _z_wbuf_t *wbf)
+{
+    if (!_zn_link_needs_retransmission(zn->link))
+        return;
+
+    if (c->tx_window == NULL)
+        c->tx_window = __zn_make_frame_window();
+
+    // The memory is bounded, the oldest frame is given up if the peer is too late to acknowledge it
+    if (c->tx_count == ZN_RELIABLE_WINDOW)
+    {
+        _Z_DEBUG("Oldest reliable frame dropped because the retransmission window is full\n");
+        c->tx_first = (c->tx_first + 1) % ZN_RELIABLE_WINDOW;
+        c->tx_count--;
+    }
+
+    __zn_fill_frame_slot(&c->tx_window[(c->tx_first + c->tx_count) % ZN_RELIABLE_WINDOW], sn, wbf);
+    c->tx_count++;
+}
+
+/**
+ * This function is unsafe because it operates in potentially concurrent data.
+ * Make sure that the following mutexes are locked before calling this function:
+ *  - zn->mutex_tx
+ */
+void __unsafe_zn_ack_frames(zn_session_t *zn, _zn_conduit_t *c, z_zint_t sn)
+{
+    // Release the frames preceding the SN expected by the peer
+    while (c->tx_count > 0 && _zn_sn_precedes(zn->sn_resolution_half, c->tx_window[c->tx_first].sn, sn))
+    {
+        c->tx_window[c->tx_first].len = 0;
+        c->tx_first = (c->tx_first + 1) % ZN_RELIABLE_WINDOW;
+        c->tx_count--;
+    }
+}
+
+/**
+ * This function is unsafe because it operates in potentially concurrent data.
+ * Make sure that the following mutexes are locked before calling this function:
+ *  - zn->mutex_tx
+ */
+int __unsafe_zn_resend_frame(zn_session_t *zn, _zn_conduit_t *c, z_zint_t sn)
+{
+    for (unsigned int i = 0; i < c->tx_count; i++)
+    {
+        _zn_frame_slot_t *slot = &c->tx_window[(c->tx_first + i) % ZN_RELIABLE_WINDOW];
+        if (slot->sn != sn)
+            continue;
+
+        // Send the frame again as it has been sent the first time
+        _z_wbuf_t wbf = _z_wbuf_make(0, 1);
+        _z_wbuf_add_iosli_wrap(&wbf, slot->buf, slot->len);
+        int res = _zn_send_wbuf(zn->link, &wbf);
+        _z_wbuf_free(&wbf);
+        if (res == 0)
+            zn->transmitted = 1;
+        return res;
+    }
+
+    // The frame is not kept anymore
+    return -1;
+}
+
+int __zn_send_sync(zn_session_t *zn, _zn_conduit_t *c, int is_forced)
+{
+    _zn_transport_message_t t_msg = _zn_transport_message_init(_ZN_MID_SYNC);
+    _ZN_SET_FLAG(t_msg.header, _ZN_FLAG_T_R);
+    _ZN_SET_FLAG(t_msg.header, _ZN_FLAG_T_C);
+    if (zn->is_qos)
+        t_msg.priority = (zn_priority_t)(c - zn->conduits);
+
+    // The count tells the peer the oldest frame that can still be retransmitted
+    z_mutex_lock(&zn->mutex_tx);
+    if (!is_forced && c->tx_count == 0)
+    {
+        z_mutex_unlock(&zn->mutex_tx);
+        return 0;
+    }
+    t_msg.body.sync.sn = c->sn_tx_reliable;
+    t_msg.body.sync.count = c->tx_count > 0 ? __zn_sn_distance(zn, c->tx_window[c->tx_first].sn, c->sn_tx_reliable) : 0;
+    z_mutex_unlock(&zn->mutex_tx);
+
+    return _zn_send_t_msg(zn, &t_msg);
+}
+
+int _zn_send_syncs(zn_session_t *zn)
+{
+    // Ask for the acknowledgment of the conduits with frames not yet acknowledged
+    int res = 0;
+    int len = zn->is_qos ? _ZN_PRIORITIES_NUM : 1;
+    for (int i = 0; i < len; i++)
+    {
+        if (__zn_send_sync(zn, &zn->conduits[i], 0) != 0)
+            res = -1;
+    }
+    return res;
+}
+
+int _zn_handle_ack_nack(zn_session_t *zn, _zn_transport_message_t *msg)
+{
+    if (!_zn_link_needs_retransmission(zn->link))
+        return _z_res_t_OK;
+
+    _zn_conduit_t *c = _zn_get_conduit(zn, msg->priority);
+    _zn_ack_nack_t *ack_nack = &msg->body.ack_nack;
+    int is_kept = 1;
+
+    z_mutex_lock(&zn->mutex_tx);
+    if (c->tx_window != NULL)
+    {
+        __unsafe_zn_ack_frames(zn, c, ack_nack->sn);
+
+        // Send again the frames missed by the peer
+        if (_ZN_HAS_FLAG(msg->header, _ZN_FLAG_T_M))
+        {
+            for (unsigned int i = 0; i < ZN_RELIABLE_WINDOW; i++)
+            {
+                if (ack_nack->mask & ((z_zint_t)1 << i))
+                    is_kept &= __unsafe_zn_resend_frame(zn, c, (ack_nack->sn + i) % zn->sn_resolution) == 0;
+            }
+        }
+    }
+    z_mutex_unlock(&zn->mutex_tx);
+
+    // Let the peer give up the frames that can not be retransmitted
+    if (!is_kept && __zn_send_sync(zn, c, 1) != 0)
+        _Z_DEBUG("Error while sending the sync message\n");
+
+    return _z_res_t_OK;
+}
+
+/*------------------ Reception ------------------*/
+_zn_frame_slot_t *__zn_get_kept_frame(_zn_conduit_t *c, z_zint_t sn)
+{
+    if (c->rx_window == NULL)
+        return NULL;
+
+    for (unsigned int i = 0; i < ZN_RELIABLE_WINDOW; i++)
+    {
+        if (c->rx_window[i].len > 0 && c->rx_window[i].sn == sn)
+            return &c->rx_window[i];
+    }
+    return NULL;
+}
+
+void __zn_keep_received_frame(zn_session_t *zn, _zn_conduit_t *c, _zn_transport_message_t *msg)
+{
+    (void)(zn);
+    if (c->rx_window == NULL)
+        c->rx_window = __zn_make_frame_window();
+
+    // The kept frames follow the next expected one by less than the window, one slot is always free
+    _zn_frame_slot_t *slot = NULL;
+    for (unsigned int i = 0; i < ZN_RELIABLE_WINDOW && slot == NULL; i++)
+    {
+        if (c->rx_window[i].len == 0)
+            slot = &c->rx_window[i];
+    }
+    if (slot == NULL)
+        return;
+
+    // The frame is encoded again since it references the reception buffer
+    _z_wbuf_t wbf = _z_wbuf_make(ZN_FRAG_BUF_TX_CHUNK, 1);
+    if (_zn_transport_message_encode(&wbf, msg) == 0)
+    {
+        __zn_fill_frame_slot(slot, msg->body.frame.sn, &wbf);
+        c->rx_count++;
+    }
+    _z_wbuf_free(&wbf);
+}
+
+int __zn_handle_kept_frame(zn_session_t *zn, _zn_conduit_t *c, _zn_frame_slot_t *slot)
+{
+    _z_zbuf_t zbf = _z_zbuf_wrap(slot->buf, slot->len);
+
+    _zn_transport_message_p_result_t r;
+    _zn_transport_message_p_result_init(&r);
+    _zn_transport_message_t *t_msg = r.value.transport_message;
+
+    int res = _z_res_t_ERR;
+    _zn_transport_message_decode_na(&zbf, &r);
+    if (r.tag == _z_res_t_OK)
+    {
+        res = _zn_handle_frame_payload(zn, NULL, c, t_msg);
+        _zn_transport_message_free(t_msg);
+    }
+    else
+    {
+        // NOTE: The error code has overwritten the message pointer
+        r.value.transport_message = t_msg;
+    }
+    _zn_transport_message_p_result_free(&r);
+
+    // The decoded frame references the slot until it is handled
+    slot->len = 0;
+    c->rx_count--;
+
+    return res;
+}
+
+int __zn_handle_kept_frames(zn_session_t *zn, _zn_conduit_t *c)
+{
+    // Handle the kept frames that are now in order
+    int res = _z_res_t_OK;
+    while (res == _z_res_t_OK && c->rx_count > 0)
+    {
+        _zn_frame_slot_t *slot = __zn_get_kept_frame(c, (c->sn_rx_reliable + 1) % zn->sn_resolution);
+        if (slot == NULL)
+            break;
+
+        c->sn_rx_reliable = slot->sn;
+        c->rx_unacked++;
+        res = __zn_handle_kept_frame(zn, c, slot);
+    }
+    return res;
+}
+
+int __zn_skip_frames(zn_session_t *zn, _zn_conduit_t *c, z_zint_t sn)
+{
+    _Z_DEBUG("Reliable frames lost because they can not be retransmitted\n");
+
+    // The kept frames preceding the SN are still handled in order, the missing ones are given up
+    int res = _z_res_t_OK;
+    while (res == _z_res_t_OK && c->rx_count > 0)
+    {
+        z_zint_t next = (c->sn_rx_reliable + 1) % zn->sn_resolution;
+        _zn_frame_slot_t *first = NULL;
+        for (unsigned int i = 0; i < ZN_RELIABLE_WINDOW; i++)
+        {
+            _zn_frame_slot_t *slot = &c->rx_window[i];
+            if (slot->len > 0 && _zn_sn_precedes(zn->sn_resolution_half, slot->sn, sn) &&
+                (first == NULL || __zn_sn_distance(zn, next, slot->sn) < __zn_sn_distance(zn, next, first->sn)))
+                first = slot;
+        }
+        if (first == NULL)
+            break;
+
+        // A message fragmented across the missing frames can not be completed
+        if (first->sn != next)
+            _zn_defrag_reset(&c->dbuf_reliable);
+        c->sn_rx_reliable = first->sn;
+        c->rx_unacked++;
+        res = __zn_handle_kept_frame(zn, c, first);
+    }
+    if (res != _z_res_t_OK)
+        return res;
+
+    if ((c->sn_rx_reliable + 1) % zn->sn_resolution != sn)
+    {
+        _zn_defrag_reset(&c->dbuf_reliable);
+        c->sn_rx_reliable = (sn + zn->sn_resolution - 1) % zn->sn_resolution;
+    }
+
+    return __zn_handle_kept_frames(zn, c);
+}
+
+void __zn_send_ack_nack(zn_session_t *zn, _zn_conduit_t *c, z_zint_t sn_end)
+{
+    _zn_transport_message_t t_msg = _zn_transport_message_init(_ZN_MID_ACK_NACK);
+    if (zn->is_qos)
+        t_msg.priority = (zn_priority_t)(c - zn->conduits);
+
+    // Acknowledge the frames preceding the next expected one
+    z_zint_t sn = (c->sn_rx_reliable + 1) % zn->sn_resolution;
+    t_msg.body.ack_nack.sn = sn;
+    t_msg.body.ack_nack.mask = 0;
+
+    // And ask for the missing ones up to the end SN and to the last kept frame
+    z_zint_t missing = _zn_sn_precedes(zn->sn_resolution_half, sn, sn_end) ? __zn_sn_distance(zn, sn, sn_end) : 0;
+    for (unsigned int i = 0; i < ZN_RELIABLE_WINDOW && c->rx_window != NULL; i++)
+    {
+        _zn_frame_slot_t *slot = &c->rx_window[i];
+        if (slot->len > 0 && __zn_sn_distance(zn, sn, slot->sn) > missing)
+            missing = __zn_sn_distance(zn, sn, slot->sn);
+    }
+    if (missing > ZN_RELIABLE_WINDOW)
+        missing = ZN_RELIABLE_WINDOW;
+    for (z_zint_t i = 0; i < missing; i++)
+    {
+        if (__zn_get_kept_frame(c, (sn + i) % zn->sn_resolution) == NULL)
+            t_msg.body.ack_nack.mask |= (z_zint_t)1 << i;
+    }
+    if (t_msg.body.ack_nack.mask != 0)
+        _ZN_SET_FLAG(t_msg.header, _ZN_FLAG_T_M);
+
+    c->rx_unacked = 0;
+    if (_zn_send_t_msg(zn, &t_msg) != 0)
+        _Z_DEBUG("Error while sending the ack nack message\n");
+}
+
+int _zn_handle_reliable_frame(zn_session_t *zn, _zn_conduit_t *c, _zn_transport_message_t *msg)
+{
+    z_zint_t sn = msg->body.frame.sn;
+
+    // A frame already received, e.g. sent again while its acknowledgment was on the way
+    if (!_zn_sn_precedes(zn->sn_resolution_half, c->sn_rx_reliable, sn) || __zn_get_kept_frame(c, sn) != NULL)
+    {
+        _Z_DEBUG("Reliable frame dropped because it is duplicated\n");
+        return _z_res_t_OK;
+    }
+
+    // The window only keeps the frames closely following the next expected one
+    int res;
+    z_zint_t next = (c->sn_rx_reliable + 1) % zn->sn_resolution;
+    if (__zn_sn_distance(zn, next, sn) >= ZN_RELIABLE_WINDOW)
+    {
+        res = __zn_skip_frames(zn, c, (sn + zn->sn_resolution - ZN_RELIABLE_WINDOW + 1) % zn->sn_resolution);
+        if (res != _z_res_t_OK)
+            return res;
+        next = (c->sn_rx_reliable + 1) % zn->sn_resolution;
+    }
+
+    if (sn != next)
+    {
+        // Keep the frame until the missing ones are received, asking for them when the gap appears
+        int is_new_gap = c->rx_count == 0;
+        __zn_keep_received_frame(zn, c, msg);
+        if (is_new_gap)
+            __zn_send_ack_nack(zn, c, sn);
+        return _z_res_t_OK;
+    }
+
+    c->sn_rx_reliable = sn;
+    c->rx_unacked++;
+    res = _zn_handle_frame_payload(zn, NULL, c, msg);
+    if (res == _z_res_t_OK)
+        res = __zn_handle_kept_frames(zn, c);
+
+    // Acknowledge the frames regularly so that the peer does not keep them for long
+    if (res == _z_res_t_OK && c->rx_unacked >= ZN_RELIABLE_WINDOW / 2)
+        __zn_send_ack_nack(zn, c, sn);
+
+    return res;
+}
+
+int _zn_handle_sync(zn_session_t *zn, _zn_transport_message_t *msg)
+{
+    // Only the reliable channel of the datagram links is acknowledged
+    if (!_zn_link_needs_retransmission(zn->link) || !_ZN_HAS_FLAG(msg->header, _ZN_FLAG_T_R))
+        return _z_res_t_OK;
+
+    _zn_conduit_t *c = _zn_get_conduit(zn, msg->priority);
+    _zn_sync_t *sync = &msg->body.sync;
+
+    // The frames preceding the oldest one kept by the peer will not be retransmitted
+    if (_ZN_HAS_FLAG(msg->header, _ZN_FLAG_T_C))
+    {
+        z_zint_t oldest = (sync->sn + zn->sn_resolution - sync->count % zn->sn_resolution) % zn->sn_resolution;
+        z_zint_t next = (c->sn_rx_reliable + 1) % zn->sn_resolution;
+        if (_zn_sn_precedes(zn->sn_resolution_half, next, oldest))
+        {
+            int res = __zn_skip_frames(zn, c, oldest);
+            if (res != _z_res_t_OK)
+                return res;
+        }
+    }
+
+    __zn_send_ack_nack(zn, c, sync->sn);
+    return _z_res_t_OK;
+}
@@ -16,6 +16,174 @@
 #include "zenoh-pico/transport/private/utils.h"
 #include "zenoh-pico/session/private/utils.h"
 
+/*------------------ Defragmentation ------------------*/
+void _zn_defrag_init(_zn_defrag_t *d)
+{
+    // The buffer grows with the first fragmented message and is then reused
+    d->zbf = _z_zbuf_make(0);
+    d->is_dropping = 0;
+}
+
+void _zn_defrag_reset(_zn_defrag_t *d)
+{
+    _z_zbuf_clear(&d->zbf);
+    d->is_dropping = 0;
+}
+
+void _zn_defrag_free(_zn_defrag_t *d)
+{
+    _z_zbuf_free(&d->zbf);
+    d->is_dropping = 0;
+}
+
+int __zn_dispatch_zenoh_message(zn_session_t *zn, _zn_transport_peer_t *peer, _zn_zenoh_message_t *z_msg)
+{
+    // The resource keys of the multicast peers are resolved before reaching the session
+    if (peer != NULL)
+        return _zn_handle_peer_zenoh_message(zn, peer, z_msg);
+    return _zn_handle_zenoh_message(zn, z_msg);
+}
+
+int _zn_handle_frame(zn_session_t *zn, _zn_transport_peer_t *peer, _zn_transport_message_t *msg)
+{
+    // Select the conduit the frame has been sent on, the peers have their own ones
+    _zn_conduit_t *c;
+    z_zint_t sn_resolution_half;
+    if (peer != NULL)
+    {
+        c = peer->is_qos ? &peer->conduits[msg->priority] : &peer->conduits[0];
+        sn_resolution_half = peer->sn_resolution_half;
+    }
+    else
+    {
+        c = _zn_get_conduit(zn, msg->priority);
+        sn_resolution_half = zn->sn_resolution_half;
+    }
+
+    // Check if the SN is correct
+    if (_ZN_HAS_FLAG(msg->header, _ZN_FLAG_T_R))
+    {
+        // The reliable frames lost or reordered by a datagram link are recovered before being handled
+        if (peer == NULL && _zn_link_needs_retransmission(zn->link))
+            return _zn_handle_reliable_frame(zn, c, msg);
+
+        // Only monothonic SNs are ensured on the other links
+        if (_zn_sn_precedes(sn_resolution_half, c->sn_rx_reliable, msg->body.frame.sn))
+        {
+            c->sn_rx_reliable = msg->body.frame.sn;
+        }
+        else
+        {
+            _zn_defrag_reset(&c->dbuf_reliable);
+            _Z_DEBUG("Reliable message dropped because it is out of order");
+            return _z_res_t_OK;
+        }
+    }
+    else
+    {
+        // The JOIN of a peer only announces its reliable SNs
+        int *is_synced = peer != NULL ? &peer->is_best_effort_synced[c - peer->conduits] : NULL;
+        if ((is_synced != NULL && !*is_synced) || _zn_sn_precedes(sn_resolution_half, c->sn_rx_best_effort, msg->body.frame.sn))
+        {
+            c->sn_rx_best_effort = msg->body.frame.sn;
+            if (is_synced != NULL)
+                *is_synced = 1;
+        }
+        else
+        {
+            _zn_defrag_reset(&c->dbuf_best_effort);
+            _Z_DEBUG("Best effort message dropped because it is out of order");
+            return _z_res_t_OK;
+        }
+    }
+
+    return _zn_handle_frame_payload(zn, peer, c, msg);
+}
+
+int _zn_handle_frame_payload(zn_session_t *zn, _zn_transport_peer_t *peer, _zn_conduit_t *c, _zn_transport_message_t *msg)
+{
+    if (_ZN_HAS_FLAG(msg->header, _ZN_FLAG_T_F))
+    {
+        int res = _z_res_t_OK;
+
+        // Select the right defragmentation buffer
+        _zn_defrag_t *d = _ZN_HAS_FLAG(msg->header, _ZN_FLAG_T_R) ? &c->dbuf_reliable : &c->dbuf_best_effort;
+        // Add the fragment to the defragmentation buffer, within the memory allowed to a channel
+        if (!d->is_dropping && _z_zbuf_append(&d->zbf, msg->body.frame.payload.fragment.val, msg->body.frame.payload.fragment.len, ZN_FRAG_BUF_RX_LIMIT) != 0)
+        {
+            _Z_DEBUG("Fragmented message dropped because it exceeds the defragmentation limit");
+            d->is_dropping = 1;
+        }
+
+        // Check if this is the last fragment
+        if (_ZN_HAS_FLAG(msg->header, _ZN_FLAG_T_E) && !d->is_dropping)
+        {
+            // Decode the zenoh message in place, its payload references the defragmentation buffer
+            _z_zbuf_t zbf = _z_zbuf_view(&d->zbf, _z_zbuf_len(&d->zbf));
+            _zn_zenoh_message_p_result_t r_zm = _zn_zenoh_message_decode(&zbf);
+            if (r_zm.tag == _z_res_t_OK)
+            {
+                _zn_zenoh_message_t *d_zm = r_zm.value.zenoh_message;
+                res = __zn_dispatch_zenoh_message(zn, peer, d_zm);
+                // Free the decoded message
+                _zn_zenoh_message_free(d_zm);
+            }
+            else
+            {
+                res = _z_res_t_ERR;
+            }
+
+            // Free the result
+            _zn_zenoh_message_p_result_free(&r_zm);
+        }
+
+        // Reset the defragmentation buffer, its memory is kept for the next message
+        if (_ZN_HAS_FLAG(msg->header, _ZN_FLAG_T_E))
+            _zn_defrag_reset(d);
+
+        return res;
+    }
+    else if (msg->body.frame.is_lazy)
+    {
+        // Decode and handle the zenoh messages one by one, each one in the storage of the previous one.
+        // NOTE: The lazy frames are only decoded by the batch handlers, in the arena of the session.
+        _z_zbuf_t zbf = _z_zbuf_wrap((uint8_t *)msg->body.frame.payload.fragment.val, msg->body.frame.payload.fragment.len);
+        zbf.arena = &zn->arena;
+
+        _zn_zenoh_message_t z_msg;
+        _zn_zenoh_message_p_result_t r_zm;
+        size_t mark = _z_arena_mark(&zn->arena);
+        while (_z_zbuf_len(&zbf) > 0)
+        {
+            r_zm.value.zenoh_message = &z_msg;
+            _zn_zenoh_message_decode_na(&zbf, &r_zm);
+            if (r_zm.tag == _z_res_t_ERR)
+            {
+                _Z_DEBUG("Frame dropped because of a malformed message");
+                return _z_res_t_ERR;
+            }
+
+            int res = __zn_dispatch_zenoh_message(zn, peer, &z_msg);
+            _z_arena_rewind(&zn->arena, mark);
+            if (res != _z_res_t_OK)
+                return res;
+        }
+        return _z_res_t_OK;
+    }
+    else
+    {
+        // Handle all the zenoh message, one by one
+        unsigned int len = z_vec_len(&msg->body.frame.payload.messages);
+        for (unsigned int i = 0; i < len; ++i)
+        {
+            int res = __zn_dispatch_zenoh_message(zn, peer, (_zn_zenoh_message_t *)z_vec_get(&msg->body.frame.payload.messages, i));
+            if (res != _z_res_t_OK)
+                return res;
+        }
+        return _z_res_t_OK;
+    }
+}
+
 int _zn_handle_transport_message(zn_session_t *zn, _zn_transport_message_t *msg)
 {
     switch (_ZN_MID(msg->header))
@@ -47,15 +215,11 @@ int _zn_handle_transport_message(zn_session_t *zn, _zn_transport_message_t *msg)
 
             // The initial SN at RX side. Initialize the session as we had already received
             // a message with a SN equal to initial_sn - 1.
-            if (msg->body.open.initial_sn > 0)
+            z_zint_t sn_rx = msg->body.open.initial_sn > 0 ? msg->body.open.initial_sn - 1 : zn->sn_resolution - 1;
+            for (int i = 0; i < _ZN_PRIORITIES_NUM; i++)
             {
-                zn->sn_rx_reliable = msg->body.open.initial_sn - 1;
-                zn->sn_rx_best_effort = msg->body.open.initial_sn - 1;
-            }
-            else
-            {
-                zn->sn_rx_reliable = zn->sn_resolution - 1;
-                zn->sn_rx_best_effort = zn->sn_resolution - 1;
+                zn->conduits[i].sn_rx_reliable = sn_rx;
+                zn->conduits[i].sn_rx_best_effort = sn_rx;
             }
         }
 
@@ -64,21 +228,20 @@ int _zn_handle_transport_message(zn_session_t *zn, _zn_transport_message_t *msg)
 
     case _ZN_MID_CLOSE:
     {
+        // NOTE: The session is only released by its owner, the reception just stops here
+        //       since the read task or a reactor may still be using it.
         _Z_DEBUG("Closing session as requested by the remote peer");
-        _zn_session_free(zn);
         return _z_res_t_ERR;
     }
 
     case _ZN_MID_SYNC:
     {
-        _Z_DEBUG("Handling of Sync messages not implemented");
-        return _z_res_t_OK;
+        return _zn_handle_sync(zn, msg);
     }
 
     case _ZN_MID_ACK_NACK:
     {
-        _Z_DEBUG("Handling of AckNack messages not implemented");
-        return _z_res_t_OK;
+        return _zn_handle_ack_nack(zn, msg);
     }
 
     case _ZN_MID_KEEP_ALIVE:
@@ -94,87 +257,7 @@ int _zn_handle_transport_message(zn_session_t *zn, _zn_transport_message_t *msg)
 
     case _ZN_MID_FRAME:
     {
-        // Check if the SN is correct
-        if (_ZN_HAS_FLAG(msg->header, _ZN_FLAG_T_R))
-        {
-            // @TODO: amend once reliability is in place. For the time being only
-            //        monothonic SNs are ensured
-            if (_zn_sn_precedes(zn->sn_resolution_half, zn->sn_rx_reliable, msg->body.frame.sn))
-            {
-                zn->sn_rx_reliable = msg->body.frame.sn;
-            }
-            else
-            {
-                _z_wbuf_reset(&zn->dbuf_reliable);
-                _Z_DEBUG("Reliable message dropped because it is out of order");
-                return _z_res_t_OK;
-            }
-        }
-        else
-        {
-            if (_zn_sn_precedes(zn->sn_resolution_half, zn->sn_rx_best_effort, msg->body.frame.sn))
-            {
-                zn->sn_rx_best_effort = msg->body.frame.sn;
-            }
-            else
-            {
-                _z_wbuf_reset(&zn->dbuf_best_effort);
-                _Z_DEBUG("Best effort message dropped because it is out of order");
-                return _z_res_t_OK;
-            }
-        }
-
-        if (_ZN_HAS_FLAG(msg->header, _ZN_FLAG_T_F))
-        {
-            int res = _z_res_t_OK;
-
-            // Select the right defragmentation buffer
-            _z_wbuf_t *dbuf = _ZN_HAS_FLAG(msg->header, _ZN_FLAG_T_R) ? &zn->dbuf_reliable : &zn->dbuf_best_effort;
-            // Add the fragment to the defragmentation buffer
-            _z_wbuf_add_iosli_from(dbuf, msg->body.frame.payload.fragment.val, msg->body.frame.payload.fragment.len);
-
-            // Check if this is the last fragment
-            if (_ZN_HAS_FLAG(msg->header, _ZN_FLAG_T_E))
-            {
-                // Convert the defragmentation buffer into a decoding buffer
-                _z_zbuf_t zbf = _z_wbuf_to_zbuf(dbuf);
-
-                // Decode the zenoh message
-                _zn_zenoh_message_p_result_t r_zm = _zn_zenoh_message_decode(&zbf);
-                if (r_zm.tag == _z_res_t_OK)
-                {
-                    _zn_zenoh_message_t *d_zm = r_zm.value.zenoh_message;
-                    res = _zn_handle_zenoh_message(zn, d_zm);
-                    // Free the decoded message
-                    _zn_zenoh_message_free(d_zm);
-                }
-                else
-                {
-                    res = _z_res_t_ERR;
-                }
-
-                // Free the result
-                _zn_zenoh_message_p_result_free(&r_zm);
-                // Free the decoding buffer
-                _z_zbuf_free(&zbf);
-                // Reset the defragmentation buffer
-                _z_wbuf_reset(dbuf);
-            }
-
-            return res;
-        }
-        else
-        {
-            // Handle all the zenoh message, one by one
-            unsigned int len = z_vec_len(&msg->body.frame.payload.messages);
-            for (unsigned int i = 0; i < len; ++i)
-            {
-                int res = _zn_handle_zenoh_message(zn, (_zn_zenoh_message_t *)z_vec_get(&msg->body.frame.payload.messages, i));
-                if (res != _z_res_t_OK)
-                    return res;
-            }
-            return _z_res_t_OK;
-        }
+        return _zn_handle_frame(zn, NULL, msg);
     }
 
     default:
@@ -15,6 +15,7 @@
 #include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include "zenoh-pico/protocol/private/iobuf.h"
 
 #define RUNS 1000
@@ -191,6 +192,100 @@ void zbuf_view(void)
     }
 }
 
+void zbuf_ring(void)
+{
+    size_t len = 128;
+    _z_zbuf_t zbf = _z_zbuf_make_ring(len);
+    printf("\n>>> ZBuf => Ring\n");
+    if (zbf.ring == 0)
+    {
+        printf("    Not supported\n");
+        _z_zbuf_free(&zbf);
+        return;
+    }
+
+    // The capacity is rounded up to whole pages
+    size_t cap = _z_zbuf_capacity(&zbf);
+    printf("    Capacity: %zu\n", cap);
+    assert(cap >= len);
+    assert(_z_zbuf_space_left(&zbf) == cap);
+
+    // Fill the ring and consume all but a few bytes
+    uint8_t counter = 0;
+    for (size_t i = 0; i < cap; i++)
+        _z_iosli_write(&zbf.ios, counter++);
+    assert(_z_zbuf_space_left(&zbf) == 0);
+    size_t left = 1 + gen_size_t() % (len - 1);
+    _z_zbuf_set_rpos(&zbf, cap - left);
+
+    // The compaction keeps the bytes where they are
+    uint8_t *rptr = _z_zbuf_get_rptr(&zbf);
+    _z_zbuf_compact(&zbf);
+    assert(_z_zbuf_get_rptr(&zbf) == rptr);
+    assert(_z_zbuf_len(&zbf) == left);
+    assert(_z_zbuf_space_left(&zbf) == cap - left);
+
+    // The bytes written past the end of the ring can be read contiguously
+    for (size_t i = 0; i < len; i++)
+        _z_iosli_write(&zbf.ios, counter++);
+    _z_zbuf_t v = _z_zbuf_view(&zbf, left + len);
+    uint8_t expected = (uint8_t)(cap - left);
+    while (_z_zbuf_can_read(&v))
+    {
+        uint8_t b = _z_zbuf_read(&v);
+        assert(b == expected++);
+    }
+    _z_zbuf_set_rpos(&zbf, _z_zbuf_get_rpos(&zbf) + left + len);
+
+    // And once read, the positions move back to the beginning of the ring
+    _z_zbuf_compact(&zbf);
+    printf("    Rpos: %zu, Wpos: %zu\n", _z_zbuf_get_rpos(&zbf), _z_zbuf_get_wpos(&zbf));
+    assert(_z_zbuf_get_rpos(&zbf) == len);
+    assert(_z_zbuf_len(&zbf) == 0);
+    assert(zbf.ios.buf[0] == (uint8_t)cap);
+
+    _z_zbuf_free(&zbf);
+}
+
+void zbuf_append(void)
+{
+    size_t len = 128;
+    size_t limit = 4 * len;
+    _z_zbuf_t zbf = _z_zbuf_make(0);
+    printf("\n>>> ZBuf => Append\n");
+
+    // The bytes are appended contiguously, the memory grows up to the limit
+    uint8_t bs[128];
+    uint8_t counter = 0;
+    for (size_t n = 0; n < limit / len; n++)
+    {
+        for (size_t i = 0; i < len; i++)
+            bs[i] = counter++;
+        int res = _z_zbuf_append(&zbf, bs, len, limit);
+        assert(res == 0);
+        printf("    Len: %zu, Capacity: %zu\n", _z_zbuf_len(&zbf), _z_zbuf_capacity(&zbf));
+        assert(_z_zbuf_len(&zbf) == (n + 1) * len);
+        assert(_z_zbuf_capacity(&zbf) <= limit);
+    }
+    uint8_t *rptr = _z_zbuf_get_rptr(&zbf);
+    for (size_t i = 0; i < limit; i++)
+        assert(rptr[i] == (uint8_t)i);
+
+    // The bytes exceeding the limit are not appended
+    int res = _z_zbuf_append(&zbf, bs, 1, limit);
+    assert(res == -1);
+    assert(_z_zbuf_len(&zbf) == limit);
+
+    // Once cleared, the memory is reused
+    _z_zbuf_clear(&zbf);
+    res = _z_zbuf_append(&zbf, bs, len, limit);
+    assert(res == 0);
+    assert(_z_zbuf_get_rptr(&zbf) == rptr);
+    assert(_z_zbuf_capacity(&zbf) == limit);
+
+    _z_zbuf_free(&zbf);
+}
+
 void wbuf_writable_readable(void)
 {
     size_t len = 128;
@@ -435,6 +530,58 @@ void wbuf_add_iosli(void)
     _z_wbuf_free(&wbf);
 }
 
+/*=============================*/
+/*           Arena             */
+/*=============================*/
+void arena_alloc_reset(void)
+{
+    size_t len = 128;
+    _z_arena_t a = _z_arena_make(len);
+    printf("\n>>> Arena => Alloc and reset\n");
+
+    // The allocations are aligned and carved one after the other
+    uint8_t *p1 = (uint8_t *)_z_arena_alloc(&a, 3);
+    uint8_t *p2 = (uint8_t *)_z_arena_alloc(&a, 8);
+    assert(p1 == a.buf);
+    assert(p2 > p1 && (size_t)(p2 - p1) % sizeof(void *) == 0);
+    memset(p1, 0xaa, 3);
+    memset(p2, 0xbb, 8);
+
+    // The allocations not fitting the memory still succeed
+    uint8_t *p3 = (uint8_t *)_z_arena_alloc(&a, 2 * len);
+    assert(p3 != NULL);
+    memset(p3, 0xcc, 2 * len);
+    assert(a.overflow_len >= 2 * len);
+    printf("    Capacity: %zu, Len: %zu, Overflow: %zu\n", a.capacity, a.len, a.overflow_len);
+
+    // And the memory grows at the reset so that they fit the next time
+    _z_arena_reset(&a);
+    assert(a.len == 0);
+    assert(a.capacity >= 3 * len);
+    assert(a.overflow == NULL);
+    uint8_t *buf = a.buf;
+    _z_arena_alloc(&a, 3);
+    _z_arena_alloc(&a, 8);
+    _z_arena_alloc(&a, 2 * len);
+    assert(a.overflow == NULL);
+    _z_arena_reset(&a);
+    assert(a.buf == buf);
+
+    // A buffer with an arena allocates from it, and frees nothing
+    _z_zbuf_t zbf = _z_zbuf_make(len);
+    void *h = _z_zbuf_alloc(&zbf, len);
+    _z_zbuf_dealloc(&zbf, h);
+    zbf.arena = &a;
+    _z_zbuf_t v = _z_zbuf_view(&zbf, 0);
+    assert(v.arena == &a);
+    uint8_t *p4 = (uint8_t *)_z_zbuf_alloc(&v, 16);
+    assert(p4 == a.buf);
+    _z_zbuf_dealloc(&v, p4);
+
+    _z_zbuf_free(&zbf);
+    _z_arena_free(&a);
+}
+
 /*=============================*/
 /*            Main             */
 /*=============================*/
@@ -447,6 +594,8 @@ int main(void)
         zbuf_writable_readable();
         zbuf_comapct();
         zbuf_view();
+        zbuf_ring();
+        zbuf_append();
         // WBuf
         wbuf_writable_readable();
         wbuf_set_pos_wbuf_get_pos();
@@ -455,5 +604,7 @@ int main(void)
         wbuf_write_zbuf_read();
         wbuf_write_zbuf_read_bytes();
         wbuf_put_zbuf_get();
+        // Arena
+        arena_alloc_reset();
     }
 }
@@ -0,0 +1,125 @@
+/*
+ * Copyright (c) 2017, 2021 ADLINK Technology Inc.
+ *
+ * This program and the accompanying materials are made available under the
+ * terms of the Eclipse Public License 2.0 which is available at
+ * http://www.eclipse.org/legal/epl-2.0, or the Apache License, Version 2.0
+ * which is available at https://www.apache.org/licenses/LICENSE-2.0.
+ *
+ * SPDX-License-Identifier: EPL-2.0 OR Apache-2.0
+ *
+ * Contributors:
+ *   ADLINK zenoh team, <zenoh@adlink-labs.tech>
+ */
+
+#include <assert.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include "zenoh-pico/system/collections.h"
+#include "zenoh-pico/system/common.h"
+#include "zenoh-pico/system/types.h"
+
+#define PRODUCERS 4
+#define RUN 100000
+#define CAPACITY 64
+#define TIMEOUT 60
+
+typedef struct
+{
+    unsigned int producer;
+    unsigned int seq;
+} msg_t;
+
+z_lf_queue_t *q;
+msg_t msgs[PRODUCERS][RUN];
+volatile unsigned int produced[PRODUCERS];
+
+void *produce(void *arg)
+{
+    unsigned int id = *(unsigned int *)arg;
+    for (unsigned int i = 0; i < RUN; i++)
+    {
+        msgs[id][i].producer = id;
+        msgs[id][i].seq = i;
+        // Retry until the consumer makes room
+        while (z_lf_queue_push(q, &msgs[id][i]) != 0)
+            z_sleep_us(1);
+        produced[id]++;
+    }
+    return 0;
+}
+
+void bounded(void)
+{
+    printf("\n>>> Bounded queue\n");
+    z_lf_queue_t *bq = z_lf_queue_make(5);
+    assert(z_lf_queue_capacity(bq) == 8);
+    assert(z_lf_queue_pull(bq) == NULL);
+
+    unsigned int vals[8];
+    for (unsigned int i = 0; i < 8; i++)
+    {
+        vals[i] = i;
+        assert(z_lf_queue_push(bq, &vals[i]) == 0);
+    }
+    // The queue is full
+    assert(z_lf_queue_push(bq, &vals[0]) == -1);
+
+    for (unsigned int i = 0; i < 8; i++)
+    {
+        unsigned int *v = (unsigned int *)z_lf_queue_pull(bq);
+        assert(v != NULL && *v == i);
+    }
+    // The queue is empty
+    assert(z_lf_queue_pull(bq) == NULL);
+
+    z_lf_queue_free(bq);
+}
+
+void concurrent(void)
+{
+    printf("\n>>> Concurrent producers\n");
+    q = z_lf_queue_make(CAPACITY);
+
+    unsigned int ids[PRODUCERS];
+    z_task_t producers[PRODUCERS];
+    for (unsigned int i = 0; i < PRODUCERS; i++)
+    {
+        ids[i] = i;
+        produced[i] = 0;
+        z_task_init(&producers[i], NULL, produce, &ids[i]);
+    }
+
+    // Consume and check that the order of each producer is preserved
+    unsigned int next[PRODUCERS] = {0};
+    unsigned int consumed = 0;
+    z_clock_t now = z_clock_now();
+    while (consumed < PRODUCERS * RUN)
+    {
+        assert(z_clock_elapsed_s(&now) < TIMEOUT);
+        msg_t *m = (msg_t *)z_lf_queue_pull(q);
+        if (m == NULL)
+            continue;
+
+        assert(m->seq == next[m->producer]);
+        next[m->producer]++;
+        consumed++;
+    }
+
+    for (unsigned int i = 0; i < PRODUCERS; i++)
+        assert(next[i] == RUN);
+    assert(z_lf_queue_pull(q) == NULL);
+
+    z_lf_queue_free(q);
+}
+
+int main(void)
+{
+    setbuf(stdout, NULL);
+
+    bounded();
+    concurrent();
+
+    return 0;
+}
@@ -0,0 +1,109 @@
+/*
+ * Copyright (c) 2017, 2021 ADLINK Technology Inc.
+ *
+ * This program and the accompanying materials are made available under the
+ * terms of the Eclipse Public License 2.0 which is available at
+ * http://www.eclipse.org/legal/epl-2.0, or the Apache License, Version 2.0
+ * which is available at https://www.apache.org/licenses/LICENSE-2.0.
+ *
+ * SPDX-License-Identifier: EPL-2.0 OR Apache-2.0
+ *
+ * Contributors:
+ *   ADLINK zenoh team, <zenoh@adlink-labs.tech>
+ */
+
+
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "zenoh-pico.h"
+#include "zenoh-pico/system/common.h"
+
+#define MSG 100
+#define TIMEOUT 60
+
+// The samples received, in order
+volatile unsigned int datas = 0;
+void data_handler(const zn_sample_t *sample, const void *arg)
+{
+    (void)arg;
+    unsigned int seq;
+    assert(sample->value.len == sizeof(seq));
+    memcpy(&seq, sample->value.val, sizeof(seq));
+    assert(seq == datas);
+    datas++;
+}
+
+void wait_for(unsigned int n)
+{
+    z_clock_t start = z_clock_now();
+    while (datas < n)
+    {
+        assert(z_clock_elapsed_s(&start) < TIMEOUT);
+        z_sleep_ms(1);
+    }
+    assert(datas == n);
+}
+
+int main(void)
+{
+    setbuf(stdout, NULL);
+
+    // A session alone on its name receives its own frames back,
+    // the batches are only sent by the writes without any deadline
+    zn_properties_t *config = zn_config_client("inproc/zn_batch_test");
+    zn_properties_insert(config, ZN_CONFIG_BATCHING_KEY, z_string_make("true"));
+    zn_properties_insert(config, ZN_CONFIG_BATCHING_TIMEOUT_KEY, z_string_make("0"));
+    zn_session_t *s = zn_open(config);
+    assert(s != NULL);
+    znp_start_read_task(s);
+
+    zn_subscriber_t *sub = zn_declare_subscriber(s, zn_rname("/demo/batch"), zn_subinfo_default(), data_handler, NULL);
+    assert(sub != NULL);
+    zn_reskey_t rk = zn_rid(zn_declare_resource(s, zn_rname("/demo/batch")));
+    zn_batch_stats_reset(s);
+
+    // The writes are batched in a single frame, sent along with the express write
+    unsigned int n = 0;
+    for (unsigned int i = 0; i < MSG; i++, n++)
+        zn_write(s, rk, (const uint8_t *)&n, sizeof(n));
+    zn_write_express(s, rk, (const uint8_t *)&n, sizeof(n));
+    n++;
+    wait_for(n);
+    zn_batch_stats_t stats = zn_batch_stats(s);
+    assert(stats.messages == MSG + 1);
+    assert(stats.batches <= 2);
+    printf("Sent %u messages in %u batches\n", (unsigned int)stats.messages, (unsigned int)stats.batches);
+
+    // A held batch is only sent upon flush
+    zn_batch_stats_reset(s);
+    int res = zn_batch_begin(s);
+    assert(res == 0);
+    for (unsigned int i = 0; i < MSG; i++, n++)
+        zn_write(s, rk, (const uint8_t *)&n, sizeof(n));
+    z_sleep_ms(10);
+    assert(datas == n - MSG);
+    stats = zn_batch_stats(s);
+    assert(stats.batches == 0);
+    res = zn_batch_flush(s);
+    assert(res == 0);
+    wait_for(n);
+    stats = zn_batch_stats(s);
+    assert(stats.batches == 1);
+    assert(stats.messages == MSG);
+
+    // Once flushed, the batch is not held anymore
+    zn_write(s, rk, (const uint8_t *)&n, sizeof(n));
+    n++;
+    zn_write_express(s, rk, (const uint8_t *)&n, sizeof(n));
+    n++;
+    wait_for(n);
+
+    zn_undeclare_subscriber(sub);
+    znp_stop_read_task(s);
+    zn_close(s);
+    zn_properties_free(config);
+
+    return 0;
+}
@@ -265,8 +265,8 @@ int main(int argc, char **argv)
     while (pubs1)
     {
         zn_publisher_t *pub = z_list_head(pubs1);
-        zn_undeclare_publisher(pub);
         printf("Undeclared publisher on session 2: %zu\n", pub->id);
+        zn_undeclare_publisher(pub);
         pubs1 = z_list_pop(pubs1);
     }
 
@@ -274,16 +274,16 @@ int main(int argc, char **argv)
     while (subs2)
     {
         zn_subscriber_t *sub = z_list_head(subs2);
-        zn_undeclare_subscriber(sub);
         printf("Undeclared subscriber on session 2: %zu\n", sub->id);
+        zn_undeclare_subscriber(sub);
         subs2 = z_list_pop(subs2);
     }
 
     while (qles2)
     {
         zn_queryable_t *qle = z_list_head(qles2);
-        zn_undeclare_queryable(qle);
         printf("Undeclared queryable on session 2: %zu\n", qle->id);
+        zn_undeclare_queryable(qle);
         qles2 = z_list_pop(qles2);
     }
 
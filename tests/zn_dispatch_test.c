@@ -0,0 +1,214 @@
+/*
+ * Copyright (c) 2017, 2021 ADLINK Technology Inc.
+ *
+ * This program and the accompanying materials are made available under the
+ * terms of the Eclipse Public License 2.0 which is available at
+ * http://www.eclipse.org/legal/epl-2.0, or the Apache License, Version 2.0
+ * which is available at https://www.apache.org/licenses/LICENSE-2.0.
+ *
+ * SPDX-License-Identifier: EPL-2.0 OR Apache-2.0
+ *
+ * Contributors:
+ *   ADLINK zenoh team, <zenoh@adlink-labs.tech>
+ */
+
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "zenoh-pico.h"
+#include "zenoh-pico/system/common.h"
+
+#define TASKS 4
+#define SUBS 4
+#define MSG 10000
+#define TIMEOUT 60
+
+// The samples received by each fast subscriber, in order
+volatile unsigned int datas[SUBS];
+volatile int slow_received = 0;
+volatile int slow_released = 0;
+volatile int self_received = 0;
+volatile int other_started = 0;
+volatile int other_released = 0;
+volatile int other_done = 0;
+volatile int other_received = 0;
+
+void fast_handler(const zn_sample_t *sample, const void *arg)
+{
+    int i = *(const int *)arg;
+    unsigned int seq;
+    assert(sample->value.len == sizeof(seq));
+    memcpy(&seq, sample->value.val, sizeof(seq));
+    assert(seq == datas[i]);
+    datas[i]++;
+}
+
+void slow_handler(const zn_sample_t *sample, const void *arg)
+{
+    (void)arg;
+    assert(strcmp(sample->key.val, "/demo/dispatch/slow") == 0);
+    while (!slow_released)
+        z_sleep_ms(1);
+    slow_received++;
+}
+
+void self_handler(const zn_sample_t *sample, const void *arg)
+{
+    (void)sample;
+    zn_subscriber_t **sub = (zn_subscriber_t **)arg;
+    self_received++;
+    zn_undeclare_subscriber(*sub);
+}
+
+void undeclaring_handler(const zn_sample_t *sample, const void *arg)
+{
+    (void)sample;
+    zn_subscriber_t **other = (zn_subscriber_t **)arg;
+    other_started = 1;
+    while (!other_released)
+        z_sleep_ms(1);
+    zn_undeclare_subscriber(*other);
+    other_done = 1;
+}
+
+void other_handler(const zn_sample_t *sample, const void *arg)
+{
+    (void)sample;
+    (void)arg;
+    other_received++;
+}
+
+void wait_flag(volatile int *flag)
+{
+    z_clock_t start = z_clock_now();
+    while (!*flag)
+    {
+        assert(z_clock_elapsed_s(&start) < TIMEOUT);
+        z_sleep_ms(1);
+    }
+}
+
+int all_received(unsigned int n)
+{
+    for (int i = 0; i < SUBS; i++)
+        if (datas[i] != n)
+            return 0;
+    return 1;
+}
+
+void wait_for(unsigned int n)
+{
+    z_clock_t start = z_clock_now();
+    while (!all_received(n))
+    {
+        assert(z_clock_elapsed_s(&start) < TIMEOUT);
+        z_sleep_ms(1);
+    }
+}
+
+int main(void)
+{
+    setbuf(stdout, NULL);
+
+    // A session alone on its name receives its own frames back
+    zn_properties_t *config = zn_config_client("inproc/zn_dispatch_test");
+    zn_session_t *s = zn_open(config);
+    assert(s != NULL);
+    znp_start_read_task(s);
+    int res = znp_start_dispatch_tasks(s, TASKS);
+    assert(res == 0);
+    res = znp_start_dispatch_tasks(s, TASKS);
+    assert(res == -1);
+
+    char rnames[SUBS][32];
+    int ids[SUBS];
+    zn_reskey_t rks[SUBS];
+    zn_subscriber_t *subs[SUBS];
+    for (int i = 0; i < SUBS; i++)
+    {
+        ids[i] = i;
+        snprintf(rnames[i], sizeof(rnames[i]), "/demo/dispatch/fast/%d", i);
+        subs[i] = zn_declare_subscriber(s, zn_rname(rnames[i]), zn_subinfo_default(), fast_handler, &ids[i]);
+        assert(subs[i] != NULL);
+        rks[i] = zn_rid(zn_declare_resource(s, zn_rname(rnames[i])));
+    }
+    zn_subscriber_t *slow = zn_declare_subscriber(s, zn_rname("/demo/dispatch/slow"), zn_subinfo_default(), slow_handler, NULL);
+    assert(slow != NULL);
+
+    // A blocked subscriber delays neither the reception nor the other subscribers,
+    // that keep receiving their samples in order
+    zn_write(s, zn_rname("/demo/dispatch/slow"), (const uint8_t *)"slow", 4);
+    for (unsigned int n = 0; n < MSG; n++)
+        for (int i = 0; i < SUBS; i++)
+            zn_write(s, rks[i], (const uint8_t *)&n, sizeof(n));
+    wait_for(MSG);
+    assert(slow_received == 0);
+    printf("Received %u samples per subscriber while a subscriber is blocked\n", MSG);
+
+    slow_released = 1;
+    z_clock_t start = z_clock_now();
+    while (slow_received == 0)
+    {
+        assert(z_clock_elapsed_s(&start) < TIMEOUT);
+        z_sleep_ms(1);
+    }
+
+    // A subscriber is undeclared once the sample being delivered to it has been handled
+    zn_write(s, zn_rname("/demo/dispatch/slow"), (const uint8_t *)"slow", 4);
+    z_sleep_ms(10);
+    zn_undeclare_subscriber(slow);
+
+    // A subscriber undeclared from its callback is not called anymore
+    zn_subscriber_t *self = NULL;
+    self = zn_declare_subscriber(s, zn_rname("/demo/dispatch/self"), zn_subinfo_default(), self_handler, &self);
+    assert(self != NULL);
+    for (int n = 0; n < 10; n++)
+        zn_write(s, zn_rname("/demo/dispatch/self"), (const uint8_t *)"self", 4);
+    z_sleep_ms(100);
+    assert(self_received == 1);
+
+    // The tasks are stopped while samples are received, that are all delivered in order
+    for (unsigned int n = MSG; n < 2 * MSG; n++)
+        for (int i = 0; i < SUBS; i++)
+            zn_write(s, rks[i], (const uint8_t *)&n, sizeof(n));
+    res = znp_stop_dispatch_tasks(s);
+    assert(res == 0);
+    res = znp_stop_dispatch_tasks(s);
+    assert(res == -1);
+    wait_for(2 * MSG);
+
+    // Once the tasks are stopped, the samples are delivered from the reception again
+    for (int i = 0; i < SUBS; i++)
+    {
+        unsigned int n = 2 * MSG;
+        zn_write(s, rks[i], (const uint8_t *)&n, sizeof(n));
+    }
+    wait_for(2 * MSG + 1);
+
+    // A callback undeclares a subscriber waiting on the single task that runs the callback
+    res = znp_start_dispatch_tasks(s, 1);
+    assert(res == 0);
+    zn_subscriber_t *other = zn_declare_subscriber(s, zn_rname("/demo/dispatch/other"), zn_subinfo_default(), other_handler, NULL);
+    assert(other != NULL);
+    zn_subscriber_t *undeclaring = zn_declare_subscriber(s, zn_rname("/demo/dispatch/undeclaring"), zn_subinfo_default(), undeclaring_handler, &other);
+    assert(undeclaring != NULL);
+    zn_write(s, zn_rname("/demo/dispatch/undeclaring"), (const uint8_t *)"undeclaring", 11);
+    wait_flag(&other_started);
+    zn_write(s, zn_rname("/demo/dispatch/other"), (const uint8_t *)"other", 5);
+    z_sleep_ms(10);
+    other_released = 1;
+    wait_flag(&other_done);
+    res = znp_stop_dispatch_tasks(s);
+    assert(res == 0);
+    assert(other_received == 0);
+    zn_undeclare_subscriber(undeclaring);
+
+    for (int i = 0; i < SUBS; i++)
+        zn_undeclare_subscriber(subs[i]);
+    znp_stop_read_task(s);
+    zn_close(s);
+    zn_properties_free(config);
+
+    return 0;
+}
@@ -0,0 +1,125 @@
+/*
+ * Copyright (c) 2017, 2021 ADLINK Technology Inc.
+ *
+ * This program and the accompanying materials are made available under the
+ * terms of the Eclipse Public License 2.0 which is available at
+ * http://www.eclipse.org/legal/epl-2.0, or the Apache License, Version 2.0
+ * which is available at https://www.apache.org/licenses/LICENSE-2.0.
+ *
+ * SPDX-License-Identifier: EPL-2.0 OR Apache-2.0
+ *
+ * Contributors:
+ *   ADLINK zenoh team, <zenoh@adlink-labs.tech>
+ */
+
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "zenoh-pico.h"
+#include "zenoh-pico/system/common.h"
+
+#define MSG 100000
+#define MSG_LEN 64
+#define FRAG_LEN 100000
+#define TIMEOUT 60
+
+volatile unsigned int datas = 0;
+void data_handler(const zn_sample_t *sample, const void *arg)
+{
+    (void)arg;
+    assert(sample->value.len == MSG_LEN || sample->value.len == FRAG_LEN);
+    assert(strncmp("/demo/inproc", sample->key.val, sample->key.len) == 0);
+    for (size_t i = 0; i < sample->value.len; i++)
+        assert(sample->value.val[i] == (uint8_t)i);
+    datas++;
+}
+
+int main(void)
+{
+    setbuf(stdout, NULL);
+
+    // A session alone on its name receives its own frames back
+    zn_properties_t *config = zn_config_client("inproc/zn_inproc_test");
+    zn_session_t *s = zn_open(config);
+    assert(s != NULL);
+    znp_start_read_task(s);
+
+    zn_subscriber_t *sub = zn_declare_subscriber(s, zn_rname("/demo/inproc"), zn_subinfo_default(), data_handler, NULL);
+    assert(sub != NULL);
+
+    uint8_t *payload = (uint8_t *)malloc(FRAG_LEN);
+    for (size_t i = 0; i < FRAG_LEN; i++)
+        payload[i] = (uint8_t)i;
+
+    // Measure the library overhead without any network
+    zn_reskey_t rk = zn_rid(zn_declare_resource(s, zn_rname("/demo/inproc")));
+    z_clock_t start = z_clock_now();
+    for (unsigned int i = 0; i < MSG; i++)
+        zn_write_ext(s, rk, payload, MSG_LEN, Z_ENCODING_DEFAULT, Z_DATA_KIND_DEFAULT, zn_congestion_control_t_BLOCK);
+    while (datas < MSG)
+    {
+        assert(z_clock_elapsed_s(&start) < TIMEOUT);
+        z_sleep_us(100);
+    }
+    clock_t elapsed = z_clock_elapsed_ms(&start);
+    printf("Sent and received %u messages of %u bytes in %lu ms\n", MSG, MSG_LEN, (unsigned long)elapsed);
+
+    // Large messages are fragmented and reassembled
+    zn_write_ext(s, rk, payload, FRAG_LEN, Z_ENCODING_DEFAULT, Z_DATA_KIND_DEFAULT, zn_congestion_control_t_BLOCK);
+    start = z_clock_now();
+    while (datas < MSG + 1)
+    {
+        assert(z_clock_elapsed_s(&start) < TIMEOUT);
+        z_sleep_us(100);
+    }
+    assert(datas == MSG + 1);
+
+    // The messages queued for the tx task are all sent once it is stopped
+    int res = znp_start_tx_task(s);
+    assert(res == 0);
+    for (unsigned int i = 0; i < MSG; i++)
+        zn_write_ext(s, rk, payload, MSG_LEN, Z_ENCODING_DEFAULT, Z_DATA_KIND_DEFAULT, zn_congestion_control_t_BLOCK);
+    res = znp_stop_tx_task(s);
+    assert(res == 0);
+    res = znp_stop_tx_task(s);
+    assert(res == -1);
+    start = z_clock_now();
+    while (datas < 2 * MSG + 1)
+    {
+        assert(z_clock_elapsed_s(&start) < TIMEOUT);
+        z_sleep_us(100);
+    }
+    assert(datas == 2 * MSG + 1);
+
+    // An unknown name can not be reached by another session
+    zn_properties_t *other = zn_config_client("inproc/zn_inproc_test_other");
+    zn_session_t *o = zn_open(other);
+    assert(o != NULL);
+    zn_write_ext(o, zn_rname("/demo/inproc"), payload, MSG_LEN, Z_ENCODING_DEFAULT, Z_DATA_KIND_DEFAULT, zn_congestion_control_t_BLOCK);
+    z_sleep_ms(10);
+    assert(datas == 2 * MSG + 1);
+    zn_close(o);
+
+    // A session is not opened with link options out of range
+    const unsigned int keys[] = {ZN_CONFIG_SO_SNDBUF_KEY, ZN_CONFIG_SO_RCVBUF_KEY, ZN_CONFIG_IP_TOS_KEY, ZN_CONFIG_SO_PRIORITY_KEY, ZN_CONFIG_IP_TOS_KEY, ZN_CONFIG_MTU_KEY};
+    const char *values[] = {"0", "4294967296", "256", "-1", "1x", "64"};
+    for (size_t i = 0; i < sizeof(keys) / sizeof(keys[0]); i++)
+    {
+        zn_properties_t *invalid = zn_config_client("inproc/zn_inproc_test_invalid");
+        zn_properties_insert(invalid, keys[i], z_string_make(values[i]));
+        zn_session_t *is = zn_open(invalid);
+        assert(is == NULL);
+        zn_properties_free(invalid);
+    }
+
+    zn_undeclare_subscriber(sub);
+    znp_stop_read_task(s);
+    zn_close(s);
+
+    free(payload);
+    zn_properties_free(config);
+    zn_properties_free(other);
+
+    return 0;
+}
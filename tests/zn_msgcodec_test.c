@@ -67,6 +67,9 @@ void print_transport_message_type(uint8_t header)
 {
     switch (_ZN_MID(header))
     {
+    case _ZN_MID_JOIN:
+        printf("Join message");
+        break;
     case _ZN_MID_SCOUT:
         printf("Scout message");
         break;
@@ -624,7 +627,8 @@ _zn_attachment_t *gen_attachment(void)
     _zn_attachment_t *p_at = (_zn_attachment_t *)malloc(sizeof(_zn_attachment_t));
 
     p_at->header = _ZN_MID_ATTACHMENT;
-    _ZN_SET_FLAG(p_at->header, _ZN_FLAGS(gen_uint8()));
+    // Sliced attachments are not supported, the flag is never encoded
+    _ZN_SET_FLAG(p_at->header, _ZN_FLAGS(gen_uint8()) & ~_ZN_FLAG_T_Z);
     p_at->payload = gen_payload(64);
 
     return p_at;
@@ -1356,6 +1360,56 @@ void data_message(void)
     _z_wbuf_free(&wbf);
 }
 
+void preencoded_data_message(void)
+{
+    printf("\n>> Pre-encoded data message\n");
+    _z_wbuf_t wbf = gen_wbuf(256);
+    _z_wbuf_t pbf = gen_wbuf(256);
+    _z_wbuf_t ebf = gen_wbuf(256);
+
+    // Initialize
+    _zn_zenoh_message_t e_zm = _zn_zenoh_message_init(_ZN_MID_DATA);
+    e_zm.body.data = gen_data_message(&e_zm.header);
+    e_zm.priority = (zn_priority_t)(gen_uint8() % _ZN_PRIORITIES_NUM);
+
+    // Encode the prefix once and append the payload to it
+    int res = _zn_zenoh_message_encode_prefix(&pbf, &e_zm);
+    assert(res == 0);
+    _z_zbuf_t pzbf = _z_wbuf_to_zbuf(&pbf);
+    z_bytes_t prefix;
+    prefix.val = _z_zbuf_get_rptr(&pzbf);
+    prefix.len = _z_zbuf_len(&pzbf);
+    res = _zn_zenoh_message_encode_preencoded(&wbf, &prefix, e_zm.body.data.payload.val, e_zm.body.data.payload.len);
+    assert(res == 0);
+
+    // The bytes are the same as those of the message encoded at once
+    res = _zn_zenoh_message_encode(&ebf, &e_zm);
+    assert(res == 0);
+    _z_zbuf_t zbf = _z_wbuf_to_zbuf(&wbf);
+    _z_zbuf_t ezbf = _z_wbuf_to_zbuf(&ebf);
+    assert(_z_zbuf_len(&zbf) == _z_zbuf_len(&ezbf));
+    assert(memcmp(_z_zbuf_get_rptr(&zbf), _z_zbuf_get_rptr(&ezbf), _z_zbuf_len(&zbf)) == 0);
+
+    // Decode
+    _zn_zenoh_message_p_result_t r_zm = _zn_zenoh_message_decode(&zbf);
+    assert(r_zm.tag == _z_res_t_OK);
+
+    _zn_zenoh_message_t *d_zm = r_zm.value.zenoh_message;
+    assert(d_zm->header == e_zm.header);
+    assert(d_zm->priority == e_zm.priority);
+    assert_eq_data_message(&e_zm.body.data, &d_zm->body.data, e_zm.header);
+
+    // Free
+    _zn_zenoh_message_free(d_zm);
+    _zn_zenoh_message_p_result_free(&r_zm);
+    _z_zbuf_free(&zbf);
+    _z_zbuf_free(&ezbf);
+    _z_zbuf_free(&pzbf);
+    _z_wbuf_free(&wbf);
+    _z_wbuf_free(&ebf);
+    _z_wbuf_free(&pbf);
+}
+
 /*------------------ Pull message ------------------*/
 _zn_pull_t gen_pull_message(uint8_t *header)
 {
@@ -1537,6 +1591,10 @@ _zn_zenoh_message_t *gen_zenoh_message(void)
         p_zm->reply_context = gen_reply_context();
     else
         p_zm->reply_context = NULL;
+    if (gen_bool())
+        p_zm->priority = (zn_priority_t)(gen_uint8() % _ZN_PRIORITIES_NUM);
+    else
+        p_zm->priority = ZN_PRIORITY_DEFAULT;
 
     uint8_t mids[] = {
         _ZN_MID_DECLARE,
@@ -1603,6 +1661,9 @@ void assert_eq_zenoh_message(_zn_zenoh_message_t *left, _zn_zenoh_message_t *rig
         assert(left->reply_context == right->reply_context);
     }
 
+    printf("   Priority (%d:%d)\n", left->priority, right->priority);
+    assert(left->priority == right->priority);
+
     // Test message
     printf("   Header (%x:%x)", left->header, right->header);
     assert(left->header == right->header);
@@ -1837,7 +1898,11 @@ _zn_join_t gen_join_message(uint8_t *header)
     e_jn.pid = gen_bytes(16);
     e_jn.lease = gen_zint();
     if (gen_bool())
+    {
+        // The lease is then encoded in seconds
+        e_jn.lease = e_jn.lease / 1000 * 1000;
         _ZN_SET_FLAG(*header, _ZN_FLAG_T_T1);
+    }
 
     if (gen_bool())
     {
@@ -1951,7 +2016,10 @@ _zn_init_t gen_init_message(uint8_t *header)
 
     e_it.options = 0;
     if (gen_bool())
+    {
+        _ZN_SET_FLAG(*header, _ZN_FLAG_T_O);
         _ZN_SET_FLAG(e_it.options, _ZN_OPT_INIT_QOS);
+    }
 
     e_it.whatami = gen_zint();
     e_it.pid = gen_bytes(16);
@@ -2380,6 +2448,7 @@ _zn_frame_t gen_frame_message(uint8_t *header, int can_be_fragment)
     _zn_frame_t e_fr;
 
     e_fr.sn = gen_zint();
+    e_fr.is_lazy = 0;
 
     if (can_be_fragment && gen_bool())
     {
@@ -2452,6 +2521,66 @@ void frame_message(void)
     _z_wbuf_free(&wbf);
 }
 
+void lazy_frame_message(void)
+{
+    printf("\n>> Lazy frame message\n");
+    _z_wbuf_t wbf = gen_wbuf(1024);
+
+    // Initialize
+    _zn_transport_message_t e_sm = _zn_transport_message_init(_ZN_MID_FRAME);
+    e_sm.body.frame = gen_frame_message(&e_sm.header, 0);
+
+    // Encode
+    int res = _zn_transport_message_encode(&wbf, &e_sm);
+    assert(res == 0);
+
+    // Decode in an arena, the zenoh messages are left encoded
+    _z_arena_t arena = _z_arena_make(64);
+    _z_zbuf_t zbf = _z_wbuf_to_zbuf(&wbf);
+    zbf.arena = &arena;
+    _zn_transport_message_p_result_t r_sm = _zn_transport_message_decode_lazy(&zbf);
+    assert(r_sm.tag == _z_res_t_OK);
+    _zn_frame_t *d_fr = &r_sm.value.transport_message->body.frame;
+    assert(d_fr->is_lazy);
+    assert(d_fr->sn == e_sm.body.frame.sn);
+
+    // The zenoh messages are decoded one by one in the same storage
+    size_t len = d_fr->payload.fragment.len;
+    _z_zbuf_t mbf;
+    mbf.ios = _z_iosli_wrap((uint8_t *)d_fr->payload.fragment.val, len, 0, len);
+    mbf.arena = &arena;
+    size_t mark = _z_arena_mark(&arena);
+    _zn_zenoh_message_t d_zm;
+    _zn_zenoh_message_p_result_t r_zm;
+    for (size_t i = 0; i < z_vec_len(&e_sm.body.frame.payload.messages); i++)
+    {
+        r_zm.value.zenoh_message = &d_zm;
+        _zn_zenoh_message_decode_na(&mbf, &r_zm);
+        assert(r_zm.tag == _z_res_t_OK);
+        assert_eq_zenoh_message((_zn_zenoh_message_t *)z_vec_get(&e_sm.body.frame.payload.messages, i), &d_zm);
+        _z_arena_rewind(&arena, mark);
+    }
+    assert(_z_zbuf_len(&mbf) == 0);
+
+    // A lazy frame is encoded again as it has been received
+    _z_wbuf_t rbf = gen_wbuf(1024);
+    res = _zn_transport_message_encode(&rbf, r_sm.value.transport_message);
+    assert(res == 0);
+    _z_zbuf_t e_zbf = _z_wbuf_to_zbuf(&wbf);
+    _z_zbuf_t r_zbf = _z_wbuf_to_zbuf(&rbf);
+    assert(_z_zbuf_len(&r_zbf) == _z_zbuf_len(&e_zbf));
+    assert(memcmp(_z_zbuf_get_rptr(&r_zbf), _z_zbuf_get_rptr(&e_zbf), _z_zbuf_len(&e_zbf)) == 0);
+
+    // Free
+    z_vec_free(&e_sm.body.frame.payload.messages);
+    _z_zbuf_free(&e_zbf);
+    _z_zbuf_free(&r_zbf);
+    _z_zbuf_free(&zbf);
+    _z_arena_free(&arena);
+    _z_wbuf_free(&rbf);
+    _z_wbuf_free(&wbf);
+}
+
 /*------------------ Transport Message ------------------*/
 _zn_transport_message_t *gen_transport_message(int can_be_fragment)
 {
@@ -2461,6 +2590,10 @@ _zn_transport_message_t *gen_transport_message(int can_be_fragment)
         p_sm->attachment = gen_attachment();
     else
         p_sm->attachment = NULL;
+    if (gen_bool())
+        p_sm->priority = (zn_priority_t)(gen_uint8() % _ZN_PRIORITIES_NUM);
+    else
+        p_sm->priority = ZN_PRIORITY_DEFAULT;
 
     uint8_t mids[] = {
         _ZN_MID_SCOUT,
@@ -2542,6 +2675,9 @@ void assert_eq_transport_message(_zn_transport_message_t *left, _zn_transport_me
     else
         assert(left->attachment == right->attachment);
 
+    printf("   Priority (%d:%d)\n", left->priority, right->priority);
+    assert(left->priority == right->priority);
+
     // Test message
     printf("   Header (%x:%x)", left->header, right->header);
     assert(left->header == right->header);
@@ -2877,6 +3013,7 @@ int main(void)
         // Zenoh messages
         declare_message();
         data_message();
+        preencoded_data_message();
         pull_message();
         query_message();
         zenoh_message();
@@ -2892,6 +3029,7 @@ int main(void)
         keep_alive_message();
         ping_pong_message();
         frame_message();
+        lazy_frame_message();
         transport_message();
         batch();
         fragmentation();
@@ -0,0 +1,202 @@
+/*
+ * Copyright (c) 2017, 2021 ADLINK Technology Inc.
+ *
+ * This program and the accompanying materials are made available under the
+ * terms of the Eclipse Public License 2.0 which is available at
+ * http://www.eclipse.org/legal/epl-2.0, or the Apache License, Version 2.0
+ * which is available at https://www.apache.org/licenses/LICENSE-2.0.
+ *
+ * SPDX-License-Identifier: EPL-2.0 OR Apache-2.0
+ *
+ * Contributors:
+ *   ADLINK zenoh team, <zenoh@adlink-labs.tech>
+ */
+
+#include <assert.h>
+#include <poll.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "zenoh-pico.h"
+#include "zenoh-pico/system/common.h"
+
+#define SESSIONS_NUM 3
+#define SPIN_MS 5000
+#define LARGE_LEN 100000
+
+zn_session_t *sessions[SESSIONS_NUM];
+z_clock_t start;
+
+// The samples received by each session
+unsigned int datas[SESSIONS_NUM];
+unsigned int larges[SESSIONS_NUM];
+
+void data_handler(const zn_sample_t *sample, const void *arg)
+{
+    int i = *(const int *)arg;
+    if (sample->value.len == LARGE_LEN)
+    {
+        for (size_t j = 0; j < LARGE_LEN; j++)
+            assert(sample->value.val[j] == (uint8_t)j);
+        larges[i]++;
+    }
+    else
+    {
+        assert(strcmp(sample->key.val, "/demo/multicast/rid") == 0 || strcmp(sample->key.val, "/demo/multicast/name") == 0);
+        datas[i]++;
+    }
+}
+
+// Drive the open sessions from this thread until the condition holds
+void spin(int (*cond)(void))
+{
+    z_clock_t begin = z_clock_now();
+    while (!cond() && z_clock_elapsed_ms(&begin) < SPIN_MS)
+    {
+        struct pollfd pfds[SESSIONS_NUM];
+        int idx[SESSIONS_NUM];
+        int n = 0;
+        for (int i = 0; i < SESSIONS_NUM; i++)
+        {
+            if (sessions[i] == NULL)
+                continue;
+            pfds[n].fd = znp_get_fd(sessions[i]);
+            pfds[n].events = POLLIN;
+            pfds[n].revents = 0;
+            idx[n++] = i;
+        }
+        poll(pfds, n, 10);
+
+        for (int i = 0; i < n; i++)
+        {
+            int res;
+            if (pfds[i].revents & POLLIN)
+            {
+                res = znp_process_readable(sessions[idx[i]]);
+                assert(res == 0);
+            }
+            res = znp_process_timers(sessions[idx[i]], (unsigned long)z_clock_elapsed_ms(&start));
+            assert(res >= 0);
+        }
+    }
+    assert(cond());
+}
+
+int knows(int i, int j)
+{
+    zn_properties_t *info = zn_info(sessions[i]);
+    zn_properties_t *other = zn_info(sessions[j]);
+    const char *peers = zn_properties_get(info, ZN_INFO_PEER_PID_KEY).val;
+    const char *pid = zn_properties_get(other, ZN_INFO_PID_KEY).val;
+    int res = peers != NULL && strstr(peers, pid) != NULL;
+    zn_properties_free(info);
+    zn_properties_free(other);
+    return res;
+}
+
+int first_two_joined(void)
+{
+    return knows(0, 1) && knows(1, 0);
+}
+
+int third_joined(void)
+{
+    return knows(0, 2) && knows(2, 0) && knows(1, 2);
+}
+
+int three_received(void)
+{
+    return datas[1] == 3;
+}
+
+int late_received(void)
+{
+    return datas[1] == 4 && datas[2] == 1;
+}
+
+int large_received(void)
+{
+    return larges[1] == 1 && larges[2] == 1;
+}
+
+int first_forgotten(void)
+{
+    zn_properties_t *info = zn_info(sessions[1]);
+    const char *peers = zn_properties_get(info, ZN_INFO_PEER_PID_KEY).val;
+    int res = peers != NULL && strchr(peers, ',') == NULL && knows(1, 2);
+    zn_properties_free(info);
+    return res;
+}
+
+zn_session_t *open_peer(const char *locator)
+{
+    zn_properties_t *config = zn_config_peer(locator);
+    zn_properties_insert(config, ZN_CONFIG_MULTICAST_INTERFACE_KEY, z_string_make("lo"));
+    zn_session_t *zn = zn_open(config);
+    zn_properties_free(config);
+    assert(zn != NULL);
+    return zn;
+}
+
+int main(void)
+{
+    setbuf(stdout, NULL);
+    start = z_clock_now();
+
+    // A group of its own for each run of the test
+    char locator[64];
+    snprintf(locator, sizeof(locator), "udp/224.0.0.225:%d", 20000 + getpid() % 20000);
+    printf("Joining %s\n", locator);
+
+    // The two first peers discover each other from their JOIN messages
+    sessions[0] = open_peer(locator);
+    sessions[1] = open_peer(locator);
+    spin(first_two_joined);
+
+    // The data are sent to the group and received by the subscribers of the other peers
+    int ids[SESSIONS_NUM] = {0, 1, 2};
+    zn_subscriber_t *sub = zn_declare_subscriber(sessions[1], zn_rname("/demo/multicast/**"), zn_subinfo_default(), data_handler, &ids[1]);
+    assert(sub != NULL);
+
+    // The resource ids are resolved with the declarations of the peer that sent the data
+    unsigned long rid = zn_declare_resource(sessions[0], zn_rname("/demo/multicast/rid"));
+    assert(rid != ZN_RESOURCE_ID_NONE);
+    int res = zn_write(sessions[0], zn_rname("/demo/multicast/name"), (const uint8_t *)"name", 4);
+    assert(res == 0);
+    res = zn_write(sessions[0], zn_rid(rid), (const uint8_t *)"rid", 3);
+    assert(res == 0);
+    res = zn_write(sessions[0], zn_rid(rid), (const uint8_t *)"rid", 3);
+    assert(res == 0);
+    spin(three_received);
+
+    // A late peer learns the resources declared before it joined
+    sessions[2] = open_peer(locator);
+    zn_subscriber_t *late_sub = zn_declare_subscriber(sessions[2], zn_rname("/demo/multicast/**"), zn_subinfo_default(), data_handler, &ids[2]);
+    assert(late_sub != NULL);
+    spin(third_joined);
+    res = zn_write(sessions[0], zn_rid(rid), (const uint8_t *)"rid", 3);
+    assert(res == 0);
+    spin(late_received);
+
+    // A large message is fragmented on the group
+    uint8_t *payload = (uint8_t *)malloc(LARGE_LEN);
+    for (size_t i = 0; i < LARGE_LEN; i++)
+        payload[i] = (uint8_t)i;
+    res = zn_write(sessions[0], zn_rname("/demo/multicast/large"), payload, LARGE_LEN);
+    assert(res == 0);
+    spin(large_received);
+    free(payload);
+
+    // A closed peer is removed from the group
+    zn_close(sessions[0]);
+    sessions[0] = NULL;
+    spin(first_forgotten);
+
+    zn_undeclare_subscriber(sub);
+    zn_undeclare_subscriber(late_sub);
+    zn_close(sessions[1]);
+    zn_close(sessions[2]);
+
+    return 0;
+}
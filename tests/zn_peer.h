@@ -0,0 +1,74 @@
+/*
+ * Copyright (c) 2017, 2021 ADLINK Technology Inc.
+ *
+ * This program and the accompanying materials are made available under the
+ * terms of the Eclipse Public License 2.0 which is available at
+ * http://www.eclipse.org/legal/epl-2.0, or the Apache License, Version 2.0
+ * which is available at https://www.apache.org/licenses/LICENSE-2.0.
+ *
+ * SPDX-License-Identifier: EPL-2.0 OR Apache-2.0
+ *
+ * Contributors:
+ *   ADLINK zenoh team, <zenoh@adlink-labs.tech>
+ */
+
+#ifndef _ZENOH_PICO_TESTS_PEER_H
+#define _ZENOH_PICO_TESTS_PEER_H
+
+#include <assert.h>
+#include <stdlib.h>
+#include "zenoh-pico.h"
+#include "zenoh-pico/protocol/private/msg.h"
+#include "zenoh-pico/protocol/private/msgcodec.h"
+#include "zenoh-pico/protocol/private/utils.h"
+#include "zenoh-pico/transport/private/utils.h"
+
+// NOTE: The tests of the links no router listens on run a minimal peer, a bare session
+//       on the accepting end of the link that plays the router side of the handshake.
+
+#define PEER_COOKIE_LEN 4
+
+static _zn_transport_message_t *peer_recv(zn_session_t *peer)
+{
+    _zn_transport_message_p_result_t r = _zn_recv_t_msg(peer);
+    if (r.tag == _z_res_t_ERR)
+        return NULL;
+    return r.value.transport_message;
+}
+
+static void peer_free(_zn_transport_message_t *t_msg)
+{
+    _zn_transport_message_free(t_msg);
+    free(t_msg);
+}
+
+// Answer the InitSyn and the OpenSyn of the session on the other end of the link
+static void peer_accept(zn_session_t *peer)
+{
+    // InitSyn -> InitAck
+    _zn_transport_message_t *t_msg = peer_recv(peer);
+    assert(t_msg != NULL);
+    assert(_ZN_MID(t_msg->header) == _ZN_MID_INIT);
+    assert(!_ZN_HAS_FLAG(t_msg->header, _ZN_FLAG_T_A));
+    peer_free(t_msg);
+
+    _zn_transport_message_t iam = _zn_init_ack_make(ZN_SN_RESOLUTION, 0, _z_bytes_make(PEER_COOKIE_LEN));
+    int res = _zn_send_t_msg(peer, &iam);
+    assert(res == 0);
+    _zn_transport_message_free(&iam);
+
+    // OpenSyn -> OpenAck, the cookie is sent back
+    t_msg = peer_recv(peer);
+    assert(t_msg != NULL);
+    assert(_ZN_MID(t_msg->header) == _ZN_MID_OPEN);
+    assert(t_msg->body.open.cookie.len == PEER_COOKIE_LEN);
+    peer_free(t_msg);
+
+    _zn_transport_message_t oam = _zn_open_ack_make(ZN_TRANSPORT_LEASE, 0);
+    res = _zn_send_t_msg(peer, &oam);
+    assert(res == 0);
+    _zn_transport_message_free(&oam);
+    (void)res;
+}
+
+#endif /* _ZENOH_PICO_TESTS_PEER_H */
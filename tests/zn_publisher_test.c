@@ -0,0 +1,154 @@
+/*
+ * Copyright (c) 2017, 2021 ADLINK Technology Inc.
+ *
+ * This program and the accompanying materials are made available under the
+ * terms of the Eclipse Public License 2.0 which is available at
+ * http://www.eclipse.org/legal/epl-2.0, or the Apache License, Version 2.0
+ * which is available at https://www.apache.org/licenses/LICENSE-2.0.
+ *
+ * SPDX-License-Identifier: EPL-2.0 OR Apache-2.0
+ *
+ * Contributors:
+ *   ADLINK zenoh team, <zenoh@adlink-labs.tech>
+ */
+
+
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "zenoh-pico.h"
+#include "zenoh-pico/protocol/private/msg.h"
+#include "zenoh-pico/system/common.h"
+
+#define MSG 1000
+#define FRAG_LEN 100000
+#define TIMEOUT 60
+
+// The samples received, in order
+volatile unsigned int datas = 0;
+void data_handler(const zn_sample_t *sample, const void *arg)
+{
+    (void)arg;
+    assert(sample->key.len == strlen("/demo/publisher"));
+    assert(strncmp("/demo/publisher", sample->key.val, sample->key.len) == 0);
+    assert(sample->value.len >= sizeof(unsigned int));
+    unsigned int seq;
+    memcpy(&seq, sample->value.val, sizeof(seq));
+    assert(seq == datas);
+    for (size_t i = sizeof(seq); i < sample->value.len; i++)
+        assert(sample->value.val[i] == (uint8_t)i);
+    datas++;
+}
+
+void wait_for(unsigned int n)
+{
+    z_clock_t start = z_clock_now();
+    while (datas < n)
+    {
+        assert(z_clock_elapsed_s(&start) < TIMEOUT);
+        z_sleep_ms(1);
+    }
+    assert(datas == n);
+}
+
+int main(void)
+{
+    setbuf(stdout, NULL);
+
+    // A session alone on its name receives its own frames back
+    zn_properties_t *config = zn_config_client("inproc/zn_publisher_test");
+    zn_session_t *s = zn_open(config);
+    assert(s != NULL);
+    znp_start_read_task(s);
+
+    zn_subscriber_t *sub = zn_declare_subscriber(s, zn_rname("/demo/publisher"), zn_subinfo_default(), data_handler, NULL);
+    assert(sub != NULL);
+
+    uint8_t *payload = (uint8_t *)malloc(FRAG_LEN);
+    for (size_t i = 0; i < FRAG_LEN; i++)
+        payload[i] = (uint8_t)i;
+
+    // The data written with the pre-encoded header carries the publisher key
+    zn_publisher_t *pub = zn_declare_publisher(s, zn_rname("/demo/publisher"));
+    assert(pub != NULL);
+    unsigned int n = 0;
+    for (; n < MSG; n++)
+    {
+        memcpy(payload, &n, sizeof(n));
+        int res = zn_publish(pub, payload, 64);
+        assert(res == 0);
+    }
+    wait_for(n);
+
+    // Large data is fragmented and reassembled
+    memcpy(payload, &n, sizeof(n));
+    zn_publish(pub, payload, FRAG_LEN);
+    n++;
+    wait_for(n);
+
+    // The publisher and zn_write can be used for the same key
+    memcpy(payload, &n, sizeof(n));
+    zn_write(s, zn_rname("/demo/publisher"), payload, 64);
+    n++;
+    memcpy(payload, &n, sizeof(n));
+    zn_publish(pub, payload, 64);
+    n++;
+    wait_for(n);
+
+    // The priority is encoded in the pre-encoded header
+    int res = zn_publisher_set_priority(pub, zn_priority_t_REAL_TIME);
+    assert(res == 0);
+    assert(pub->header.val[0] == _ZN_DECO_PRIORITY(zn_priority_t_REAL_TIME));
+    memcpy(payload, &n, sizeof(n));
+    zn_publish(pub, payload, 64);
+    n++;
+    wait_for(n);
+    res = zn_publisher_set_priority(pub, ZN_PRIORITY_DEFAULT);
+    assert(res == 0);
+    assert(_ZN_MID(pub->header.val[0]) == _ZN_MID_DATA);
+
+    // The priorities out of range are rejected
+    res = zn_publisher_set_priority(pub, (zn_priority_t)_ZN_PRIORITIES_NUM);
+    assert(res == -1);
+    assert(pub->priority == ZN_PRIORITY_DEFAULT);
+    res = zn_write_qos(s, zn_rname("/demo/publisher"), payload, 64, (zn_priority_t)_ZN_PRIORITIES_NUM, zn_reliability_t_RELIABLE, zn_congestion_control_t_BLOCK);
+    assert(res == -1);
+
+    // The congestion control is encoded in the pre-encoded header
+    zn_publisher_set_congestion_control(pub, zn_congestion_control_t_DROP);
+    assert(_ZN_HAS_FLAG(pub->header.val[0], _ZN_FLAG_Z_D));
+    zn_publisher_set_congestion_control(pub, zn_congestion_control_t_BLOCK);
+    assert(!_ZN_HAS_FLAG(pub->header.val[0], _ZN_FLAG_Z_D));
+
+    // Best-effort data is framed apart from the reliable data and still received in order
+    zn_publisher_set_reliability(pub, zn_reliability_t_BEST_EFFORT);
+    for (unsigned int i = 0; i < MSG; i++, n++)
+    {
+        memcpy(payload, &n, sizeof(n));
+        zn_publish(pub, payload, 64);
+    }
+    wait_for(n);
+    zn_publisher_set_reliability(pub, zn_reliability_t_RELIABLE);
+
+    // Each write can choose its own reliability and congestion control
+    for (unsigned int i = 0; i < MSG; i++, n++)
+    {
+        memcpy(payload, &n, sizeof(n));
+        zn_reliability_t reliability = i % 2 ? zn_reliability_t_BEST_EFFORT : zn_reliability_t_RELIABLE;
+        zn_congestion_control_t cong_ctrl = i % 3 ? zn_congestion_control_t_BLOCK : zn_congestion_control_t_DROP;
+        res = zn_write_qos(s, zn_rname("/demo/publisher"), payload, 64, ZN_PRIORITY_DEFAULT, reliability, cong_ctrl);
+        assert(res == 0);
+    }
+    wait_for(n);
+
+    zn_undeclare_publisher(pub);
+    zn_undeclare_subscriber(sub);
+    znp_stop_read_task(s);
+    zn_close(s);
+
+    free(payload);
+    zn_properties_free(config);
+
+    return 0;
+}
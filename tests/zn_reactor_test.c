@@ -0,0 +1,254 @@
+/*
+ * Copyright (c) 2017, 2021 ADLINK Technology Inc.
+ *
+ * This program and the accompanying materials are made available under the
+ * terms of the Eclipse Public License 2.0 which is available at
+ * http://www.eclipse.org/legal/epl-2.0, or the Apache License, Version 2.0
+ * which is available at https://www.apache.org/licenses/LICENSE-2.0.
+ *
+ * SPDX-License-Identifier: EPL-2.0 OR Apache-2.0
+ *
+ * Contributors:
+ *   ADLINK zenoh team, <zenoh@adlink-labs.tech>
+ */
+
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include "zenoh-pico.h"
+#include "zenoh-pico/link/private/manager.h"
+#include "zenoh-pico/protocol/private/msg.h"
+#include "zenoh-pico/protocol/private/msgcodec.h"
+#include "zenoh-pico/protocol/private/utils.h"
+#include "zenoh-pico/session/private/utils.h"
+#include "zenoh-pico/system/common.h"
+#include "zenoh-pico/transport/private/utils.h"
+#include "zn_peer.h"
+
+#define SESSIONS 8
+#define THREADS 2
+#define MSG 100
+#define MSG_LEN 256
+#define URI "/demo/reactor"
+
+// NOTE: No router listens on the Unix domain socket, each session is connected to a
+//       minimal peer running in its own thread, that completes the INIT/OPEN handshake,
+//       publishes some data and waits for a keep alive.
+typedef struct
+{
+    zn_session_t *zn;
+    volatile int go;
+    volatile int keep_alives;
+    volatile int closed;
+    volatile int done;
+} peer_t;
+
+int lsock;
+char path[64];
+// The last session is driven by an event loop in the main thread
+peer_t peers[SESSIONS + 1];
+volatile unsigned int datas[SESSIONS + 1];
+
+void *peer_run(void *arg)
+{
+    peer_t *p = (peer_t *)arg;
+
+    // Accept the connection
+    p->zn->link->sock = accept(lsock, NULL, NULL);
+    assert(p->zn->link->sock >= 0);
+
+    peer_accept(p->zn);
+
+    // Publish once the session is attached to the reactor
+    while (!p->go)
+        z_sleep_ms(1);
+    uint8_t payload[MSG_LEN];
+    memset(payload, 0x5a, MSG_LEN);
+    for (unsigned int i = 0; i < MSG; i++)
+    {
+        int res = zn_write(p->zn, zn_rname(URI), payload, MSG_LEN);
+        assert(res == 0);
+    }
+
+    // Receive until the session is closed
+    while (!p->closed)
+    {
+        _zn_transport_message_t *t_msg = peer_recv(p->zn);
+        if (t_msg == NULL)
+            break;
+        if (_ZN_MID(t_msg->header) == _ZN_MID_KEEP_ALIVE)
+            p->keep_alives++;
+        else if (_ZN_MID(t_msg->header) == _ZN_MID_CLOSE)
+            p->closed = 1;
+        peer_free(t_msg);
+    }
+
+    p->done = 1;
+    return 0;
+}
+
+void peer_start(peer_t *p, z_task_t *task)
+{
+    p->zn = _zn_session_init();
+    p->zn->link = _zn_new_link_unix(path);
+    p->zn->sn_resolution = ZN_SN_RESOLUTION;
+    p->zn->sn_resolution_half = ZN_SN_RESOLUTION / 2;
+    p->go = 0;
+    p->keep_alives = 0;
+    p->closed = 0;
+    p->done = 0;
+    z_task_init(task, NULL, peer_run, p);
+}
+
+void peer_stop(peer_t *p)
+{
+    while (!p->done)
+        z_sleep_ms(1);
+    assert(p->closed);
+    _zn_close_link(p->zn->link);
+    _zn_session_free(p->zn);
+}
+
+void data_handler(const zn_sample_t *sample, const void *arg)
+{
+    unsigned int idx = *(const unsigned int *)arg;
+    assert(sample->value.len == MSG_LEN);
+    assert(sample->key.len == strlen(URI));
+    assert(strncmp(URI, sample->key.val, sample->key.len) == 0);
+    datas[idx]++;
+}
+
+int main(void)
+{
+    setbuf(stdout, NULL);
+
+    snprintf(path, sizeof(path), "/tmp/zn_reactor_test_%d.sock", (int)getpid());
+    unlink(path);
+
+    lsock = socket(AF_UNIX, SOCK_STREAM, 0);
+    assert(lsock >= 0);
+    struct sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    strncpy(addr.sun_path, path, sizeof(addr.sun_path) - 1);
+    int res = bind(lsock, (struct sockaddr *)&addr, sizeof(addr));
+    assert(res == 0);
+    res = listen(lsock, SESSIONS + 1);
+    assert(res == 0);
+
+    znp_reactor_t *r = znp_reactor_new();
+    assert(r != NULL);
+    res = znp_reactor_start(r, THREADS);
+    assert(res == 0);
+
+    char locator[80];
+    snprintf(locator, sizeof(locator), "unixsock-stream/%s", path);
+    zn_properties_t *config = zn_config_client(locator);
+    zn_properties_insert(config, ZN_CONFIG_QOS_KEY, z_string_make("false"));
+
+    z_task_t tasks[SESSIONS + 1];
+    zn_session_t *ss[SESSIONS + 1];
+    zn_subscriber_t *subs[SESSIONS + 1];
+    unsigned int idx[SESSIONS + 1];
+    for (unsigned int i = 0; i < SESSIONS; i++)
+    {
+        peer_start(&peers[i], &tasks[i]);
+
+        // No read task nor lease task, the sessions are attached to the running reactor
+        ss[i] = zn_open(config);
+        assert(ss[i] != NULL);
+        idx[i] = i;
+        datas[i] = 0;
+        subs[i] = zn_declare_subscriber(ss[i], zn_rname(URI), zn_subinfo_default(), data_handler, &idx[i]);
+        assert(subs[i] != NULL);
+        res = znp_reactor_attach(r, ss[i]);
+        assert(res == 0);
+    }
+
+    // A link without socket can not be attached
+    zn_properties_t *inproc_config = zn_config_client("inproc/zn_reactor_test");
+    zn_session_t *inproc = zn_open(inproc_config);
+    assert(inproc != NULL);
+    res = znp_reactor_attach(r, inproc);
+    assert(res == -1);
+    zn_close(inproc);
+    zn_properties_free(inproc_config);
+
+    // The data of all the sessions are received by the reactor threads
+    for (unsigned int i = 0; i < SESSIONS; i++)
+        peers[i].go = 1;
+    z_clock_t start = z_clock_now();
+    for (unsigned int i = 0; i < SESSIONS; i++)
+    {
+        while (datas[i] < MSG && z_clock_elapsed_ms(&start) < 5000)
+            z_sleep_ms(1);
+        assert(datas[i] == MSG);
+    }
+    printf("Received %u data messages on %u sessions in %lums\n", MSG, SESSIONS, (unsigned long)z_clock_elapsed_ms(&start));
+
+    // And the keep alives are sent by the reactor timers
+    for (unsigned int i = 0; i < SESSIONS; i++)
+    {
+        while (peers[i].keep_alives == 0 && z_clock_elapsed_ms(&start) < 5000)
+            z_sleep_ms(1);
+        assert(peers[i].keep_alives > 0);
+    }
+
+    // A detached session is no longer processed by the reactor
+    res = znp_reactor_detach(r, ss[0]);
+    assert(res == 0);
+    res = znp_reactor_detach(r, ss[0]);
+    assert(res == -1);
+
+    res = znp_reactor_stop(r);
+    assert(res == 0);
+    znp_reactor_free(r);
+
+    // Drive a session from a single threaded event loop
+    unsigned int last = SESSIONS;
+    peer_start(&peers[last], &tasks[last]);
+    ss[last] = zn_open(config);
+    assert(ss[last] != NULL);
+    idx[last] = last;
+    datas[last] = 0;
+    subs[last] = zn_declare_subscriber(ss[last], zn_rname(URI), zn_subinfo_default(), data_handler, &idx[last]);
+    assert(subs[last] != NULL);
+    struct pollfd pfd;
+    pfd.fd = znp_get_fd(ss[last]);
+    pfd.events = POLLIN;
+    assert(pfd.fd >= 0);
+    peers[last].go = 1;
+
+    start = z_clock_now();
+    while ((datas[last] < MSG || peers[last].keep_alives == 0) && z_clock_elapsed_ms(&start) < 5000)
+    {
+        int timeout = znp_process_timers(ss[last], (unsigned long)z_clock_elapsed_ms(&start));
+        assert(timeout >= 0);
+        if (poll(&pfd, 1, timeout) > 0)
+        {
+            res = znp_process_readable(ss[last]);
+            assert(res == 0);
+        }
+    }
+    printf("Received %u data messages and sent %d keep alives from the event loop\n", datas[last], peers[last].keep_alives);
+    assert(datas[last] == MSG);
+    assert(peers[last].keep_alives > 0);
+
+    for (unsigned int i = 0; i <= SESSIONS; i++)
+    {
+        zn_undeclare_subscriber(subs[i]);
+        zn_close(ss[i]);
+        peer_stop(&peers[i]);
+    }
+
+    close(lsock);
+    unlink(path);
+    zn_properties_free(config);
+
+    return 0;
+}
@@ -0,0 +1,191 @@
+/*
+ * Copyright (c) 2017, 2021 ADLINK Technology Inc.
+ *
+ * This program and the accompanying materials are made available under the
+ * terms of the Eclipse Public License 2.0 which is available at
+ * http://www.eclipse.org/legal/epl-2.0, or the Apache License, Version 2.0
+ * which is available at https://www.apache.org/licenses/LICENSE-2.0.
+ *
+ * SPDX-License-Identifier: EPL-2.0 OR Apache-2.0
+ *
+ * Contributors:
+ *   ADLINK zenoh team, <zenoh@adlink-labs.tech>
+ */
+
+#include <assert.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "zenoh-pico.h"
+#include "zenoh-pico/link/private/manager.h"
+#include "zenoh-pico/protocol/private/msg.h"
+#include "zenoh-pico/protocol/private/msgcodec.h"
+#include "zenoh-pico/protocol/private/utils.h"
+#include "zenoh-pico/session/private/utils.h"
+#include "zenoh-pico/system/common.h"
+#include "zenoh-pico/transport/private/utils.h"
+#include "zn_peer.h"
+
+#define MSG 1000
+#define MSG_LEN 1024
+#define FRAG_LEN 100000
+
+// NOTE: No router listens on shared memory, the test runs a minimal peer in a
+//       separate thread that completes the INIT/OPEN handshake and checks the data.
+zn_session_t *peer;
+volatile unsigned int datas = 0;
+volatile int closed = 0;
+volatile int done = 0;
+
+void check_data(const _zn_zenoh_message_t *z_msg)
+{
+    assert(_ZN_MID(z_msg->header) == _ZN_MID_DATA);
+    assert(strcmp(z_msg->body.data.key.rname, "/demo/shm") == 0);
+    size_t len = z_msg->body.data.payload.len;
+    assert(len == MSG_LEN || len == FRAG_LEN);
+    for (size_t i = 0; i < len; i++)
+        assert(z_msg->body.data.payload.val[i] == (uint8_t)i);
+    datas++;
+}
+
+void *peer_run(void *arg)
+{
+    (void)arg;
+
+    // Accept the connection
+    _zn_socket_result_t r_sock = peer->link->open_f(peer->link, 0);
+    assert(r_sock.tag == _z_res_t_OK);
+
+    peer_accept(peer);
+
+    // Receive the data until the session is closed
+    _z_wbuf_t dbuf = _z_wbuf_make(ZN_FRAG_BUF_TX_CHUNK, 1);
+    while (!closed)
+    {
+        _zn_transport_message_t *t_msg = peer_recv(peer);
+        if (t_msg == NULL)
+            break;
+        switch (_ZN_MID(t_msg->header))
+        {
+        case _ZN_MID_FRAME:
+            if (_ZN_HAS_FLAG(t_msg->header, _ZN_FLAG_T_F))
+            {
+                // Copy the fragment since the message is freed right after
+                _z_wbuf_write_bytes(&dbuf, t_msg->body.frame.payload.fragment.val, 0, t_msg->body.frame.payload.fragment.len);
+                if (_ZN_HAS_FLAG(t_msg->header, _ZN_FLAG_T_E))
+                {
+                    _z_zbuf_t zbf = _z_wbuf_to_zbuf(&dbuf);
+                    _zn_zenoh_message_p_result_t r_zm = _zn_zenoh_message_decode(&zbf);
+                    assert(r_zm.tag == _z_res_t_OK);
+                    check_data(r_zm.value.zenoh_message);
+                    _zn_zenoh_message_free(r_zm.value.zenoh_message);
+                    _zn_zenoh_message_p_result_free(&r_zm);
+                    _z_zbuf_free(&zbf);
+                    _z_wbuf_reset(&dbuf);
+                }
+            }
+            else
+            {
+                for (size_t i = 0; i < z_vec_len(&t_msg->body.frame.payload.messages); i++)
+                    check_data((const _zn_zenoh_message_t *)z_vec_get(&t_msg->body.frame.payload.messages, i));
+            }
+            break;
+        case _ZN_MID_CLOSE:
+            closed = 1;
+            break;
+        default:
+            break;
+        }
+        _zn_transport_message_free(t_msg);
+        free(t_msg);
+    }
+
+    _z_wbuf_free(&dbuf);
+    done = 1;
+    return 0;
+}
+
+int main(void)
+{
+    setbuf(stdout, NULL);
+
+    char name[64];
+    snprintf(name, sizeof(name), "zn_shm_test_%d", (int)getpid());
+
+    // The peer listens on the shared memory segment
+    peer = _zn_session_init();
+    peer->link = _zn_new_link_shm(name, 1);
+    z_task_t task;
+    z_task_init(&task, NULL, peer_run, NULL);
+
+    char locator[80];
+    snprintf(locator, sizeof(locator), "shm/%s", name);
+    zn_properties_t *config = zn_config_client(locator);
+    zn_properties_insert(config, ZN_CONFIG_QOS_KEY, z_string_make("false"));
+    zn_session_t *s = zn_open(config);
+    assert(s != NULL);
+    assert(s->link->is_streamed && s->link->is_reliable);
+
+    // An unknown protocol is rejected
+    _zn_link_p_result_t r_link = _zn_open_link("foo/bar", 0, NULL);
+    assert(r_link.tag == _z_res_t_ERR);
+
+    zn_reskey_t rk = zn_rname("/demo/shm");
+    uint8_t *payload = (uint8_t *)malloc(FRAG_LEN);
+    for (size_t i = 0; i < FRAG_LEN; i++)
+        payload[i] = (uint8_t)i;
+
+    // Small messages fill the rings, a large one is fragmented
+    int res;
+    for (unsigned int i = 0; i < MSG; i++)
+    {
+        res = zn_write_ext(s, rk, payload, MSG_LEN, Z_ENCODING_DEFAULT, Z_DATA_KIND_DEFAULT, zn_congestion_control_t_BLOCK);
+        assert(res == 0);
+    }
+    res = zn_write_ext(s, rk, payload, FRAG_LEN, Z_ENCODING_DEFAULT, Z_DATA_KIND_DEFAULT, zn_congestion_control_t_BLOCK);
+    assert(res == 0);
+
+    zn_close(s);
+    while (!done)
+        z_sleep_ms(1);
+    printf("Received %u data messages\n", datas);
+    assert(closed);
+    assert(datas == MSG + 1);
+
+    // The listener removes the segment
+    _zn_close_link(peer->link);
+    _zn_session_free(peer);
+
+    // A segment left behind is replaced by a new listener, which gives up after the timeout
+    char stale[80];
+    snprintf(stale, sizeof(stale), "/%s", name);
+    int fd = shm_open(stale, O_CREAT | O_RDWR, S_IRUSR | S_IWUSR);
+    assert(fd >= 0);
+    close(fd);
+    _zn_link_t *listener = _zn_new_link_shm(name, 1);
+    z_clock_t start = z_clock_now();
+    _zn_socket_result_t r_sock = listener->open_f(listener, 50);
+    assert(r_sock.tag == _z_res_t_ERR);
+    assert(z_clock_elapsed_ms(&start) >= 50);
+    listener->release_f(listener);
+    free(listener);
+
+    // A connector gives up after the timeout without listener
+    _zn_link_t *connector = _zn_new_link_shm(name, 0);
+    start = z_clock_now();
+    r_sock = connector->open_f(connector, 50);
+    assert(r_sock.tag == _z_res_t_ERR);
+    assert(z_clock_elapsed_ms(&start) >= 50);
+    connector->release_f(connector);
+    free(connector);
+
+    free(payload);
+    free(rk.rname);
+    zn_properties_free(config);
+
+    return 0;
+}
@@ -0,0 +1,427 @@
+/*
+ * Copyright (c) 2017, 2021 ADLINK Technology Inc.
+ *
+ * This program and the accompanying materials are made available under the
+ * terms of the Eclipse Public License 2.0 which is available at
+ * http://www.eclipse.org/legal/epl-2.0, or the Apache License, Version 2.0
+ * which is available at https://www.apache.org/licenses/LICENSE-2.0.
+ *
+ * SPDX-License-Identifier: EPL-2.0 OR Apache-2.0
+ *
+ * Contributors:
+ *   ADLINK zenoh team, <zenoh@adlink-labs.tech>
+ */
+
+#include <assert.h>
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <sys/socket.h>
+#include "zenoh-pico.h"
+#include "zenoh-pico/link/private/manager.h"
+#include "zenoh-pico/system/common.h"
+#include "zenoh-pico/protocol/private/msgcodec.h"
+#include "zenoh-pico/protocol/private/utils.h"
+#include "zenoh-pico/session/private/utils.h"
+#include "zenoh-pico/transport/private/utils.h"
+
+#define DGRAM_LEN 1024
+#define DGRAM_NUM 6
+#define PATH_MTU 600
+#define MSG_LEN 4000
+#define FRAMES_NUM 3
+
+int bind_loopback(int *port)
+{
+    int sock = socket(AF_INET, SOCK_DGRAM, 0);
+    assert(sock >= 0);
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = 0;
+    int res = bind(sock, (struct sockaddr *)&addr, sizeof(addr));
+    assert(res == 0);
+    socklen_t alen = sizeof(addr);
+    res = getsockname(sock, (struct sockaddr *)&addr, &alen);
+    assert(res == 0);
+    *port = ntohs(addr.sin_port);
+    return sock;
+}
+
+void send_dgrams(_zn_link_t *link, uint8_t *buf, size_t *lens, size_t num)
+{
+    _z_wbuf_t wbf = _z_wbuf_make(DGRAM_LEN, 0);
+    size_t off = 0;
+    for (size_t i = 0; i < num; i++)
+    {
+        _z_wbuf_clear(&wbf);
+        _z_wbuf_write_bytes(&wbf, buf, off, lens[i]);
+        int res = _zn_send_wbuf(link, &wbf);
+        assert(res == 0);
+        off += lens[i];
+    }
+    _z_wbuf_free(&wbf);
+}
+
+void recv_dgrams(int psock, uint8_t *buf, size_t *lens, size_t num, struct sockaddr_storage *from, socklen_t *flen)
+{
+    uint8_t rbuf[DGRAM_LEN];
+    size_t off = 0;
+    for (size_t i = 0; i < num; i++)
+    {
+        *flen = sizeof(*from);
+        ssize_t n = recvfrom(psock, rbuf, DGRAM_LEN, 0, (struct sockaddr *)from, flen);
+        assert(n == (ssize_t)lens[i]);
+        assert(memcmp(buf + off, rbuf, lens[i]) == 0);
+        off += lens[i];
+    }
+}
+
+void test_mtu(void)
+{
+    int port;
+    int psock = bind_loopback(&port);
+
+    char locator[64];
+    snprintf(locator, sizeof(locator), "udp/127.0.0.1:%d", port);
+    _zn_link_p_result_t r_link = _zn_open_link(locator, 0, NULL);
+    assert(r_link.tag == _z_res_t_OK);
+    _zn_link_t *link = r_link.value.link;
+
+    // The datagrams fit in the largest UDP payload at most
+    printf("Loopback UDP link MTU: %u\n", link->mtu);
+    assert(link->mtu <= 65507);
+    _zn_close_link(link);
+    link->release_f(link);
+    free(link);
+
+    // A configured path MTU lowers the MTU of the link
+    _zn_link_opts_t opts = _zn_link_opts_default();
+    opts.mtu = PATH_MTU;
+    r_link = _zn_open_link(locator, 0, &opts);
+    assert(r_link.tag == _z_res_t_OK);
+    link = r_link.value.link;
+    assert(link->mtu == PATH_MTU);
+    assert(_zn_link_wbuf_capacity(link) == PATH_MTU);
+    _zn_close_link(link);
+    link->release_f(link);
+    free(link);
+
+    // A path MTU too small for the fragments is raised to the smallest one
+    opts.mtu = 64;
+    r_link = _zn_open_link(locator, 0, &opts);
+    assert(r_link.tag == _z_res_t_OK);
+    link = r_link.value.link;
+    assert(link->mtu == ZN_LINK_MTU_MIN);
+    _zn_close_link(link);
+    link->release_f(link);
+    free(link);
+
+    opts.mtu = PATH_MTU;
+    r_link = _zn_open_link(locator, 0, &opts);
+    assert(r_link.tag == _z_res_t_OK);
+    link = r_link.value.link;
+
+    zn_session_t *zn = _zn_session_init();
+    zn->link = link;
+    _z_wbuf_free(&zn->wbuf);
+    zn->wbuf = _z_wbuf_make(_zn_link_wbuf_capacity(zn->link), 0);
+    zn->sn_resolution = ZN_SN_RESOLUTION;
+    zn->sn_resolution_half = ZN_SN_RESOLUTION / 2;
+
+    // A message larger than the MTU is fragmented in datagrams fitting the MTU
+    uint8_t *payload = (uint8_t *)malloc(MSG_LEN);
+    memset(payload, 0xab, MSG_LEN);
+    int res = zn_write(zn, zn_rname("/test/mtu"), payload, MSG_LEN);
+    assert(res == 0);
+
+    _z_zbuf_t zbf = _z_zbuf_make(ZN_READ_BUF_LEN);
+    size_t frags = 0;
+    int is_final = 0;
+    while (!is_final)
+    {
+        _z_zbuf_clear(&zbf);
+        ssize_t n = recv(psock, _z_zbuf_get_wptr(&zbf), _z_zbuf_space_left(&zbf), 0);
+        assert(n > 0 && n <= PATH_MTU);
+        _z_zbuf_set_wpos(&zbf, n);
+
+        _zn_transport_message_p_result_t r_msg = _zn_transport_message_decode(&zbf);
+        assert(r_msg.tag == _z_res_t_OK);
+        _zn_transport_message_t *t_msg = r_msg.value.transport_message;
+        assert(_ZN_MID(t_msg->header) == _ZN_MID_FRAME);
+        assert(_ZN_HAS_FLAG(t_msg->header, _ZN_FLAG_T_F));
+        is_final = _ZN_HAS_FLAG(t_msg->header, _ZN_FLAG_T_E);
+        _zn_transport_message_free(t_msg);
+        free(t_msg);
+        frags++;
+    }
+    printf("Message of %d bytes sent in %zu fragments\n", MSG_LEN, frags);
+    assert(frags >= MSG_LEN / PATH_MTU);
+
+    _z_zbuf_free(&zbf);
+    free(payload);
+    _zn_close_link(link);
+    _zn_session_free(zn);
+    close(psock);
+}
+
+_zn_transport_message_t *recv_t_msg(int psock, _z_zbuf_t *zbf)
+{
+    _z_zbuf_clear(zbf);
+    ssize_t n = recv(psock, _z_zbuf_get_wptr(zbf), _z_zbuf_space_left(zbf), 0);
+    assert(n > 0);
+    _z_zbuf_set_wpos(zbf, n);
+
+    _zn_transport_message_p_result_t r_msg = _zn_transport_message_decode(zbf);
+    assert(r_msg.tag == _z_res_t_OK);
+    return r_msg.value.transport_message;
+}
+
+void free_t_msg(_zn_transport_message_t *t_msg)
+{
+    _zn_transport_message_free(t_msg);
+    free(t_msg);
+}
+
+char received[FRAMES_NUM + 1];
+size_t received_num = 0;
+
+void data_handler(const zn_sample_t *sample, const void *arg)
+{
+    (void)(arg);
+    assert(sample->value.len == 1);
+    received[received_num++] = (char)sample->value.val[0];
+}
+
+void test_reliability(void)
+{
+    int port;
+    int psock = bind_loopback(&port);
+
+    char locator[64];
+    snprintf(locator, sizeof(locator), "udp/127.0.0.1:%d", port);
+    _zn_link_p_result_t r_link = _zn_open_link(locator, 0, NULL);
+    assert(r_link.tag == _z_res_t_OK);
+
+    zn_session_t *zn = _zn_session_init();
+    zn->link = r_link.value.link;
+    _z_wbuf_free(&zn->wbuf);
+    zn->wbuf = _z_wbuf_make(_zn_link_wbuf_capacity(zn->link), 0);
+    zn->sn_resolution = ZN_SN_RESOLUTION;
+    zn->sn_resolution_half = ZN_SN_RESOLUTION / 2;
+    _zn_conduit_t *c = &zn->conduits[0];
+    assert(_zn_link_needs_retransmission(zn->link));
+
+    zn_subscriber_t *sub = zn_declare_subscriber(zn, zn_rname("/test/**"), zn_subinfo_default(), data_handler, NULL);
+    assert(sub != NULL);
+    _z_zbuf_t zbf = _z_zbuf_make(ZN_READ_BUF_LEN);
+    free_t_msg(recv_t_msg(psock, &zbf));
+
+    // The reliable frames are kept until they are acknowledged
+    z_zint_t sns[FRAMES_NUM];
+    for (int i = 0; i < FRAMES_NUM; i++)
+    {
+        int res = zn_write(zn, zn_rname("/test/reliability"), (const uint8_t *)"x", 1);
+        assert(res == 0);
+        _zn_transport_message_t *t_msg = recv_t_msg(psock, &zbf);
+        assert(_ZN_MID(t_msg->header) == _ZN_MID_FRAME);
+        sns[i] = t_msg->body.frame.sn;
+        free_t_msg(t_msg);
+    }
+    assert(c->tx_count == FRAMES_NUM + 1);
+
+    // A missing frame is sent again, the preceding ones are released
+    _zn_transport_message_t ack_nack = _zn_transport_message_init(_ZN_MID_ACK_NACK);
+    _ZN_SET_FLAG(ack_nack.header, _ZN_FLAG_T_M);
+    ack_nack.body.ack_nack.sn = sns[1];
+    ack_nack.body.ack_nack.mask = 0x01;
+    int res = _zn_handle_transport_message(zn, &ack_nack);
+    assert(res == _z_res_t_OK);
+    assert(c->tx_count == 2);
+    _zn_transport_message_t *t_msg = recv_t_msg(psock, &zbf);
+    assert(_ZN_MID(t_msg->header) == _ZN_MID_FRAME);
+    assert(t_msg->body.frame.sn == sns[1]);
+    free_t_msg(t_msg);
+
+    // The sync tells the oldest frame still kept
+    res = _zn_send_syncs(zn);
+    assert(res == 0);
+    t_msg = recv_t_msg(psock, &zbf);
+    assert(_ZN_MID(t_msg->header) == _ZN_MID_SYNC);
+    assert(_ZN_HAS_FLAG(t_msg->header, _ZN_FLAG_T_R) && _ZN_HAS_FLAG(t_msg->header, _ZN_FLAG_T_C));
+    assert(t_msg->body.sync.sn == (sns[2] + 1) % ZN_SN_RESOLUTION);
+    assert(t_msg->body.sync.count == 2);
+    free_t_msg(t_msg);
+
+    // Nothing is synced once all the frames are acknowledged
+    ack_nack = _zn_transport_message_init(_ZN_MID_ACK_NACK);
+    ack_nack.body.ack_nack.sn = (sns[2] + 1) % ZN_SN_RESOLUTION;
+    res = _zn_handle_transport_message(zn, &ack_nack);
+    assert(res == _z_res_t_OK);
+    assert(c->tx_count == 0);
+    res = _zn_send_syncs(zn);
+    assert(res == 0);
+    uint8_t b;
+    ssize_t n = recv(psock, &b, 1, MSG_DONTWAIT);
+    assert(n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK));
+
+    // Capture frames to be received out of order
+    _z_zbuf_t zbfs[FRAMES_NUM];
+    _zn_transport_message_t *frames[FRAMES_NUM];
+    for (int i = 0; i < FRAMES_NUM; i++)
+    {
+        char payload = (char)('0' + i);
+        res = zn_write(zn, zn_rname("/test/reliability"), (const uint8_t *)&payload, 1);
+        assert(res == 0);
+        zbfs[i] = _z_zbuf_make(ZN_READ_BUF_LEN);
+        frames[i] = recv_t_msg(psock, &zbfs[i]);
+    }
+    z_zint_t first = frames[0]->body.frame.sn;
+    z_zint_t last = frames[FRAMES_NUM - 1]->body.frame.sn;
+    c->sn_rx_reliable = (first + ZN_SN_RESOLUTION - 1) % ZN_SN_RESOLUTION;
+
+    // The missing frames are asked as soon as the gap appears
+    res = _zn_handle_transport_message(zn, frames[2]);
+    assert(res == _z_res_t_OK);
+    assert(received_num == 0);
+    t_msg = recv_t_msg(psock, &zbf);
+    assert(_ZN_MID(t_msg->header) == _ZN_MID_ACK_NACK);
+    assert(t_msg->body.ack_nack.sn == first);
+    assert(t_msg->body.ack_nack.mask == 0x03);
+    free_t_msg(t_msg);
+    res = _zn_handle_transport_message(zn, frames[1]);
+    assert(res == _z_res_t_OK);
+    assert(received_num == 0);
+
+    // And delivered in order once received
+    res = _zn_handle_transport_message(zn, frames[0]);
+    assert(res == _z_res_t_OK);
+    assert(received_num == FRAMES_NUM);
+    assert(strncmp(received, "012", FRAMES_NUM) == 0);
+    assert(c->sn_rx_reliable == last);
+    assert(c->rx_count == 0);
+
+    // A frame sent again is delivered once
+    res = _zn_handle_transport_message(zn, frames[1]);
+    assert(res == _z_res_t_OK);
+    assert(received_num == FRAMES_NUM);
+
+    // The frames not kept anymore by the peer are given up
+    _zn_transport_message_t sync = _zn_transport_message_init(_ZN_MID_SYNC);
+    _ZN_SET_FLAG(sync.header, _ZN_FLAG_T_R);
+    _ZN_SET_FLAG(sync.header, _ZN_FLAG_T_C);
+    sync.body.sync.sn = (last + 3) % ZN_SN_RESOLUTION;
+    sync.body.sync.count = 1;
+    res = _zn_handle_transport_message(zn, &sync);
+    assert(res == _z_res_t_OK);
+    assert(c->sn_rx_reliable == (last + 1) % ZN_SN_RESOLUTION);
+    t_msg = recv_t_msg(psock, &zbf);
+    assert(_ZN_MID(t_msg->header) == _ZN_MID_ACK_NACK);
+    assert(t_msg->body.ack_nack.sn == (last + 2) % ZN_SN_RESOLUTION);
+    assert(t_msg->body.ack_nack.mask == 0x01);
+    free_t_msg(t_msg);
+
+    for (int i = 0; i < FRAMES_NUM; i++)
+    {
+        free_t_msg(frames[i]);
+        _z_zbuf_free(&zbfs[i]);
+    }
+    _z_zbuf_free(&zbf);
+    zn_undeclare_subscriber(sub);
+    _zn_close_link(zn->link);
+    _zn_session_free(zn);
+    close(psock);
+}
+
+int main(void)
+{
+    setbuf(stdout, NULL);
+
+    uint8_t *buf = (uint8_t *)malloc(DGRAM_NUM * DGRAM_LEN);
+    for (size_t i = 0; i < DGRAM_NUM * DGRAM_LEN; i++)
+        buf[i] = (uint8_t)i;
+
+    int port;
+    int psock = bind_loopback(&port);
+
+    char locator[64];
+    snprintf(locator, sizeof(locator), "udp/127.0.0.1:%d", port);
+    _zn_link_p_result_t r_link = _zn_open_link(locator, 0, NULL);
+    assert(r_link.tag == _z_res_t_OK);
+    _zn_link_t *link = r_link.value.link;
+    // Only a link batching its datagrams can queue them
+    int is_batching = link->flush_f != NULL;
+    printf("Using batched datagrams: %d\n", is_batching);
+
+    // The datagrams of the same size but the last are sent at once, possibly with GSO
+    struct sockaddr_storage from;
+    socklen_t flen;
+    size_t same_lens[DGRAM_NUM] = {DGRAM_LEN, DGRAM_LEN, DGRAM_LEN, DGRAM_LEN, DGRAM_LEN, DGRAM_LEN / 2};
+    _zn_cork_link(link);
+    assert(link->is_corked == is_batching);
+    send_dgrams(link, buf, same_lens, DGRAM_NUM);
+    if (is_batching)
+    {
+        // Nothing has been sent yet
+        uint8_t b;
+        ssize_t n = recv(psock, &b, 1, MSG_DONTWAIT);
+        assert(n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK));
+    }
+    int res = _zn_uncork_link(link);
+    assert(res == 0);
+    assert(!link->is_corked);
+    recv_dgrams(psock, buf, same_lens, DGRAM_NUM, &from, &flen);
+
+    // The datagrams of different sizes are kept apart
+    size_t mixed_lens[DGRAM_NUM] = {10, DGRAM_LEN, 1, DGRAM_LEN / 2, DGRAM_LEN, 100};
+    _zn_cork_link(link);
+    send_dgrams(link, buf, mixed_lens, DGRAM_NUM);
+    res = _zn_uncork_link(link);
+    assert(res == 0);
+    recv_dgrams(psock, buf, mixed_lens, DGRAM_NUM, &from, &flen);
+
+    // And sent one by one when the link is not corked
+    send_dgrams(link, buf, mixed_lens, DGRAM_NUM);
+    recv_dgrams(psock, buf, mixed_lens, DGRAM_NUM, &from, &flen);
+
+    // The datagrams already received are read without going to the socket
+    size_t off = 0;
+    for (size_t i = 0; i < DGRAM_NUM; i++)
+    {
+        ssize_t n = sendto(psock, buf + off, mixed_lens[i], 0, (struct sockaddr *)&from, flen);
+        assert(n == (ssize_t)mixed_lens[i]);
+        off += mixed_lens[i];
+    }
+    uint8_t rbuf[DGRAM_LEN];
+    off = 0;
+    for (size_t i = 0; i < DGRAM_NUM; i++)
+    {
+        size_t rb = link->read_f(link, rbuf, DGRAM_LEN);
+        assert(rb == mixed_lens[i]);
+        assert(memcmp(buf + off, rbuf, mixed_lens[i]) == 0);
+        off += mixed_lens[i];
+        if (link->buffered_f != NULL)
+        {
+            printf("Datagrams left after read %zu: %zu\n", i, link->buffered_f(link));
+            assert(link->buffered_f(link) <= DGRAM_NUM - 1 - i);
+        }
+    }
+    if (link->buffered_f != NULL)
+        assert(link->buffered_f(link) == 0);
+
+    _zn_close_link(link);
+    link->release_f(link);
+    free(link);
+    close(psock);
+    free(buf);
+
+    test_mtu();
+    test_reliability();
+
+    return 0;
+}
@@ -0,0 +1,99 @@
+/*
+ * Copyright (c) 2017, 2021 ADLINK Technology Inc.
+ *
+ * This program and the accompanying materials are made available under the
+ * terms of the Eclipse Public License 2.0 which is available at
+ * http://www.eclipse.org/legal/epl-2.0, or the Apache License, Version 2.0
+ * which is available at https://www.apache.org/licenses/LICENSE-2.0.
+ *
+ * SPDX-License-Identifier: EPL-2.0 OR Apache-2.0
+ *
+ * Contributors:
+ *   ADLINK zenoh team, <zenoh@adlink-labs.tech>
+ */
+
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include "zenoh-pico.h"
+#include "zenoh-pico/link/private/manager.h"
+#include "zenoh-pico/system/common.h"
+
+#define LEN 100000
+
+int main(void)
+{
+    setbuf(stdout, NULL);
+
+    char path[64];
+    snprintf(path, sizeof(path), "/tmp/zn_unixsock_test_%d.sock", (int)getpid());
+    unlink(path);
+
+    // Listen on the socket path
+    int lsock = socket(AF_UNIX, SOCK_STREAM, 0);
+    assert(lsock >= 0);
+    struct sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    strncpy(addr.sun_path, path, sizeof(addr.sun_path) - 1);
+    int res = bind(lsock, (struct sockaddr *)&addr, sizeof(addr));
+    assert(res == 0);
+    res = listen(lsock, 1);
+    assert(res == 0);
+
+    // Connect through the link manager
+    char locator[80];
+    snprintf(locator, sizeof(locator), "unixsock-stream/%s", path);
+    _zn_link_p_result_t r_link = _zn_open_link(locator, 0, NULL);
+    assert(r_link.tag == _z_res_t_OK);
+    _zn_link_t *link = r_link.value.link;
+    assert(link->is_reliable && link->is_streamed);
+    int psock = accept(lsock, NULL, NULL);
+    assert(psock >= 0);
+
+    // A missing socket path fails to open
+    r_link = _zn_open_link("unixsock-stream//tmp/zn_unixsock_test_none.sock", 0, NULL);
+    assert(r_link.tag == _z_res_t_ERR);
+
+    // Send a stream of bytes in several slices
+    uint8_t *buf = (uint8_t *)malloc(LEN);
+    for (size_t i = 0; i < LEN; i++)
+        buf[i] = (uint8_t)i;
+    _z_wbuf_t wbf = _z_wbuf_make(LEN / 4, 1);
+    _z_wbuf_write_bytes(&wbf, buf, 0, LEN);
+    printf("Sending %zu slices\n", _z_wbuf_len_iosli(&wbf));
+    res = _zn_send_wbuf(link, &wbf);
+    assert(res == 0);
+
+    uint8_t *rbuf = (uint8_t *)malloc(LEN);
+    res = _zn_read_exact_unix(psock, rbuf, LEN);
+    assert(res == LEN);
+    assert(memcmp(buf, rbuf, LEN) == 0);
+
+    // And back
+    res = _zn_send_unix(psock, buf, 16);
+    assert(res == 16);
+    res = link->read_exact_f(link, rbuf, 16);
+    assert(res == 16);
+    assert(memcmp(buf, rbuf, 16) == 0);
+
+    // The peer sees the end of the stream once the link is closed
+    _zn_close_link(link);
+    res = _zn_read_exact_unix(psock, rbuf, 1);
+    assert(res < 0);
+
+    link->release_f(link);
+    free(link);
+    close(psock);
+    close(lsock);
+    unlink(path);
+    _z_wbuf_free(&wbf);
+    free(buf);
+    free(rbuf);
+
+    return 0;
+}
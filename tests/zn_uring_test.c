@@ -0,0 +1,155 @@
+/*
+ * Copyright (c) 2017, 2021 ADLINK Technology Inc.
+ *
+ * This program and the accompanying materials are made available under the
+ * terms of the Eclipse Public License 2.0 which is available at
+ * http://www.eclipse.org/legal/epl-2.0, or the Apache License, Version 2.0
+ * which is available at https://www.apache.org/licenses/LICENSE-2.0.
+ *
+ * SPDX-License-Identifier: EPL-2.0 OR Apache-2.0
+ *
+ * Contributors:
+ *   ADLINK zenoh team, <zenoh@adlink-labs.tech>
+ */
+
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <sys/socket.h>
+#include "zenoh-pico.h"
+#include "zenoh-pico/link/private/manager.h"
+#include "zenoh-pico/system/common.h"
+
+#define LEN 100000
+#define DGRAM_LEN 1024
+
+int bind_loopback(int type, int *port)
+{
+    int sock = socket(AF_INET, type, 0);
+    assert(sock >= 0);
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = 0;
+    int res = bind(sock, (struct sockaddr *)&addr, sizeof(addr));
+    assert(res == 0);
+    socklen_t alen = sizeof(addr);
+    res = getsockname(sock, (struct sockaddr *)&addr, &alen);
+    assert(res == 0);
+    *port = ntohs(addr.sin_port);
+    return sock;
+}
+
+void test_tcp(uint8_t *buf, uint8_t *rbuf)
+{
+    int port;
+    int lsock = bind_loopback(SOCK_STREAM, &port);
+    int res = listen(lsock, 1);
+    assert(res == 0);
+
+    char locator[64];
+    snprintf(locator, sizeof(locator), "tcp/127.0.0.1:%d", port);
+    _zn_link_p_result_t r_link = _zn_open_link(locator, 0, NULL);
+    assert(r_link.tag == _z_res_t_OK);
+    _zn_link_t *link = r_link.value.link;
+    int psock = accept(lsock, NULL, NULL);
+    assert(psock >= 0);
+    printf("Using io_uring: %d\n", link->uring != NULL);
+
+    // Send a stream of bytes in several slices
+    _z_wbuf_t wbf = _z_wbuf_make(LEN / 4, 1);
+    _z_wbuf_write_bytes(&wbf, buf, 0, LEN);
+    printf("Sending %zu slices on TCP\n", _z_wbuf_len_iosli(&wbf));
+    res = _zn_send_wbuf(link, &wbf);
+    assert(res == 0);
+    res = _zn_read_exact_tcp(psock, rbuf, LEN);
+    assert(res == LEN);
+    assert(memcmp(buf, rbuf, LEN) == 0);
+
+    // And back, in chunks larger than the buffers provided to the kernel
+    memset(rbuf, 0, LEN);
+    ssize_t wb = send(psock, buf, LEN, 0);
+    assert(wb == LEN);
+    size_t rb = link->read_exact_f(link, rbuf, LEN);
+    assert(rb == LEN);
+    assert(memcmp(buf, rbuf, LEN) == 0);
+
+    // The reads end once the peer closes
+    close(psock);
+    rb = link->read_f(link, rbuf, 1);
+    assert((int)rb <= 0);
+
+    _zn_close_link(link);
+    link->release_f(link);
+    free(link);
+    close(lsock);
+    _z_wbuf_free(&wbf);
+}
+
+void test_udp(uint8_t *buf, uint8_t *rbuf)
+{
+    int port;
+    int psock = bind_loopback(SOCK_DGRAM, &port);
+
+    char locator[64];
+    snprintf(locator, sizeof(locator), "udp/127.0.0.1:%d", port);
+    _zn_link_p_result_t r_link = _zn_open_link(locator, 0, NULL);
+    assert(r_link.tag == _z_res_t_OK);
+    _zn_link_t *link = r_link.value.link;
+
+    // The slices are gathered in a single datagram
+    _z_wbuf_t wbf = _z_wbuf_make(DGRAM_LEN / 4, 1);
+    _z_wbuf_write_bytes(&wbf, buf, 0, DGRAM_LEN);
+    printf("Sending %zu slices on UDP\n", _z_wbuf_len_iosli(&wbf));
+    int res = _zn_send_wbuf(link, &wbf);
+    assert(res == 0);
+
+    struct sockaddr_storage from;
+    socklen_t flen = sizeof(from);
+    ssize_t n = recvfrom(psock, rbuf, LEN, 0, (struct sockaddr *)&from, &flen);
+    assert(n == DGRAM_LEN);
+    assert(memcmp(buf, rbuf, DGRAM_LEN) == 0);
+
+    // The datagrams are received one at a time
+    for (int i = 0; i < 2; i++)
+    {
+        n = sendto(psock, buf + i, DGRAM_LEN, 0, (struct sockaddr *)&from, flen);
+        assert(n == DGRAM_LEN);
+    }
+    for (int i = 0; i < 2; i++)
+    {
+        memset(rbuf, 0, LEN);
+        size_t rb = link->read_f(link, rbuf, LEN);
+        assert(rb == DGRAM_LEN);
+        assert(memcmp(buf + i, rbuf, DGRAM_LEN) == 0);
+    }
+
+    _zn_close_link(link);
+    link->release_f(link);
+    free(link);
+    close(psock);
+    _z_wbuf_free(&wbf);
+}
+
+int main(void)
+{
+    setbuf(stdout, NULL);
+
+    uint8_t *buf = (uint8_t *)malloc(LEN);
+    for (size_t i = 0; i < LEN; i++)
+        buf[i] = (uint8_t)i;
+    uint8_t *rbuf = (uint8_t *)malloc(LEN);
+
+    test_tcp(buf, rbuf);
+    test_udp(buf, rbuf);
+
+    free(buf);
+    free(rbuf);
+
+    return 0;
+}